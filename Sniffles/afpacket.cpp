@@ -0,0 +1,295 @@
+#include "afpacket.h"
+
+#ifdef __linux__
+
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+
+#include "str.h"
+
+// PACKET_FANOUT_FLAG_DEFRAG makes the kernel reassemble IP fragments before
+// hashing, so every fragment of a datagram lands on the same worker.
+#define AFPACKET_FANOUT_MODE	(PACKET_FANOUT_HASH | PACKET_FANOUT_FLAG_DEFRAG)
+
+CAfPacketCapture::CAfPacketCapture(const char* pszDevice, uint16 nPort, int nWorkers, int nRingMB)
+	: m_strDevice(pszDevice), m_nPort(nPort), m_bUnlocked(false), m_bLoopback(false), m_bStopping(false)
+{
+	if (nWorkers < 1)
+		nWorkers = 1;
+
+	// every ring is locked in memory when it can be, so many workers share one budget
+	int nBlocks = (int)(((uint64)(nRingMB > 0 ? nRingMB : 0) << 20) / AFPACKET_BLOCK_SIZE / nWorkers);
+	m_nBlocks = nBlocks < AFPACKET_MIN_BLOCKS ? AFPACKET_MIN_BLOCKS : nBlocks > AFPACKET_MAX_BLOCKS ? AFPACKET_MAX_BLOCKS : nBlocks;
+
+	for (int i = 0; i < nWorkers; i++)
+	{
+		worker_t* pWorker = new worker_t;
+		pWorker->fd = -1;
+		pWorker->pRing = NULL;
+		pWorker->nKernelPackets = 0;
+		pWorker->nKernelDrops = 0;
+		m_workers.push_back(pWorker);
+	}
+}
+
+CAfPacketCapture::~CAfPacketCapture()
+{
+	Stop();
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		worker_t* pWorker = m_workers[i];
+
+		if (pWorker->thread.joinable())
+			pWorker->thread.join();
+		if (pWorker->pRing)
+			munmap(pWorker->pRing, (size_t)AFPACKET_BLOCK_SIZE * m_nBlocks);
+		if (pWorker->fd >= 0)
+			close(pWorker->fd);
+
+		delete pWorker;
+	}
+}
+
+bool CAfPacketCapture::Open()
+{
+	int nIfIndex = if_nametoindex(m_strDevice.c_str());
+	if (!nIfIndex)
+	{
+		outf("[afpacket] no such interface: %s\n", m_strDevice.c_str());
+		return false;
+	}
+
+	struct ifreq ifr;
+	memset(&ifr, 0, sizeof(ifr));
+	strncpy(ifr.ifr_name, m_strDevice.c_str(), IFNAMSIZ - 1);
+
+	int fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (fd >= 0)
+	{
+		if (ioctl(fd, SIOCGIFFLAGS, &ifr) == 0)
+			m_bLoopback = (ifr.ifr_flags & IFF_LOOPBACK) != 0;
+		close(fd);
+	}
+
+	// any id works as long as it is unique on the machine
+	int nFanoutId = getpid() & 0xFFFF;
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		if (!OpenSocket(m_workers[i], nIfIndex, nFanoutId))
+			return false;
+	}
+
+	if (m_bUnlocked)
+		outf("[afpacket] RLIMIT_MEMLOCK is too low to lock the %u MB rings, they may be paged out\n", m_nBlocks * (AFPACKET_BLOCK_SIZE >> 20));
+
+	return true;
+}
+
+bool CAfPacketCapture::OpenSocket(worker_t* pWorker, int nIfIndex, int nFanoutId)
+{
+	pWorker->fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+	if (pWorker->fd < 0)
+	{
+		outf("[afpacket] socket: %s\n", strerror(errno));
+		return false;
+	}
+
+	int version = TPACKET_V3;
+	if (setsockopt(pWorker->fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0)
+	{
+		outf("[afpacket] PACKET_VERSION: %s\n", strerror(errno));
+		return false;
+	}
+
+	// "udp and (src port N or dst port N)" for untagged IPv4 on Ethernet, dropping
+	// non-first fragments. The kernel has already pulled any VLAN tag out.
+	struct sock_filter filter[] =
+	{
+		BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 12),							// ethertype
+		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ETH_P_IP, 0, 10),
+		BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 23),							// ip protocol
+		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, IPPROTO_UDP, 0, 8),
+		BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 20),							// fragment offset
+		BPF_JUMP(BPF_JMP | BPF_JSET | BPF_K, 0x1FFF, 6, 0),
+		BPF_STMT(BPF_LDX | BPF_B | BPF_MSH, 14),							// x = ip header size
+		BPF_STMT(BPF_LD | BPF_H | BPF_IND, 14),							// src port
+		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, m_nPort, 2, 0),
+		BPF_STMT(BPF_LD | BPF_H | BPF_IND, 16),							// dst port
+		BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, m_nPort, 0, 1),
+		BPF_STMT(BPF_RET | BPF_K, 0xFFFF),
+		BPF_STMT(BPF_RET | BPF_K, 0),
+	};
+	struct sock_fprog program = { sizeof(filter) / sizeof(filter[0]), filter };
+
+	if (setsockopt(pWorker->fd, SOL_SOCKET, SO_ATTACH_FILTER, &program, sizeof(program)) < 0)
+	{
+		outf("[afpacket] SO_ATTACH_FILTER: %s\n", strerror(errno));
+		return false;
+	}
+
+	struct tpacket_req3 req;
+	memset(&req, 0, sizeof(req));
+	req.tp_block_size = AFPACKET_BLOCK_SIZE;
+	req.tp_block_nr = m_nBlocks;
+	req.tp_frame_size = AFPACKET_FRAME_SIZE;
+	req.tp_frame_nr = (AFPACKET_BLOCK_SIZE / AFPACKET_FRAME_SIZE) * m_nBlocks;
+	req.tp_retire_blk_tov = AFPACKET_BLOCK_TIMEOUT;
+
+	if (setsockopt(pWorker->fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0)
+	{
+		outf("[afpacket] PACKET_RX_RING: %s\n", strerror(errno));
+		return false;
+	}
+
+	size_t nRingSize = (size_t)AFPACKET_BLOCK_SIZE * m_nBlocks;
+	void* pRing = mmap(NULL, nRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED, pWorker->fd, 0);
+	if (pRing == MAP_FAILED)
+	{
+		// MAP_LOCKED needs RLIMIT_MEMLOCK headroom, the ring still works without it
+		pRing = mmap(NULL, nRingSize, PROT_READ | PROT_WRITE, MAP_SHARED, pWorker->fd, 0);
+		if (pRing == MAP_FAILED)
+		{
+			outf("[afpacket] mmap: %s\n", strerror(errno));
+			return false;
+		}
+		m_bUnlocked = true;
+	}
+	pWorker->pRing = (uint8*)pRing;
+
+	struct sockaddr_ll addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sll_family = AF_PACKET;
+	addr.sll_protocol = htons(ETH_P_ALL);
+	addr.sll_ifindex = nIfIndex;
+
+	if (bind(pWorker->fd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+	{
+		outf("[afpacket] bind: %s\n", strerror(errno));
+		return false;
+	}
+
+	int fanout = nFanoutId | (AFPACKET_FANOUT_MODE << 16);
+	if (setsockopt(pWorker->fd, SOL_PACKET, PACKET_FANOUT, &fanout, sizeof(fanout)) < 0)
+	{
+		outf("[afpacket] PACKET_FANOUT: %s\n", strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+void CAfPacketCapture::Run()
+{
+	for (size_t i = 0; i < m_workers.size(); i++)
+		m_workers[i]->thread = std::thread(WorkerMain, this, m_workers[i]);
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+		m_workers[i]->thread.join();
+}
+
+void CAfPacketCapture::Stop()
+{
+	m_bStopping.store(true, std::memory_order_release);
+}
+
+void CAfPacketCapture::CollectStats(decode_stats_t& stats) const
+{
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		merge_stats(stats, m_workers[i]->decoder.m_stats);
+		stats.nDropped += m_workers[i]->nKernelDrops;
+	}
+}
+
+// The kernel resets these counters every time they are read
+void CAfPacketCapture::ReadKernelStats(worker_t* pWorker)
+{
+	struct tpacket_stats_v3 kstats;
+	socklen_t len = sizeof(kstats);
+
+	if (getsockopt(pWorker->fd, SOL_PACKET, PACKET_STATISTICS, &kstats, &len) == 0)
+	{
+		pWorker->nKernelPackets += kstats.tp_packets;
+		pWorker->nKernelDrops += kstats.tp_drops;
+	}
+}
+
+void CAfPacketCapture::WalkBlock(worker_t* pWorker, const uint8* pBlock)
+{
+	const struct tpacket_block_desc* pDesc = (const struct tpacket_block_desc*)pBlock;
+	uint32 nPackets = pDesc->hdr.bh1.num_pkts;
+	const uint8* p = pBlock + pDesc->hdr.bh1.offset_to_first_pkt;
+
+	decode_stats_t& stats = pWorker->decoder.m_stats;
+
+	for (uint32 i = 0; i < nPackets; i++)
+	{
+		const struct tpacket3_hdr* pHeader = (const struct tpacket3_hdr*)p;
+
+		p += pHeader->tp_next_offset;
+
+		// same as libpcap: on loopback only keep the incoming copy
+		if (m_bLoopback)
+		{
+			const struct sockaddr_ll* pAddr = (const struct sockaddr_ll*)((const uint8*)pHeader + TPACKET_ALIGN(sizeof(struct tpacket3_hdr)));
+			if (pAddr->sll_pkttype == PACKET_OUTGOING)
+				continue;
+		}
+
+		stats.nFrames++;
+		stats.nFrameBytes += pHeader->tp_snaplen;
+
+		udp_frame_t frame;
+		if (parse_udp_frame(LINKTYPE_ETHERNET, (const uint8*)pHeader + pHeader->tp_mac, pHeader->tp_snaplen, frame))
+		{
+			frame.nTimestampUs = (uint64)pHeader->tp_sec * 1000000 + pHeader->tp_nsec / 1000;
+			pWorker->decoder.ProcessDatagram(frame);
+		}
+	}
+}
+
+void CAfPacketCapture::WorkerMain(CAfPacketCapture* pCapture, worker_t* pWorker)
+{
+	uint32 nBlock = 0;
+
+	while (!pCapture->m_bStopping.load(std::memory_order_acquire))
+	{
+		uint8* pBlock = pWorker->pRing + (size_t)nBlock * AFPACKET_BLOCK_SIZE;
+		struct tpacket_block_desc* pDesc = (struct tpacket_block_desc*)pBlock;
+
+		if (!(__atomic_load_n(&pDesc->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER))
+		{
+			// short timeout so Stop() is noticed on a quiet wire
+			struct pollfd pfd;
+			pfd.fd = pWorker->fd;
+			pfd.events = POLLIN | POLLERR;
+			pfd.revents = 0;
+			poll(&pfd, 1, 100);
+			continue;
+		}
+
+		pCapture->WalkBlock(pWorker, pBlock);
+
+		// hand the block back to the kernel
+		__atomic_store_n(&pDesc->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+		nBlock = (nBlock + 1) % pCapture->m_nBlocks;
+
+		if (nBlock == 0)
+			pCapture->ReadKernelStats(pWorker);
+	}
+
+	pCapture->ReadKernelStats(pWorker);
+}
+
+#endif // __linux__
@@ -0,0 +1,72 @@
+#pragma once
+
+// Linux only: AF_PACKET capture with TPACKET_V3 memory mapped rings
+#ifdef __linux__
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "decoder.h"
+
+#define AFPACKET_BLOCK_SIZE		(1 << 22)	// 4 MB per block
+#define AFPACKET_MIN_BLOCKS		4			// 16 MB of ring per worker at least
+#define AFPACKET_MAX_BLOCKS		64			// 256 MB of ring per worker at most
+#define AFPACKET_RING_MB		1024		// ring memory shared by all workers, unless -afpacketring says otherwise
+#define AFPACKET_FRAME_SIZE		2048
+#define AFPACKET_BLOCK_TIMEOUT	10			// ms before the kernel retires a partly filled block
+
+//-----------------------------------------------------------------------------
+// Captures from one interface with one AF_PACKET socket per decode worker.
+// The sockets join a PACKET_FANOUT_HASH group, so the kernel spreads flows
+// across them and each worker walks its own mmap ring. There is no copy into
+// user space and no hand-off between threads. nRingMB of ring is split
+// between the workers, within AFPACKET_MIN_BLOCKS and AFPACKET_MAX_BLOCKS each.
+//-----------------------------------------------------------------------------
+class CAfPacketCapture
+{
+public:
+	CAfPacketCapture(const char* pszDevice, uint16 nPort, int nWorkers, int nRingMB = AFPACKET_RING_MB);
+	~CAfPacketCapture();
+
+	// Creates the sockets and rings. Prints the reason and returns false on failure.
+	bool	Open();
+
+	// Captures until Stop() is called from another thread
+	void	Run();
+	void	Stop();
+
+	// Decoder stats from every worker, plus kernel drops
+	void	CollectStats(decode_stats_t& stats) const;
+
+private:
+	CAfPacketCapture(const CAfPacketCapture&);
+	CAfPacketCapture& operator=(const CAfPacketCapture&);
+
+	struct worker_t
+	{
+		int				fd;
+		uint8*			pRing;
+		CNetDecoder		decoder;
+		uint64			nKernelPackets;
+		uint64			nKernelDrops;
+		std::thread		thread;
+	};
+
+	bool	OpenSocket(worker_t* pWorker, int nIfIndex, int nFanoutId);
+	void	ReadKernelStats(worker_t* pWorker);
+	void	WalkBlock(worker_t* pWorker, const uint8* pBlock);
+
+	static void WorkerMain(CAfPacketCapture* pCapture, worker_t* pWorker);
+
+	std::string				m_strDevice;
+	uint16					m_nPort;
+	uint32					m_nBlocks;		// ring blocks per worker
+	bool					m_bUnlocked;	// some ring couldn't be MAP_LOCKED
+	bool					m_bLoopback;	// lo shows every packet twice, once per direction
+	std::vector<worker_t*>	m_workers;
+	std::atomic<bool>		m_bStopping;
+};
+
+#endif // __linux__
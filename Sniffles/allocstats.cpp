@@ -0,0 +1,59 @@
+#include "allocstats.h"
+
+#ifdef SNIFFLES_ALLOC_STATS
+
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+static std::atomic<uint64> s_nAllocs(0);
+static std::atomic<uint64> s_nFrees(0);
+static std::atomic<uint64> s_nBytes(0);
+
+void* operator new(size_t nSize)
+{
+	s_nAllocs.fetch_add(1, std::memory_order_relaxed);
+	s_nBytes.fetch_add(nSize, std::memory_order_relaxed);
+
+	void* p = malloc(nSize ? nSize : 1);
+	if (!p)
+		throw std::bad_alloc();
+	return p;
+}
+
+void* operator new[](size_t nSize)
+{
+	return operator new(nSize);
+}
+
+void operator delete(void* p) noexcept
+{
+	if (!p)
+		return;
+
+	s_nFrees.fetch_add(1, std::memory_order_relaxed);
+	free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	operator delete(p);
+}
+
+bool get_alloc_stats(alloc_stats_t& stats)
+{
+	stats.nAllocs = s_nAllocs.load(std::memory_order_relaxed);
+	stats.nFrees = s_nFrees.load(std::memory_order_relaxed);
+	stats.nBytes = s_nBytes.load(std::memory_order_relaxed);
+	return true;
+}
+
+#else
+
+bool get_alloc_stats(alloc_stats_t& stats)
+{
+	memset(&stats, 0, sizeof(stats));
+	return false;
+}
+
+#endif
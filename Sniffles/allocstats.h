@@ -0,0 +1,15 @@
+#pragma once
+
+#include "platform.h"
+
+// Build with SNIFFLES_ALLOC_STATS defined to count every operator new/delete
+// in the process. Off by default, the counters are shared by all threads.
+struct alloc_stats_t
+{
+	uint64	nAllocs;
+	uint64	nFrees;
+	uint64	nBytes;			// total requested, not live
+};
+
+// False when the counters aren't compiled in, stats is zeroed then
+bool get_alloc_stats(alloc_stats_t& stats);
@@ -0,0 +1,2950 @@
+#include "bench.h"
+#include "net.h"
+#include "str.h"
+#include "icekeys.h"
+#include "decoder.h"
+#include "dispatch.h"
+#include "msgpool.h"
+#include "allocstats.h"
+#include "wirefields.h"
+#include "emitter.h"
+#include "entities.h"
+#include "stringtable.h"
+#include "gameevents.h"
+#include "usermsg.h"
+#include "packetbitbuf.h"
+#include "netcompress.h"
+#include "lzss.h"
+#include "snappy.h"
+#include "corpus.h"
+#include "split.h"
+#include "subchannel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Each case should run for at least this long
+#define BENCH_MIN_SECONDS		0.25
+
+// Size of the datagrams the ICE and decode cases work on, close to the MTU
+#define BENCH_DATAGRAM_SIZE		1200
+
+// Uncompressed size of the packet used by the decompression cases
+#define BENCH_COMPRESSED_SIZE	16384
+
+// Keeps the compiler from throwing away results
+static volatile uint32 s_nBenchSink;
+
+//-----------------------------------------------------------------------------
+// Shared inputs, built once before the cases run
+//-----------------------------------------------------------------------------
+struct bench_data_t
+{
+	std::string		strPacket;			// plain netchannel packet
+	std::string		strDatagram;		// the same packet framed and encrypted, as sent by a server
+	std::string		strOutput;			// scratch output buffer
+	std::string		strLzss;			// BENCH_COMPRESSED_SIZE packet as an LZSS payload
+	std::string		strSnappy;			// and as a Snappy payload
+	std::string		strLzssDatagram;	// the payloads behind the -3 header, framed and encrypted
+	std::string		strSnappyDatagram;
+	std::string		strEntities;		// serialized CSVCMsg_PacketEntities of a full update
+	std::string		strGameEvent;		// serialized CSVCMsg_GameEvent with a few keys
+	CSVCMsg_GameEventList			gameEventList;		// declares the keys of strGameEvent
+	std::string		strUserMessage;		// serialized svc_UserMessage carrying a CCSUsrMsg_SayText2
+	std::string		strSamples[DISPATCH_MAX_MESSAGE_TYPES];	// one of each message type, every field set
+	std::vector<CSVCMsg_SendTable>	sendTables;			// signon of a small mod, see build_send_tables
+	CSVCMsg_ClassInfo				classInfo;
+	std::string						strTableLayout;		// the tables built and saved
+	CSVCMsg_PacketEntities			entitiesEnter;		// BENCH_ENTITIES players entering
+	CSVCMsg_PacketEntities			entitiesDelta;		// and a tick of them moving
+	std::string						strEntitiesDelta;	// serialized
+	CSVCMsg_CreateStringTable		stringTablePrecache;	// model paths, mostly substrings of earlier ones
+	CSVCMsg_CreateStringTable		stringTableBaselines;	// instance baselines of BENCH_STRING_CLASSES classes
+	CSVCMsg_UpdateStringTable		stringTableUpdate;		// and all of them sent again
+	std::string						strStringTableUpdate;	// serialized
+	std::string		strBits;			// BENCH_BIT_READ_SIZE bytes of noise for the bit reader
+	std::string		strVarInts;			// BENCH_VARINTS varints, mostly short like message headers
+	std::string		strVarIntsOffset;	// and the same behind 3 bits
+	std::string		strCoords;			// noise for BENCH_COORDS vectors, any bits decode as coordinates
+	std::vector<float>	coords;			// where the coordinate cases decode to
+	std::string		strUBitVars;		// BENCH_UBITVARS ubitvars, mostly small like class ids
+	std::string		strStrings;			// BENCH_STRINGS strings behind 3 bits, like string table entries
+	std::vector<std::string>	corpus;				// netchannel packets, recorded or from build_synthetic_corpus
+	std::vector<std::string>	corpusDatagrams;	// the ones that fit a datagram, framed and encrypted
+	std::vector<std::string>	corpusLzss;			// LZSS payloads of the ones that compress
+	uint32			nCorpusBytes;
+	uint32			nCorpusDatagramBytes;
+	uint32			nCorpusLzssBytes;	// uncompressed bytes of corpusLzss
+	unsigned char	key[ICE_KEY_SIZE];	// key of ICE_DEFAULT_BUILD
+};
+
+static void put_varint(std::string& str, uint32 nValue)
+{
+	while (nValue >= 0x80)
+	{
+		str += (char)(nValue | 0x80);
+		nValue >>= 7;
+	}
+	str += (char)nValue;
+}
+
+static void put_message(std::string& str, int nCmd, const ::google::protobuf::MessageLite& msg)
+{
+	std::string strMsg;
+	msg.SerializeToString(&strMsg);
+
+	put_varint(str, nCmd);
+	put_varint(str, (uint32)strMsg.size());
+	str += strMsg;
+}
+
+// Netchannel header followed by a tick
+static std::string build_packet_start()
+{
+	std::string str;
+	uint32 nSeq = 1;
+	str.append((const char*)&nSeq, 4);		// sequence
+	str.append((const char*)&nSeq, 4);		// sequence ack
+	str += (char)0;							// flags
+	str.append(2, '\0');					// checksum
+	str += (char)0;							// reliable state
+
+	CNETMsg_Tick tick;
+	tick.set_tick(1000);
+	put_message(str, net_Tick, tick);
+
+	return str;
+}
+
+// A netchannel packet with a tick followed by a print big enough to reach nSize
+static std::string build_packet(uint32 nSize)
+{
+	std::string str = build_packet_start();
+
+	CSVCMsg_Print print;
+	print.set_text(std::string(nSize > str.size() + 8 ? nSize - str.size() - 8 : 1, 'x'));
+	put_message(str, svc_Print, print);
+
+	return str;
+}
+
+// Entity deltas are mostly small values and zero runs
+static CSVCMsg_PacketEntities build_entities(uint32 nSize)
+{
+	std::string strEntities;
+	uint32 nSeed = 12345;
+	while (strEntities.size() < nSize)
+	{
+		nSeed = nSeed * 1103515245 + 12345;
+		uint32 r = nSeed >> 16;
+
+		if (r & 1)
+			strEntities.append((r >> 1) & 7, '\0');
+		else
+			strEntities += (char)((r >> 4) & 0x1F);
+	}
+
+	CSVCMsg_PacketEntities entities;
+	entities.set_max_entries(1024);
+	entities.set_updated_entries(200);
+	entities.set_is_delta(true);
+	entities.set_entity_data(strEntities);
+	return entities;
+}
+
+static std::string build_entities_message(uint32 nSize)
+{
+	return build_entities(nSize).SerializeAsString();
+}
+
+// player_death as the server sends it, keys only
+static std::string build_game_event_message()
+{
+	CSVCMsg_GameEvent event;
+	event.set_eventid(23);
+
+	for (int i = 0; i < 4; i++)
+	{
+		CSVCMsg_GameEvent_key_t* pKey = event.add_keys();
+		pKey->set_type(4);		// short
+		pKey->set_val_short(i + 2);
+	}
+
+	CSVCMsg_GameEvent_key_t* pKey = event.add_keys();
+	pKey->set_type(1);			// string
+	pKey->set_val_string("ak47");
+
+	pKey = event.add_keys();
+	pKey->set_type(6);			// bool
+	pKey->set_val_bool(true);
+
+	return event.SerializeAsString();
+}
+
+static void add_event_descriptor(CSVCMsg_GameEventList& list, int nEventId, const char* pszName, const char* pszKeys)
+{
+	CSVCMsg_GameEventList::descriptor_t* pDescriptor = list.add_descriptors();
+	pDescriptor->set_eventid(nEventId);
+	pDescriptor->set_name(pszName);
+
+	// "<type>name <type>name ..."
+	for (const char* psz = pszKeys; *psz; )
+	{
+		CSVCMsg_GameEventList::key_t* pKey = pDescriptor->add_keys();
+		pKey->set_type(*psz++ - '0');
+
+		const char* pszEnd = strchr(psz, ' ');
+		if (!pszEnd)
+			pszEnd = psz + strlen(psz);
+		pKey->set_name(std::string(psz, pszEnd));
+		psz = *pszEnd ? pszEnd + 1 : pszEnd;
+	}
+}
+
+// The events around build_game_event_message's player_death
+static void build_game_event_list(CSVCMsg_GameEventList& list)
+{
+	add_event_descriptor(list, 22, "player_hurt", "4userid 4attacker 5health 5armor 1weapon 4dmg_health 5dmg_armor 5hitgroup");
+	add_event_descriptor(list, 23, "player_death", "4userid 4attacker 4assister 4dominated 1weapon 6headshot");
+	add_event_descriptor(list, 24, "weapon_fire", "4userid 1weapon 6silenced");
+	add_event_descriptor(list, 40, "round_start", "3timelimit 3fraglimit 1objective");
+}
+
+// Something shaped like a full update: a tick, entity deltas and chat text
+static std::string build_update_packet(uint32 nSize)
+{
+	std::string str = build_packet_start();
+
+	put_message(str, svc_PacketEntities, build_entities(nSize - 1024));
+
+	CSVCMsg_Print print;
+	std::string strText;
+	while (str.size() + strText.size() + 8 < nSize)
+		strText += "Player killed Enemy with ak47 (headshot)\n";
+	print.set_text(strText);
+	put_message(str, svc_Print, print);
+
+	return str;
+}
+
+// Sets every field through reflection: repeated fields get a few elements,
+// sub messages are filled two levels deep
+static void fill_sample(::google::protobuf::Message& msg, int nDepth)
+{
+	using namespace ::google::protobuf;
+
+	const Descriptor* pDescriptor = msg.GetDescriptor();
+	const Reflection* pReflection = msg.GetReflection();
+
+	for (int i = 0; i < pDescriptor->field_count(); i++)
+	{
+		const FieldDescriptor* pField = pDescriptor->field(i);
+		bool bRepeated = pField->is_repeated();
+		int nCount = bRepeated ? 4 : 1;
+
+		for (int j = 0; j < nCount; j++)
+		{
+			switch (pField->cpp_type())
+			{
+			case FieldDescriptor::CPPTYPE_INT32:
+				bRepeated ? pReflection->AddInt32(&msg, pField, 1000 + j) : pReflection->SetInt32(&msg, pField, 1000 + j);
+				break;
+			case FieldDescriptor::CPPTYPE_INT64:
+				bRepeated ? pReflection->AddInt64(&msg, pField, 100000 + j) : pReflection->SetInt64(&msg, pField, 100000 + j);
+				break;
+			case FieldDescriptor::CPPTYPE_UINT32:
+				bRepeated ? pReflection->AddUInt32(&msg, pField, 1000 + j) : pReflection->SetUInt32(&msg, pField, 1000 + j);
+				break;
+			case FieldDescriptor::CPPTYPE_UINT64:
+				bRepeated ? pReflection->AddUInt64(&msg, pField, 100000 + j) : pReflection->SetUInt64(&msg, pField, 100000 + j);
+				break;
+			case FieldDescriptor::CPPTYPE_DOUBLE:
+				bRepeated ? pReflection->AddDouble(&msg, pField, 1.5 + j) : pReflection->SetDouble(&msg, pField, 1.5 + j);
+				break;
+			case FieldDescriptor::CPPTYPE_FLOAT:
+				bRepeated ? pReflection->AddFloat(&msg, pField, 1.5f + j) : pReflection->SetFloat(&msg, pField, 1.5f + j);
+				break;
+			case FieldDescriptor::CPPTYPE_BOOL:
+				bRepeated ? pReflection->AddBool(&msg, pField, true) : pReflection->SetBool(&msg, pField, true);
+				break;
+			case FieldDescriptor::CPPTYPE_ENUM:
+				bRepeated ? pReflection->AddEnum(&msg, pField, pField->enum_type()->value(0)) :
+					pReflection->SetEnum(&msg, pField, pField->enum_type()->value(0));
+				break;
+			case FieldDescriptor::CPPTYPE_STRING:
+				bRepeated ? pReflection->AddString(&msg, pField, "models/player/sample_value.mdl") :
+					pReflection->SetString(&msg, pField, "models/player/sample_value.mdl");
+				break;
+			case FieldDescriptor::CPPTYPE_MESSAGE:
+				if (nDepth < 2)
+					fill_sample(bRepeated ? *pReflection->AddMessage(&msg, pField) : *pReflection->MutableMessage(&msg, pField), nDepth + 1);
+				break;
+			}
+		}
+	}
+}
+
+template <typename T>
+static std::string build_sample()
+{
+	T msg;
+	fill_sample(msg, 0);
+	return msg.SerializeAsString();
+}
+
+// Compressed payloads, laid out the way they follow the -3 header
+static std::string compress_lzss(const std::string& strPacket)
+{
+	std::string str(strPacket.size(), '\0');
+	unsigned int nSize = 0;
+
+	CLZSS lzss;
+	if (!lzss.CompressNoAlloc((unsigned char*)&strPacket[0], (int)strPacket.size(), (unsigned char*)&str[0], &nSize))
+		return std::string();
+
+	str.resize(nSize);
+	return str;
+}
+
+static std::string compress_snappy(const std::string& strPacket)
+{
+	std::string str(4 + snappy::MaxCompressedLength(strPacket.size()), '\0');
+	uint32 id = SNAPPY_ID;
+	memcpy(&str[0], &id, 4);
+
+	size_t nSize = 0;
+	snappy::RawCompress(strPacket.data(), strPacket.size(), &str[4], &nSize);
+
+	str.resize(4 + nSize);
+	return str;
+}
+
+static std::string compressed_packet(const std::string& strPayload)
+{
+	int32 header = NET_HEADER_FLAG_COMPRESSEDPACKET;
+	return std::string((const char*)&header, 4) + strPayload;
+}
+
+// Adds the [deltaOffset][padding][size] framing and encrypts every whole block
+static std::string encrypt_datagram(const std::string& strPacket, const IceKey& ice)
+{
+	uint8 deltaOffset = 3;
+	uint32 nSize = (uint32)strPacket.size();
+
+	std::string str;
+	str += (char)deltaOffset;
+	str.append(deltaOffset, (char)0xAA);
+	str += (char)(nSize >> 24);
+	str += (char)(nSize >> 16);
+	str += (char)(nSize >> 8);
+	str += (char)nSize;
+	str += strPacket;
+
+	for (size_t i = 0; i + 8 <= str.size(); i += 8)
+		ice.encrypt((const unsigned char*)&str[i], (unsigned char*)&str[i]);
+
+	return str;
+}
+
+//-----------------------------------------------------------------------------
+// Cases
+//-----------------------------------------------------------------------------
+
+// What every packet used to pay: build the level 2 schedule, then throw it away
+static bool bench_ice_schedule(bench_data_t& data, uint32 nIterations)
+{
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		IceKey ice(2);
+		ice.set(data.key);
+		s_nBenchSink += ice.keySize();
+	}
+
+	return true;
+}
+
+static bool bench_ice_decrypt_block(bench_data_t& data, uint32 nIterations)
+{
+	const IceKey* pIce = CIceKeyCache::Get(2, data.key);
+	const unsigned char* pIn = (const unsigned char*)data.strDatagram.data();
+	unsigned char* pOut = (unsigned char*)&data.strOutput[0];
+	uint32 nBlocks = (uint32)data.strDatagram.size() / 8;
+
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		for (uint32 j = 0; j < nBlocks; j++)
+			pIce->decrypt(pIn + j * 8, pOut + j * 8);
+		s_nBenchSink += pOut[0];
+	}
+
+	return true;
+}
+
+static bool bench_ice_decrypt_bulk(bench_data_t& data, uint32 nIterations)
+{
+	const IceKey* pIce = CIceKeyCache::Get(2, data.key);
+	const unsigned char* pIn = (const unsigned char*)data.strDatagram.data();
+	unsigned char* pOut = (unsigned char*)&data.strOutput[0];
+	int nBlocks = (int)data.strDatagram.size() / 8;
+
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		pIce->decryptBlocks(pIn, pOut, nBlocks);
+		s_nBenchSink += pOut[0];
+	}
+
+	return true;
+}
+
+// Decrypt with a schedule rebuilt for every datagram, the old per-packet path
+static bool bench_ice_decrypt_rebuild(bench_data_t& data, uint32 nIterations)
+{
+	const unsigned char* pIn = (const unsigned char*)data.strDatagram.data();
+	unsigned char* pOut = (unsigned char*)&data.strOutput[0];
+	int nBlocks = (int)data.strDatagram.size() / 8;
+
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		IceKey ice(2);
+		ice.set(data.key);
+		ice.decryptBlocks(pIn, pOut, nBlocks);
+		s_nBenchSink += pOut[0];
+	}
+
+	return true;
+}
+
+static bool bench_decompress(const std::string& strPayload, std::string& strOutput, uint32 nIterations)
+{
+	const uint8* pIn = (const uint8*)strPayload.data();
+	uint8* pOut = (uint8*)&strOutput[0];
+
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		uint32 nSize = net_decompress(pIn, (uint32)strPayload.size(), pOut, (uint32)strOutput.size());
+		if (!nSize)
+			return false;
+		s_nBenchSink += nSize;
+	}
+
+	return true;
+}
+
+static bool bench_lzss_decompress(bench_data_t& data, uint32 nIterations)
+{
+	return bench_decompress(data.strLzss, data.strOutput, nIterations);
+}
+
+static bool bench_snappy_decompress(bench_data_t& data, uint32 nIterations)
+{
+	return bench_decompress(data.strSnappy, data.strOutput, nIterations);
+}
+
+// Cost a new session pays once to find its key
+static bool bench_ice_detect(bench_data_t& data, uint32 nIterations)
+{
+	const uint8* pData = (const uint8*)data.strDatagram.data();
+	uint32 size = (uint32)data.strDatagram.size();
+
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		if (!g_iceKeys.Detect(pData, size, NULL))
+			return false;
+	}
+
+	return true;
+}
+
+static bool bench_decode(const std::string& strDatagram, uint32 nIterations, const CMessageDispatcher* pDispatcher = NULL)
+{
+	CNetDecoder decoder;
+	if (pDispatcher)
+		decoder.SetDispatcher(pDispatcher);
+
+	udp_frame_t frame;
+	memset(&frame, 0, sizeof(frame));
+	frame.nSrcAddr = 0x0A000001;
+	frame.nDstAddr = 0x0A000002;
+	frame.nSrcPort = PORT_SERVER;
+	frame.nDstPort = PORT_CLIENT;
+	frame.pPayload = (const uint8*)strDatagram.data();
+	frame.nPayloadSize = (uint32)strDatagram.size();
+
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		if (!decoder.ProcessDatagram(frame))
+			return false;
+	}
+
+	s_nBenchSink += (uint32)decoder.m_stats.nPackets;
+	return !decoder.m_stats.nParseFailed;
+}
+
+static bool bench_decode_datagram(bench_data_t& data, uint32 nIterations)
+{
+	return bench_decode(data.strDatagram, nIterations);
+}
+
+static bool bench_decode_lzss(bench_data_t& data, uint32 nIterations)
+{
+	return bench_decode(data.strLzssDatagram, nIterations);
+}
+
+static bool bench_decode_snappy(bench_data_t& data, uint32 nIterations)
+{
+	return bench_decode(data.strSnappyDatagram, nIterations);
+}
+
+// A fresh message per parse, what every message used to cost
+template <typename T>
+static bool bench_parse_fresh(const std::string& strMessage, uint32 nIterations)
+{
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		T msg;
+		if (!msg.ParseFromArray(strMessage.data(), (int)strMessage.size()))
+			return false;
+	}
+
+	return true;
+}
+
+template <typename T>
+static bool bench_parse_pooled(const std::string& strMessage, uint32 nIterations)
+{
+	CMessagePool pool;
+
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		if (!pool.Get<T>().ParseFromArray(strMessage.data(), (int)strMessage.size()))
+			return false;
+	}
+
+	return true;
+}
+
+static bool bench_parse_entities_fresh(bench_data_t& data, uint32 nIterations)
+{
+	return bench_parse_fresh<CSVCMsg_PacketEntities>(data.strEntities, nIterations);
+}
+
+static bool bench_parse_entities_pooled(bench_data_t& data, uint32 nIterations)
+{
+	return bench_parse_pooled<CSVCMsg_PacketEntities>(data.strEntities, nIterations);
+}
+
+static bool bench_parse_event_fresh(bench_data_t& data, uint32 nIterations)
+{
+	return bench_parse_fresh<CSVCMsg_GameEvent>(data.strGameEvent, nIterations);
+}
+
+static bool bench_parse_event_pooled(bench_data_t& data, uint32 nIterations)
+{
+	return bench_parse_pooled<CSVCMsg_GameEvent>(data.strGameEvent, nIterations);
+}
+
+// A chat line, as svc_UserMessage carries it
+static std::string build_user_message()
+{
+	CCSUsrMsg_SayText2 sayText;
+	sayText.set_ent_idx(3);
+	sayText.set_chat(true);
+	sayText.set_msg_name("Cstrike_Chat_All");
+	sayText.add_params("Player");
+	sayText.add_params("nice shot, that was a one tap through the smoke");
+	sayText.add_params("");
+	sayText.add_params("");
+
+	CSVCMsg_UserMessage userMessage;
+	userMessage.set_msg_type(CS_UM_SayText2);
+	userMessage.set_msg_data(sayText.SerializeAsString());
+	return userMessage.SerializeAsString();
+}
+
+template <typename T>
+static void bench_on_user_message(const T& /*msg*/, int nSize, const message_source_t& /*source*/, void* /*pContext*/)
+{
+	s_nBenchSink += nSize;
+}
+
+// The chat line with nobody subscribed to it, and with a subscriber
+static bool bench_user_message(bench_data_t& data, uint32 nIterations, bool bSubscribed)
+{
+	CUserMessageDispatcher* pUserMessages = new CUserMessageDispatcher;
+	CUserMessagePool* pPool = new CUserMessagePool;
+	decode_stats_t stats;
+	reset_stats(stats);
+
+	if (bSubscribed)
+		pUserMessages->Subscribe(bench_on_user_message<CCSUsrMsg_SayText2>);
+
+	udp_frame_t frame;
+	memset(&frame, 0, sizeof(frame));
+	message_source_t source = { &frame, NULL, false };
+
+	bool bOk = true;
+	for (uint32 i = 0; bOk && i < nIterations; i++)
+	{
+		bOk = pUserMessages->DispatchUserMessage((const uint8*)data.strUserMessage.data(),
+			(int)data.strUserMessage.size(), source, *pPool, stats);
+	}
+
+	delete pPool;
+	delete pUserMessages;
+	return bOk;
+}
+
+static bool bench_user_message_skip(bench_data_t& data, uint32 nIterations)
+{
+	return bench_user_message(data, nIterations, false);
+}
+
+static bool bench_user_message_parse(bench_data_t& data, uint32 nIterations)
+{
+	return bench_user_message(data, nIterations, true);
+}
+
+// The same event decoded against its compiled layout
+static bool bench_game_event_decode(bench_data_t& data, uint32 nIterations)
+{
+	CGameEventLayouts* pLayouts = new CGameEventLayouts;
+	game_event_t event;
+
+	bool bOk = pLayouts->Compile(data.gameEventList);
+	for (uint32 i = 0; bOk && i < nIterations; i++)
+	{
+		bOk = pLayouts->Decode((const uint8*)data.strGameEvent.data(), (int)data.strGameEvent.size(), event);
+		s_nBenchSink += game_event_int(event, GAMEEVENT_KEY_ATTACKER);
+	}
+
+	delete pLayouts;
+	return bOk;
+}
+
+// The extract cases ask for the first few fields of each type
+#define BENCH_EXTRACT_FIELDS	3
+
+template <typename T>
+static bool bench_parse_sample(bench_data_t& data, uint32 nIterations)
+{
+	const std::string& strSample = data.strSamples[message_id<T>::value];
+	CMessagePool pool;
+
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		if (!pool.Get<T>().ParseFromArray(strSample.data(), (int)strSample.size()))
+			return false;
+	}
+
+	return true;
+}
+
+template <typename T>
+static bool bench_extract_sample(bench_data_t& data, uint32 nIterations)
+{
+	const std::string& strSample = data.strSamples[message_id<T>::value];
+	const ::google::protobuf::Descriptor* pDescriptor = T::descriptor();
+
+	wire_field_t fields[BENCH_EXTRACT_FIELDS];
+	int nFields = MIN(pDescriptor->field_count(), BENCH_EXTRACT_FIELDS);
+	for (int i = 0; i < nFields; i++)
+		fields[i].nField = pDescriptor->field(i)->number();
+
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		if (!extract_fields((const uint8*)strSample.data(), (int)strSample.size(), fields, nFields))
+			return false;
+		s_nBenchSink += (uint32)fields[0].nValue;
+	}
+
+	return true;
+}
+
+template <typename T>
+static void bench_on_message(const T& /*msg*/, int nSize, const message_source_t& /*source*/, void* /*pContext*/)
+{
+	s_nBenchSink += nSize;
+}
+
+// decode_snappy with every message type subscribed, i.e. the parse work that
+// is skipped when nobody wants the messages
+static bool bench_decode_snappy_parse(bench_data_t& data, uint32 nIterations)
+{
+	CMessageDispatcher dispatcher;
+
+#define SUBSCRIBE_MESSAGE(id, type) dispatcher.Subscribe(bench_on_message<type>);
+	NET_MESSAGE_TYPES(SUBSCRIBE_MESSAGE)
+#undef SUBSCRIBE_MESSAGE
+
+	return bench_decode(data.strSnappyDatagram, nIterations, &dispatcher);
+}
+
+#ifdef _WIN32
+#define BENCH_NULL_DEVICE		"NUL"
+#else
+#define BENCH_NULL_DEVICE		"/dev/null"
+#endif
+
+// decode_snappy with every message queued for NDJSON output, i.e. what the
+// decode thread pays for -emit. Formatting happens on the writer thread, and
+// whatever it can't keep up with is dropped rather than timed.
+static bool bench_decode_snappy_emit(bench_data_t& data, uint32 nIterations)
+{
+	CMessageDispatcher dispatcher;
+	CEventEmitter emitter;
+
+	if (!emitter.Open(BENCH_NULL_DEVICE, EMIT_FORMAT_NDJSON))
+		return false;
+
+	emitter.Subscribe(dispatcher, NULL);
+	return bench_decode(data.strSnappyDatagram, nIterations, &dispatcher);
+}
+
+//-----------------------------------------------------------------------------
+// Entity updates, written with the same encodings CEntityDecoder reads
+//-----------------------------------------------------------------------------
+
+// Players in the entity cases, each sending BENCH_ENTITY_DELTA_PROPS props a tick
+#define BENCH_ENTITIES				64
+#define BENCH_ENTITY_DELTA_PROPS	8
+#define BENCH_ENTITY_ACK_TICKS		4		// how far back entity_delta_snapshot's deltas are from
+
+struct bench_bits_t
+{
+	std::string		str;
+	uint32			nBits;
+};
+
+static void put_bits(bench_bits_t& bits, uint32 nValue, int nCount)
+{
+	for (int i = 0; i < nCount; i++, bits.nBits++)
+	{
+		if (!(bits.nBits & 7))
+			bits.str += '\0';
+		if ((nValue >> i) & 1)
+			bits.str[bits.nBits >> 3] |= (char)(1 << (bits.nBits & 7));
+	}
+}
+
+static void put_bit_varint(bench_bits_t& bits, uint32 nValue)
+{
+	while (nValue >= 0x80)
+	{
+		put_bits(bits, (nValue & 0x7F) | 0x80, 8);
+		nValue >>= 7;
+	}
+	put_bits(bits, nValue, 8);
+}
+
+static void put_ubitvar(bench_bits_t& bits, uint32 nValue)
+{
+	if (nValue < 16)
+		put_bits(bits, nValue, 6);
+	else if (nValue < 256)
+	{
+		put_bits(bits, (nValue & 15) | 16, 6);
+		put_bits(bits, nValue >> 4, 4);
+	}
+	else
+	{
+		put_bits(bits, (nValue & 15) | 32, 6);
+		put_bits(bits, nValue >> 4, 8);
+	}
+}
+
+// "New way" field index deltas, 0xFFF ends the list
+static void put_field_index(bench_bits_t& bits, int nIndex, int nLastIndex)
+{
+	uint32 nDelta = nIndex - nLastIndex - 1;
+	if (!nDelta && nIndex >= 0)
+	{
+		put_bits(bits, 1, 1);
+		return;
+	}
+
+	put_bits(bits, 0, 1);
+	if (nDelta < 8)
+	{
+		put_bits(bits, 1, 1);
+		put_bits(bits, nDelta, 3);
+		return;
+	}
+
+	put_bits(bits, 0, 1);
+	if (nDelta < 32)
+		put_bits(bits, nDelta, 7);
+	else if (nDelta < 128)
+	{
+		put_bits(bits, (nDelta & 31) | 32, 7);
+		put_bits(bits, nDelta >> 5, 2);
+	}
+	else if (nDelta < 512)
+	{
+		put_bits(bits, (nDelta & 31) | 64, 7);
+		put_bits(bits, nDelta >> 5, 4);
+	}
+	else
+	{
+		put_bits(bits, (nDelta & 31) | 96, 7);
+		put_bits(bits, nDelta >> 5, 7);
+	}
+}
+
+static void put_float(bench_bits_t& bits, const send_prop_t& prop, float flValue)
+{
+	if (prop.nDecode == PROP_DECODE_NOSCALE)
+	{
+		uint32 nValue;
+		memcpy(&nValue, &flValue, sizeof(nValue));
+		put_bits(bits, nValue, 32);
+	}
+	else if (prop.nDecode == PROP_DECODE_COORD)
+	{
+		// whole units only
+		int nValue = (int)flValue;
+		if (!nValue)
+		{
+			put_bits(bits, 0, 2);
+			return;
+		}
+		put_bits(bits, 1, 2);
+		put_bits(bits, nValue < 0, 1);
+		put_bits(bits, (nValue < 0 ? -nValue : nValue) - 1, COORD_INTEGER_BITS);
+	}
+	else
+	{
+		uint32 nMax = (1u << prop.nBits) - 1;
+		float flFraction = (flValue - prop.flLowValue) / (prop.flHighValue - prop.flLowValue);
+		put_bits(bits, (uint32)(flFraction * nMax + 0.5f), prop.nBits);
+	}
+}
+
+// A made up value for every prop type the bench tables use
+static void put_prop(bench_bits_t& bits, const send_prop_t* pProps, const send_prop_t& prop, uint32 nSeed)
+{
+	switch (prop.nType)
+	{
+	case DPT_Int:
+		if (prop.nDecode == PROP_DECODE_UVARINT || prop.nDecode == PROP_DECODE_VARINT)
+			put_bit_varint(bits, nSeed & 0xFF);
+		else
+			put_bits(bits, nSeed, prop.nBits);
+		break;
+	case DPT_Float:
+		put_float(bits, prop, prop.flLowValue + (float)(nSeed % 100) * 0.01f * (prop.flHighValue - prop.flLowValue));
+		break;
+	case DPT_Vector:
+		for (int i = 0; i < 3; i++)
+			put_float(bits, prop, (float)((int)(nSeed >> (i * 4)) % 2000 - 1000));
+		break;
+	case DPT_String:
+		put_bits(bits, 6, DT_MAX_STRING_BITS);
+		for (int i = 0; i < 6; i++)
+			put_bits(bits, 'a' + (nSeed + i) % 26, 8);
+		break;
+	case DPT_Array:
+	{
+		int nCountBits = 1;
+		for (int nMax = prop.nElements; nMax >>= 1; )
+			nCountBits++;
+
+		put_bits(bits, prop.nElements, nCountBits);
+		for (int i = 0; i < prop.nElements; i++)
+			put_prop(bits, pProps, pProps[prop.nElementProp], nSeed + i);
+	}
+	break;
+	}
+}
+
+static void add_send_prop(CSVCMsg_SendTable& table, int nType, const char* pszName, int nFlags, int nBits,
+	float flLow = 0.0f, float flHigh = 0.0f, const char* pszTable = NULL, int nElements = 0)
+{
+	CSVCMsg_SendTable::sendprop_t* pProp = table.add_props();
+	pProp->set_type(nType);
+	pProp->set_var_name(pszName);
+	pProp->set_flags(nFlags);
+	pProp->set_priority(128);
+	pProp->set_num_bits(nBits);
+	pProp->set_low_value(flLow);
+	pProp->set_high_value(flHigh);
+	if (pszTable)
+		pProp->set_dt_name(pszTable);
+	if (nElements)
+		pProp->set_num_elements(nElements);
+}
+
+// A player class built on a base entity: a collapsible table, an excluded
+// prop, an array and props that change often, like a real mod's. CCSPlayer
+// sends its origin in two copies like CS:GO's, one for its own client and one
+// for everyone else.
+static void build_send_tables(std::vector<CSVCMsg_SendTable>& tables, CSVCMsg_ClassInfo& classInfo)
+{
+	tables.resize(6);
+
+	CSVCMsg_SendTable& collision = tables[0];
+	collision.set_net_table_name("DT_CollisionProperty");
+	add_send_prop(collision, DPT_Vector, "m_vecMins", SPROP_NOSCALE, 0);
+	add_send_prop(collision, DPT_Vector, "m_vecMaxs", SPROP_NOSCALE, 0);
+	add_send_prop(collision, DPT_Int, "m_nSolidType", SPROP_UNSIGNED, 3);
+
+	CSVCMsg_SendTable& base = tables[1];
+	base.set_net_table_name("DT_BaseEntity");
+	add_send_prop(base, DPT_Int, "m_flSimulationTime", SPROP_UNSIGNED | SPROP_CHANGES_OFTEN, 8);
+	add_send_prop(base, DPT_Vector, "m_vecOrigin", SPROP_COORD | SPROP_CHANGES_OFTEN, 0);
+	add_send_prop(base, DPT_Vector, "m_angRotation", 0, 13, 0.0f, 360.0f);
+	add_send_prop(base, DPT_Int, "m_iTeamNum", SPROP_UNSIGNED, 6);
+	add_send_prop(base, DPT_Int, "m_nModelIndex", 0, 12);
+	add_send_prop(base, DPT_DataTable, "m_Collision", SPROP_COLLAPSIBLE, 0, 0.0f, 0.0f, "DT_CollisionProperty");
+	add_send_prop(base, DPT_String, "m_iName", 0, 0);
+
+	CSVCMsg_SendTable& player = tables[2];
+	player.set_net_table_name("DT_BasePlayer");
+	add_send_prop(player, DPT_DataTable, "baseclass", 0, 0, 0.0f, 0.0f, "DT_BaseEntity");
+	add_send_prop(player, DPT_Int, "m_nModelIndex", SPROP_EXCLUDE, 0, 0.0f, 0.0f, "DT_BaseEntity");
+	add_send_prop(player, DPT_Int, "m_iHealth", SPROP_UNSIGNED, 10);
+	add_send_prop(player, DPT_Int, "m_ArmorValue", SPROP_VARINT | SPROP_UNSIGNED, 32);
+	add_send_prop(player, DPT_Int, "m_iAmmo", SPROP_UNSIGNED | SPROP_INSIDEARRAY, 10);
+	add_send_prop(player, DPT_Array, "m_iAmmo", 0, 0, 0.0f, 0.0f, NULL, 32);
+	add_send_prop(player, DPT_Float, "m_angEyeAngles[0]", SPROP_CHANGES_OFTEN, 11, -90.0f, 90.0f);
+	add_send_prop(player, DPT_Float, "m_angEyeAngles[1]", SPROP_CHANGES_OFTEN, 11, 0.0f, 360.0f);
+	add_send_prop(player, DPT_Int, "m_fFlags", SPROP_UNSIGNED, 10);
+	add_send_prop(player, DPT_Int, "m_nTickBase", 0, 32);
+
+	CSVCMsg_SendTable& localData = tables[3];
+	localData.set_net_table_name("DT_CSLocalPlayerExclusive");
+	add_send_prop(localData, DPT_VectorXY, "m_vecOrigin", SPROP_NOSCALE | SPROP_CHANGES_OFTEN, 0);
+	add_send_prop(localData, DPT_Float, "m_vecOrigin[2]", SPROP_NOSCALE | SPROP_CHANGES_OFTEN, 0);
+
+	CSVCMsg_SendTable& nonLocalData = tables[4];
+	nonLocalData.set_net_table_name("DT_CSNonLocalPlayerExclusive");
+	add_send_prop(nonLocalData, DPT_VectorXY, "m_vecOrigin", SPROP_NOSCALE | SPROP_CHANGES_OFTEN, 0);
+	add_send_prop(nonLocalData, DPT_Float, "m_vecOrigin[2]", SPROP_NOSCALE | SPROP_CHANGES_OFTEN, 0);
+
+	CSVCMsg_SendTable& csPlayer = tables[5];
+	csPlayer.set_net_table_name("DT_CSPlayer");
+	add_send_prop(csPlayer, DPT_DataTable, "baseclass", 0, 0, 0.0f, 0.0f, "DT_BasePlayer");
+	add_send_prop(csPlayer, DPT_Vector, "m_vecOrigin", SPROP_EXCLUDE, 0, 0.0f, 0.0f, "DT_BaseEntity");
+	add_send_prop(csPlayer, DPT_DataTable, "cslocaldata", 0, 0, 0.0f, 0.0f, "DT_CSLocalPlayerExclusive");
+	add_send_prop(csPlayer, DPT_DataTable, "csnonlocaldata", 0, 0, 0.0f, 0.0f, "DT_CSNonLocalPlayerExclusive");
+	add_send_prop(csPlayer, DPT_Int, "m_iAccount", SPROP_UNSIGNED, 16);
+
+	CSVCMsg_ClassInfo::class_t* pClass = classInfo.add_classes();
+	pClass->set_class_id(0);
+	pClass->set_data_table_name("DT_BaseEntity");
+	pClass->set_class_name("CBaseEntity");
+
+	pClass = classInfo.add_classes();
+	pClass->set_class_id(1);
+	pClass->set_data_table_name("DT_BasePlayer");
+	pClass->set_class_name("CBasePlayer");
+
+	pClass = classInfo.add_classes();
+	pClass->set_class_id(2);
+	pClass->set_data_table_name("DT_CSPlayer");
+	pClass->set_class_name("CCSPlayer");
+}
+
+static void build_entity_updates(bench_data_t& data)
+{
+	CSendTables tables;
+	if (!tables.Build(data.sendTables, data.classInfo))
+		return;
+
+	tables.Save(data.strTableLayout);
+
+	int nPlayer = tables.FindClass("CBasePlayer");
+	const server_class_t& player = *tables.GetClass(nPlayer);
+	const send_prop_t* pProps = tables.GetProps(player);
+
+	static const char* s_pszDeltaProps[BENCH_ENTITY_DELTA_PROPS] =
+	{
+		"m_flSimulationTime", "m_vecOrigin", "m_angEyeAngles[0]", "m_angEyeAngles[1]",
+		"m_iHealth", "m_fFlags", "m_nTickBase", "m_iAmmo",
+	};
+
+	int nDeltaProps[BENCH_ENTITY_DELTA_PROPS];
+	for (int i = 0; i < BENCH_ENTITY_DELTA_PROPS; i++)
+		nDeltaProps[i] = tables.FindProp(nPlayer, s_pszDeltaProps[i]);
+	std::sort(nDeltaProps, nDeltaProps + BENCH_ENTITY_DELTA_PROPS);
+
+	// every player enters with all of its props
+	bench_bits_t enter = { std::string(), 0 };
+	for (int i = 0; i < BENCH_ENTITIES; i++)
+	{
+		put_ubitvar(enter, 0);
+		put_bits(enter, 0, 1);
+		put_bits(enter, 1, 1);
+		put_bits(enter, nPlayer, tables.GetClassBits());
+		put_bits(enter, i, NUM_NETWORKED_EHANDLE_SERIAL_NUMBER_BITS);
+
+		put_bits(enter, 1, 1);
+		for (uint32 j = 0; j < player.nProps; j++)
+			put_field_index(enter, j, (int)j - 1);
+		put_field_index(enter, 0xFFF + (int)player.nProps, (int)player.nProps - 1);
+
+		for (uint32 j = 0; j < player.nProps; j++)
+			put_prop(enter, pProps, pProps[j], i * 31 + j);
+	}
+
+	data.entitiesEnter.set_max_entries(BENCH_ENTITIES + 1);
+	data.entitiesEnter.set_updated_entries(BENCH_ENTITIES);
+	data.entitiesEnter.set_is_delta(false);
+	data.entitiesEnter.set_entity_data(enter.str);
+
+	// then they move
+	bench_bits_t delta = { std::string(), 0 };
+	for (int i = 0; i < BENCH_ENTITIES; i++)
+	{
+		put_ubitvar(delta, 0);
+		put_bits(delta, 0, 2);
+
+		put_bits(delta, 1, 1);
+		int nLast = -1;
+		for (int j = 0; j < BENCH_ENTITY_DELTA_PROPS; j++)
+		{
+			put_field_index(delta, nDeltaProps[j], nLast);
+			nLast = nDeltaProps[j];
+		}
+		put_field_index(delta, nLast + 1 + 0xFFF, nLast);
+
+		for (int j = 0; j < BENCH_ENTITY_DELTA_PROPS; j++)
+			put_prop(delta, pProps, pProps[nDeltaProps[j]], i * 17 + j);
+	}
+
+	data.entitiesDelta.set_max_entries(BENCH_ENTITIES + 1);
+	data.entitiesDelta.set_updated_entries(BENCH_ENTITIES);
+	data.entitiesDelta.set_is_delta(true);
+	data.entitiesDelta.set_delta_from(1);
+	data.entitiesDelta.set_entity_data(delta.str);
+}
+
+static bool bench_entity_tables_build(bench_data_t& data, uint32 nIterations)
+{
+	CSendTables tables;
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		if (!tables.Build(data.sendTables, data.classInfo))
+			return false;
+		s_nBenchSink += tables.GetClassCount();
+	}
+
+	return true;
+}
+
+// What a session that finds its layout in the table cache pays instead
+static bool bench_entity_tables_load(bench_data_t& data, uint32 nIterations)
+{
+	CSendTables tables;
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		if (!tables.Attach(data.strTableLayout.data(), data.strTableLayout.size()))
+			return false;
+		s_nBenchSink += tables.GetClassCount();
+	}
+
+	return true;
+}
+
+// One tick of BENCH_ENTITIES players moving, against state they entered with,
+// optionally at a tick like a session does: each tick is kept as a frame and
+// snapshot, and deltas from a frame BENCH_ENTITY_ACK_TICKS back restore it
+static bool bench_entity_ticks(bench_data_t& data, uint32 nIterations, bool bSnapshot)
+{
+	CEntityDecoder* pDecoder = new CEntityDecoder;
+	CSVCMsg_PacketEntities delta = data.entitiesDelta;
+	decode_stats_t stats;
+	reset_stats(stats);
+
+	bool bOk = pDecoder->GetTables().Build(data.sendTables, data.classInfo) &&
+		pDecoder->ReadPacketEntities(data.entitiesEnter, bSnapshot ? 0 : -1, stats);
+
+	for (uint32 i = 0; bOk && i < nIterations; i++)
+	{
+		int nTick = (int)i + 1;
+		if (bSnapshot)
+			delta.set_delta_from(nTick > BENCH_ENTITY_ACK_TICKS ? nTick - BENCH_ENTITY_ACK_TICKS : 0);
+
+		bOk = pDecoder->ReadPacketEntities(delta, bSnapshot ? nTick : -1, stats);
+	}
+
+	delete pDecoder;
+	return bOk;
+}
+
+static bool bench_entity_delta(bench_data_t& data, uint32 nIterations)
+{
+	return bench_entity_ticks(data, nIterations, false);
+}
+
+static bool bench_entity_delta_snapshot(bench_data_t& data, uint32 nIterations)
+{
+	return bench_entity_ticks(data, nIterations, true);
+}
+
+// The tick as a handler gets it, parsed first, which copies entity_data out
+// of the packet, or walked and decoded where it is
+static bool bench_entity_delta_serialized(bench_data_t& data, uint32 nIterations, bool bInPlace)
+{
+	CEntityDecoder* pDecoder = new CEntityDecoder;
+	CSVCMsg_PacketEntities msg;
+	decode_stats_t stats;
+	reset_stats(stats);
+
+	const uint8* pData = (const uint8*)data.strEntitiesDelta.data();
+	int nSize = (int)data.strEntitiesDelta.size();
+
+	bool bOk = pDecoder->GetTables().Build(data.sendTables, data.classInfo) &&
+		pDecoder->ReadPacketEntities(data.entitiesEnter, -1, stats);
+
+	for (uint32 i = 0; bOk && i < nIterations; i++)
+	{
+		if (bInPlace)
+			bOk = pDecoder->ReadPacketEntities(pData, nSize, -1, stats);
+		else
+			bOk = msg.ParseFromArray(pData, nSize) && pDecoder->ReadPacketEntities(msg, -1, stats);
+	}
+
+	delete pDecoder;
+	return bOk;
+}
+
+static bool bench_entity_delta_parsed(bench_data_t& data, uint32 nIterations)
+{
+	return bench_entity_delta_serialized(data, nIterations, false);
+}
+
+static bool bench_entity_delta_in_place(bench_data_t& data, uint32 nIterations)
+{
+	return bench_entity_delta_serialized(data, nIterations, true);
+}
+
+// Every player's origin, out of the columns
+static bool bench_entity_select_origins(bench_data_t& data, uint32 nIterations)
+{
+	CEntityDecoder* pDecoder = new CEntityDecoder;
+	decode_stats_t stats;
+	reset_stats(stats);
+
+	static uint16 s_nIndices[MAX_EDICTS];
+	static float s_flOrigins[MAX_EDICTS][3];
+
+	bool bOk = pDecoder->GetTables().Build(data.sendTables, data.classInfo) &&
+		pDecoder->ReadPacketEntities(data.entitiesEnter, -1, stats);
+
+	if (bOk)
+	{
+		int nPlayer = pDecoder->GetTables().FindClass("CBasePlayer");
+		for (uint32 i = 0; i < nIterations; i++)
+			s_nBenchSink += entity_select_origins(pDecoder->GetStore().GetLive(), nPlayer, s_nIndices, s_flOrigins);
+	}
+
+	delete pDecoder;
+	return bOk;
+}
+
+//-----------------------------------------------------------------------------
+// String tables, written with the engine's substring history
+//-----------------------------------------------------------------------------
+
+#define BENCH_STRING_ENTRIES		512		// model paths in the precache table
+#define BENCH_STRING_CLASSES		32		// classes with an instance baseline
+#define BENCH_BASELINE_SIZE			96		// bytes of each baseline
+
+struct bench_string_history_t
+{
+	std::vector<std::string>	strings;	// oldest first, at most STRINGTABLE_HISTORY
+};
+
+// One entry at the next index, its string sharing the longest prefix it can
+// with a recent one
+static void put_string_entry(bench_bits_t& bits, bench_string_history_t& history, const char* pszString,
+	const uint8* pUserData, uint32 nUserDataSize)
+{
+	put_bits(bits, 1, 1);
+
+	put_bits(bits, pszString != NULL, 1);
+	if (pszString)
+	{
+		int nBest = -1;
+		uint32 nBestLength = 0;
+		for (size_t i = 0; i < history.strings.size(); i++)
+		{
+			const std::string& str = history.strings[i];
+			uint32 nLength = 0;
+			while (nLength < str.size() && nLength < STRINGTABLE_HISTORY - 1 && str[nLength] == pszString[nLength])
+				nLength++;
+
+			if (nLength > nBestLength)
+			{
+				nBest = (int)i;
+				nBestLength = nLength;
+			}
+		}
+
+		// the engine only bothers for 3 bytes or more
+		if (nBestLength >= 3)
+		{
+			put_bits(bits, 1, 1);
+			put_bits(bits, nBest, 5);
+			put_bits(bits, nBestLength, SUBSTRING_BITS);
+		}
+		else
+		{
+			put_bits(bits, 0, 1);
+			nBestLength = 0;
+		}
+
+		for (const char* psz = pszString + nBestLength; *psz; psz++)
+			put_bits(bits, (uint8)*psz, 8);
+		put_bits(bits, 0, 8);
+	}
+
+	put_bits(bits, pUserData != NULL, 1);
+	if (pUserData)
+	{
+		put_bits(bits, nUserDataSize, MAX_USERDATA_BITS);
+		for (uint32 i = 0; i < nUserDataSize; i++)
+			put_bits(bits, pUserData[i], 8);
+	}
+
+	history.strings.push_back(pszString ? std::string(pszString, strnlen(pszString, STRINGTABLE_HISTORY)) : std::string());
+	if (history.strings.size() > STRINGTABLE_HISTORY)
+		history.strings.erase(history.strings.begin());
+}
+
+// Entry i of the precache table, in runs of 16 sharing a folder
+static void bench_model_path(int i, char* pszPath, size_t nSize)
+{
+	static const char* s_pszFolders[] =
+	{
+		"models/props/de_dust/hr_dust/dust_crates/",
+		"models/props/de_inferno/hr_i/inferno_fountain/",
+		"models/weapons/",
+		"models/player/custom_player/legacy/",
+	};
+
+	_snprintf_s(pszPath, nSize, _TRUNCATE, "%sprop_%03d_lod%d.mdl", s_pszFolders[(i / 16) % 4], i / 4, i % 4);
+}
+
+// Instance baseline of class i, BENCH_BASELINE_SIZE bytes
+static void bench_baseline(int i, uint8* pBaseline)
+{
+	for (int j = 0; j < BENCH_BASELINE_SIZE; j++)
+		pBaseline[j] = (uint8)(i * 7 + j);
+}
+
+static void build_string_tables(bench_data_t& data)
+{
+	bench_bits_t precache = { std::string(), 0 };
+	bench_string_history_t history;
+
+	put_bits(precache, 0, 1);
+	for (int i = 0; i < BENCH_STRING_ENTRIES; i++)
+	{
+		char szPath[128];
+		bench_model_path(i, szPath, sizeof(szPath));
+		put_string_entry(precache, history, szPath, NULL, 0);
+	}
+
+	data.stringTablePrecache.set_name("modelprecache");
+	data.stringTablePrecache.set_max_entries(1024);
+	data.stringTablePrecache.set_num_entries(BENCH_STRING_ENTRIES);
+	data.stringTablePrecache.set_user_data_fixed_size(false);
+	data.stringTablePrecache.set_string_data(precache.str);
+
+	bench_bits_t baselines = { std::string(), 0 };
+	bench_bits_t update = { std::string(), 0 };
+	bench_string_history_t baselinesHistory;
+	bench_string_history_t updateHistory;
+
+	put_bits(baselines, 0, 1);
+	put_bits(update, 0, 1);
+	for (int i = 0; i < BENCH_STRING_CLASSES; i++)
+	{
+		uint8 baseline[BENCH_BASELINE_SIZE];
+		bench_baseline(i, baseline);
+
+		char szClass[16];
+		_snprintf_s(szClass, sizeof(szClass), _TRUNCATE, "%d", i);
+		put_string_entry(baselines, baselinesHistory, szClass, baseline, BENCH_BASELINE_SIZE);
+
+		// the same entries, strings and all, with new data
+		baseline[0]++;
+		put_string_entry(update, updateHistory, szClass, baseline, BENCH_BASELINE_SIZE);
+	}
+
+	data.stringTableBaselines.set_name("instancebaseline");
+	data.stringTableBaselines.set_max_entries(1024);
+	data.stringTableBaselines.set_num_entries(BENCH_STRING_CLASSES);
+	data.stringTableBaselines.set_user_data_fixed_size(false);
+	data.stringTableBaselines.set_string_data(baselines.str);
+
+	data.stringTableUpdate.set_table_id(1);
+	data.stringTableUpdate.set_num_changed_entries(BENCH_STRING_CLASSES);
+	data.stringTableUpdate.set_string_data(update.str);
+}
+
+// A signon's worth of tables, decoded from scratch each time
+static bool bench_string_table_create(bench_data_t& data, uint32 nIterations)
+{
+	CStringTables* pTables = new CStringTables;
+
+	bool bOk = true;
+	for (uint32 i = 0; bOk && i < nIterations; i++)
+	{
+		pTables->Clear();
+		bOk = pTables->Create(data.stringTablePrecache) && pTables->Create(data.stringTableBaselines);
+	}
+
+	delete pTables;
+	return bOk;
+}
+
+// Every baseline replaced, as after a class's defaults change mid-match
+static bool bench_string_table_update(bench_data_t& data, uint32 nIterations)
+{
+	CStringTables* pTables = new CStringTables;
+	bool bOk = pTables->Create(data.stringTablePrecache) && pTables->Create(data.stringTableBaselines);
+
+	for (uint32 i = 0; bOk && i < nIterations; i++)
+		bOk = pTables->Update(data.stringTableUpdate);
+
+	delete pTables;
+	return bOk;
+}
+
+// The same from the serialized message, against parsing it first
+static bool bench_string_table_update_serialized(bench_data_t& data, uint32 nIterations, bool bInPlace)
+{
+	CStringTables* pTables = new CStringTables;
+	CSVCMsg_UpdateStringTable msg;
+
+	const uint8* pData = (const uint8*)data.strStringTableUpdate.data();
+	int nSize = (int)data.strStringTableUpdate.size();
+
+	bool bOk = pTables->Create(data.stringTablePrecache) && pTables->Create(data.stringTableBaselines);
+
+	for (uint32 i = 0; bOk && i < nIterations; i++)
+	{
+		if (bInPlace)
+			bOk = pTables->Update(pData, nSize);
+		else
+			bOk = msg.ParseFromArray(pData, nSize) && pTables->Update(msg);
+	}
+
+	delete pTables;
+	return bOk;
+}
+
+static bool bench_string_table_update_parsed(bench_data_t& data, uint32 nIterations)
+{
+	return bench_string_table_update_serialized(data, nIterations, false);
+}
+
+static bool bench_string_table_update_in_place(bench_data_t& data, uint32 nIterations)
+{
+	return bench_string_table_update_serialized(data, nIterations, true);
+}
+
+//-----------------------------------------------------------------------------
+// CBitRead on its own, with field widths in about the mix an entity update has
+//-----------------------------------------------------------------------------
+#define BENCH_BIT_READ_SIZE		4096
+
+static const int s_nBenchBitWidths[] = { 1, 1, 7, 11, 3, 1, 17, 32, 5, 1, 12, 8 };
+
+static void build_bits(bench_data_t& data)
+{
+	data.strBits.resize(BENCH_BIT_READ_SIZE);
+
+	uint32 nState = 0x9E3779B9;
+	for (int i = 0; i < BENCH_BIT_READ_SIZE; i++)
+	{
+		nState = nState * 1664525 + 1013904223;
+		data.strBits[i] = (char)(nState >> 24);
+	}
+}
+
+// Every field of the buffer, the last few in the reader's tail
+static bool bench_bit_read(bench_data_t& data, uint32 nIterations)
+{
+	const int nWidths = sizeof(s_nBenchBitWidths) / sizeof(s_nBenchBitWidths[0]);
+
+	int nCycleBits = 0;
+	for (int i = 0; i < nWidths; i++)
+		nCycleBits += s_nBenchBitWidths[i];
+	int nCycles = BENCH_BIT_READ_SIZE * 8 / nCycleBits;
+
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		CBitRead buf(data.strBits.data(), (int)data.strBits.size());
+
+		uint32 nSum = 0;
+		for (int j = 0; j < nCycles; j++)
+		{
+			for (int k = 0; k < nWidths; k++)
+				nSum += buf.ReadUBitLong(s_nBenchBitWidths[k]);
+		}
+
+		if (buf.IsOverflowed())
+			return false;
+		s_nBenchSink += nSum;
+	}
+
+	return true;
+}
+
+// Enough that the branch predictor can't learn their lengths, as it would
+// for a few hundred decoded over and over
+#define BENCH_VARINTS			65536
+
+static void build_varints(bench_data_t& data)
+{
+	bench_bits_t offset = { std::string(), 0 };
+	put_bits(offset, 0, 3);
+
+	uint32 nState = 0x9E3779B9;
+	for (int i = 0; i < BENCH_VARINTS; i++)
+	{
+		nState = nState * 1664525 + 1013904223;
+
+		// half of them one byte, a quarter two, the rest three to five
+		uint32 nValue = nState >> 8;
+		switch (nState >> 29)
+		{
+		case 0: case 1: case 2: case 3:	nValue &= 0x7F; break;
+		case 4: case 5:					nValue &= 0x3FFF; break;
+		case 6:							nValue &= 0x1FFFFF; break;
+		default:						nValue *= 257; break;
+		}
+
+		put_varint(data.strVarInts, nValue);
+		put_bit_varint(offset, nValue);
+	}
+
+	data.strVarIntsOffset = offset.str;
+}
+
+static bool bench_varint_read(const std::string& strVarInts, int nStartBit, uint32 nIterations)
+{
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		CBitRead buf(strVarInts.data(), (int)strVarInts.size());
+		buf.Seek(nStartBit);
+
+		uint32 nSum = 0;
+		for (int j = 0; j < BENCH_VARINTS; j++)
+			nSum += buf.ReadVarInt32();
+
+		if (buf.IsOverflowed())
+			return false;
+		s_nBenchSink += nSum;
+	}
+
+	return true;
+}
+
+static bool bench_varint_read_aligned(bench_data_t& data, uint32 nIterations)
+{
+	return bench_varint_read(data.strVarInts, 0, nIterations);
+}
+
+// Like varints following reliable data, which leaves the stream off a byte
+static bool bench_varint_read_offset(bench_data_t& data, uint32 nIterations)
+{
+	return bench_varint_read(data.strVarIntsOffset, 3, nIterations);
+}
+
+// Message header pairs, as ProcessMessages reads them
+static bool bench_varint_read_pairs(bench_data_t& data, uint32 nIterations)
+{
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		CBitRead buf(data.strVarInts.data(), (int)data.strVarInts.size());
+
+		uint32 nSum = 0;
+		for (int j = 0; j < BENCH_VARINTS / 2; j++)
+		{
+			uint32 header[2];
+			if (!buf.ReadVarInt32s(header, 2))
+				return false;
+			nSum += header[0] + header[1];
+		}
+
+		s_nBenchSink += nSum;
+	}
+
+	return true;
+}
+
+// The same bytes as wire format varints
+static bool bench_varint_wire(bench_data_t& data, uint32 nIterations)
+{
+	const uint8* pEnd = (const uint8*)data.strVarInts.data() + data.strVarInts.size();
+
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		const uint8* p = (const uint8*)data.strVarInts.data();
+
+		uint64 nSum = 0;
+		for (int j = 0; j < BENCH_VARINTS; j++)
+		{
+			uint64 nValue;
+			if (!wire_read_varint(p, pEnd, nValue))
+				return false;
+			nSum += nValue;
+		}
+
+		s_nBenchSink += (uint32)nSum;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Coordinates and normals one at a time, against the bulk reads
+//-----------------------------------------------------------------------------
+#define BENCH_COORDS			16384
+#define BENCH_CELL_BITS			10
+
+static void build_coords(bench_data_t& data)
+{
+	// a vector of three full coordinates takes 69 bits
+	data.strCoords.resize(BENCH_COORDS * 9);
+	data.coords.resize(BENCH_COORDS * 3);
+
+	uint32 nState = 0x2545F491;
+	for (size_t i = 0; i < data.strCoords.size(); i++)
+	{
+		nState = nState * 1664525 + 1013904223;
+		data.strCoords[i] = (char)(nState >> 24);
+	}
+}
+
+static bool bench_coord_read(bench_data_t& data, uint32 nIterations)
+{
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		CBitRead buf(data.strCoords.data(), (int)data.strCoords.size());
+		for (int j = 0; j < BENCH_COORDS; j++)
+			data.coords[j] = buf.ReadBitCoord();
+		if (buf.IsOverflowed())
+			return false;
+	}
+
+	return true;
+}
+
+static bool bench_coord_bulk(bench_data_t& data, uint32 nIterations)
+{
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		CBitRead buf(data.strCoords.data(), (int)data.strCoords.size());
+		if (!buf.ReadBitCoords(data.coords.data(), BENCH_COORDS))
+			return false;
+	}
+
+	return true;
+}
+
+static bool bench_coord_mp_read(bench_data_t& data, uint32 nIterations)
+{
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		CBitRead buf(data.strCoords.data(), (int)data.strCoords.size());
+		for (int j = 0; j < BENCH_COORDS; j++)
+			data.coords[j] = buf.ReadBitCoordMP(kCW_None);
+		if (buf.IsOverflowed())
+			return false;
+	}
+
+	return true;
+}
+
+static bool bench_coord_mp_bulk(bench_data_t& data, uint32 nIterations)
+{
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		CBitRead buf(data.strCoords.data(), (int)data.strCoords.size());
+		if (!buf.ReadBitCoordMPs(data.coords.data(), BENCH_COORDS, kCW_None))
+			return false;
+	}
+
+	return true;
+}
+
+static bool bench_cell_coord_read(bench_data_t& data, uint32 nIterations)
+{
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		CBitRead buf(data.strCoords.data(), (int)data.strCoords.size());
+		for (int j = 0; j < BENCH_COORDS; j++)
+			data.coords[j] = buf.ReadBitCellCoord(BENCH_CELL_BITS, kCW_None);
+		if (buf.IsOverflowed())
+			return false;
+	}
+
+	return true;
+}
+
+static bool bench_cell_coord_bulk(bench_data_t& data, uint32 nIterations)
+{
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		CBitRead buf(data.strCoords.data(), (int)data.strCoords.size());
+		if (!buf.ReadBitCellCoords(data.coords.data(), BENCH_COORDS, BENCH_CELL_BITS, kCW_None))
+			return false;
+	}
+
+	return true;
+}
+
+static bool bench_normal_read(bench_data_t& data, uint32 nIterations)
+{
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		CBitRead buf(data.strCoords.data(), (int)data.strCoords.size());
+		for (int j = 0; j < BENCH_COORDS; j++)
+			data.coords[j] = buf.ReadBitNormal();
+		if (buf.IsOverflowed())
+			return false;
+	}
+
+	return true;
+}
+
+static bool bench_normal_bulk(bench_data_t& data, uint32 nIterations)
+{
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		CBitRead buf(data.strCoords.data(), (int)data.strCoords.size());
+		if (!buf.ReadBitNormals(data.coords.data(), BENCH_COORDS))
+			return false;
+	}
+
+	return true;
+}
+
+static bool bench_vec3_coord_read(bench_data_t& data, uint32 nIterations)
+{
+	Vector* pVectors = (Vector*)data.coords.data();
+
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		CBitRead buf(data.strCoords.data(), (int)data.strCoords.size());
+		for (int j = 0; j < BENCH_COORDS; j++)
+			buf.ReadBitVec3Coord(pVectors[j]);
+		if (buf.IsOverflowed())
+			return false;
+	}
+
+	return true;
+}
+
+static bool bench_vec3_coord_bulk(bench_data_t& data, uint32 nIterations)
+{
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		CBitRead buf(data.strCoords.data(), (int)data.strCoords.size());
+		if (!buf.ReadBitVec3Coords((Vector*)data.coords.data(), BENCH_COORDS))
+			return false;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// The other primitives string tables and entity headers are read with
+//-----------------------------------------------------------------------------
+#define BENCH_UBITVARS			16384
+#define BENCH_STRINGS			4096
+
+static void build_ubitvars(bench_data_t& data)
+{
+	bench_bits_t bits = { std::string(), 0 };
+
+	uint32 nState = 0x2545F491;
+	for (int i = 0; i < BENCH_UBITVARS; i++)
+	{
+		nState = nState * 1664525 + 1013904223;
+
+		// 3 in 4 fit the 4 bit form, most of the rest the 8 bit one
+		uint32 nValue = nState >> 20;
+		switch ((nState >> 8) & 15)
+		{
+		case 0:
+			break;
+		case 1: case 2: case 3:
+			nValue &= 255;
+			break;
+		default:
+			nValue &= 15;
+			break;
+		}
+
+		put_ubitvar(bits, nValue);
+	}
+
+	data.strUBitVars = bits.str;
+}
+
+static void build_strings(bench_data_t& data)
+{
+	static const char* s_pszDirs[] = { "models/player/", "models/weapons/", "materials/decals/", "sound/weapons/" };
+	static const char* s_pszNames[] = { "ct_sas", "tm_phoenix", "w_rif_ak47", "v_pist_deagle", "blood", "ak47_01" };
+
+	bench_bits_t bits = { std::string(), 0 };
+	put_bits(bits, 0, 3);
+
+	char szString[64];
+	for (int i = 0; i < BENCH_STRINGS; i++)
+	{
+		_snprintf_s(szString, sizeof(szString), _TRUNCATE, "%s%s_%d.mdl", s_pszDirs[i & 3], s_pszNames[i % 6], i);
+		for (const char* p = szString; ; p++)
+		{
+			put_bits(bits, (uint8)*p, 8);
+			if (!*p)
+				break;
+		}
+	}
+
+	data.strStrings = bits.str;
+}
+
+static bool bench_bit_read_ubitvar(bench_data_t& data, uint32 nIterations)
+{
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		CBitRead buf(data.strUBitVars.data(), (int)data.strUBitVars.size());
+
+		uint32 nSum = 0;
+		for (int j = 0; j < BENCH_UBITVARS; j++)
+			nSum += buf.ReadUBitVar();
+
+		if (buf.IsOverflowed())
+			return false;
+		s_nBenchSink += nSum;
+	}
+
+	return true;
+}
+
+static bool bench_bit_read_string(bench_data_t& data, uint32 nIterations)
+{
+	char szString[256];
+
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		CBitRead buf(data.strStrings.data(), (int)data.strStrings.size());
+		buf.ReadUBitLong(3);
+
+		uint32 nSum = 0;
+		for (int j = 0; j < BENCH_STRINGS; j++)
+		{
+			buf.ReadString(szString, sizeof(szString));
+			nSum += (uint8)szString[0];
+		}
+
+		if (buf.IsOverflowed())
+			return false;
+		s_nBenchSink += nSum;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Corpus: whole packets as they arrive in a match, recorded with -record or
+// built here. Each iteration goes through every packet once.
+//-----------------------------------------------------------------------------
+#define BENCH_CORPUS_PACKETS	512
+
+// Ticks as a server sends them: a net_Tick and the entity deltas, often a
+// game event, user message or chat line with them, and now and then a full
+// update
+static void build_synthetic_corpus(bench_data_t& data)
+{
+	uint32 nState = 0x9E3779B9;
+	for (int i = 0; i < BENCH_CORPUS_PACKETS; i++)
+	{
+		nState = nState * 1664525 + 1013904223;
+
+		if (!(i & 63))
+		{
+			data.corpus.push_back(build_update_packet(BENCH_COMPRESSED_SIZE));
+			continue;
+		}
+
+		std::string str = build_packet_start();
+		put_message(str, svc_PacketEntities, data.entitiesDelta);
+
+		switch (nState >> 29)
+		{
+		case 0:
+			put_varint(str, svc_GameEvent);
+			put_varint(str, (uint32)data.strGameEvent.size());
+			str += data.strGameEvent;
+			break;
+		case 1:
+			put_varint(str, svc_UserMessage);
+			put_varint(str, (uint32)data.strUserMessage.size());
+			str += data.strUserMessage;
+			break;
+		case 2:
+		{
+			CSVCMsg_Print print;
+			print.set_text(std::string(16 + ((nState >> 16) & 127), 'x'));
+			put_message(str, svc_Print, print);
+			break;
+		}
+		}
+
+		data.corpus.push_back(str);
+	}
+}
+
+static bool build_corpus(bench_data_t& data, const char* pszCorpus)
+{
+	if (pszCorpus)
+	{
+		if (!load_corpus(pszCorpus, data.corpus) || data.corpus.empty())
+		{
+			outf("can't read corpus %s\n", pszCorpus);
+			return false;
+		}
+	}
+	else
+		build_synthetic_corpus(data);
+
+	const IceKey* pIce = CIceKeyCache::Get(2, data.key);
+
+	data.nCorpusBytes = 0;
+	data.nCorpusDatagramBytes = 0;
+	data.nCorpusLzssBytes = 0;
+
+	for (size_t i = 0; i < data.corpus.size(); i++)
+	{
+		const std::string& strPacket = data.corpus[i];
+		data.nCorpusBytes += (uint32)strPacket.size();
+
+		// decompressed packets can be larger than any datagram
+		if (strPacket.size() + 8 <= NET_MAX_MESSAGE)
+		{
+			data.corpusDatagrams.push_back(encrypt_datagram(strPacket, *pIce));
+			data.nCorpusDatagramBytes += (uint32)data.corpusDatagrams.back().size();
+		}
+
+		std::string strLzss = compress_lzss(strPacket);
+		if (!strLzss.empty())
+		{
+			data.corpusLzss.push_back(strLzss);
+			data.nCorpusLzssBytes += (uint32)strPacket.size();
+		}
+	}
+
+	outf("corpus %s: %u packets, %u bytes, %u lzss payloads\n", pszCorpus ? pszCorpus : "(synthetic)",
+		(uint32)data.corpus.size(), data.nCorpusBytes, (uint32)data.corpusLzss.size());
+
+	return true;
+}
+
+static bool bench_corpus_read(bench_data_t& data, uint32 nIterations, const CMessageDispatcher* pDispatcher)
+{
+	CNetDecoder decoder;
+	if (pDispatcher)
+		decoder.SetDispatcher(pDispatcher);
+
+	udp_frame_t frame;
+	memset(&frame, 0, sizeof(frame));
+	frame.nSrcPort = PORT_SERVER;
+	frame.nDstPort = PORT_CLIENT;
+
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		for (size_t j = 0; j < data.corpus.size(); j++)
+		{
+			const std::string& strPacket = data.corpus[j];
+			s_nBenchSink += decoder.ReadPacket(frame, (const unsigned char*)strPacket.data(), (int)strPacket.size());
+		}
+	}
+
+	return !decoder.m_stats.nParseFailed;
+}
+
+// Only the headers, bodies are skipped like in a replay without handlers
+static bool bench_corpus_read_packet(bench_data_t& data, uint32 nIterations)
+{
+	return bench_corpus_read(data, nIterations, NULL);
+}
+
+// Every message type subscribed, so every body is parsed
+static bool bench_corpus_read_packet_parse(bench_data_t& data, uint32 nIterations)
+{
+	CMessageDispatcher dispatcher;
+
+#define SUBSCRIBE_MESSAGE(id, type) dispatcher.Subscribe(bench_on_message<type>);
+	NET_MESSAGE_TYPES(SUBSCRIBE_MESSAGE)
+#undef SUBSCRIBE_MESSAGE
+
+	return bench_corpus_read(data, nIterations, &dispatcher);
+}
+
+// Block by block like ice_decrypt_block, ProcessDatagram decrypts in bulk
+static bool bench_corpus_ice_decrypt(bench_data_t& data, uint32 nIterations)
+{
+	// a corpus of packets too big for a datagram leaves nothing to time
+	if (data.corpusDatagrams.empty())
+		return false;
+
+	const IceKey* pIce = CIceKeyCache::Get(2, data.key);
+	unsigned char* pOut = (unsigned char*)&data.strOutput[0];
+
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		for (size_t j = 0; j < data.corpusDatagrams.size(); j++)
+		{
+			const unsigned char* pIn = (const unsigned char*)data.corpusDatagrams[j].data();
+			uint32 nBlocks = (uint32)data.corpusDatagrams[j].size() / 8;
+
+			for (uint32 k = 0; k < nBlocks; k++)
+				pIce->decrypt(pIn + k * 8, pOut + k * 8);
+		}
+		s_nBenchSink += pOut[0];
+	}
+
+	return true;
+}
+
+static bool bench_corpus_lzss_uncompress(bench_data_t& data, uint32 nIterations)
+{
+	if (data.corpusLzss.empty())
+		return false;
+
+	CLZSS lzss;
+	unsigned char* pOut = (unsigned char*)&data.strOutput[0];
+
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		for (size_t j = 0; j < data.corpusLzss.size(); j++)
+		{
+			const std::string& strLzss = data.corpusLzss[j];
+			unsigned int nSize = lzss.SafeUncompress((const unsigned char*)strLzss.data(), (unsigned int)strLzss.size(),
+				pOut, (unsigned int)data.strOutput.size());
+			if (!nSize)
+				return false;
+			s_nBenchSink += nSize;
+		}
+	}
+
+	return true;
+}
+
+// ProcessDatagram end to end: decrypt, check the framing, read the packet
+static bool bench_corpus_decode_datagram(bench_data_t& data, uint32 nIterations)
+{
+	CNetDecoder decoder;
+
+	udp_frame_t frame;
+	memset(&frame, 0, sizeof(frame));
+	frame.nSrcAddr = 0x0A000001;
+	frame.nDstAddr = 0x0A000002;
+	frame.nSrcPort = PORT_SERVER;
+	frame.nDstPort = PORT_CLIENT;
+
+	if (data.corpusDatagrams.empty())
+		return false;
+
+	for (uint32 i = 0; i < nIterations; i++)
+	{
+		for (size_t j = 0; j < data.corpusDatagrams.size(); j++)
+		{
+			frame.pPayload = (const uint8*)data.corpusDatagrams[j].data();
+			frame.nPayloadSize = (uint32)data.corpusDatagrams[j].size();
+			if (!decoder.ProcessDatagram(frame))
+				return false;
+		}
+	}
+
+	s_nBenchSink += (uint32)decoder.m_stats.nPackets;
+	return !decoder.m_stats.nParseFailed;
+}
+
+//-----------------------------------------------------------------------------
+// Checks: a known message for each decoder, encoded here, decoded and compared
+// field by field. They run before the cases, which would otherwise time
+// decoders that reject their input.
+//-----------------------------------------------------------------------------
+#define BENCH_CHECK_ENTITY			5		// entity index of the entity check
+#define BENCH_CHECK_SPLIT_SIZE		1000	// fragment body size of the split check
+#define BENCH_CHECK_TRANSFER_SIZE	(3 * FRAGMENT_SIZE - 100)	// bytes of the subchannel check
+#define BENCH_CHECK_BIT_BYTES		20		// bit_read checks buffers of up to this many bytes
+#define BENCH_CHECK_COORD_BYTES		48		// coord_bulk checks buffers of up to this many bytes
+#define BENCH_CHECK_COORD_STARTS	16		// and this many start offsets into each
+
+struct bench_check_prop_t
+{
+	int				nProp;		// flattened index
+	int32			nValue;		// a vector is (nValue, -nValue, 2 * nValue), or its x and y
+};
+
+static bool check_prop_less(const bench_check_prop_t& a, const bench_check_prop_t& b)
+{
+	return a.nProp < b.nProp;
+}
+
+// Changed props of one entity, ints, floats and vectors of whole numbers
+static void put_check_props(bench_bits_t& bits, const send_prop_t* pProps, const bench_check_prop_t* pChecks, int nChecks)
+{
+	put_bits(bits, 1, 1);
+
+	int nLast = -1;
+	for (int i = 0; i < nChecks; i++)
+	{
+		put_field_index(bits, pChecks[i].nProp, nLast);
+		nLast = pChecks[i].nProp;
+	}
+	put_field_index(bits, nLast + 1 + 0xFFF, nLast);
+
+	for (int i = 0; i < nChecks; i++)
+	{
+		const send_prop_t& prop = pProps[pChecks[i].nProp];
+		int32 nValue = pChecks[i].nValue;
+
+		if (prop.nType == DPT_Vector || prop.nType == DPT_VectorXY)
+		{
+			put_float(bits, prop, (float)nValue);
+			put_float(bits, prop, (float)-nValue);
+			if (prop.nType == DPT_Vector)
+				put_float(bits, prop, (float)(2 * nValue));
+		}
+		else if (prop.nType == DPT_Float)
+			put_float(bits, prop, (float)nValue);
+		else if (prop.nDecode == PROP_DECODE_UVARINT)
+			put_bit_varint(bits, (uint32)nValue);
+		else
+			put_bits(bits, (uint32)nValue, prop.nBits);
+	}
+}
+
+static bool check_entity_props(const CEntityDecoder& decoder, int nIndex, const send_prop_t* pProps,
+	const bench_check_prop_t* pChecks, int nChecks)
+{
+	const entity_t* pEntity = decoder.GetEntity(nIndex);
+	if (!pEntity)
+		return false;
+
+	for (int i = 0; i < nChecks; i++)
+	{
+		const send_prop_t& prop = pProps[pChecks[i].nProp];
+		int32 nValue = pChecks[i].nValue;
+
+		if (prop.nType == DPT_Vector || prop.nType == DPT_VectorXY)
+		{
+			float flVector[3];
+			entity_vector(*pEntity, prop, flVector);
+			if (flVector[0] != (float)nValue || flVector[1] != (float)-nValue ||
+				(prop.nType == DPT_Vector && flVector[2] != (float)(2 * nValue)))
+				return false;
+		}
+		else if (prop.nType == DPT_Float)
+		{
+			if (entity_float(*pEntity, prop) != (float)nValue)
+				return false;
+		}
+		else if (entity_int(*pEntity, prop) != nValue)
+			return false;
+	}
+
+	return true;
+}
+
+// The origin columns of an entity
+static bool check_entity_origin(const CEntityDecoder& decoder, int nIndex, float x, float y, float z)
+{
+	const entity_snapshot_t& live = decoder.GetStore().GetLive();
+	return live.Floats(ENTITY_COLUMN_ORIGIN_X)[nIndex] == x && live.Floats(ENTITY_COLUMN_ORIGIN_Y)[nIndex] == y &&
+		live.Floats(ENTITY_COLUMN_ORIGIN_Z)[nIndex] == z;
+}
+
+// Each delta applies to the frame it names, not the state the one before left
+static bool check_entity_delta_from(bench_data_t& data, CEntityDecoder& decoder)
+{
+	decode_stats_t stats;
+	reset_stats(stats);
+
+	CSendTables& tables = decoder.GetTables();
+	if (!tables.Build(data.sendTables, data.classInfo))
+		return false;
+
+	int nPlayer = tables.FindClass("CBasePlayer");
+	if (nPlayer < 0)
+		return false;
+
+	const send_prop_t* pProps = tables.GetProps(*tables.GetClass(nPlayer));
+	bench_check_prop_t health = { tables.FindProp(nPlayer, "m_iHealth"), 87 };
+	bench_check_prop_t team = { tables.FindProp(nPlayer, "m_iTeamNum"), 3 };
+	if (health.nProp < 0 || team.nProp < 0)
+		return false;
+
+	bench_check_prop_t checks[] = { health, team };
+	std::sort(checks, checks + 2, check_prop_less);
+
+	bench_bits_t enter = { std::string(), 0 };
+	put_ubitvar(enter, BENCH_CHECK_ENTITY);
+	put_bits(enter, 0, 1);
+	put_bits(enter, 1, 1);
+	put_bits(enter, nPlayer, tables.GetClassBits());
+	put_bits(enter, 9, NUM_NETWORKED_EHANDLE_SERIAL_NUMBER_BITS);
+	put_check_props(enter, pProps, checks, 2);
+
+	CSVCMsg_PacketEntities msg;
+	msg.set_updated_entries(1);
+	msg.set_is_delta(false);
+	msg.set_entity_data(enter.str);
+
+	if (!decoder.ReadPacketEntities(msg, 10, stats))
+		return false;
+
+	// tick 11 from 10 changes the health, tick 12 from 10 only the team
+	health.nValue = 42;
+	team.nValue = 2;
+	const bench_check_prop_t* pChanges[] = { &health, &team };
+	for (int i = 0; i < 2; i++)
+	{
+		bench_bits_t delta = { std::string(), 0 };
+		put_ubitvar(delta, BENCH_CHECK_ENTITY);
+		put_bits(delta, 0, 2);
+		put_check_props(delta, pProps, pChanges[i], 1);
+
+		msg.set_is_delta(true);
+		msg.set_delta_from(10);
+		msg.set_entity_data(delta.str);
+
+		if (!decoder.ReadPacketEntities(msg, 11 + i, stats))
+			return false;
+	}
+
+	// the snapshot of tick 12 has it dirty against tick 11's
+	const entity_t* pEntity = decoder.GetEntity(BENCH_CHECK_ENTITY);
+	const entity_snapshot_t& live = decoder.GetStore().GetLive();
+	const entity_snapshot_t* pSnapshot = decoder.GetStore().FindSnapshot(12);
+	if (!pEntity || entity_int(*pEntity, pProps[health.nProp]) != 87 || entity_int(*pEntity, pProps[team.nProp]) != 2 ||
+		live.Ints(ENTITY_COLUMN_HEALTH)[BENCH_CHECK_ENTITY] != 87 || live.Ints(ENTITY_COLUMN_TEAM)[BENCH_CHECK_ENTITY] != 2 ||
+		!pSnapshot || !pSnapshot->IsDirty(BENCH_CHECK_ENTITY))
+		return false;
+
+	// an empty delta from 11 is tick 11 again
+	msg.set_updated_entries(0);
+	msg.set_delta_from(11);
+	msg.set_entity_data(std::string());
+
+	pEntity = decoder.GetEntity(BENCH_CHECK_ENTITY);
+	if (!decoder.ReadPacketEntities(msg, 13, stats) ||
+		entity_int(*pEntity, pProps[health.nProp]) != 42 || entity_int(*pEntity, pProps[team.nProp]) != 3 ||
+		live.Ints(ENTITY_COLUMN_HEALTH)[BENCH_CHECK_ENTITY] != 42 || live.Ints(ENTITY_COLUMN_TEAM)[BENCH_CHECK_ENTITY] != 3)
+		return false;
+
+	// a frame we never saw can't be delta'd from
+	msg.set_delta_from(5);
+	return !decoder.ReadPacketEntities(msg, 14, stats);
+}
+
+// A player entering, then a delta of its health, then leaving the PVS
+static bool check_entity_updates(bench_data_t& data, CEntityDecoder& decoder)
+{
+	decode_stats_t stats;
+	reset_stats(stats);
+
+	CSendTables& tables = decoder.GetTables();
+	if (!tables.Build(data.sendTables, data.classInfo))
+		return false;
+
+	int nPlayer = tables.FindClass("CBasePlayer");
+	if (nPlayer < 0)
+		return false;
+
+	const send_prop_t* pProps = tables.GetProps(*tables.GetClass(nPlayer));
+
+	bench_check_prop_t checks[] =
+	{
+		{ tables.FindProp(nPlayer, "m_iHealth"),		87 },
+		{ tables.FindProp(nPlayer, "m_iTeamNum"),		3 },
+		{ tables.FindProp(nPlayer, "m_ArmorValue"),	100 },
+		{ tables.FindProp(nPlayer, "m_fFlags"),		257 },
+		{ tables.FindProp(nPlayer, "m_vecOrigin"),	100 },
+	};
+	const int nChecks = sizeof(checks) / sizeof(checks[0]);
+
+	for (int i = 0; i < nChecks; i++)
+	{
+		if (checks[i].nProp < 0)
+			return false;
+	}
+	std::sort(checks, checks + nChecks, check_prop_less);
+
+	bench_bits_t enter = { std::string(), 0 };
+	put_ubitvar(enter, BENCH_CHECK_ENTITY);
+	put_bits(enter, 0, 1);
+	put_bits(enter, 1, 1);
+	put_bits(enter, nPlayer, tables.GetClassBits());
+	put_bits(enter, 9, NUM_NETWORKED_EHANDLE_SERIAL_NUMBER_BITS);
+	put_check_props(enter, pProps, checks, nChecks);
+
+	CSVCMsg_PacketEntities msg;
+	msg.set_updated_entries(1);
+	msg.set_is_delta(false);
+	msg.set_entity_data(enter.str);
+
+	if (!decoder.ReadPacketEntities(msg, -1, stats) || !check_entity_props(decoder, BENCH_CHECK_ENTITY, pProps, checks, nChecks) ||
+		decoder.GetEntity(BENCH_CHECK_ENTITY)->nSerial != 9)
+		return false;
+
+	const entity_snapshot_t& live = decoder.GetStore().GetLive();
+	if (live.Ints(ENTITY_COLUMN_CLASS)[BENCH_CHECK_ENTITY] != nPlayer ||
+		live.Ints(ENTITY_COLUMN_HEALTH)[BENCH_CHECK_ENTITY] != 87 ||
+		live.Ints(ENTITY_COLUMN_TEAM)[BENCH_CHECK_ENTITY] != 3 ||
+		!check_entity_origin(decoder, BENCH_CHECK_ENTITY, 100.0f, -100.0f, 200.0f))
+		return false;
+
+	// the delta goes through the serialized message
+	bench_check_prop_t health = { tables.FindProp(nPlayer, "m_iHealth"), 42 };
+	bench_bits_t delta = { std::string(), 0 };
+	put_ubitvar(delta, BENCH_CHECK_ENTITY);
+	put_bits(delta, 0, 2);
+	put_check_props(delta, pProps, &health, 1);
+
+	msg.set_is_delta(true);
+	msg.set_entity_data(delta.str);
+	std::string strDelta = msg.SerializeAsString();
+
+	for (int i = 0; i < nChecks; i++)
+	{
+		if (checks[i].nProp == health.nProp)
+			checks[i].nValue = health.nValue;
+	}
+
+	if (!decoder.ReadPacketEntities((const uint8*)strDelta.data(), (int)strDelta.size(), -1, stats) ||
+		!check_entity_props(decoder, BENCH_CHECK_ENTITY, pProps, checks, nChecks) ||
+		live.Ints(ENTITY_COLUMN_HEALTH)[BENCH_CHECK_ENTITY] != 42)
+		return false;
+
+	bench_bits_t leave = { std::string(), 0 };
+	put_ubitvar(leave, BENCH_CHECK_ENTITY);
+	put_bits(leave, 3, 2);
+
+	msg.set_entity_data(leave.str);
+	return decoder.ReadPacketEntities(msg, -1, stats) && !decoder.GetEntity(BENCH_CHECK_ENTITY) &&
+		decoder.GetStore().GetLive().Ints(ENTITY_COLUMN_CLASS)[BENCH_CHECK_ENTITY] == -1;
+}
+
+// A CS player seen by another client moves in its non-local origin, then
+// one update carries the local copy. The columns follow whichever copy was
+// decoded, never the other one's stale value. One entering without either
+// takes its baseline's non-local copy.
+static bool check_entity_split_origin(bench_data_t& data, CEntityDecoder& decoder)
+{
+	decode_stats_t stats;
+	reset_stats(stats);
+
+	CSendTables& tables = decoder.GetTables();
+	if (!tables.Build(data.sendTables, data.classInfo))
+		return false;
+
+	int nPlayer = tables.FindClass("CCSPlayer");
+	if (nPlayer < 0)
+		return false;
+
+	const send_prop_t* pProps = tables.GetProps(*tables.GetClass(nPlayer));
+
+	bench_check_prop_t nonLocal[] =
+	{
+		{ tables.FindProp(nPlayer, "m_vecOrigin", "DT_CSNonLocalPlayerExclusive"),		300 },
+		{ tables.FindProp(nPlayer, "m_vecOrigin[2]", "DT_CSNonLocalPlayerExclusive"),	600 },
+	};
+	bench_check_prop_t local[] =
+	{
+		{ tables.FindProp(nPlayer, "m_vecOrigin", "DT_CSLocalPlayerExclusive"),		50 },
+		{ tables.FindProp(nPlayer, "m_vecOrigin[2]", "DT_CSLocalPlayerExclusive"),	70 },
+	};
+
+	// the base entity's origin is excluded, only the copies are left
+	if (nonLocal[0].nProp < 0 || nonLocal[1].nProp < 0 || local[0].nProp < 0 || local[1].nProp < 0 ||
+		tables.FindProp(nPlayer, "m_vecOrigin", "DT_BaseEntity") >= 0)
+		return false;
+
+	std::sort(nonLocal, nonLocal + 2, check_prop_less);
+	std::sort(local, local + 2, check_prop_less);
+
+	bench_bits_t enter = { std::string(), 0 };
+	put_ubitvar(enter, BENCH_CHECK_ENTITY);
+	put_bits(enter, 0, 1);
+	put_bits(enter, 1, 1);
+	put_bits(enter, nPlayer, tables.GetClassBits());
+	put_bits(enter, 9, NUM_NETWORKED_EHANDLE_SERIAL_NUMBER_BITS);
+	put_check_props(enter, pProps, nonLocal, 2);
+
+	CSVCMsg_PacketEntities msg;
+	msg.set_updated_entries(1);
+	msg.set_is_delta(false);
+	msg.set_entity_data(enter.str);
+
+	if (!decoder.ReadPacketEntities(msg, -1, stats) || !check_entity_props(decoder, BENCH_CHECK_ENTITY, pProps, nonLocal, 2) ||
+		!check_entity_origin(decoder, BENCH_CHECK_ENTITY, 300.0f, -300.0f, 600.0f))
+		return false;
+
+	// x and y move, z stays
+	nonLocal[0].nValue = 400;
+	bench_bits_t move = { std::string(), 0 };
+	put_ubitvar(move, BENCH_CHECK_ENTITY);
+	put_bits(move, 0, 2);
+	put_check_props(move, pProps, nonLocal, 1);
+
+	msg.set_is_delta(true);
+	msg.set_entity_data(move.str);
+
+	if (!decoder.ReadPacketEntities(msg, -1, stats) ||
+		!check_entity_origin(decoder, BENCH_CHECK_ENTITY, 400.0f, -400.0f, 600.0f))
+		return false;
+
+	bench_bits_t localMove = { std::string(), 0 };
+	put_ubitvar(localMove, BENCH_CHECK_ENTITY);
+	put_bits(localMove, 0, 2);
+	put_check_props(localMove, pProps, local, 2);
+
+	msg.set_entity_data(localMove.str);
+	if (!decoder.ReadPacketEntities(msg, -1, stats) ||
+		!check_entity_origin(decoder, BENCH_CHECK_ENTITY, 50.0f, -50.0f, 70.0f))
+		return false;
+
+	// another one enters with both copies only in its class's baseline, and
+	// takes the non-local one
+	bench_check_prop_t both[] = { nonLocal[0], nonLocal[1], local[0], local[1] };
+	std::sort(both, both + 4, check_prop_less);
+
+	bench_bits_t baseline = { std::string(), 0 };
+	put_check_props(baseline, pProps, both, 4);
+	decoder.SetBaseline(nPlayer, (const uint8*)baseline.str.data(), (int)baseline.str.size());
+
+	bench_check_prop_t account = { tables.FindProp(nPlayer, "m_iAccount"), 800 };
+	if (account.nProp < 0)
+		return false;
+
+	bench_bits_t baselineEnter = { std::string(), 0 };
+	put_ubitvar(baselineEnter, BENCH_CHECK_ENTITY + 1);
+	put_bits(baselineEnter, 0, 1);
+	put_bits(baselineEnter, 1, 1);
+	put_bits(baselineEnter, nPlayer, tables.GetClassBits());
+	put_bits(baselineEnter, 10, NUM_NETWORKED_EHANDLE_SERIAL_NUMBER_BITS);
+	put_check_props(baselineEnter, pProps, &account, 1);
+
+	msg.set_entity_data(baselineEnter.str);
+	return decoder.ReadPacketEntities(msg, -1, stats) &&
+		check_entity_origin(decoder, BENCH_CHECK_ENTITY + 1, 400.0f, -400.0f, 600.0f);
+}
+
+static bool check_entities(bench_data_t& data)
+{
+	CEntityDecoder* pDecoder = new CEntityDecoder;
+	bool bOk = check_entity_updates(data, *pDecoder);
+
+	pDecoder->Reset();
+	bOk = bOk && check_entity_split_origin(data, *pDecoder);
+
+	pDecoder->Reset();
+	bOk = bOk && check_entity_delta_from(data, *pDecoder);
+
+	delete pDecoder;
+	return bOk;
+}
+
+// Every entry of the precache and baseline tables, then the baselines again
+// after the update
+static bool check_string_table_entries(bench_data_t& data, CStringTables& tables)
+{
+	if (!tables.Create(data.stringTablePrecache) || !tables.Create(data.stringTableBaselines))
+		return false;
+
+	const string_table_t* pPrecache = tables.GetTable(tables.FindTable("modelprecache"));
+	if (!pPrecache || pPrecache->entries.size() != BENCH_STRING_ENTRIES)
+		return false;
+
+	for (int i = 0; i < BENCH_STRING_ENTRIES; i++)
+	{
+		char szPath[128];
+		bench_model_path(i, szPath, sizeof(szPath));
+
+		const string_table_entry_t& entry = pPrecache->entries[i];
+		if (entry.nLength != strlen(szPath) || strcmp(entry.pszString, szPath) || entry.pUserData)
+			return false;
+	}
+
+	if (!tables.Update((const uint8*)data.strStringTableUpdate.data(), (int)data.strStringTableUpdate.size()) ||
+		tables.GetChanged().size() != BENCH_STRING_CLASSES)
+		return false;
+
+	const string_table_t* pBaselines = tables.GetTable(tables.FindTable("instancebaseline"));
+	if (!pBaselines || pBaselines->entries.size() != BENCH_STRING_CLASSES)
+		return false;
+
+	for (int i = 0; i < BENCH_STRING_CLASSES; i++)
+	{
+		char szClass[16];
+		_snprintf_s(szClass, sizeof(szClass), _TRUNCATE, "%d", i);
+
+		uint8 baseline[BENCH_BASELINE_SIZE];
+		bench_baseline(i, baseline);
+		baseline[0]++;
+
+		const string_table_entry_t& entry = pBaselines->entries[i];
+		if (strcmp(entry.pszString, szClass) || entry.nUserDataSize != BENCH_BASELINE_SIZE ||
+			!entry.pUserData || memcmp(entry.pUserData, baseline, BENCH_BASELINE_SIZE))
+			return false;
+	}
+
+	// naming an entry without user data clears it, and only it
+	bench_bits_t clear = { std::string(), 0 };
+	bench_string_history_t history;
+	put_bits(clear, 0, 1);
+	put_string_entry(clear, history, NULL, NULL, 0);
+
+	CSVCMsg_UpdateStringTable update;
+	update.set_table_id(tables.FindTable("instancebaseline"));
+	update.set_num_changed_entries(1);
+	update.set_string_data(clear.str);
+
+	return tables.Update(update) && tables.GetChanged().size() == 1 && !pBaselines->entries[0].pUserData &&
+		!pBaselines->entries[0].nUserDataSize && pBaselines->entries[1].pUserData &&
+		!strcmp(pBaselines->entries[0].pszString, "0");
+}
+
+static bool check_string_tables(bench_data_t& data)
+{
+	CStringTables* pTables = new CStringTables;
+	bool bOk = check_string_table_entries(data, *pTables);
+	delete pTables;
+	return bOk;
+}
+
+// A datagram split the way the engine sends one, delivered last fragment first
+static bool check_split(bench_data_t& data)
+{
+	std::string strDatagram = encrypt_datagram(build_packet(4000), *CIceKeyCache::Get(2, data.key));
+	uint32 nCount = ((uint32)strDatagram.size() + BENCH_CHECK_SPLIT_SIZE - 1) / BENCH_CHECK_SPLIT_SIZE;
+
+	CSplitReassembler* pSplits = new CSplitReassembler;
+	decode_stats_t stats;
+	reset_stats(stats);
+
+	udp_frame_t frame;
+	memset(&frame, 0, sizeof(frame));
+	frame.nSrcPort = PORT_SERVER;
+	frame.nDstPort = PORT_CLIENT;
+
+	bool bOk = true;
+	for (uint32 i = nCount; bOk && i-- > 0; )
+	{
+		uint8 header[SPLIT_HEADER_SIZE];
+		store_le32(header, (uint32)NET_HEADER_FLAG_SPLITPACKET);
+		store_le32(header + 4, 7);
+		store_le16(header + 8, (uint16)(i << 8 | nCount));
+		store_le16(header + 10, BENCH_CHECK_SPLIT_SIZE);
+
+		std::string strFragment((const char*)header, sizeof(header));
+		strFragment += strDatagram.substr(i * BENCH_CHECK_SPLIT_SIZE, BENCH_CHECK_SPLIT_SIZE);
+
+		frame.pPayload = (const uint8*)strFragment.data();
+		frame.nPayloadSize = (uint32)strFragment.size();
+
+		const uint8* pOut = NULL;
+		uint32 nOutSize = 0;
+		bool bComplete = pSplits->AddFragment(frame, pOut, nOutSize, stats);
+
+		bOk = i ? !bComplete : bComplete && nOutSize == strDatagram.size() && !memcmp(pOut, strDatagram.data(), nOutSize);
+	}
+
+	delete pSplits;
+	return bOk;
+}
+
+// One chunk of a reliable stream, followed by a marker byte to check the
+// reader stops where the chunk ends
+static std::string build_subchannel_chunk(const std::string& strTransfer, uint32 nStart, uint32 nNum)
+{
+	bench_bits_t bits = { std::string(), 0 };
+	put_bits(bits, 1, 1);
+	put_bits(bits, nStart, MAX_FILE_SIZE_BITS - FRAGMENT_BITS);
+	put_bits(bits, nNum, 3);
+
+	if (!nStart)
+	{
+		put_bits(bits, 0, 1);	// not a file
+		put_bits(bits, 0, 1);	// not compressed
+		put_bits(bits, (uint32)strTransfer.size(), MAX_FILE_SIZE_BITS);
+	}
+
+	uint32 nOffset = nStart * FRAGMENT_SIZE;
+	uint32 nBytes = MIN(nNum * FRAGMENT_SIZE, (uint32)strTransfer.size() - nOffset);
+	for (uint32 i = 0; i < nBytes; i++)
+		put_bits(bits, (uint8)strTransfer[nOffset + i], 8);
+
+	put_bits(bits, 0xA5, 8);
+	return bits.str;
+}
+
+// A transfer of three fragments in two chunks, the first one sent twice
+static bool check_subchannel(bench_data_t& /*data*/)
+{
+	std::string strTransfer(BENCH_CHECK_TRANSFER_SIZE, '\0');
+	for (size_t i = 0; i < strTransfer.size(); i++)
+		strTransfer[i] = (char)(i * 13 + 1);
+
+	std::string strChunks[3] =
+	{
+		build_subchannel_chunk(strTransfer, 0, 2),
+		build_subchannel_chunk(strTransfer, 0, 2),
+		build_subchannel_chunk(strTransfer, 2, 1),
+	};
+
+	CSubChannelReassembler* pSubChannels = new CSubChannelReassembler;
+	decode_stats_t stats;
+	reset_stats(stats);
+
+	udp_frame_t frame;
+	memset(&frame, 0, sizeof(frame));
+	frame.nSrcPort = PORT_SERVER;
+	frame.nDstPort = PORT_CLIENT;
+
+	bool bOk = true;
+	for (int i = 0; bOk && i < 3; i++)
+	{
+		CBitRead buf(strChunks[i].data(), (int)strChunks[i].size());
+
+		const uint8* pOut = NULL;
+		uint32 nOutSize = 0;
+		bOk = pSubChannels->ReadSubChannelData(frame, buf, 0, pOut, nOutSize, stats) && buf.ReadUBitLong(8) == 0xA5;
+
+		if (bOk && i < 2)
+			bOk = !nOutSize;
+		else if (bOk)
+			bOk = nOutSize == strTransfer.size() && !memcmp(pOut, strTransfer.data(), nOutSize);
+	}
+
+	delete pSubChannels;
+	return bOk;
+}
+
+// build_game_event_message's player_death against its descriptor
+static bool check_game_event(bench_data_t& data)
+{
+	CGameEventLayouts* pLayouts = new CGameEventLayouts;
+	game_event_t event;
+
+	bool bOk = pLayouts->Compile(data.gameEventList) &&
+		pLayouts->Decode((const uint8*)data.strGameEvent.data(), (int)data.strGameEvent.size(), event) &&
+		event.nEventId == 23 && event.pLayout->strName == "player_death" &&
+		game_event_int(event, GAMEEVENT_KEY_USERID) == 2 &&
+		game_event_int(event, GAMEEVENT_KEY_ATTACKER) == 3 &&
+		game_event_int(event, GAMEEVENT_KEY_ASSISTER) == 4 &&
+		game_event_int(event, GAMEEVENT_KEY_HEADSHOT) == 1;
+
+	if (bOk)
+	{
+		uint32 nLength;
+		const char* pszWeapon = game_event_string(event, GAMEEVENT_KEY_WEAPON, nLength);
+		bOk = nLength == 4 && !memcmp(pszWeapon, "ak47", 4);
+	}
+
+	delete pLayouts;
+	return bOk;
+}
+
+// Bit nBit of a buffer, LSB first like CBitRead
+static inline uint32 check_bit(const uint8* pData, int nBit)
+{
+	return (pData[nBit >> 3] >> (nBit & 7)) & 1;
+}
+
+// Reads of every width from every offset of buffers of 0 to
+// BENCH_CHECK_BIT_BYTES bytes, on through the reader's tail until one runs
+// past the end, against the buffer taken a bit at a time. Each buffer is a
+// heap block of its exact size, so a load past it trips a sanitizer build.
+static bool check_bit_read(bench_data_t& data)
+{
+	for (int nBytes = 0; nBytes <= BENCH_CHECK_BIT_BYTES; nBytes++)
+	{
+		std::vector<uint8> buffer(data.strBits.begin(), data.strBits.begin() + nBytes);
+		const uint8* pData = buffer.data();
+		int nBits = nBytes * 8;
+
+		for (int nWidth = 1; nWidth <= 32; nWidth++)
+		{
+			for (int nStart = 0; nStart <= nBits; nStart++)
+			{
+				CBitRead buf(pData, nBytes);
+				if (!buf.Seek(nStart))
+					return false;
+
+				for (int nBit = nStart; ; nBit += nWidth)
+				{
+					// a read that doesn't fit overflows and returns zero
+					bool bOverflow = nBit + nWidth > nBits;
+					uint32 nExpected = 0;
+					for (int i = 0; !bOverflow && i < nWidth; i++)
+						nExpected |= check_bit(pData, nBit + i) << i;
+
+					if (buf.ReadUBitLong(nWidth) != nExpected || buf.IsOverflowed() != bOverflow)
+						return false;
+					if (bOverflow)
+						break;
+				}
+
+				// and so does every read after it
+				if (buf.ReadUBitLong(nWidth) || !buf.IsOverflowed())
+					return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+// A bulk coordinate read and the one at a time read it must match, nFloats
+// floats an item
+struct bench_check_coord_t
+{
+	int				nFloats;
+	void			(*pfnScalar)(CBitRead& buf, float* pOut, int nBits, EBitCoordType coordType);
+	bool			(*pfnBulk)(CBitRead& buf, float* pOut, int nCount, int nBits, EBitCoordType coordType);
+};
+
+static void check_read_coord(CBitRead& buf, float* pOut, int, EBitCoordType) { *pOut = buf.ReadBitCoord(); }
+static bool check_read_coords(CBitRead& buf, float* pOut, int nCount, int, EBitCoordType) { return buf.ReadBitCoords(pOut, nCount); }
+
+static void check_read_coord_mp(CBitRead& buf, float* pOut, int, EBitCoordType coordType) { *pOut = buf.ReadBitCoordMP(coordType); }
+static bool check_read_coord_mps(CBitRead& buf, float* pOut, int nCount, int, EBitCoordType coordType) { return buf.ReadBitCoordMPs(pOut, nCount, coordType); }
+
+static void check_read_cell_coord(CBitRead& buf, float* pOut, int nBits, EBitCoordType coordType) { *pOut = buf.ReadBitCellCoord(nBits, coordType); }
+static bool check_read_cell_coords(CBitRead& buf, float* pOut, int nCount, int nBits, EBitCoordType coordType) { return buf.ReadBitCellCoords(pOut, nCount, nBits, coordType); }
+
+static void check_read_normal(CBitRead& buf, float* pOut, int, EBitCoordType) { *pOut = buf.ReadBitNormal(); }
+static bool check_read_normals(CBitRead& buf, float* pOut, int nCount, int, EBitCoordType) { return buf.ReadBitNormals(pOut, nCount); }
+
+static void check_read_vec3_coord(CBitRead& buf, float* pOut, int, EBitCoordType)
+{
+	Vector v;
+	buf.ReadBitVec3Coord(v);
+	pOut[0] = v.x;
+	pOut[1] = v.y;
+	pOut[2] = v.z;
+}
+
+static bool check_read_vec3_coords(CBitRead& buf, float* pOut, int nCount, int, EBitCoordType)
+{
+	return buf.ReadBitVec3Coords((Vector*)pOut, nCount);
+}
+
+static const bench_check_coord_t s_checkCoord = { 1, check_read_coord, check_read_coords };
+static const bench_check_coord_t s_checkCoordMP = { 1, check_read_coord_mp, check_read_coord_mps };
+static const bench_check_coord_t s_checkCellCoord = { 1, check_read_cell_coord, check_read_cell_coords };
+static const bench_check_coord_t s_checkNormal = { 1, check_read_normal, check_read_normals };
+static const bench_check_coord_t s_checkVec3Coord = { 3, check_read_vec3_coord, check_read_vec3_coords };
+
+// One bulk read against its one at a time read, over buffers of 0 to
+// BENCH_CHECK_COORD_BYTES random bytes from several start offsets, in counts
+// doubling up to one that runs past the end. The floats must match bit for
+// bit, and so must the bits read and the overflow.
+static bool check_coord_reads(bench_data_t& data, const bench_check_coord_t& reader, int nBits, EBitCoordType coordType)
+{
+	for (int nBytes = 0; nBytes <= BENCH_CHECK_COORD_BYTES; nBytes++)
+	{
+		std::vector<uint8> buffer(data.strCoords.begin(), data.strCoords.begin() + nBytes);
+		int nBufferBits = nBytes * 8;
+
+		for (int nStart = 0; nStart < BENCH_CHECK_COORD_STARTS && nStart <= nBufferBits; nStart++)
+		{
+			// every item takes at least a bit, so the last count overflows
+			for (int nCount = 0; ; nCount = nCount * 2 + 1)
+			{
+				nCount = std::min(nCount, nBufferBits + 1);
+
+				std::vector<float> expected(nCount * reader.nFloats), actual(nCount * reader.nFloats);
+
+				CBitRead scalar(buffer.data(), nBytes);
+				CBitRead bulk(buffer.data(), nBytes);
+				if (!scalar.Seek(nStart) || !bulk.Seek(nStart))
+					return false;
+
+				for (int i = 0; i < nCount; i++)
+					reader.pfnScalar(scalar, expected.data() + i * reader.nFloats, nBits, coordType);
+
+				bool bOk = reader.pfnBulk(bulk, actual.data(), nCount, nBits, coordType);
+				if (bOk == bulk.IsOverflowed() || bulk.IsOverflowed() != scalar.IsOverflowed() ||
+					bulk.GetNumBitsRead() != scalar.GetNumBitsRead() ||
+					(nCount && memcmp(actual.data(), expected.data(), actual.size() * sizeof(float))))
+					return false;
+
+				if (nCount > nBufferBits)
+					break;
+			}
+		}
+	}
+
+	return true;
+}
+
+static bool check_coord_bulk(bench_data_t& data)
+{
+	static const int s_nCellBits[] = { 1, BENCH_CELL_BITS, 24, 25, 32 };
+	static const EBitCoordType s_coordTypes[] = { kCW_None, kCW_LowPrecision, kCW_Integral };
+
+	if (!check_coord_reads(data, s_checkCoord, 0, kCW_None) ||
+		!check_coord_reads(data, s_checkNormal, 0, kCW_None) ||
+		!check_coord_reads(data, s_checkVec3Coord, 0, kCW_None))
+		return false;
+
+	for (EBitCoordType coordType : s_coordTypes)
+	{
+		if (!check_coord_reads(data, s_checkCoordMP, 0, coordType))
+			return false;
+
+		for (int nBits : s_nCellBits)
+		{
+			if (!check_coord_reads(data, s_checkCellCoord, nBits, coordType))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+struct bench_check_t
+{
+	const char*		pszName;
+	bool			(*pfnCheck)(bench_data_t& data);
+};
+
+static const bench_check_t s_benchChecks[] =
+{
+	{ "entities",			check_entities },
+	{ "string_tables",		check_string_tables },
+	{ "split",				check_split },
+	{ "subchannel",			check_subchannel },
+	{ "game_event",			check_game_event },
+	{ "bit_read",			check_bit_read },
+	{ "coord_bulk",			check_coord_bulk },
+};
+
+// nBytes of the corpus cases, which depends on the corpus
+#define BENCH_CORPUS_BYTES			0xFFFFFFF0	// packet bytes
+#define BENCH_CORPUS_DATAGRAM_BYTES	0xFFFFFFF1	// encrypted datagram bytes
+#define BENCH_CORPUS_LZSS_BYTES		0xFFFFFFF2	// uncompressed bytes of the LZSS payloads
+
+struct bench_case_t
+{
+	const char*		pszName;
+	uint32			nBytes;		// input bytes per iteration, 0 when throughput makes no sense
+	bool			(*pfnRun)(bench_data_t& data, uint32 nIterations);	// false when the work failed
+};
+
+static const bench_case_t s_benchCases[] =
+{
+	{ "ice_schedule",			0,						bench_ice_schedule },
+	{ "ice_decrypt_block",		BENCH_DATAGRAM_SIZE,	bench_ice_decrypt_block },
+	{ "ice_decrypt_bulk",		BENCH_DATAGRAM_SIZE,	bench_ice_decrypt_bulk },
+	{ "ice_decrypt_rebuild",	BENCH_DATAGRAM_SIZE,	bench_ice_decrypt_rebuild },
+	{ "ice_detect",				0,						bench_ice_detect },
+	{ "decode_datagram",		BENCH_DATAGRAM_SIZE,	bench_decode_datagram },
+	{ "lzss_decompress",		BENCH_COMPRESSED_SIZE,	bench_lzss_decompress },
+	{ "snappy_decompress",		BENCH_COMPRESSED_SIZE,	bench_snappy_decompress },
+	{ "decode_lzss",			BENCH_COMPRESSED_SIZE,	bench_decode_lzss },
+	{ "decode_snappy",			BENCH_COMPRESSED_SIZE,	bench_decode_snappy },
+	{ "decode_snappy_parse",	BENCH_COMPRESSED_SIZE,	bench_decode_snappy_parse },
+	{ "decode_snappy_emit",		BENCH_COMPRESSED_SIZE,	bench_decode_snappy_emit },
+	{ "entity_tables_build",	0,						bench_entity_tables_build },
+	{ "entity_tables_load",		0,						bench_entity_tables_load },
+	{ "entity_delta",			0,						bench_entity_delta },
+	{ "entity_delta_snapshot",	0,						bench_entity_delta_snapshot },
+	{ "entity_delta_parsed",	0,						bench_entity_delta_parsed },
+	{ "entity_delta_in_place",	0,						bench_entity_delta_in_place },
+	{ "entity_select_origins",	0,						bench_entity_select_origins },
+	{ "string_table_create",	0,						bench_string_table_create },
+	{ "string_table_update",	0,						bench_string_table_update },
+	{ "string_table_update_parsed",	0,					bench_string_table_update_parsed },
+	{ "string_table_update_in_place",	0,				bench_string_table_update_in_place },
+	{ "bit_read",				BENCH_BIT_READ_SIZE,	bench_bit_read },
+	{ "varint_read_aligned",	0,						bench_varint_read_aligned },
+	{ "varint_read_offset",		0,						bench_varint_read_offset },
+	{ "varint_read_pairs",		0,						bench_varint_read_pairs },
+	{ "varint_wire",			0,						bench_varint_wire },
+	{ "coord_read",				0,						bench_coord_read },
+	{ "coord_bulk",				0,						bench_coord_bulk },
+	{ "coord_mp_read",			0,						bench_coord_mp_read },
+	{ "coord_mp_bulk",			0,						bench_coord_mp_bulk },
+	{ "cell_coord_read",		0,						bench_cell_coord_read },
+	{ "cell_coord_bulk",		0,						bench_cell_coord_bulk },
+	{ "normal_read",			0,						bench_normal_read },
+	{ "normal_bulk",			0,						bench_normal_bulk },
+	{ "vec3_coord_read",		0,						bench_vec3_coord_read },
+	{ "vec3_coord_bulk",		0,						bench_vec3_coord_bulk },
+	{ "bit_read_ubitvar",		0,						bench_bit_read_ubitvar },
+	{ "bit_read_string",		0,						bench_bit_read_string },
+	{ "parse_entities_fresh",	0,						bench_parse_entities_fresh },
+	{ "parse_entities_pooled",	0,						bench_parse_entities_pooled },
+	{ "parse_event_fresh",		0,						bench_parse_event_fresh },
+	{ "parse_event_pooled",		0,						bench_parse_event_pooled },
+	{ "game_event_decode",		0,						bench_game_event_decode },
+	{ "user_message_skip",		0,						bench_user_message_skip },
+	{ "user_message_parse",		0,						bench_user_message_parse },
+
+	// ParseFromArray against extract_fields, for every message type
+#define BENCH_MESSAGE_CASES(id, type) \
+	{ "parse_" #id,				0,						bench_parse_sample<type> }, \
+	{ "extract_" #id,			0,						bench_extract_sample<type> },
+	NET_MESSAGE_TYPES(BENCH_MESSAGE_CASES)
+#undef BENCH_MESSAGE_CASES
+
+	{ "corpus_read_packet",		BENCH_CORPUS_BYTES,		bench_corpus_read_packet },
+	{ "corpus_read_packet_parse",	BENCH_CORPUS_BYTES,	bench_corpus_read_packet_parse },
+	{ "corpus_ice_decrypt",		BENCH_CORPUS_DATAGRAM_BYTES,	bench_corpus_ice_decrypt },
+	{ "corpus_lzss_uncompress",	BENCH_CORPUS_LZSS_BYTES,	bench_corpus_lzss_uncompress },
+	{ "corpus_decode_datagram",	BENCH_CORPUS_DATAGRAM_BYTES,	bench_corpus_decode_datagram },
+};
+
+static uint32 case_bytes(const bench_case_t& bench, const bench_data_t& data)
+{
+	switch (bench.nBytes)
+	{
+	case BENCH_CORPUS_BYTES:			return data.nCorpusBytes;
+	case BENCH_CORPUS_DATAGRAM_BYTES:	return data.nCorpusDatagramBytes;
+	case BENCH_CORPUS_LZSS_BYTES:		return data.nCorpusLzssBytes;
+	}
+
+	return bench.nBytes;
+}
+
+//-----------------------------------------------------------------------------
+// Runs a case with a doubling iteration count until it takes long enough to
+// time, then reports the time per iteration. A case whose work fails is
+// reported as FAILED instead of timed.
+//-----------------------------------------------------------------------------
+static bool run_case(const bench_case_t& bench, bench_data_t& data)
+{
+	// warm up caches and the key cache
+	if (!bench.pfnRun(data, 1))
+	{
+		outf("  %-28s FAILED\n", bench.pszName);
+		return false;
+	}
+
+	uint32 nIterations = 1;
+	double flSeconds = 0.0;
+	alloc_stats_t allocsBefore, allocsAfter;
+	bool bAllocStats = false;
+
+	while (true)
+	{
+		get_alloc_stats(allocsBefore);
+
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		bool bOk = bench.pfnRun(data, nIterations);
+		std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+
+		if (!bOk)
+		{
+			outf("  %-28s FAILED\n", bench.pszName);
+			return false;
+		}
+
+		bAllocStats = get_alloc_stats(allocsAfter);
+
+		flSeconds = std::chrono::duration<double>(end - start).count();
+		if (flSeconds >= BENCH_MIN_SECONDS || nIterations >= (1u << 30))
+			break;
+
+		nIterations *= 2;
+	}
+
+	double flNsPerOp = flSeconds * 1e9 / nIterations;
+
+	outf("  %-28s %12.1f ns/op", bench.pszName, flNsPerOp);
+
+	uint32 nBytes = case_bytes(bench, data);
+	if (nBytes)
+		outf("  %10.2f MB/s", (double)nBytes * nIterations / flSeconds / (1024.0 * 1024.0));
+
+	if (bAllocStats)
+		outf("  %8.2f allocs/op", (double)(allocsAfter.nAllocs - allocsBefore.nAllocs) / nIterations);
+
+	out("\n");
+	return true;
+}
+
+int run_benchmarks(const char* pszFilter, const char* pszCorpus)
+{
+	bool bQuiet = g_bQuiet;
+	g_bQuiet = true;
+
+	bench_data_t data;
+	CIceKeyRegistry::MakeBuildKey(ICE_DEFAULT_BUILD, data.key);
+	data.strPacket = build_packet(BENCH_DATAGRAM_SIZE - 8);
+	data.strDatagram = encrypt_datagram(data.strPacket, *CIceKeyCache::Get(2, data.key));
+	data.strOutput.resize(NET_MAX_MESSAGE);
+
+	std::string strUpdate = build_update_packet(BENCH_COMPRESSED_SIZE);
+	data.strLzss = compress_lzss(strUpdate);
+	data.strSnappy = compress_snappy(strUpdate);
+	data.strLzssDatagram = encrypt_datagram(compressed_packet(data.strLzss), *CIceKeyCache::Get(2, data.key));
+	data.strSnappyDatagram = encrypt_datagram(compressed_packet(data.strSnappy), *CIceKeyCache::Get(2, data.key));
+	data.strEntities = build_entities_message(BENCH_COMPRESSED_SIZE);
+	data.strGameEvent = build_game_event_message();
+	build_game_event_list(data.gameEventList);
+	data.strUserMessage = build_user_message();
+	build_send_tables(data.sendTables, data.classInfo);
+	build_entity_updates(data);
+	build_string_tables(data);
+	data.strEntitiesDelta = data.entitiesDelta.SerializeAsString();
+	data.strStringTableUpdate = data.stringTableUpdate.SerializeAsString();
+	build_bits(data);
+	build_varints(data);
+	build_coords(data);
+	build_ubitvars(data);
+	build_strings(data);
+
+	if (!build_corpus(data, pszCorpus))
+	{
+		g_bQuiet = bQuiet;
+		return 1;
+	}
+
+#define BUILD_SAMPLE(id, type) data.strSamples[id] = build_sample<type>();
+	NET_MESSAGE_TYPES(BUILD_SAMPLE)
+#undef BUILD_SAMPLE
+
+	outf("compressed %u byte update: lzss %u bytes, snappy %u bytes\n", (uint32)strUpdate.size(),
+		(uint32)data.strLzss.size(), (uint32)data.strSnappy.size());
+
+	out("---- checks -------------------------------------\n");
+
+	int nFailed = 0;
+	for (size_t i = 0; i < sizeof(s_benchChecks) / sizeof(s_benchChecks[0]); i++)
+	{
+		bool bOk = s_benchChecks[i].pfnCheck(data);
+		outf("  %-28s %s\n", s_benchChecks[i].pszName, bOk ? "ok" : "FAILED");
+		nFailed += !bOk;
+	}
+
+	out("---- benchmarks ---------------------------------\n");
+
+	for (size_t i = 0; i < sizeof(s_benchCases) / sizeof(s_benchCases[0]); i++)
+	{
+		if (pszFilter && !strstr(s_benchCases[i].pszName, pszFilter))
+			continue;
+
+		nFailed += !run_case(s_benchCases[i], data);
+	}
+
+	g_bQuiet = bQuiet;
+	return nFailed ? 1 : 0;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "platform.h"
+
+// Runs every micro benchmark whose name contains pszFilter, or all of them
+// when pszFilter is NULL. Results go to stdout, one line per case. The
+// corpus_* cases replay the packets of pszCorpus (see corpus.h), or a
+// synthetic corpus when it is NULL.
+int run_benchmarks(const char* pszFilter, const char* pszCorpus);
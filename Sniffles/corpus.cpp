@@ -0,0 +1,115 @@
+#include "corpus.h"
+#include "net.h"
+#include "frame.h"
+#include "str.h"
+
+CCorpusRecorder g_corpusRecorder;
+
+CCorpusRecorder::CCorpusRecorder()
+{
+	m_pFile = NULL;
+	m_nPackets = 0;
+}
+
+CCorpusRecorder::~CCorpusRecorder()
+{
+	Close();
+}
+
+bool CCorpusRecorder::Open(const char* pszFile)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (fopen_s(&m_pFile, pszFile, "wb") != 0 || !m_pFile)
+	{
+		m_pFile = NULL;
+		shout_error("Can't open the -record file");
+		return false;
+	}
+
+	uint8 header[8];
+	store_le32(header, CORPUS_MAGIC);
+	store_le32(header + 4, CORPUS_VERSION);
+
+	if (fwrite(header, sizeof(header), 1, m_pFile) != 1)
+	{
+		fclose(m_pFile);
+		m_pFile = NULL;
+		shout_error("Can't write the -record file");
+		return false;
+	}
+
+	m_nPackets = 0;
+	m_strBatch.clear();
+	m_strBatch.reserve(CORPUS_BATCH_SIZE + NET_MAX_MESSAGE + 4);
+	return true;
+}
+
+void CCorpusRecorder::Close()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_pFile)
+	{
+		if (!m_strBatch.empty())
+			fwrite(m_strBatch.data(), 1, m_strBatch.size(), m_pFile);
+		std::string().swap(m_strBatch);
+
+		fclose(m_pFile);
+		m_pFile = NULL;
+	}
+}
+
+void CCorpusRecorder::Record(const uint8* pPacket, uint32 nSize)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (!m_pFile)
+		return;
+
+	uint8 size[4];
+	store_le32(size, nSize);
+
+	m_strBatch.append((const char*)size, sizeof(size));
+	m_strBatch.append((const char*)pPacket, nSize);
+	m_nPackets++;
+
+	if (m_strBatch.size() >= CORPUS_BATCH_SIZE)
+	{
+		fwrite(m_strBatch.data(), 1, m_strBatch.size(), m_pFile);
+		m_strBatch.clear();
+	}
+}
+
+bool load_corpus(const char* pszFile, std::vector<std::string>& packets)
+{
+	FILE* pFile = NULL;
+	if (fopen_s(&pFile, pszFile, "rb") != 0 || !pFile)
+		return false;
+
+	uint8 header[8];
+	bool bValid = fread(header, sizeof(header), 1, pFile) == 1 &&
+		load_le32(header) == CORPUS_MAGIC && load_le32(header + 4) == CORPUS_VERSION;
+
+	uint8 size[4];
+	while (bValid && fread(size, sizeof(size), 1, pFile) == 1)
+	{
+		uint32 nSize = load_le32(size);
+		if (nSize > NET_MAX_MESSAGE)
+		{
+			bValid = false;
+			break;
+		}
+
+		packets.push_back(std::string(nSize, '\0'));
+		if (nSize && fread(&packets.back()[0], 1, nSize, pFile) != nSize)
+		{
+			// the recorder writes whole records, a short one is a torn write
+			packets.pop_back();
+			break;
+		}
+	}
+
+	fclose(pFile);
+	return bValid;
+}
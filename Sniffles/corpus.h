@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdio.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "platform.h"
+
+#define CORPUS_MAGIC			0x43464E53	// "SNFC"
+#define CORPUS_VERSION			1
+#define CORPUS_BATCH_SIZE		(1 << 20)	// records are written in batches of about this many bytes
+
+// A corpus file starts with CORPUS_MAGIC and CORPUS_VERSION (little endian
+// uint32s), then one record per netchannel packet:
+//
+//   uint32 nSize        packet bytes that follow
+//   uint8  data[nSize]  the packet as ReadPacket gets it, decrypted and
+//                       decompressed
+//
+// Packets are recorded with -record and replayed by the corpus_* bench cases.
+struct corpus_header_t
+{
+	uint32	nMagic;			// CORPUS_MAGIC
+	uint32	nVersion;		// CORPUS_VERSION
+};
+
+//-----------------------------------------------------------------------------
+// Writes every packet a decoder reads to a corpus file. Decode threads share
+// one recorder. A packet is only appended to a batch under the lock; the
+// batch is written once it reaches CORPUS_BATCH_SIZE, and what is left of it
+// on Close.
+//-----------------------------------------------------------------------------
+class CCorpusRecorder
+{
+public:
+	CCorpusRecorder();
+	~CCorpusRecorder();
+
+	bool			Open(const char* pszFile);
+	void			Close();
+	bool			IsOpen() const { return m_pFile != NULL; }
+
+	void			Record(const uint8* pPacket, uint32 nSize);
+
+	uint64			GetPackets() const { return m_nPackets; }
+
+private:
+	std::mutex		m_mutex;
+	FILE*			m_pFile;
+	uint64			m_nPackets;
+	std::string		m_strBatch;		// whole records not written yet
+};
+
+extern CCorpusRecorder g_corpusRecorder;
+
+// Reads every packet of a corpus file, false if it can't be read or isn't one
+bool load_corpus(const char* pszFile, std::vector<std::string>& packets);
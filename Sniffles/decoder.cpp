@@ -0,0 +1,283 @@
+#include "decoder.h"
+#include "net.h"
+#include "icekeys.h"
+#include "netcompress.h"
+#include "packetbitbuf.h"
+#include "dispatch.h"
+#include "corpus.h"
+
+CNetDecoder::CNetDecoder()
+{
+	memset(&m_stats, 0, sizeof(m_stats));
+
+	m_pDecryptBufferAlloc = (uint8*)malloc(NET_MAX_MESSAGE + 32);
+	m_pDecryptBuffer = (uint8*)(((uintp)m_pDecryptBufferAlloc + 15) & ~(uintp)15);
+
+	memset(m_flowKeys, 0, sizeof(m_flowKeys));
+
+	m_pDispatcher = &g_dispatcher;
+
+	m_pDecompressBuffer = (uint8*)malloc(NET_MAX_PAYLOAD);
+	m_pMessageBuffer = (uint8*)malloc(NET_MAX_PAYLOAD);
+}
+
+CNetDecoder::~CNetDecoder()
+{
+	free(m_pDecryptBufferAlloc);
+	free(m_pDecompressBuffer);
+	free(m_pMessageBuffer);
+}
+
+//-----------------------------------------------------------------------------
+// Decrypts a game server datagram and hands the framed netchannel packet to
+// ReadPacket. Works straight off the capture buffer: one pass of decryption
+// into m_pDecryptBuffer and no heap allocations.
+//-----------------------------------------------------------------------------
+bool CNetDecoder::ProcessDatagram(const udp_frame_t& frame)
+{
+	if (frame.nSrcPort != PORT_SERVER)
+		return false;
+
+	const uint8* pData = frame.pPayload;
+	uint32 size = frame.nPayloadSize;
+
+	if (!g_bQuiet)
+	{
+		char szSrc[16], szDst[16];
+		format_ipv4(frame.nSrcAddr, szSrc, sizeof(szSrc));
+		format_ipv4(frame.nDstAddr, szDst, sizeof(szDst));
+
+		outf("\npacket %i:\n", frame.nIpId);
+		outf("  ver: %i\n", 4);
+		outf("  src addr: %s:%i\n", szSrc, frame.nSrcPort);
+		outf("  dst addr: %s:%i\n", szDst, frame.nDstPort);
+		outf("  payload size: %d\n", size);
+	}
+
+	m_stats.nDatagrams++;
+	m_stats.nDatagramBytes += size;
+
+	// Large packets are encrypted whole and then split, so they are put back
+	// together before anything else happens
+	if (size >= 4 && (int32)load_le32(pData) == NET_HEADER_FLAG_SPLITPACKET)
+	{
+		if (!m_splits.AddFragment(frame, pData, size, m_stats))
+			return false;
+
+		voutf("  reassembled split packet: %d\n", size);
+	}
+
+	if (size < 8 || size > NET_MAX_MESSAGE)
+		return false;
+
+	// A session keeps the key it was detected with. Detection only runs for new
+	// sessions, or when the cached key stops fitting (the server changed build).
+	flow_key_t& flow = m_flowKeys[hash_flow(frame) >> (32 - DECODER_FLOW_BITS)];
+	bool bKnownFlow = flow.pIce && flow.nSrcAddr == frame.nSrcAddr && flow.nDstAddr == frame.nDstAddr &&
+		flow.nSrcPort == frame.nSrcPort && flow.nDstPort == frame.nDstPort;
+
+	const IceKey* pIce = bKnownFlow ? flow.pIce : NULL;
+	const uint8* pPacket = NULL;
+	uint32 nPacketSize = 0;
+
+	if (!pIce || !DecryptDatagram(*pIce, pData, size, pPacket, nPacketSize))
+	{
+		const IceKey* pDetected = g_iceKeys.Detect(pData, size, pIce);
+		if (!pDetected)
+		{
+			m_stats.nKeyMisses++;
+			return false;
+		}
+
+		m_stats.nKeyDetections++;
+
+		flow.nSrcAddr = frame.nSrcAddr;
+		flow.nDstAddr = frame.nDstAddr;
+		flow.nSrcPort = frame.nSrcPort;
+		flow.nDstPort = frame.nDstPort;
+		flow.pIce = pDetected;
+
+		if (!DecryptDatagram(*pDetected, pData, size, pPacket, nPacketSize))
+			return false;
+	}
+
+	// Compressed packets carry their own header after the framing
+	if (nPacketSize >= 4 && (int32)load_le32(pPacket) == NET_HEADER_FLAG_COMPRESSEDPACKET)
+	{
+		uint32 nUncompressedSize = net_decompress(pPacket + 4, nPacketSize - 4, m_pDecompressBuffer, NET_MAX_PAYLOAD);
+		if (!nUncompressedSize)
+		{
+			m_stats.nDecompressFailed++;
+			return false;
+		}
+
+		voutf("  decompressed: %d -> %d\n", nPacketSize, nUncompressedSize);
+
+		m_stats.nCompressedPackets++;
+		m_stats.nCompressedBytes += nPacketSize;
+
+		pPacket = m_pDecompressBuffer;
+		nPacketSize = nUncompressedSize;
+	}
+
+	m_stats.nPackets++;
+	m_stats.nPacketBytes += nPacketSize;
+
+	if (g_corpusRecorder.IsOpen())
+		g_corpusRecorder.Record(pPacket, nPacketSize);
+
+	ReadPacket(frame, pPacket, nPacketSize);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Decrypts a datagram into m_pDecryptBuffer and checks its framing. On success
+// pPacket points at the netchannel packet inside the buffer.
+//-----------------------------------------------------------------------------
+bool CNetDecoder::DecryptDatagram(const IceKey& ice, const uint8* pData, uint32 size, const uint8*& pPacket, uint32& nPacketSize)
+{
+	int32 blockSize = ice.blockSize();
+
+	// The first block tells us how much padding precedes the packet
+	uint8* pDataOut = m_pDecryptBuffer;
+	ice.decrypt(pData, pDataOut);
+
+	unsigned char deltaOffset = pDataOut[0];
+	voutf("  deltaOffset: %d\n", deltaOffset);
+	if (deltaOffset == 0 || (uint32)deltaOffset + 5 >= size)
+		return false;
+
+	const uint8* p1 = pData + blockSize;
+	uint8* p2 = pDataOut + blockSize;
+
+	// decrypt the rest of the 8 byte blocks in one go
+	int32 bytesLeft = size - blockSize;
+	int32 nBlocks = bytesLeft / blockSize;
+
+	ice.decryptBlocks(p1, p2, nBlocks);
+
+	bytesLeft -= nBlocks * blockSize;
+	p1 += nBlocks * blockSize;
+	p2 += nBlocks * blockSize;
+
+	//The end chunk doesn't get an encryption. it sux.
+	memcpy(p2, p1, bytesLeft);
+
+	uint32 dataFinalSize = load_be32(&pDataOut[deltaOffset + 1]);
+	voutf("  dataFinalSize: %d\n", dataFinalSize);
+
+	if (dataFinalSize + deltaOffset + 5 != size)
+		return false;
+
+	pPacket = &pDataOut[deltaOffset + 5];
+	nPacketSize = dataFinalSize;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Reads the packet header like the engine's ProcessPacketHeader, then the
+// reliable subchannel data and finally the unreliable messages. Completed
+// reliable transfers are decoded as soon as their last fragment arrives.
+//-----------------------------------------------------------------------------
+int CNetDecoder::ReadPacket(const udp_frame_t& frame, const unsigned char* packetData, int size)
+{
+	if (size < 8)
+		return size;
+
+	CBitRead buf(packetData, size);
+
+	// Sequence numbers, checksum and reliable state only matter to the
+	// engine's netchannel, we only need to get past them
+	buf.ReadUBitLong(32); // nSeqNrIn
+	buf.ReadUBitLong(32); // nSeqNrOut
+	int32 nFlags = buf.ReadByte(); // nFlags
+
+	buf.ReadUBitLong(16); // nChecksum
+	buf.ReadByte(); // reliable state of 8 subchannels
+
+	if (nFlags & PACKET_FLAG_CHOKED)
+		buf.ReadByte(); // nChoked
+
+	if (nFlags & PACKET_FLAG_CHALLENGE)
+		buf.ReadUBitLong(32); // nChallenge
+
+	message_source_t source;
+	source.pFrame = &frame;
+	source.pDecoder = this;
+	source.bReliable = false;
+
+	if (nFlags & PACKET_FLAG_RELIABLE)
+	{
+		buf.ReadUBitLong(3); // nSubChannel
+
+		for (int i = 0; i < MAX_STREAMS; i++)
+		{
+			if (!buf.ReadOneBit())
+				continue;
+
+			const uint8* pData;
+			uint32 nDataSize;
+
+			// error while reading fragments, drop the whole packet
+			if (!m_subChannels.ReadSubChannelData(frame, buf, i, pData, nDataSize, m_stats))
+				return size;
+
+			if (nDataSize)
+			{
+				voutf("  reliable transfer: %d bytes\n", nDataSize);
+
+				message_source_t reliable = source;
+				reliable.bReliable = true;
+
+				CBitRead stream(pData, nDataSize);
+				ProcessMessages(stream, reliable);
+			}
+		}
+	}
+
+	ProcessMessages(buf, source);
+
+	return size;
+}
+
+void CNetDecoder::ProcessMessages(CBitRead& buf, const message_source_t& source)
+{
+	while (buf.GetNumBitsLeft() >= 16 && !buf.IsOverflowed())
+	{
+		uint32 header[2];
+		if (!buf.ReadVarInt32s(header, 2))
+			break;
+
+		int Cmd = (int)header[0];
+		int Size = (int)header[1];
+		if (Size < 0 || Size > buf.GetNumBytesLeft())
+			break;
+
+		count_message(m_stats, Cmd, Size);
+
+		// Nothing wants it, don't even look at the body
+		if (!m_pDispatcher->IsSubscribed(Cmd))
+		{
+			m_stats.nMessagesSkipped++;
+			buf.SeekRelative(Size * 8);
+			continue;
+		}
+
+		// Messages are parsed in place unless reliable data before them left
+		// the stream off a byte boundary
+		bool bAligned = (buf.GetNumBitsRead() & 7) == 0;
+		const uint8* pMessage = buf.GetBasePointer() + buf.GetNumBytesRead();
+
+		if (!bAligned)
+		{
+			buf.ReadBytes(m_pMessageBuffer, Size);
+			pMessage = m_pMessageBuffer;
+		}
+
+		if (!m_pDispatcher->Dispatch(Cmd, pMessage, Size, source, m_messages))
+			m_stats.nParseFailed++;
+
+		if (bAligned)
+			buf.SeekRelative(Size * 8);
+	}
+}
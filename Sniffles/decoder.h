@@ -0,0 +1,91 @@
+#pragma once
+
+#include "platform.h"
+#include "frame.h"
+#include "stats.h"
+#include "split.h"
+#include "subchannel.h"
+#include "msgpool.h"
+#include "entities.h"
+#include "usermsg.h"
+
+class IceKey;
+class CBitRead;
+
+// Per decoder cache of which key each session uses
+#define DECODER_FLOW_BITS		10
+#define DECODER_FLOW_SLOTS		(1 << DECODER_FLOW_BITS)
+
+//-----------------------------------------------------------------------------
+// Everything needed to turn game server datagrams into messages. A decoder is
+// owned by exactly one thread; run one per worker to decode in parallel.
+//-----------------------------------------------------------------------------
+class CNetDecoder
+{
+public:
+	CNetDecoder();
+	~CNetDecoder();
+
+	// Decrypts a datagram and decodes the netchannel packet inside it.
+	// The frame payload is only read during the call.
+	bool			ProcessDatagram(const udp_frame_t& frame);
+
+	// Decodes a decrypted netchannel packet of the session frame belongs to.
+	int				ReadPacket(const udp_frame_t& frame, const unsigned char* packetData, int size);
+
+	// Decodes Cmd/Size framed messages until the buffer runs out, handing
+	// each one to the dispatcher.
+	void			ProcessMessages(CBitRead& buf, const message_source_t& source);
+
+	// g_dispatcher unless replaced; must outlive the decoder
+	void			SetDispatcher(const CMessageDispatcher* pDispatcher) { m_pDispatcher = pDispatcher; }
+
+	// Entity state of the sessions this decoder handles, fed by the handlers
+	// add_entity_handlers registers
+	CEntityTracker&	GetEntityTracker() { return m_entities; }
+
+	// svc_UserMessage payloads are parsed into these, see add_user_message_handlers
+	CUserMessagePool&	GetUserMessagePool() { return m_userMessages; }
+
+	decode_stats_t	m_stats;
+
+private:
+	CNetDecoder(const CNetDecoder&);
+	CNetDecoder& operator=(const CNetDecoder&);
+
+	// Decrypted datagrams land here, NET_MAX_MESSAGE bytes and 16 byte aligned.
+	// The packet body is read wherever the padding in front of it leaves it.
+	uint8*			m_pDecryptBuffer;
+	uint8*			m_pDecryptBufferAlloc;
+
+	// Compressed packets are expanded into this, NET_MAX_PAYLOAD bytes
+	uint8*			m_pDecompressBuffer;
+
+	// Messages that don't start on a byte boundary (after reliable data) are
+	// copied here before parsing, NET_MAX_PAYLOAD bytes
+	uint8*			m_pMessageBuffer;
+
+	bool			DecryptDatagram(const IceKey& ice, const uint8* pData, uint32 size, const uint8*& pPacket, uint32& nPacketSize);
+
+	// Direct mapped on the flow hash; a collision just costs a new detection
+	struct flow_key_t
+	{
+		uint32			nSrcAddr;
+		uint32			nDstAddr;
+		uint16			nSrcPort;
+		uint16			nDstPort;
+		const IceKey*	pIce;		// NULL for an empty slot
+	};
+
+	flow_key_t		m_flowKeys[DECODER_FLOW_SLOTS];
+
+	const CMessageDispatcher*	m_pDispatcher;
+
+	// parsed messages are reused from here
+	CMessagePool	m_messages;
+	CUserMessagePool	m_userMessages;
+
+	CSplitReassembler	m_splits;
+	CSubChannelReassembler	m_subChannels;
+	CEntityTracker		m_entities;
+};
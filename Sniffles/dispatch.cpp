@@ -0,0 +1,134 @@
+#include "dispatch.h"
+#include "msgpool.h"
+
+CMessageDispatcher g_dispatcher;
+
+CMessageDispatcher::CMessageDispatcher()
+{
+	m_nSubscribed = 0;
+}
+
+void CMessageDispatcher::SubscribeRaw(int nCmd, pfnRawMessageHandler_t pfnHandler, void* pContext)
+{
+	AddHandler(nCmd, true, (pfnGenericHandler_t)pfnHandler, pContext);
+}
+
+void CMessageDispatcher::AddHandler(int nCmd, bool bRaw, pfnGenericHandler_t pfnHandler, void* pContext)
+{
+	if ((uint32)nCmd >= DISPATCH_MAX_MESSAGE_TYPES)
+		return;
+
+	handler_t handler;
+	handler.pfnHandler = pfnHandler;
+	handler.pContext = pContext;
+
+	if (bRaw)
+		m_handlers[nCmd].raw.push_back(handler);
+	else
+		m_handlers[nCmd].typed.push_back(handler);
+
+	m_nSubscribed |= 1u << nCmd;
+}
+
+bool CMessageDispatcher::Dispatch(int nCmd, const uint8* pData, int nSize, const message_source_t& source, CMessagePool& pool) const
+{
+	if (!IsSubscribed(nCmd))
+		return true;
+
+	const message_handlers_t& handlers = m_handlers[nCmd];
+
+	for (size_t i = 0; i < handlers.raw.size(); i++)
+	{
+		const handler_t& handler = handlers.raw[i];
+		((pfnRawMessageHandler_t)handler.pfnHandler)(nCmd, pData, nSize, source, handler.pContext);
+	}
+
+	if (handlers.typed.empty())
+		return true;
+
+	const message_type_t* pType = GetMessageType(nCmd);
+	if (!pType)
+		return true;
+
+	return (this->*pType->pfnParse)(nCmd, pData, nSize, source, pool);
+}
+
+template <typename T>
+bool CMessageDispatcher::ParseAndDispatch(int nCmd, const uint8* pData, int nSize, const message_source_t& source, CMessagePool& pool) const
+{
+	typedef void (*pfnHandler_t)(const T& msg, int nSize, const message_source_t& source, void* pContext);
+
+	// ParseFromArray starts with Clear(), which keeps string and repeated
+	// field capacity from the last message of this type
+	T& msg = pool.Get<T>();
+	if (!msg.ParseFromArray(pData, nSize))
+		return false;
+
+	const std::vector<handler_t>& typed = m_handlers[nCmd].typed;
+	for (size_t i = 0; i < typed.size(); i++)
+		((pfnHandler_t)typed[i].pfnHandler)(msg, nSize, source, typed[i].pContext);
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Id -> message type table, NULL entries for ids the protocol doesn't use
+//-----------------------------------------------------------------------------
+const CMessageDispatcher::message_type_t* CMessageDispatcher::GetMessageType(int nCmd)
+{
+	struct message_table_t
+	{
+		message_type_t	types[DISPATCH_MAX_MESSAGE_TYPES];
+
+		message_table_t()
+		{
+			memset(types, 0, sizeof(types));
+
+#define ADD_MESSAGE_TYPE(id, type) \
+			types[id].pszName = #id; \
+			types[id].pfnParse = &CMessageDispatcher::ParseAndDispatch<type>;
+			NET_MESSAGE_TYPES(ADD_MESSAGE_TYPE)
+#undef ADD_MESSAGE_TYPE
+		}
+	};
+
+	// built on first use, safe to race from several decoder threads
+	static const message_table_t s_table;
+
+	if ((uint32)nCmd >= DISPATCH_MAX_MESSAGE_TYPES || !s_table.types[nCmd].pszName)
+		return NULL;
+
+	return &s_table.types[nCmd];
+}
+
+const char* CMessageDispatcher::GetMessageName(int nCmd)
+{
+	const message_type_t* pType = GetMessageType(nCmd);
+	return pType ? pType->pszName : NULL;
+}
+
+int CMessageDispatcher::FindMessage(const char* pszName)
+{
+	for (int nCmd = 0; nCmd < DISPATCH_MAX_MESSAGE_TYPES; nCmd++)
+	{
+		const char* pszMessage = GetMessageName(nCmd);
+		if (pszMessage && !strcmp(pszMessage, pszName))
+			return nCmd;
+	}
+
+	return -1;
+}
+
+template <typename T>
+static void print_message(const T& msg, int nSize, const message_source_t& /*source*/, void* /*pContext*/)
+{
+	MsgPrintf(msg, nSize, "%s", msg.DebugString().c_str());
+}
+
+void add_print_handlers(CMessageDispatcher& dispatcher)
+{
+	dispatcher.Subscribe(print_message<CNETMsg_Tick>);
+	dispatcher.Subscribe(print_message<CNETMsg_SignonState>);
+	dispatcher.Subscribe(print_message<CSVCMsg_ServerInfo>);
+	dispatcher.Subscribe(print_message<CSVCMsg_PacketEntities>);
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <vector>
+
+#include "platform.h"
+#include "net.h"
+#include "frame.h"
+
+// Message ids are NETMSG_TYPE_BITS wide
+#define DISPATCH_MAX_MESSAGE_TYPES		(1 << NETMSG_TYPE_BITS)
+
+// Every message in netmessages_public.proto with the id it is sent under
+#define NET_MESSAGE_TYPES(X) \
+	X(net_NOP,					CNETMsg_NOP) \
+	X(net_Disconnect,			CNETMsg_Disconnect) \
+	X(net_File,					CNETMsg_File) \
+	X(net_Tick,					CNETMsg_Tick) \
+	X(net_StringCmd,			CNETMsg_StringCmd) \
+	X(net_SetConVar,			CNETMsg_SetConVar) \
+	X(net_SignonState,			CNETMsg_SignonState) \
+	X(svc_ServerInfo,			CSVCMsg_ServerInfo) \
+	X(svc_SendTable,			CSVCMsg_SendTable) \
+	X(svc_ClassInfo,			CSVCMsg_ClassInfo) \
+	X(svc_SetPause,				CSVCMsg_SetPause) \
+	X(svc_CreateStringTable,	CSVCMsg_CreateStringTable) \
+	X(svc_UpdateStringTable,	CSVCMsg_UpdateStringTable) \
+	X(svc_VoiceInit,			CSVCMsg_VoiceInit) \
+	X(svc_VoiceData,			CSVCMsg_VoiceData) \
+	X(svc_Print,				CSVCMsg_Print) \
+	X(svc_Sounds,				CSVCMsg_Sounds) \
+	X(svc_SetView,				CSVCMsg_SetView) \
+	X(svc_FixAngle,				CSVCMsg_FixAngle) \
+	X(svc_CrosshairAngle,		CSVCMsg_CrosshairAngle) \
+	X(svc_BSPDecal,				CSVCMsg_BSPDecal) \
+	X(svc_UserMessage,			CSVCMsg_UserMessage) \
+	X(svc_GameEvent,			CSVCMsg_GameEvent) \
+	X(svc_PacketEntities,		CSVCMsg_PacketEntities) \
+	X(svc_TempEntities,			CSVCMsg_TempEntities) \
+	X(svc_Prefetch,				CSVCMsg_Prefetch) \
+	X(svc_Menu,					CSVCMsg_Menu) \
+	X(svc_GameEventList,		CSVCMsg_GameEventList) \
+	X(svc_GetCvarValue,			CSVCMsg_GetCvarValue)
+
+// message_id<CSVCMsg_Print>::value == svc_Print
+template <typename T> struct message_id;
+
+#define DECLARE_MESSAGE_ID(id, type) \
+	template <> struct message_id<type> { enum { value = id }; };
+NET_MESSAGE_TYPES(DECLARE_MESSAGE_ID)
+#undef DECLARE_MESSAGE_ID
+
+class CMessagePool;
+class CNetDecoder;
+
+// Where a message came from, handed to every handler along with it
+struct message_source_t
+{
+	const udp_frame_t*	pFrame;		// datagram that delivered it (the last fragment for reliable data)
+	CNetDecoder*		pDecoder;	// decoder, and so the thread, the session belongs to
+	bool				bReliable;	// decoded from a reliable subchannel transfer
+};
+
+// Gets the serialized body, nothing is parsed
+typedef void (*pfnRawMessageHandler_t)(int nCmd, const uint8* pData, int nSize, const message_source_t& source, void* pContext);
+
+//-----------------------------------------------------------------------------
+// Routes decoded messages to whoever asked for them. Handlers are registered
+// at startup, before any decoder runs, and the dispatcher is read-only from
+// then on; handlers are called on the thread decoding the session.
+//
+// A message is only parsed when a typed handler wants it. Ids nobody
+// subscribed to are skipped by the decoder using just their Cmd/Size header.
+//-----------------------------------------------------------------------------
+class CMessageDispatcher
+{
+public:
+	CMessageDispatcher();
+
+	// Typed handlers get the parsed message, which is reused for the next
+	// message of its type once the handler returns, e.g.
+	//   void OnTick(const CNETMsg_Tick& msg, int nSize, const message_source_t& source, void* pContext);
+	//   dispatcher.Subscribe(OnTick);
+	template <typename T>
+	void			Subscribe(void (*pfnHandler)(const T& msg, int nSize, const message_source_t& source, void* pContext), void* pContext = NULL)
+	{
+		AddHandler(message_id<T>::value, false, (pfnGenericHandler_t)pfnHandler, pContext);
+	}
+
+	// Raw handlers also work for ids without a known message type
+	void			SubscribeRaw(int nCmd, pfnRawMessageHandler_t pfnHandler, void* pContext = NULL);
+
+	bool			IsSubscribed(int nCmd) const
+	{
+		return (uint32)nCmd < DISPATCH_MAX_MESSAGE_TYPES && ((m_nSubscribed >> nCmd) & 1);
+	}
+
+	// Hands a message body to its handlers. Typed handlers get it parsed into
+	// the pool's object for its type. Returns false if it had to be parsed and
+	// didn't parse.
+	bool			Dispatch(int nCmd, const uint8* pData, int nSize, const message_source_t& source, CMessagePool& pool) const;
+
+	static const char*	GetMessageName(int nCmd);
+
+	// Id of a message by the name GetMessageName gives it, -1 if unknown
+	static int			FindMessage(const char* pszName);
+
+private:
+	typedef void (*pfnGenericHandler_t)();
+
+	struct handler_t
+	{
+		pfnGenericHandler_t	pfnHandler;
+		void*				pContext;
+	};
+
+	struct message_handlers_t
+	{
+		std::vector<handler_t>	raw;
+		std::vector<handler_t>	typed;
+	};
+
+	void			AddHandler(int nCmd, bool bRaw, pfnGenericHandler_t pfnHandler, void* pContext);
+
+	template <typename T>
+	bool			ParseAndDispatch(int nCmd, const uint8* pData, int nSize, const message_source_t& source, CMessagePool& pool) const;
+
+	struct message_type_t
+	{
+		const char*	pszName;
+		bool		(CMessageDispatcher::*pfnParse)(int nCmd, const uint8* pData, int nSize, const message_source_t& source, CMessagePool& pool) const;
+	};
+
+	static const message_type_t*	GetMessageType(int nCmd);
+
+	uint32				m_nSubscribed;		// bit per id with at least one handler
+	message_handlers_t	m_handlers[DISPATCH_MAX_MESSAGE_TYPES];
+};
+
+// Handlers the decoder runs with unless told otherwise
+extern CMessageDispatcher g_dispatcher;
+
+// Prints the messages sniffles has always shown (ticks, signon state, server
+// info and packet entities)
+void add_print_handlers(CMessageDispatcher& dispatcher);
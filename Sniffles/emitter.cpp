@@ -0,0 +1,568 @@
+#include "emitter.h"
+#include "str.h"
+
+#include <chrono>
+#include <cmath>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+using ::google::protobuf::Message;
+using ::google::protobuf::Reflection;
+using ::google::protobuf::FieldDescriptor;
+
+static_assert(sizeof(emit_record_t) <= EMIT_SLOT_SIZE, "emit_record_t must fit in the first slot");
+
+// Threads remember the ring they were given, per emitter
+struct thread_producer_t
+{
+	uint32	nEmitter;
+	void*	pProducer;
+};
+
+static thread_local thread_producer_t t_producer = { 0, NULL };
+static std::atomic<uint32> s_nNextEmitterId(1);
+
+CEventEmitter::CEventEmitter() : m_nProducers(0), m_nUnqueued(0), m_bStopping(false)
+{
+	m_nId = s_nNextEmitterId.fetch_add(1);
+	m_pFile = NULL;
+	m_bStdout = false;
+	m_format = EMIT_FORMAT_NDJSON;
+	m_pRecordBuffer = (uint8*)malloc(EMIT_RING_SLOTS * EMIT_SLOT_SIZE);
+	m_nBytesWritten = 0;
+	m_nWriteErrors = 0;
+
+	for (int i = 0; i < EMIT_MAX_PRODUCERS; i++)
+		m_pProducers[i].store(NULL, std::memory_order_relaxed);
+}
+
+CEventEmitter::~CEventEmitter()
+{
+	Stop();
+
+	for (int i = 0; i < EMIT_MAX_PRODUCERS; i++)
+		delete m_pProducers[i].load(std::memory_order_relaxed);
+
+	free(m_pRecordBuffer);
+}
+
+bool CEventEmitter::Open(const char* pszFile, emit_format_t format)
+{
+	if (!strcmp(pszFile, "-"))
+	{
+#ifdef _WIN32
+		// no \r\n translation, binary records must go out as they are
+		_setmode(_fileno(stdout), _O_BINARY);
+#endif
+		m_pFile = stdout;
+		m_bStdout = true;
+	}
+	else if (fopen_s(&m_pFile, pszFile, "wb") != 0 || !m_pFile)
+	{
+		shout_error("Can't open the -emit file");
+		return false;
+	}
+
+	// Everything goes out in EMIT_BATCH_SIZE writes, stdio buffering would
+	// only add a copy
+	setvbuf(m_pFile, NULL, _IONBF, 0);
+
+	m_format = format;
+	m_strBatch.reserve(EMIT_BATCH_SIZE * 2);
+
+	if (m_format == EMIT_FORMAT_BINARY)
+	{
+		uint8 header[8];
+		store_le32(header, EMIT_FILE_MAGIC);
+		store_le32(header + 4, EMIT_FILE_VERSION);
+		m_strBatch.append((const char*)header, sizeof(header));
+	}
+
+	m_bStopping.store(false, std::memory_order_relaxed);
+	m_thread = std::thread(WriterMain, this);
+	return true;
+}
+
+void CEventEmitter::Stop()
+{
+	if (!m_thread.joinable())
+		return;
+
+	m_bStopping.store(true, std::memory_order_release);
+	m_thread.join();
+
+	if (!m_bStdout)
+		fclose(m_pFile);
+	m_pFile = NULL;
+}
+
+bool CEventEmitter::Subscribe(CMessageDispatcher& dispatcher, const char* pszMessages)
+{
+	if (!pszMessages)
+	{
+		for (int nCmd = 0; nCmd < DISPATCH_MAX_MESSAGE_TYPES; nCmd++)
+			dispatcher.SubscribeRaw(nCmd, OnMessage, this);
+		return true;
+	}
+
+	std::string strMessages(pszMessages);
+	size_t nStart = 0;
+
+	while (nStart < strMessages.size())
+	{
+		size_t nEnd = strMessages.find(',', nStart);
+		if (nEnd == std::string::npos)
+			nEnd = strMessages.size();
+
+		int nCmd = CMessageDispatcher::FindMessage(strMessages.substr(nStart, nEnd - nStart).c_str());
+		if (nCmd < 0)
+			return false;
+
+		dispatcher.SubscribeRaw(nCmd, OnMessage, this);
+		nStart = nEnd + 1;
+	}
+
+	return true;
+}
+
+void CEventEmitter::OnMessage(int nCmd, const uint8* pData, int nSize, const message_source_t& source, void* pContext)
+{
+	((CEventEmitter*)pContext)->Emit(nCmd, pData, nSize, source);
+}
+
+//-----------------------------------------------------------------------------
+// The calling thread's ring, set up the first time the thread emits. NULL once
+// EMIT_MAX_PRODUCERS threads have taken one.
+//-----------------------------------------------------------------------------
+CEventEmitter::producer_t* CEventEmitter::GetProducer()
+{
+	if (t_producer.nEmitter == m_nId)
+		return (producer_t*)t_producer.pProducer;
+
+	producer_t* pProducer = NULL;
+
+	uint32 nIndex = m_nProducers.fetch_add(1, std::memory_order_relaxed);
+	if (nIndex < EMIT_MAX_PRODUCERS)
+	{
+		pProducer = new producer_t;
+		pProducer->nRecords = 0;
+		pProducer->nDropped = 0;
+
+		// the writer picks it up from here
+		m_pProducers[nIndex].store(pProducer, std::memory_order_release);
+	}
+
+	t_producer.nEmitter = m_nId;
+	t_producer.pProducer = pProducer;
+	return pProducer;
+}
+
+void CEventEmitter::Emit(int nCmd, const uint8* pData, int nSize, const message_source_t& source)
+{
+	producer_t* pProducer = GetProducer();
+	if (!pProducer)
+	{
+		m_nUnqueued.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	uint32 nBodySize = (uint32)nSize;
+	uint32 nSlots = (sizeof(emit_record_t) + nBodySize + EMIT_SLOT_SIZE - 1) / EMIT_SLOT_SIZE;
+
+	// the writer is behind, losing the record beats stalling the decoder
+	if (nSlots > EMIT_RING_SLOTS || !pProducer->ring.Reserve(nSlots))
+	{
+		pProducer->nDropped++;
+		return;
+	}
+
+	emit_record_t record;
+	memset(&record, 0, sizeof(record));
+	record.nSize = nBodySize;
+	record.nSlots = nSlots;
+	record.nCmd = nCmd;
+	record.nFlags = source.bReliable ? EMIT_FLAG_RELIABLE : 0;
+	record.nTimestampUs = source.pFrame->nTimestampUs;
+	record.nSrcAddr = source.pFrame->nSrcAddr;
+	record.nDstAddr = source.pFrame->nDstAddr;
+	record.nSrcPort = source.pFrame->nSrcPort;
+	record.nDstPort = source.pFrame->nDstPort;
+
+	// header and the start of the body in the first slot, the rest of the
+	// body in the ones after it
+	uint8* pSlot = pProducer->ring.PushSlot(0)->data;
+	uint32 nCopied = EMIT_SLOT_SIZE - sizeof(emit_record_t);
+	if (nCopied > nBodySize)
+		nCopied = nBodySize;
+
+	memcpy(pSlot, &record, sizeof(record));
+	memcpy(pSlot + sizeof(record), pData, nCopied);
+
+	for (uint32 i = 1; i < nSlots; i++)
+	{
+		uint32 nCopy = nBodySize - nCopied;
+		if (nCopy > EMIT_SLOT_SIZE)
+			nCopy = EMIT_SLOT_SIZE;
+
+		memcpy(pProducer->ring.PushSlot(i)->data, pData + nCopied, nCopy);
+		nCopied += nCopy;
+	}
+
+	pProducer->ring.CommitPush(nSlots);
+	pProducer->nRecords++;
+}
+
+//-----------------------------------------------------------------------------
+// Writer thread
+//-----------------------------------------------------------------------------
+void CEventEmitter::WriterMain(CEventEmitter* pEmitter)
+{
+	for (;;)
+	{
+		// read before draining, anything queued before Stop() is then seen
+		bool bStopping = pEmitter->m_bStopping.load(std::memory_order_acquire);
+		bool bWork = false;
+
+		uint32 nProducers = pEmitter->m_nProducers.load(std::memory_order_acquire);
+		if (nProducers > EMIT_MAX_PRODUCERS)
+			nProducers = EMIT_MAX_PRODUCERS;
+
+		for (uint32 i = 0; i < nProducers; i++)
+		{
+			producer_t* pProducer = pEmitter->m_pProducers[i].load(std::memory_order_acquire);
+			if (pProducer && pEmitter->DrainProducer(pProducer))
+				bWork = true;
+		}
+
+		if (bWork)
+			continue;
+
+		// Caught up. Write out the partial batch so a quiet capture, or a live
+		// one that is never stopped, doesn't sit in memory.
+		pEmitter->Flush();
+
+		if (bStopping)
+			break;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+bool CEventEmitter::DrainProducer(producer_t* pProducer)
+{
+	bool bWork = false;
+
+	while (emit_slot_t* pSlot = pProducer->ring.BeginPop())
+	{
+		emit_record_t record;
+		memcpy(&record, pSlot->data, sizeof(record));
+
+		// the slots of a record are published together, reassemble the body
+		uint32 nCopied = EMIT_SLOT_SIZE - sizeof(emit_record_t);
+		if (nCopied > record.nSize)
+			nCopied = record.nSize;
+
+		memcpy(m_pRecordBuffer, pSlot->data + sizeof(record), nCopied);
+
+		for (uint32 i = 1; i < record.nSlots; i++)
+		{
+			uint32 nCopy = record.nSize - nCopied;
+			if (nCopy > EMIT_SLOT_SIZE)
+				nCopy = EMIT_SLOT_SIZE;
+
+			memcpy(m_pRecordBuffer + nCopied, pProducer->ring.PopSlot(i)->data, nCopy);
+			nCopied += nCopy;
+		}
+
+		pProducer->ring.CommitPop(record.nSlots);
+
+		WriteRecord(record, m_pRecordBuffer);
+		if (m_strBatch.size() >= EMIT_BATCH_SIZE)
+			Flush();
+
+		bWork = true;
+	}
+
+	return bWork;
+}
+
+void CEventEmitter::Flush()
+{
+	if (m_strBatch.empty())
+		return;
+
+	if (fwrite(m_strBatch.data(), 1, m_strBatch.size(), m_pFile) != m_strBatch.size())
+		m_nWriteErrors++;
+	else
+		m_nBytesWritten += m_strBatch.size();
+
+	m_strBatch.clear();
+}
+
+//-----------------------------------------------------------------------------
+// JSON from protobuf reflection. Field names are the .proto names, enums are
+// written by name, bytes fields as base64 and 64 bit integers as plain numbers.
+//-----------------------------------------------------------------------------
+static void json_append_string(std::string& str, const std::string& strValue)
+{
+	static const char s_szHex[] = "0123456789abcdef";
+
+	str += '"';
+
+	for (size_t i = 0; i < strValue.size(); i++)
+	{
+		uint8 c = (uint8)strValue[i];
+
+		if (c == '"' || c == '\\')
+		{
+			str += '\\';
+			str += (char)c;
+		}
+		else if (c < 0x20)
+		{
+			str += "\\u00";
+			str += s_szHex[c >> 4];
+			str += s_szHex[c & 15];
+		}
+		else
+			str += (char)c;
+	}
+
+	str += '"';
+}
+
+static void json_append_base64(std::string& str, const std::string& strValue)
+{
+	static const char s_szBase64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+	const uint8* p = (const uint8*)strValue.data();
+	size_t nSize = strValue.size();
+
+	str += '"';
+
+	for (size_t i = 0; i < nSize; i += 3)
+	{
+		uint32 nBits = (uint32)p[i] << 16;
+		if (i + 1 < nSize)
+			nBits |= (uint32)p[i + 1] << 8;
+		if (i + 2 < nSize)
+			nBits |= p[i + 2];
+
+		str += s_szBase64[(nBits >> 18) & 63];
+		str += s_szBase64[(nBits >> 12) & 63];
+		str += i + 1 < nSize ? s_szBase64[(nBits >> 6) & 63] : '=';
+		str += i + 2 < nSize ? s_szBase64[nBits & 63] : '=';
+	}
+
+	str += '"';
+}
+
+static void json_append_number(std::string& str, double flValue, const char* pszFormat)
+{
+	// JSON has no NaN or infinity
+	if (!std::isfinite(flValue))
+	{
+		str += "null";
+		return;
+	}
+
+	char szValue[32];
+	_snprintf_s(szValue, sizeof(szValue), _TRUNCATE, pszFormat, flValue);
+	str += szValue;
+}
+
+static void json_append_message(std::string& str, const Message& msg);
+
+// nIndex is the element of a repeated field, -1 for a singular one
+static void json_append_value(std::string& str, const Message& msg, const FieldDescriptor* pField, int nIndex)
+{
+#define FIELD_VALUE(type) (nIndex < 0 ? pReflection->Get##type(msg, pField) : pReflection->GetRepeated##type(msg, pField, nIndex))
+
+	const Reflection* pReflection = msg.GetReflection();
+	char szValue[32];
+	std::string strScratch;
+
+	switch (pField->cpp_type())
+	{
+	case FieldDescriptor::CPPTYPE_INT32:
+		_snprintf_s(szValue, sizeof(szValue), _TRUNCATE, "%d", FIELD_VALUE(Int32));
+		str += szValue;
+		break;
+
+	case FieldDescriptor::CPPTYPE_UINT32:
+		_snprintf_s(szValue, sizeof(szValue), _TRUNCATE, "%u", FIELD_VALUE(UInt32));
+		str += szValue;
+		break;
+
+	case FieldDescriptor::CPPTYPE_INT64:
+		_snprintf_s(szValue, sizeof(szValue), _TRUNCATE, "%lld", (long long)FIELD_VALUE(Int64));
+		str += szValue;
+		break;
+
+	case FieldDescriptor::CPPTYPE_UINT64:
+		_snprintf_s(szValue, sizeof(szValue), _TRUNCATE, "%llu", (unsigned long long)FIELD_VALUE(UInt64));
+		str += szValue;
+		break;
+
+	case FieldDescriptor::CPPTYPE_FLOAT:
+		json_append_number(str, FIELD_VALUE(Float), "%.9g");
+		break;
+
+	case FieldDescriptor::CPPTYPE_DOUBLE:
+		json_append_number(str, FIELD_VALUE(Double), "%.17g");
+		break;
+
+	case FieldDescriptor::CPPTYPE_BOOL:
+		str += FIELD_VALUE(Bool) ? "true" : "false";
+		break;
+
+	case FieldDescriptor::CPPTYPE_ENUM:
+		json_append_string(str, FIELD_VALUE(Enum)->name());
+		break;
+
+	case FieldDescriptor::CPPTYPE_STRING:
+	{
+		const std::string& strValue = nIndex < 0
+			? pReflection->GetStringReference(msg, pField, &strScratch)
+			: pReflection->GetRepeatedStringReference(msg, pField, nIndex, &strScratch);
+
+		if (pField->type() == FieldDescriptor::TYPE_BYTES)
+			json_append_base64(str, strValue);
+		else
+			json_append_string(str, strValue);
+	}
+	break;
+
+	case FieldDescriptor::CPPTYPE_MESSAGE:
+		json_append_message(str, FIELD_VALUE(Message));
+		break;
+	}
+
+#undef FIELD_VALUE
+}
+
+static void json_append_message(std::string& str, const Message& msg)
+{
+	const Reflection* pReflection = msg.GetReflection();
+
+	std::vector<const FieldDescriptor*> fields;
+	pReflection->ListFields(msg, &fields);
+
+	str += '{';
+
+	for (size_t i = 0; i < fields.size(); i++)
+	{
+		const FieldDescriptor* pField = fields[i];
+
+		if (i)
+			str += ',';
+		json_append_string(str, pField->name());
+		str += ':';
+
+		if (!pField->is_repeated())
+		{
+			json_append_value(str, msg, pField, -1);
+			continue;
+		}
+
+		str += '[';
+
+		int nCount = pReflection->FieldSize(msg, pField);
+		for (int j = 0; j < nCount; j++)
+		{
+			if (j)
+				str += ',';
+			json_append_value(str, msg, pField, j);
+		}
+
+		str += ']';
+	}
+
+	str += '}';
+}
+
+// The writer's own message of type nCmd, NULL for ids without a type
+static Message* get_message(CMessagePool& pool, int nCmd)
+{
+	switch (nCmd)
+	{
+#define GET_MESSAGE(id, type) case id: return &pool.Get<type>();
+		NET_MESSAGE_TYPES(GET_MESSAGE)
+#undef GET_MESSAGE
+	}
+
+	return NULL;
+}
+
+void CEventEmitter::WriteRecord(const emit_record_t& record, const uint8* pBody)
+{
+	if (m_format == EMIT_FORMAT_BINARY)
+	{
+		uint8 header[EMIT_RECORD_HEADER_SIZE];
+		store_le32(header, record.nSize);
+		store_le16(header + 4, (uint16)record.nCmd);
+		header[6] = record.nFlags;
+		header[7] = 0;
+		store_le32(header + 8, (uint32)record.nTimestampUs);
+		store_le32(header + 12, (uint32)(record.nTimestampUs >> 32));
+		store_le32(header + 16, record.nSrcAddr);
+		store_le32(header + 20, record.nDstAddr);
+		store_le16(header + 24, record.nSrcPort);
+		store_le16(header + 26, record.nDstPort);
+
+		m_strBatch.append((const char*)header, sizeof(header));
+		m_strBatch.append((const char*)pBody, record.nSize);
+		return;
+	}
+
+	char szSrc[16], szDst[16];
+	format_ipv4(record.nSrcAddr, szSrc, sizeof(szSrc));
+	format_ipv4(record.nDstAddr, szDst, sizeof(szDst));
+
+	char szLine[256];
+	_snprintf_s(szLine, sizeof(szLine), _TRUNCATE,
+		"{\"ts\":%llu,\"src\":\"%s:%u\",\"dst\":\"%s:%u\",\"cmd\":%d,\"size\":%u,\"reliable\":%s",
+		(unsigned long long)record.nTimestampUs, szSrc, record.nSrcPort, szDst, record.nDstPort,
+		record.nCmd, record.nSize, (record.nFlags & EMIT_FLAG_RELIABLE) ? "true" : "false");
+	m_strBatch += szLine;
+
+	// ids the protocol doesn't define only get the envelope
+	Message* pMsg = get_message(m_messages, record.nCmd);
+	if (pMsg)
+	{
+		m_strBatch += ",\"msg\":\"";
+		m_strBatch += CMessageDispatcher::GetMessageName(record.nCmd);
+		m_strBatch += "\",\"body\":";
+
+		if (pMsg->ParseFromArray(pBody, (int)record.nSize))
+			json_append_message(m_strBatch, *pMsg);
+		else
+			m_strBatch += "null";
+	}
+
+	m_strBatch += "}\n";
+}
+
+void CEventEmitter::PrintStats() const
+{
+	uint64 nRecords = 0;
+	uint64 nDropped = m_nUnqueued.load(std::memory_order_relaxed);
+
+	for (int i = 0; i < EMIT_MAX_PRODUCERS; i++)
+	{
+		const producer_t* pProducer = m_pProducers[i].load(std::memory_order_acquire);
+		if (!pProducer)
+			continue;
+
+		nRecords += pProducer->nRecords;
+		nDropped += pProducer->nDropped;
+	}
+
+	outf("  emitted: %llu messages, dropped: %llu, %llu bytes written", nRecords, nDropped, m_nBytesWritten);
+	if (m_nWriteErrors)
+		outf(", %llu write errors", m_nWriteErrors);
+	out("\n");
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <stdio.h>
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "platform.h"
+#include "ring.h"
+#include "dispatch.h"
+#include "msgpool.h"
+
+#define EMIT_SLOT_SIZE			256			// records are packed into slots of this size
+#define EMIT_RING_SLOTS			8192		// per decode thread, 2MB
+#define EMIT_MAX_PRODUCERS		64			// decode threads that can emit at once
+#define EMIT_BATCH_SIZE			(1 << 20)	// bytes collected before each fwrite
+
+// Binary output starts with EMIT_FILE_MAGIC and EMIT_FILE_VERSION (little
+// endian uint32s), then one record after another: an EMIT_RECORD_HEADER_SIZE
+// byte header followed by the serialized message body
+//
+//   uint32 nSize        body bytes after the header
+//   uint16 nCmd         message id
+//   uint8  nFlags       EMIT_FLAG_*
+//   uint8  reserved
+//   uint64 nTimestampUs capture time of the datagram
+//   uint32 nSrcAddr     IPv4 addresses and ports of the datagram
+//   uint32 nDstAddr
+//   uint16 nSrcPort
+//   uint16 nDstPort
+#define EMIT_FILE_MAGIC			0x45464E53	// "SNFE"
+#define EMIT_FILE_VERSION		1
+#define EMIT_RECORD_HEADER_SIZE	28
+
+#define EMIT_FLAG_RELIABLE		(1 << 0)	// came from a reliable subchannel transfer
+
+enum emit_format_t
+{
+	EMIT_FORMAT_NDJSON,		// one JSON object per line, the body as JSON
+	EMIT_FORMAT_BINARY,		// length prefixed records, the body as sent
+};
+
+struct emit_slot_t
+{
+	uint8	data[EMIT_SLOT_SIZE];
+};
+
+// What the decode thread queues per message, followed by the body
+struct emit_record_t
+{
+	uint32	nSize;
+	uint32	nSlots;			// including the ones the body spills into
+	int		nCmd;
+	uint8	nFlags;
+	uint64	nTimestampUs;
+	uint32	nSrcAddr;
+	uint32	nDstAddr;
+	uint16	nSrcPort;
+	uint16	nDstPort;
+};
+
+//-----------------------------------------------------------------------------
+// Writes decoded messages to a file from its own thread. Decode threads only
+// copy the message body into a ring of their own, nothing is formatted or
+// written on them, and a full ring drops the record rather than waiting: a
+// slow disk or pipe loses output, never packets. The writer thread turns the
+// records into NDJSON or binary records and hands them to fwrite in
+// EMIT_BATCH_SIZE chunks.
+//
+// A decode thread gets its ring the first time it emits, so any thread that
+// runs a decoder can emit without being set up first.
+//-----------------------------------------------------------------------------
+class CEventEmitter
+{
+public:
+	CEventEmitter();
+	~CEventEmitter();
+
+	// Starts the writer thread on a file, "-" for stdout
+	bool			Open(const char* pszFile, emit_format_t format);
+
+	// Writes whatever is still queued, joins the writer thread and closes the
+	// file. Call once the decoders are done.
+	void			Stop();
+
+	// Emits every message with the given ids, or every message id when
+	// pszMessages is NULL. pszMessages is a comma separated list of names as
+	// GetMessageName gives them. False on an unknown name.
+	bool			Subscribe(CMessageDispatcher& dispatcher, const char* pszMessages);
+
+	// Queues a message on the calling thread's ring, never blocks
+	void			Emit(int nCmd, const uint8* pData, int nSize, const message_source_t& source);
+
+	bool			IsStdout() const { return m_bStdout; }
+
+	// Only valid after Stop()
+	void			PrintStats() const;
+
+private:
+	CEventEmitter(const CEventEmitter&);
+	CEventEmitter& operator=(const CEventEmitter&);
+
+	struct producer_t
+	{
+		CSpscRing<emit_slot_t, EMIT_RING_SLOTS>	ring;
+		uint64									nRecords;	// producer owned, read after Stop
+		uint64									nDropped;
+	};
+
+	static void		OnMessage(int nCmd, const uint8* pData, int nSize, const message_source_t& source, void* pContext);
+
+	producer_t*		GetProducer();
+
+	static void		WriterMain(CEventEmitter* pEmitter);
+	bool			DrainProducer(producer_t* pProducer);
+	void			WriteRecord(const emit_record_t& record, const uint8* pBody);
+	void			Flush();
+
+	uint32						m_nId;			// tells thread local producers of different emitters apart
+	FILE*						m_pFile;
+	bool						m_bStdout;
+	emit_format_t				m_format;
+
+	std::atomic<producer_t*>	m_pProducers[EMIT_MAX_PRODUCERS];
+	std::atomic<uint32>			m_nProducers;	// may run past EMIT_MAX_PRODUCERS
+	std::atomic<uint64>			m_nUnqueued;	// emitted on threads that got no ring
+
+	std::thread					m_thread;
+	std::atomic<bool>			m_bStopping;
+
+	// writer thread owned
+	std::string					m_strBatch;
+	uint8*						m_pRecordBuffer;	// records are reassembled from their slots here
+	CMessagePool				m_messages;			// NDJSON bodies are parsed into these
+	uint64						m_nBytesWritten;
+	uint64						m_nWriteErrors;
+};
@@ -0,0 +1,992 @@
+#include "entities.h"
+#include "decoder.h"
+#include "dispatch.h"
+#include "packetbitbuf.h"
+#include "wirefields.h"
+
+#include <math.h>
+
+#include "google/protobuf/wire_format_lite.h"
+
+using google::protobuf::internal::WireFormatLite;
+
+CEntityDecoder::CEntityDecoder()
+{
+	m_nFields = 0;
+
+	for (int i = 0; i < MAX_EDICTS; i++)
+	{
+		m_entities[i].nClass = -1;
+		m_entities[i].nSerial = 0;
+
+		for (int j = 0; j < 2; j++)
+		{
+			m_clientBaselines[j][i].nClass = -1;
+			m_clientBaselines[j][i].nSerial = 0;
+		}
+	}
+
+	memset(m_frames, 0, sizeof(m_frames));
+	memset(m_pSaved, 0, sizeof(m_pSaved));
+	memset(m_bChanged, 0, sizeof(m_bChanged));
+	m_nFrames = 0;
+	m_nNewestFrame = 0;
+	m_nFrameTick = -1;
+}
+
+CEntityDecoder::~CEntityDecoder()
+{
+	ClearFrames();
+
+	for (size_t i = 0; i < m_freeFrameEntities.size(); i++)
+		delete m_freeFrameEntities[i];
+}
+
+void CEntityDecoder::Reset()
+{
+	// value blocks keep their capacity for the next map
+	for (int i = 0; i < MAX_EDICTS; i++)
+	{
+		m_entities[i].nClass = -1;
+		m_clientBaselines[0][i].nClass = -1;
+		m_clientBaselines[1][i].nClass = -1;
+	}
+
+	m_baselines.clear();
+	m_store.Reset();
+	ClearFrames();
+}
+
+void CEntityDecoder::SetBaseline(int nClass, const uint8* pData, int nSize)
+{
+	if (nClass < 0 || nClass >= SENDTABLE_MAX_CLASSES)
+		return;
+
+	if ((size_t)nClass >= m_baselines.size())
+		m_baselines.resize(nClass + 1);
+
+	if (nSize > 0)
+		m_baselines[nClass].assign((const char*)pData, nSize);
+	else
+		m_baselines[nClass].clear();
+}
+
+//-----------------------------------------------------------------------------
+// Field indices are deltas from the previous one. The "new way" encoding
+// spends one bit on the common +1 case and three bits on small gaps.
+//-----------------------------------------------------------------------------
+static inline int read_field_index(CBitRead& buf, int nLastIndex, bool bNewWay)
+{
+	if (bNewWay && buf.ReadOneBit())
+		return nLastIndex + 1;
+
+	int nDelta;
+	if (bNewWay && buf.ReadOneBit())
+	{
+		nDelta = buf.ReadUBitLong(3);
+	}
+	else
+	{
+		nDelta = buf.ReadUBitLong(7);
+		switch (nDelta & (32 | 64))
+		{
+		case 32:
+			nDelta = (nDelta & ~96) | (buf.ReadUBitLong(2) << 5);
+			break;
+		case 64:
+			nDelta = (nDelta & ~96) | (buf.ReadUBitLong(4) << 5);
+			break;
+		case 96:
+			nDelta = (nDelta & ~96) | (buf.ReadUBitLong(7) << 5);
+			break;
+		}
+	}
+
+	// end of the list
+	if (nDelta == 0xFFF)
+		return -1;
+
+	return nLastIndex + 1 + nDelta;
+}
+
+static inline float decode_float(CBitRead& buf, const send_prop_t& prop)
+{
+	switch (prop.nDecode)
+	{
+	case PROP_DECODE_COORD:
+		return buf.ReadBitCoord();
+	case PROP_DECODE_COORD_MP:
+		return buf.ReadBitCoordMP(kCW_None);
+	case PROP_DECODE_COORD_MP_LOWPRECISION:
+		return buf.ReadBitCoordMP(kCW_LowPrecision);
+	case PROP_DECODE_COORD_MP_INTEGRAL:
+		return buf.ReadBitCoordMP(kCW_Integral);
+	case PROP_DECODE_NOSCALE:
+		return buf.ReadBitFloat();
+	case PROP_DECODE_NORMAL:
+		return buf.ReadBitNormal();
+	case PROP_DECODE_CELL_COORD:
+		return buf.ReadBitCellCoord(prop.nBits, kCW_None);
+	case PROP_DECODE_CELL_COORD_LOWPRECISION:
+		return buf.ReadBitCellCoord(prop.nBits, kCW_LowPrecision);
+	case PROP_DECODE_CELL_COORD_INTEGRAL:
+		return buf.ReadBitCellCoord(prop.nBits, kCW_Integral);
+	}
+
+	if (!prop.nBits)
+		return prop.flLowValue;
+
+	// the engine's formula, to the last bit of float rounding
+	uint32 nInterp = buf.ReadUBitLong(prop.nBits);
+	float flValue = (float)nInterp / (float)((1ull << prop.nBits) - 1);
+	return prop.flLowValue + (prop.flHighValue - prop.flLowValue) * flValue;
+}
+
+// The components of a vector, in one bulk read where the encoding has one
+static inline void decode_floats(CBitRead& buf, const send_prop_t& prop, float* pValues, int nCount)
+{
+	switch (prop.nDecode)
+	{
+	case PROP_DECODE_COORD:
+		buf.ReadBitCoords(pValues, nCount);
+		return;
+	case PROP_DECODE_COORD_MP:
+		buf.ReadBitCoordMPs(pValues, nCount, kCW_None);
+		return;
+	case PROP_DECODE_COORD_MP_LOWPRECISION:
+		buf.ReadBitCoordMPs(pValues, nCount, kCW_LowPrecision);
+		return;
+	case PROP_DECODE_COORD_MP_INTEGRAL:
+		buf.ReadBitCoordMPs(pValues, nCount, kCW_Integral);
+		return;
+	case PROP_DECODE_NORMAL:
+		buf.ReadBitNormals(pValues, nCount);
+		return;
+	case PROP_DECODE_CELL_COORD:
+		buf.ReadBitCellCoords(pValues, nCount, prop.nBits, kCW_None);
+		return;
+	case PROP_DECODE_CELL_COORD_LOWPRECISION:
+		buf.ReadBitCellCoords(pValues, nCount, prop.nBits, kCW_LowPrecision);
+		return;
+	case PROP_DECODE_CELL_COORD_INTEGRAL:
+		buf.ReadBitCellCoords(pValues, nCount, prop.nBits, kCW_Integral);
+		return;
+	}
+
+	for (int i = 0; i < nCount; i++)
+		pValues[i] = decode_float(buf, prop);
+}
+
+static inline uint32 decode_int(CBitRead& buf, const send_prop_t& prop)
+{
+	switch (prop.nDecode)
+	{
+	case PROP_DECODE_VARINT:
+		return (uint32)buf.ReadSignedVarInt32();
+	case PROP_DECODE_UVARINT:
+		return buf.ReadVarInt32();
+	case PROP_DECODE_UINT:
+		return prop.nBits ? buf.ReadUBitLong(prop.nBits) : 0;
+	}
+
+	return prop.nBits ? (uint32)buf.ReadSBitLong(prop.nBits) : 0;
+}
+
+static inline int64 decode_int64(CBitRead& buf, const send_prop_t& prop)
+{
+	switch (prop.nDecode)
+	{
+	case PROP_DECODE_VARINT:
+		return buf.ReadSignedVarInt64();
+	case PROP_DECODE_UVARINT:
+		return (int64)buf.ReadVarInt64();
+	}
+
+	// 32 low bits first, then the rest; signed values lead with a sign bit
+	bool bNegative = false;
+	int nHighBits = prop.nBits - 32;
+
+	if (prop.nDecode == PROP_DECODE_INT)
+	{
+		bNegative = buf.ReadOneBit() != 0;
+		nHighBits--;
+	}
+
+	uint32 nLow = buf.ReadUBitLong(32);
+	uint32 nHigh = nHighBits > 0 ? buf.ReadUBitLong(nHighBits) : 0;
+
+	int64 nValue = (int64)(((uint64)nHigh << 32) | nLow);
+	return bNegative ? -nValue : nValue;
+}
+
+void CEntityDecoder::DecodeProp(CBitRead& buf, const send_prop_t* pProps, const send_prop_t& prop, uint8* pValue)
+{
+	switch (prop.nType)
+	{
+	case DPT_Int:
+	{
+		uint32 nValue = decode_int(buf, prop);
+		memcpy(pValue, &nValue, sizeof(nValue));
+	}
+	break;
+
+	case DPT_Float:
+	{
+		float flValue = decode_float(buf, prop);
+		memcpy(pValue, &flValue, sizeof(flValue));
+	}
+	break;
+
+	case DPT_Vector:
+	{
+		float v[3];
+		if (prop.nFlags & SPROP_NORMAL)
+		{
+			decode_floats(buf, prop, v, 2);
+
+			// z is whatever makes it unit length, only its sign is sent
+			bool bNegative = buf.ReadOneBit() != 0;
+			float flXYSqr = v[0] * v[0] + v[1] * v[1];
+			v[2] = flXYSqr < 1.0f ? sqrtf(1.0f - flXYSqr) : 0.0f;
+			if (bNegative)
+				v[2] = -v[2];
+		}
+		else
+			decode_floats(buf, prop, v, 3);
+
+		memcpy(pValue, v, sizeof(v));
+	}
+	break;
+
+	case DPT_VectorXY:
+	{
+		float v[2];
+		decode_floats(buf, prop, v, 2);
+		memcpy(pValue, v, sizeof(v));
+	}
+	break;
+
+	case DPT_String:
+	{
+		uint32 nLength = buf.ReadUBitLong(DT_MAX_STRING_BITS);
+		memcpy(pValue, &nLength, sizeof(nLength));
+		buf.ReadBytes(pValue + 4, nLength);
+	}
+	break;
+
+	case DPT_Array:
+	{
+		const send_prop_t& element = pProps[prop.nElementProp];
+		uint32 nElementSize = send_prop_value_size(element, NULL);
+
+		int nCountBits = 1;
+		for (int nMax = prop.nElements; nMax >>= 1; )
+			nCountBits++;
+
+		uint32 nCount = buf.ReadUBitLong(nCountBits);
+		uint32 nStored = nCount < prop.nElements ? nCount : prop.nElements;
+		memcpy(pValue, &nStored, sizeof(nStored));
+
+		for (uint32 i = 0; i < nCount && !buf.IsOverflowed(); i++)
+		{
+			uint8* pElement = i < nStored ? pValue + 4 + i * nElementSize : m_scratch;
+			DecodeProp(buf, pProps, element, pElement);
+		}
+	}
+	break;
+
+	case DPT_Int64:
+	{
+		int64 nValue = decode_int64(buf, prop);
+		memcpy(pValue, &nValue, sizeof(nValue));
+	}
+	break;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// One entity's changed props: the list of field indices, then their values in
+// the same order
+//-----------------------------------------------------------------------------
+bool CEntityDecoder::ReadEntity(CBitRead& buf, entity_t& entity)
+{
+	const server_class_t* pClass = m_tables.GetClass(entity.nClass);
+	if (!pClass)
+		return false;
+
+	bool bNewWay = buf.ReadOneBit() != 0;
+	int nCount = 0;
+
+	for (int nIndex = -1; ; )
+	{
+		nIndex = read_field_index(buf, nIndex, bNewWay);
+		if (nIndex < 0)
+			break;
+
+		// indices only go up, so this also bounds nCount
+		if (nIndex >= (int)pClass->nProps || buf.IsOverflowed())
+			return false;
+
+		m_fieldIndices[nCount++] = (uint16)nIndex;
+	}
+
+	const send_prop_t* pProps = m_tables.GetProps(*pClass);
+	uint8* pValues = entity.values.data();
+	m_nFields = nCount;
+
+	for (int i = 0; i < nCount; i++)
+	{
+		const send_prop_t& prop = pProps[m_fieldIndices[i]];
+		DecodeProp(buf, pProps, prop, pValues + prop.nValueOffset);
+	}
+
+	return !buf.IsOverflowed();
+}
+
+bool CEntityDecoder::EnterEntity(CBitRead& buf, int nIndex, int nBaseline)
+{
+	int nClass = buf.ReadUBitLong(m_tables.GetClassBits());
+	uint32 nSerial = buf.ReadUBitLong(NUM_NETWORKED_EHANDLE_SERIAL_NUMBER_BITS);
+
+	const server_class_t* pClass = m_tables.GetClass(nClass);
+	if (!pClass || buf.IsOverflowed())
+		return false;
+
+	entity_t& entity = m_entities[nIndex];
+	entity.nClass = nClass;
+	entity.nSerial = nSerial;
+
+	// a client baseline is the whole value block, the instance baseline only
+	// what the class sends
+	const entity_t& clientBaseline = m_clientBaselines[nBaseline][nIndex];
+	if (clientBaseline.nClass == nClass)
+	{
+		entity.values = clientBaseline.values;
+		return ReadEntity(buf, entity);
+	}
+
+	entity.values.assign(pClass->nValueSize, 0);
+
+	if ((size_t)nClass < m_baselines.size() && !m_baselines[nClass].empty())
+	{
+		const std::string& strBaseline = m_baselines[nClass];
+		CBitRead baseline(strBaseline.data(), (int)strBaseline.size());
+		ReadEntity(baseline, entity);
+	}
+
+	return ReadEntity(buf, entity);
+}
+
+//-----------------------------------------------------------------------------
+// Frames. Value blocks are reused through a free list like the store's
+// columns, so a frame allocates nothing once a session has warmed up.
+//-----------------------------------------------------------------------------
+CEntityDecoder::frame_entity_t* CEntityDecoder::AllocFrameEntity(const entity_t& entity)
+{
+	frame_entity_t* pEntity;
+	if (!m_freeFrameEntities.empty())
+	{
+		pEntity = m_freeFrameEntities.back();
+		m_freeFrameEntities.pop_back();
+	}
+	else
+		pEntity = new frame_entity_t;
+
+	pEntity->entity.nClass = entity.nClass;
+	pEntity->entity.nSerial = entity.nSerial;
+	pEntity->entity.values = entity.values;
+	pEntity->nRefs = 1;
+	return pEntity;
+}
+
+void CEntityDecoder::ReleaseFrameEntity(frame_entity_t* pEntity)
+{
+	if (pEntity && --pEntity->nRefs == 0)
+		m_freeFrameEntities.push_back(pEntity);
+}
+
+void CEntityDecoder::ClearFrames()
+{
+	for (int i = 0; i < m_nFrames; i++)
+	{
+		entity_frame_t& frame = m_frames[(m_nNewestFrame - i + ENTITY_MAX_FRAMES) % ENTITY_MAX_FRAMES];
+		for (int j = 0; j < MAX_EDICTS; j++)
+		{
+			ReleaseFrameEntity(frame.pEntities[j]);
+			frame.pEntities[j] = NULL;
+		}
+	}
+
+	for (int i = 0; i < MAX_EDICTS; i++)
+	{
+		ReleaseFrameEntity(m_pSaved[i]);
+		m_pSaved[i] = NULL;
+	}
+
+	// Reset frees every entity, which is what a NULL saved entity stands for
+	memset(m_bChanged, 0, sizeof(m_bChanged));
+	m_nFrames = 0;
+	m_nNewestFrame = 0;
+	m_nFrameTick = -1;
+}
+
+// Keeps the current state as the frame of nTick, replacing one of the same tick
+void CEntityDecoder::SaveFrame(int nTick)
+{
+	for (int i = 0; i < MAX_EDICTS; i++)
+	{
+		if (!m_bChanged[i])
+			continue;
+
+		m_bChanged[i] = false;
+		ReleaseFrameEntity(m_pSaved[i]);
+		m_pSaved[i] = m_entities[i].nClass >= 0 ? AllocFrameEntity(m_entities[i]) : NULL;
+	}
+
+	if (!m_nFrames || m_frames[m_nNewestFrame].nTick != nTick)
+	{
+		m_nNewestFrame = (m_nNewestFrame + 1) % ENTITY_MAX_FRAMES;
+		if (m_nFrames < ENTITY_MAX_FRAMES)
+			m_nFrames++;
+	}
+
+	// the frame being replaced mostly holds the same blocks already
+	entity_frame_t& frame = m_frames[m_nNewestFrame];
+	frame.nTick = nTick;
+	for (int i = 0; i < MAX_EDICTS; i++)
+	{
+		if (frame.pEntities[i] == m_pSaved[i])
+			continue;
+
+		ReleaseFrameEntity(frame.pEntities[i]);
+		frame.pEntities[i] = m_pSaved[i];
+		if (m_pSaved[i])
+			m_pSaved[i]->nRefs++;
+	}
+
+	m_nFrameTick = nTick;
+}
+
+// Puts the entities and the store back to the frame of nTick, false if it is gone
+bool CEntityDecoder::RestoreFrame(int nTick)
+{
+	const entity_frame_t* pFrame = NULL;
+	for (int i = 0; i < m_nFrames && !pFrame; i++)
+	{
+		const entity_frame_t& frame = m_frames[(m_nNewestFrame - i + ENTITY_MAX_FRAMES) % ENTITY_MAX_FRAMES];
+		if (frame.nTick == nTick)
+			pFrame = &frame;
+	}
+
+	if (!pFrame || !m_store.Restore(nTick))
+		return false;
+
+	for (int i = 0; i < MAX_EDICTS; i++)
+	{
+		frame_entity_t* pSaved = pFrame->pEntities[i];
+		if (!m_bChanged[i] && m_pSaved[i] == pSaved)
+			continue;
+
+		entity_t& entity = m_entities[i];
+		if (pSaved)
+		{
+			entity.nClass = pSaved->entity.nClass;
+			entity.nSerial = pSaved->entity.nSerial;
+			entity.values = pSaved->entity.values;
+			pSaved->nRefs++;
+		}
+		else
+			entity.nClass = -1;
+
+		ReleaseFrameEntity(m_pSaved[i]);
+		m_pSaved[i] = pSaved;
+		m_bChanged[i] = false;
+	}
+
+	m_nFrameTick = nTick;
+	return true;
+}
+
+bool CEntityDecoder::ReadPacketEntities(const CSVCMsg_PacketEntities& msg, int nTick, decode_stats_t& stats)
+{
+	const std::string& strData = msg.entity_data();
+	return ReadEntities((const uint8*)strData.data(), (int)strData.size(), msg.is_delta(),
+		msg.has_delta_from() ? msg.delta_from() : -1, msg.updated_entries(), msg.update_baseline(), msg.baseline(),
+		nTick, stats);
+}
+
+bool CEntityDecoder::ReadPacketEntities(const uint8* pData, int nSize, int nTick, decode_stats_t& stats)
+{
+	const uint8* p = pData;
+	const uint8* pEnd = pData + nSize;
+
+	uint64 nUpdates = 0;
+	uint64 nDelta = 0;
+	uint64 nDeltaFrom = (uint64)-1;
+	uint64 nUpdateBaseline = 0;
+	uint64 nBaseline = 0;
+	const uint8* pEntityData = NULL;
+	uint32 nEntityDataSize = 0;
+
+	while (p < pEnd)
+	{
+		uint64 nTag;
+		if (!wire_read_varint(p, pEnd, nTag))
+			return false;
+
+		uint32 nField = (uint32)(nTag >> 3);
+		int nWireType = (int)(nTag & 7);
+
+		if (nField == CSVCMsg_PacketEntities::kUpdatedEntriesFieldNumber && nWireType == WireFormatLite::WIRETYPE_VARINT)
+		{
+			if (!wire_read_varint(p, pEnd, nUpdates))
+				return false;
+		}
+		else if (nField == CSVCMsg_PacketEntities::kIsDeltaFieldNumber && nWireType == WireFormatLite::WIRETYPE_VARINT)
+		{
+			if (!wire_read_varint(p, pEnd, nDelta))
+				return false;
+		}
+		else if (nField == CSVCMsg_PacketEntities::kDeltaFromFieldNumber && nWireType == WireFormatLite::WIRETYPE_VARINT)
+		{
+			if (!wire_read_varint(p, pEnd, nDeltaFrom))
+				return false;
+		}
+		else if (nField == CSVCMsg_PacketEntities::kUpdateBaselineFieldNumber && nWireType == WireFormatLite::WIRETYPE_VARINT)
+		{
+			if (!wire_read_varint(p, pEnd, nUpdateBaseline))
+				return false;
+		}
+		else if (nField == CSVCMsg_PacketEntities::kBaselineFieldNumber && nWireType == WireFormatLite::WIRETYPE_VARINT)
+		{
+			if (!wire_read_varint(p, pEnd, nBaseline))
+				return false;
+		}
+		else if (nField == CSVCMsg_PacketEntities::kEntityDataFieldNumber && nWireType == WireFormatLite::WIRETYPE_LENGTH_DELIMITED)
+		{
+			if (!wire_read_bytes(p, pEnd, pEntityData, nEntityDataSize))
+				return false;
+		}
+		else if (!wire_skip_field(p, pEnd, nWireType))
+			return false;
+	}
+
+	return ReadEntities(pEntityData, (int)nEntityDataSize, nDelta != 0, (int32)nDeltaFrom, (int32)nUpdates,
+		nUpdateBaseline != 0, (int32)nBaseline, nTick, stats);
+}
+
+bool CEntityDecoder::ReadEntities(const uint8* pData, int nSize, bool bDelta, int nDeltaFrom, int nUpdates,
+	bool bUpdateBaseline, int nBaseline, int nTick, decode_stats_t& stats)
+{
+	// frames start with a full update; before it, or without ticks, the
+	// current state is all there is
+	bool bFrames = nTick >= 0 && (m_nFrames || !bDelta);
+
+	bool bOk = true;
+	if (bFrames && bDelta && nDeltaFrom >= 0 && nDeltaFrom != m_nFrameTick)
+		bOk = RestoreFrame(nDeltaFrom);
+
+	if (bOk)
+	{
+		m_nFrameTick = -1;
+		bOk = ReadEntityData(pData, nSize, bDelta, nUpdates, bUpdateBaseline, nBaseline, stats);
+	}
+
+	// a frame that didn't decode is missing, like one that never arrived
+	if (bOk && bFrames)
+		SaveFrame(nTick);
+
+	// whatever did decode is the state at this tick
+	if (nTick >= 0)
+		m_store.Snapshot(nTick);
+
+	return bOk;
+}
+
+bool CEntityDecoder::ReadEntityData(const uint8* pData, int nSize, bool bDelta, int nUpdates, bool bUpdateBaseline, int nBaseline, decode_stats_t& stats)
+{
+	if (nBaseline != 0 && nBaseline != 1)
+		return false;
+
+	CBitRead buf(pData, nSize);
+
+	// the other slot becomes this one plus the entities entering now
+	entity_t* pNewBaselines = m_clientBaselines[1 - nBaseline];
+	if (bUpdateBaseline)
+	{
+		const entity_t* pBaselines = m_clientBaselines[nBaseline];
+		for (int i = 0; i < MAX_EDICTS; i++)
+		{
+			pNewBaselines[i].nClass = pBaselines[i].nClass;
+			if (pBaselines[i].nClass >= 0)
+				pNewBaselines[i].values = pBaselines[i].values;
+		}
+	}
+
+	// a full update lists every entity there is
+	if (!bDelta)
+	{
+		for (int i = 0; i < MAX_EDICTS; i++)
+		{
+			if (m_entities[i].nClass >= 0)
+				m_bChanged[i] = true;
+			m_entities[i].nClass = -1;
+		}
+		m_store.RemoveAll();
+	}
+
+	int nIndex = -1;
+
+	for (int i = 0; i < nUpdates; i++)
+	{
+		// the gap can be up to 32 bits
+		uint32 nSkip = buf.ReadUBitVar();
+		if (nSkip >= MAX_EDICTS)
+			return false;
+
+		nIndex += 1 + nSkip;
+		if (nIndex >= MAX_EDICTS || buf.IsOverflowed())
+			return false;
+
+		if (buf.ReadOneBit())
+		{
+			// leaves the PVS; deleted or not, there is nothing left to track
+			buf.ReadOneBit();
+			if (!bDelta)
+				return false;
+
+			m_entities[nIndex].nClass = -1;
+			m_bChanged[nIndex] = true;
+			m_store.Remove(nIndex);
+			continue;
+		}
+
+		// marked first, a failed read may have written part of it
+		m_bChanged[nIndex] = true;
+
+		bool bEnter = buf.ReadOneBit() != 0;
+		if (bEnter)
+		{
+			if (!EnterEntity(buf, nIndex, nBaseline))
+				return false;
+
+			if (bUpdateBaseline)
+			{
+				pNewBaselines[nIndex].nClass = m_entities[nIndex].nClass;
+				pNewBaselines[nIndex].values = m_entities[nIndex].values;
+			}
+		}
+		else
+		{
+			// a delta for an entity we never saw enter, the rest can't be read
+			entity_t& entity = m_entities[nIndex];
+			if (entity.nClass < 0 || !ReadEntity(buf, entity))
+				return false;
+		}
+
+		// the update's own fields, not its baseline's
+		m_store.Update(nIndex, m_entities[nIndex], m_tables, m_fieldIndices, m_nFields, bEnter);
+		stats.nEntityUpdates++;
+	}
+
+	return !buf.IsOverflowed();
+}
+
+//-----------------------------------------------------------------------------
+// Sessions
+//-----------------------------------------------------------------------------
+CEntityTracker::CEntityTracker()
+{
+	memset(m_pSessions, 0, sizeof(m_pSessions));
+	m_nClock = 0;
+}
+
+CEntityTracker::~CEntityTracker()
+{
+	for (int i = 0; i < ENTITY_MAX_SESSIONS; i++)
+		delete m_pSessions[i];
+}
+
+CEntityTracker::session_t* CEntityTracker::GetSession(const udp_frame_t& frame, bool bCreate, bool bEvictLive)
+{
+	session_t* pOldest = NULL;
+	int nFree = -1;
+
+	for (int i = 0; i < ENTITY_MAX_SESSIONS; i++)
+	{
+		session_t* pSession = m_pSessions[i];
+		if (!pSession)
+		{
+			if (nFree < 0)
+				nFree = i;
+			continue;
+		}
+
+		if (pSession->nSrcAddr == frame.nSrcAddr && pSession->nDstAddr == frame.nDstAddr &&
+			pSession->nSrcPort == frame.nSrcPort && pSession->nDstPort == frame.nDstPort)
+		{
+			pSession->nLastUsed = ++m_nClock;
+			pSession->nLastSeenUs = frame.nTimestampUs;
+			return pSession;
+		}
+
+		if (!pOldest || pSession->nLastUsed < pOldest->nLastUsed)
+			pOldest = pSession;
+	}
+
+	if (!bCreate)
+		return NULL;
+
+	session_t* pSession = pOldest;
+	if (nFree >= 0)
+		pSession = m_pSessions[nFree] = new session_t;
+	else if (!bEvictLive && frame.nTimestampUs < pOldest->nLastSeenUs + ENTITY_SESSION_IDLE_US)
+		return NULL;
+
+	pSession->nSrcAddr = frame.nSrcAddr;
+	pSession->nDstAddr = frame.nDstAddr;
+	pSession->nSrcPort = frame.nSrcPort;
+	pSession->nDstPort = frame.nDstPort;
+	pSession->nLastUsed = ++m_nClock;
+	pSession->nLastSeenUs = frame.nTimestampUs;
+	pSession->bKey = false;
+	pSession->bCachedTables = false;
+	pSession->nTick = -1;
+	pSession->sendTables.clear();
+	pSession->decoder.Reset();
+	pSession->decoder.GetTables().Clear();
+	pSession->stringTables.Clear();
+	pSession->gameEvents.Clear();
+	return pSession;
+}
+
+CEntityDecoder* CEntityTracker::FindSession(const udp_frame_t& frame)
+{
+	session_t* pSession = GetSession(frame, false);
+	return pSession ? &pSession->decoder : NULL;
+}
+
+const CStringTables* CEntityTracker::FindStringTables(const udp_frame_t& frame)
+{
+	session_t* pSession = GetSession(frame, false);
+	return pSession ? &pSession->stringTables : NULL;
+}
+
+const CGameEventLayouts* CEntityTracker::FindGameEvents(const udp_frame_t& frame)
+{
+	session_t* pSession = GetSession(frame, false);
+	return pSession ? &pSession->gameEvents : NULL;
+}
+
+void CEntityTracker::OnServerInfo(const udp_frame_t& frame, const CSVCMsg_ServerInfo& msg, decode_stats_t& stats)
+{
+	// new map, the tables follow
+	session_t* pSession = GetSession(frame, true);
+	pSession->sendTables.clear();
+	pSession->decoder.Reset();
+	pSession->decoder.GetTables().Clear();
+	pSession->stringTables.Clear();
+	pSession->gameEvents.Clear();
+
+	pSession->key.nClientCrc = msg.client_crc();
+	pSession->key.nProtocol = msg.protocol();
+	pSession->key.nMaxClasses = msg.max_classes();
+	pSession->bKey = true;
+
+	pSession->bCachedTables = g_sendTableCache.Load(pSession->key, pSession->decoder.GetTables());
+	if (pSession->bCachedTables)
+		stats.nEntityTablesCached++;
+}
+
+void CEntityTracker::OnSendTable(const udp_frame_t& frame, const CSVCMsg_SendTable& msg)
+{
+	if (msg.is_end())
+		return;
+
+	session_t* pSession = GetSession(frame, true);
+	if (!pSession->bCachedTables && pSession->sendTables.size() < ENTITY_MAX_SEND_TABLES)
+		pSession->sendTables.push_back(msg);
+}
+
+void CEntityTracker::OnClassInfo(const udp_frame_t& frame, const CSVCMsg_ClassInfo& msg, decode_stats_t& stats)
+{
+	session_t* pSession = GetSession(frame, true);
+
+	// create_on_client means the client builds the tables from its own
+	// binaries, none were sent
+	if (pSession->bCachedTables || msg.create_on_client() || pSession->sendTables.empty())
+		return;
+
+	CSendTables& tables = pSession->decoder.GetTables();
+	if (tables.Build(pSession->sendTables, msg))
+	{
+		stats.nEntityTableBuilds++;
+		if (pSession->bKey)
+			g_sendTableCache.Store(pSession->key, tables);
+	}
+	else
+		stats.nEntityErrors++;
+
+	// only the flattened lists are needed from here on
+	std::vector<CSVCMsg_SendTable>().swap(pSession->sendTables);
+}
+
+void CEntityTracker::OnPacketEntities(const udp_frame_t& frame, const uint8* pData, int nSize, decode_stats_t& stats)
+{
+	session_t* pSession = GetSession(frame, false);
+
+	// joined mid-match, the tables of the last signon we saw are the best bet,
+	// but not at the cost of a session that is still building up state
+	if (!pSession && g_sendTableCache.HasLayout())
+	{
+		pSession = GetSession(frame, true, false);
+		if (!pSession)
+		{
+			stats.nEntityUntracked++;
+			return;
+		}
+
+		if (g_sendTableCache.LoadLatest(pSession->decoder.GetTables()))
+			stats.nEntityTablesCached++;
+	}
+
+	if (!pSession || !pSession->decoder.GetTables().IsReady())
+	{
+		stats.nEntityNoTables++;
+		return;
+	}
+
+	stats.nEntityPackets++;
+	if (!pSession->decoder.ReadPacketEntities(pData, nSize, pSession->nTick, stats))
+		stats.nEntityErrors++;
+}
+
+void CEntityTracker::OnTick(const udp_frame_t& frame, const CNETMsg_Tick& msg)
+{
+	// ticks alone don't make a session worth tracking
+	session_t* pSession = GetSession(frame, false);
+	if (pSession)
+		pSession->nTick = (int)msg.tick();
+}
+
+void CEntityTracker::OnCreateStringTable(const udp_frame_t& frame, const CSVCMsg_CreateStringTable& msg, decode_stats_t& stats)
+{
+	session_t* pSession = GetSession(frame, true);
+	bool bDecoded = pSession->stringTables.Create(msg);
+	OnStringTableChanged(*pSession, bDecoded, stats);
+}
+
+void CEntityTracker::OnUpdateStringTable(const udp_frame_t& frame, const uint8* pData, int nSize, decode_stats_t& stats)
+{
+	// an update to a table we never saw created can't be applied
+	session_t* pSession = GetSession(frame, false);
+	if (!pSession)
+		return;
+
+	bool bDecoded = pSession->stringTables.Update(pData, nSize);
+	OnStringTableChanged(*pSession, bDecoded, stats);
+}
+
+// Instance baselines arrive as string table entries named by class id
+void CEntityTracker::OnStringTableChanged(session_t& session, bool bDecoded, decode_stats_t& stats)
+{
+	const CStringTables& stringTables = session.stringTables;
+	const std::vector<int>& changed = stringTables.GetChanged();
+
+	stats.nStringTableUpdates++;
+	stats.nStringTableEntries += changed.size();
+	if (!bDecoded)
+		stats.nStringTableErrors++;
+
+	const string_table_t* pTable = stringTables.GetTable(stringTables.GetChangedTable());
+	if (!pTable || pTable->strName != "instancebaseline")
+		return;
+
+	// an entry that lost its data drops the baseline
+	for (size_t i = 0; i < changed.size(); i++)
+	{
+		const string_table_entry_t& entry = pTable->entries[changed[i]];
+		session.decoder.SetBaseline(atoi(entry.pszString), entry.pUserData, (int)entry.nUserDataSize);
+	}
+}
+
+void CEntityTracker::OnGameEventList(const udp_frame_t& frame, const CSVCMsg_GameEventList& msg, decode_stats_t& stats)
+{
+	session_t* pSession = GetSession(frame, true);
+
+	stats.nGameEventLists++;
+	if (!pSession->gameEvents.Compile(msg))
+		stats.nGameEventErrors++;
+}
+
+const game_event_t* CEntityTracker::OnGameEvent(const udp_frame_t& frame, const uint8* pData, int nSize, decode_stats_t& stats)
+{
+	session_t* pSession = GetSession(frame, false);
+	if (!pSession || !pSession->gameEvents.IsReady())
+	{
+		stats.nGameEventsNoList++;
+		return NULL;
+	}
+
+	if (!pSession->gameEvents.Decode(pData, nSize, m_event))
+	{
+		if (m_event.pLayout)
+			stats.nGameEventErrors++;
+		else
+			stats.nGameEventsNoList++;
+		return NULL;
+	}
+
+	stats.nGameEvents++;
+	return &m_event;
+}
+
+//-----------------------------------------------------------------------------
+// Dispatcher glue, entity state lives in the decoder that got the message
+//-----------------------------------------------------------------------------
+static void on_tick(const CNETMsg_Tick& msg, int /*nSize*/, const message_source_t& source, void* /*pContext*/)
+{
+	source.pDecoder->GetEntityTracker().OnTick(*source.pFrame, msg);
+}
+
+static void on_server_info(const CSVCMsg_ServerInfo& msg, int /*nSize*/, const message_source_t& source, void* /*pContext*/)
+{
+	source.pDecoder->GetEntityTracker().OnServerInfo(*source.pFrame, msg, source.pDecoder->m_stats);
+}
+
+static void on_send_table(const CSVCMsg_SendTable& msg, int /*nSize*/, const message_source_t& source, void* /*pContext*/)
+{
+	source.pDecoder->GetEntityTracker().OnSendTable(*source.pFrame, msg);
+}
+
+static void on_class_info(const CSVCMsg_ClassInfo& msg, int /*nSize*/, const message_source_t& source, void* /*pContext*/)
+{
+	source.pDecoder->GetEntityTracker().OnClassInfo(*source.pFrame, msg, source.pDecoder->m_stats);
+}
+
+// Raw, so entity_data is decoded in the packet rather than copied out by a parse
+static void on_packet_entities(int /*nCmd*/, const uint8* pData, int nSize, const message_source_t& source, void* /*pContext*/)
+{
+	source.pDecoder->GetEntityTracker().OnPacketEntities(*source.pFrame, pData, nSize, source.pDecoder->m_stats);
+}
+
+static void on_create_string_table(const CSVCMsg_CreateStringTable& msg, int /*nSize*/, const message_source_t& source, void* /*pContext*/)
+{
+	source.pDecoder->GetEntityTracker().OnCreateStringTable(*source.pFrame, msg, source.pDecoder->m_stats);
+}
+
+static void on_update_string_table(int /*nCmd*/, const uint8* pData, int nSize, const message_source_t& source, void* /*pContext*/)
+{
+	source.pDecoder->GetEntityTracker().OnUpdateStringTable(*source.pFrame, pData, nSize, source.pDecoder->m_stats);
+}
+
+void add_entity_handlers(CMessageDispatcher& dispatcher)
+{
+	dispatcher.Subscribe(on_tick);
+	dispatcher.Subscribe(on_server_info);
+	dispatcher.Subscribe(on_send_table);
+	dispatcher.Subscribe(on_class_info);
+	dispatcher.Subscribe(on_create_string_table);
+	dispatcher.SubscribeRaw(svc_UpdateStringTable, on_update_string_table);
+	dispatcher.SubscribeRaw(svc_PacketEntities, on_packet_entities);
+}
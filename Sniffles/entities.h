@@ -0,0 +1,246 @@
+#pragma once
+
+#include <vector>
+
+#include "platform.h"
+#include "frame.h"
+#include "stats.h"
+#include "sendtable.h"
+#include "tablecache.h"
+#include "entitystore.h"
+#include "stringtable.h"
+#include "gameevents.h"
+
+class CBitRead;
+class CMessageDispatcher;
+
+#define ENTITY_MAX_SESSIONS		64		// sessions per decoder with entity state, a full server's players
+#define ENTITY_SESSION_IDLE_US	(30 * 1000000ull)	// a session quiet this long may make room for a new one
+#define ENTITY_MAX_SEND_TABLES	4096	// svc_SendTable messages kept per signon
+#define ENTITY_MAX_FRAMES		ENTITY_MAX_SNAPSHOTS	// ticks of entity values kept for delta_from, one per snapshot
+
+struct entity_t
+{
+	int					nClass;		// -1 while the slot is free
+	uint32				nSerial;
+	std::vector<uint8>	values;		// server_class_t::nValueSize bytes, laid out by send_prop_t::nValueOffset
+};
+
+// Values of an entity's props, straight out of its value block
+static inline int32 entity_int(const entity_t& entity, const send_prop_t& prop)
+{
+	int32 nValue;
+	memcpy(&nValue, &entity.values[prop.nValueOffset], sizeof(nValue));
+	return nValue;
+}
+
+static inline int64 entity_int64(const entity_t& entity, const send_prop_t& prop)
+{
+	int64 nValue;
+	memcpy(&nValue, &entity.values[prop.nValueOffset], sizeof(nValue));
+	return nValue;
+}
+
+static inline float entity_float(const entity_t& entity, const send_prop_t& prop)
+{
+	float flValue;
+	memcpy(&flValue, &entity.values[prop.nValueOffset], sizeof(flValue));
+	return flValue;
+}
+
+// x, y and for DPT_Vector z
+static inline void entity_vector(const entity_t& entity, const send_prop_t& prop, float* pOut)
+{
+	memcpy(pOut, &entity.values[prop.nValueOffset], prop.nType == DPT_Vector ? 12 : 8);
+}
+
+// Not terminated, nLength bytes
+static inline const char* entity_string(const entity_t& entity, const send_prop_t& prop, uint32& nLength)
+{
+	memcpy(&nLength, &entity.values[prop.nValueOffset], sizeof(nLength));
+	return (const char*)&entity.values[prop.nValueOffset + 4];
+}
+
+//-----------------------------------------------------------------------------
+// The entities of one session. svc_PacketEntities updates are decoded against
+// the session's flattened prop lists into each entity's value block: a prop
+// never sent keeps its baseline value, or zero without a baseline.
+//
+// The server deltas against the last frame the client acked, not the last
+// one it sent. Like a client, the decoder keeps the entities of the last
+// ENTITY_MAX_FRAMES ticks and applies each delta to its delta_from frame;
+// a delta whose frame we don't have is an error. An entity a frame didn't
+// change shares its value block with the frame before. Until the first full
+// update, or without a tick, deltas are applied to the current state.
+//
+// Like a client, the decoder keeps two baseline slots. An entity entering
+// starts from its value block in the slot the update's baseline names, or
+// from its class's instance baseline when that slot has none for its class.
+// An update with update_baseline copies that slot to the other one and
+// stores the entities entering in it.
+//-----------------------------------------------------------------------------
+class CEntityDecoder
+{
+public:
+	CEntityDecoder();
+	~CEntityDecoder();
+
+	CSendTables&		GetTables() { return m_tables; }
+	const CSendTables&	GetTables() const { return m_tables; }
+
+	// Frees every entity and forgets the baselines, for a new signon
+	void			Reset();
+
+	// False when the update was malformed or referred to state we don't have.
+	// Entities decoded before the error keep their new values. nTick is that
+	// of the packet's net_Tick, -1 if unknown; with one, the state is kept as
+	// that tick's frame and the store takes a snapshot at it.
+	bool			ReadPacketEntities(const CSVCMsg_PacketEntities& msg, int nTick, decode_stats_t& stats);
+
+	// The same from the serialized message, which is walked in place:
+	// entity_data is decoded where it is, and nothing is parsed or copied
+	bool			ReadPacketEntities(const uint8* pData, int nSize, int nTick, decode_stats_t& stats);
+
+	// Instance baseline of a class: a field list and values in the same
+	// encoding as an update, applied to entities of the class as they enter.
+	// nSize 0 drops it.
+	void			SetBaseline(int nClass, const uint8* pData, int nSize);
+
+	// NULL for a free slot
+	const entity_t*	GetEntity(int nIndex) const
+	{
+		return (uint32)nIndex < MAX_EDICTS && m_entities[nIndex].nClass >= 0 ? &m_entities[nIndex] : NULL;
+	}
+
+	// Hot props of every entity, and their recent history
+	CEntityStore&		GetStore() { return m_store; }
+	const CEntityStore&	GetStore() const { return m_store; }
+
+private:
+	CEntityDecoder(const CEntityDecoder&);
+	CEntityDecoder& operator=(const CEntityDecoder&);
+
+	// An entity as frames keep it, shared by every frame it didn't change in
+	struct frame_entity_t
+	{
+		entity_t		entity;
+		int				nRefs;
+	};
+
+	struct entity_frame_t
+	{
+		int				nTick;
+		frame_entity_t*	pEntities[MAX_EDICTS];	// NULL for a free slot
+	};
+
+	bool			ReadEntities(const uint8* pData, int nSize, bool bDelta, int nDeltaFrom, int nUpdates,
+						bool bUpdateBaseline, int nBaseline, int nTick, decode_stats_t& stats);
+	bool			ReadEntityData(const uint8* pData, int nSize, bool bDelta, int nUpdates, bool bUpdateBaseline, int nBaseline, decode_stats_t& stats);
+	bool			EnterEntity(CBitRead& buf, int nIndex, int nBaseline);
+	bool			ReadEntity(CBitRead& buf, entity_t& entity);
+	void			DecodeProp(CBitRead& buf, const send_prop_t* pProps, const send_prop_t& prop, uint8* pValue);
+
+	frame_entity_t*	AllocFrameEntity(const entity_t& entity);
+	void			ReleaseFrameEntity(frame_entity_t* pEntity);
+	void			SaveFrame(int nTick);
+	bool			RestoreFrame(int nTick);
+	void			ClearFrames();
+
+	CSendTables				m_tables;
+	entity_t				m_entities[MAX_EDICTS];
+	CEntityStore			m_store;
+	std::vector<std::string>	m_baselines;	// by class id, empty when there is none
+	entity_t				m_clientBaselines[2][MAX_EDICTS];	// by entity index, nClass -1 when there is none
+
+	entity_frame_t			m_frames[ENTITY_MAX_FRAMES];	// ring, m_nNewestFrame is the latest
+	int						m_nFrames;
+	int						m_nNewestFrame;
+	frame_entity_t*			m_pSaved[MAX_EDICTS];	// what m_entities held at m_nFrameTick
+	bool					m_bChanged[MAX_EDICTS];	// written since
+	int						m_nFrameTick;			// -1 when m_entities is no frame's
+	std::vector<frame_entity_t*>	m_freeFrameEntities;
+
+	// field indices of the entity being read, m_nFields of them
+	uint16					m_fieldIndices[SENDTABLE_MAX_PROPS];
+	int						m_nFields;
+
+	// array elements past the prop's nElements are decoded into here
+	uint8					m_scratch[4 + DT_MAX_STRING_BUFFERSIZE];
+};
+
+//-----------------------------------------------------------------------------
+// Entity state for the sessions one decoder sees. A session's prop lists are
+// built when its svc_ClassInfo arrives, from the svc_SendTable messages sent
+// before it, and svc_ServerInfo starts over for a new map. At most
+// ENTITY_MAX_SESSIONS sessions are tracked. A signon makes room for its
+// session by dropping the least recently updated one; a session first seen
+// mid-match only takes a free slot or one idle for ENTITY_SESSION_IDLE_US,
+// and its packets are counted as untracked otherwise. Each
+// svc_PacketEntities ends with a snapshot of the session's CEntityStore at
+// the tick of the packet's net_Tick.
+//
+// With g_sendTableCache open, a signon whose layout is cached skips the
+// build, freshly built layouts are stored, and a session first seen mid-match
+// uses the layout stored last.
+//-----------------------------------------------------------------------------
+class CEntityTracker
+{
+public:
+	CEntityTracker();
+	~CEntityTracker();
+
+	void			OnServerInfo(const udp_frame_t& frame, const CSVCMsg_ServerInfo& msg, decode_stats_t& stats);
+	void			OnSendTable(const udp_frame_t& frame, const CSVCMsg_SendTable& msg);
+	void			OnClassInfo(const udp_frame_t& frame, const CSVCMsg_ClassInfo& msg, decode_stats_t& stats);
+	void			OnPacketEntities(const udp_frame_t& frame, const uint8* pData, int nSize, decode_stats_t& stats);
+	void			OnTick(const udp_frame_t& frame, const CNETMsg_Tick& msg);
+	void			OnCreateStringTable(const udp_frame_t& frame, const CSVCMsg_CreateStringTable& msg, decode_stats_t& stats);
+	void			OnUpdateStringTable(const udp_frame_t& frame, const uint8* pData, int nSize, decode_stats_t& stats);
+	void			OnGameEventList(const udp_frame_t& frame, const CSVCMsg_GameEventList& msg, decode_stats_t& stats);
+
+	// Decodes a serialized svc_GameEvent against the session's layouts. The
+	// event is overwritten by the next one; NULL if it didn't decode.
+	const game_event_t*	OnGameEvent(const udp_frame_t& frame, const uint8* pData, int nSize, decode_stats_t& stats);
+
+	// Entity state of the session frame belongs to, NULL if there is none
+	CEntityDecoder*	FindSession(const udp_frame_t& frame);
+	const CStringTables*	FindStringTables(const udp_frame_t& frame);
+	const CGameEventLayouts*	FindGameEvents(const udp_frame_t& frame);
+
+private:
+	CEntityTracker(const CEntityTracker&);
+	CEntityTracker& operator=(const CEntityTracker&);
+
+	struct session_t
+	{
+		uint32			nSrcAddr;
+		uint32			nDstAddr;
+		uint16			nSrcPort;
+		uint16			nDstPort;
+		uint64			nLastUsed;
+		uint64			nLastSeenUs;	// capture time of its last message
+		send_table_key_t	key;		// from svc_ServerInfo
+		bool			bKey;			// false for a session joined mid-match
+		bool			bCachedTables;	// the signon's tables needn't be built
+		int				nTick;			// of the last net_Tick, -1 before the first
+		std::vector<CSVCMsg_SendTable>	sendTables;	// since the last svc_ServerInfo
+		CEntityDecoder	decoder;
+		CStringTables	stringTables;
+		CGameEventLayouts	gameEvents;
+	};
+
+	// With bCreate, a session not tracked yet takes a free slot, or else the
+	// least recently updated one's; unless bEvictLive, only if that is idle
+	session_t*		GetSession(const udp_frame_t& frame, bool bCreate, bool bEvictLive = true);
+	void			OnStringTableChanged(session_t& session, bool bDecoded, decode_stats_t& stats);
+
+	session_t*		m_pSessions[ENTITY_MAX_SESSIONS];	// allocated on first use
+	uint64			m_nClock;
+
+	game_event_t	m_event;	// the last one OnGameEvent decoded
+};
+
+// Feeds net_Tick, svc_ServerInfo, svc_SendTable, svc_ClassInfo,
+// svc_CreateStringTable, svc_UpdateStringTable and svc_PacketEntities to the
+// entity tracker of the decoder that received them
+void add_entity_handlers(CMessageDispatcher& dispatcher);
@@ -0,0 +1,379 @@
+#include "entitystore.h"
+#include "entities.h"
+
+#include <algorithm>
+
+// Props behind the columns, by name. A column is filled by the first prop
+// listed that a class has, so players get eye angles rather than their
+// model's rotation.
+//
+// Props named with their table are copies of the same value, and share their
+// columns: a CS player's origin is sent in DT_CSLocalPlayerExclusive to its
+// own client and in DT_CSNonLocalPlayerExclusive to everyone else. The copy
+// an update decoded is the one written. An entity entering without either
+// takes the first one listed its class has.
+struct hot_prop_source_t
+{
+	const char*	pszName;
+	const char*	pszTable;		// NULL for a prop of any table
+	int			nColumn;
+	int			nLastColumn;	// of the group it may fill
+};
+
+static const hot_prop_source_t s_hotPropSources[] =
+{
+	{ "m_vecOrigin",		"DT_CSNonLocalPlayerExclusive",	ENTITY_COLUMN_ORIGIN_X,	ENTITY_COLUMN_ORIGIN_Z },
+	{ "m_vecOrigin[2]",		"DT_CSNonLocalPlayerExclusive",	ENTITY_COLUMN_ORIGIN_Z,	ENTITY_COLUMN_ORIGIN_Z },
+	{ "m_vecOrigin",		"DT_CSLocalPlayerExclusive",	ENTITY_COLUMN_ORIGIN_X,	ENTITY_COLUMN_ORIGIN_Z },
+	{ "m_vecOrigin[2]",		"DT_CSLocalPlayerExclusive",	ENTITY_COLUMN_ORIGIN_Z,	ENTITY_COLUMN_ORIGIN_Z },
+	{ "m_vecOrigin",		NULL,	ENTITY_COLUMN_ORIGIN_X,	ENTITY_COLUMN_ORIGIN_Z },
+	{ "m_vecOrigin[2]",		NULL,	ENTITY_COLUMN_ORIGIN_Z,	ENTITY_COLUMN_ORIGIN_Z },	// players send z on its own
+	{ "m_angEyeAngles",		NULL,	ENTITY_COLUMN_PITCH,	ENTITY_COLUMN_ROLL },
+	{ "m_angEyeAngles[0]",	NULL,	ENTITY_COLUMN_PITCH,	ENTITY_COLUMN_PITCH },
+	{ "m_angEyeAngles[1]",	NULL,	ENTITY_COLUMN_YAW,		ENTITY_COLUMN_YAW },
+	{ "m_angRotation",		NULL,	ENTITY_COLUMN_PITCH,	ENTITY_COLUMN_ROLL },
+	{ "m_iHealth",			NULL,	ENTITY_COLUMN_HEALTH,	ENTITY_COLUMN_HEALTH },
+	{ "m_iTeamNum",			NULL,	ENTITY_COLUMN_TEAM,		ENTITY_COLUMN_TEAM },
+};
+
+static inline bool is_int_column(int nColumn)
+{
+	return nColumn == ENTITY_COLUMN_CLASS || nColumn == ENTITY_COLUMN_HEALTH || nColumn == ENTITY_COLUMN_TEAM;
+}
+
+CEntityStore::CEntityStore()
+{
+	for (int i = 0; i < ENTITY_COLUMNS; i++)
+		m_live.pColumns[i] = AllocColumn();
+
+	m_nSnapshots = 0;
+	m_nNewest = 0;
+	m_nTablesGeneration = 0;
+	m_bResolved = false;
+
+	ClearLive();
+}
+
+CEntityStore::~CEntityStore()
+{
+	for (size_t i = 0; i < m_allColumns.size(); i++)
+		free(m_allColumns[i]);
+}
+
+entity_column_t* CEntityStore::AllocColumn()
+{
+	entity_column_t* pColumn;
+	if (!m_freeColumns.empty())
+	{
+		pColumn = m_freeColumns.back();
+		m_freeColumns.pop_back();
+	}
+	else
+	{
+		// at most one per column for the live state and every snapshot
+		pColumn = (entity_column_t*)malloc(sizeof(entity_column_t));
+		m_allColumns.push_back(pColumn);
+	}
+
+	pColumn->nRefs = 1;
+	return pColumn;
+}
+
+void CEntityStore::ReleaseColumn(entity_column_t* pColumn)
+{
+	if (--pColumn->nRefs == 0)
+		m_freeColumns.push_back(pColumn);
+}
+
+// The live column, copied first if a snapshot still shares it
+entity_column_t* CEntityStore::WriteColumn(int nColumn)
+{
+	entity_column_t* pColumn = m_live.pColumns[nColumn];
+	if (pColumn->nRefs == 1)
+		return pColumn;
+
+	entity_column_t* pCopy = AllocColumn();
+	memcpy(pCopy->nValues, pColumn->nValues, sizeof(pCopy->nValues));
+	ReleaseColumn(pColumn);
+
+	m_live.pColumns[nColumn] = pCopy;
+	return pCopy;
+}
+
+void CEntityStore::ClearLive()
+{
+	for (int i = 0; i < ENTITY_COLUMNS; i++)
+	{
+		entity_column_t* pColumn = WriteColumn(i);
+		if (i == ENTITY_COLUMN_CLASS)
+			memset(pColumn->nValues, 0xFF, sizeof(pColumn->nValues));
+		else
+			memset(pColumn->nValues, 0, sizeof(pColumn->nValues));
+	}
+
+	m_live.nTick = -1;
+	memset(m_live.nDirty, 0, sizeof(m_live.nDirty));
+}
+
+void CEntityStore::Reset()
+{
+	for (int i = 0; i < m_nSnapshots; i++)
+	{
+		entity_snapshot_t& snapshot = m_snapshots[(m_nNewest - i + ENTITY_MAX_SNAPSHOTS) % ENTITY_MAX_SNAPSHOTS];
+		for (int j = 0; j < ENTITY_COLUMNS; j++)
+			ReleaseColumn(snapshot.pColumns[j]);
+	}
+
+	m_nSnapshots = 0;
+	m_nNewest = 0;
+	m_bResolved = false;
+
+	ClearLive();
+}
+
+//-----------------------------------------------------------------------------
+// Finds, for every class, the props that fill the columns
+//-----------------------------------------------------------------------------
+void CEntityStore::ResolveClasses(const CSendTables& tables)
+{
+	m_classProps.assign(tables.GetClassCount(), class_props_t());
+	m_hotProps.clear();
+
+	for (int nClass = 0; nClass < tables.GetClassCount(); nClass++)
+	{
+		const server_class_t& serverClass = *tables.GetClass(nClass);
+		const send_prop_t* pProps = tables.GetProps(serverClass);
+
+		m_classProps[nClass].nFirst = (uint32)m_hotProps.size();
+
+		uint32 nTaken = 0;
+		for (size_t i = 0; i < sizeof(s_hotPropSources) / sizeof(s_hotPropSources[0]); i++)
+		{
+			const hot_prop_source_t& source = s_hotPropSources[i];
+
+			int nProp = tables.FindProp(nClass, source.pszName, source.pszTable);
+			if (nProp < 0)
+				continue;
+
+			const send_prop_t& prop = pProps[nProp];
+
+			int nComponents = 0;
+			switch (prop.nType)
+			{
+			case DPT_Int:
+			case DPT_Float:
+				nComponents = 1;
+				break;
+			case DPT_VectorXY:
+				nComponents = 2;
+				break;
+			case DPT_Vector:
+				nComponents = 3;
+				break;
+			}
+
+			if (!nComponents || source.nColumn + nComponents - 1 > source.nLastColumn)
+				continue;
+
+			// copies come first and may share, anything after them may not
+			uint32 nColumns = ((1u << nComponents) - 1) << source.nColumn;
+			if (!source.pszTable && (nTaken & nColumns))
+				continue;
+			nTaken |= nColumns;
+
+			hot_prop_t hot;
+			hot.nValueOffset = prop.nValueOffset;
+			hot.nProp = (uint16)nProp;
+			hot.nType = prop.nType;
+			hot.nColumn = (uint8)source.nColumn;
+			hot.nComponents = (uint8)nComponents;
+			hot.bCopy = source.pszTable != NULL;
+			m_hotProps.push_back(hot);
+		}
+
+		m_classProps[nClass].nCount = (uint32)m_hotProps.size() - m_classProps[nClass].nFirst;
+	}
+
+	m_nTablesGeneration = tables.GetGeneration();
+	m_bResolved = true;
+}
+
+void CEntityStore::Update(int nIndex, const entity_t& entity, const CSendTables& tables, const uint16* pFields, int nFields, bool bEnter)
+{
+	if (!m_bResolved || tables.GetGeneration() != m_nTablesGeneration)
+		ResolveClasses(tables);
+
+	bool bDirty = false;
+
+	// a new class in the slot doesn't inherit what the old one had
+	if (m_live.Ints(ENTITY_COLUMN_CLASS)[nIndex] != entity.nClass)
+	{
+		bEnter = true;
+		WriteColumn(ENTITY_COLUMN_CLASS)->nValues[nIndex] = entity.nClass;
+		for (int i = ENTITY_COLUMN_CLASS + 1; i < ENTITY_COLUMNS; i++)
+		{
+			if (m_live.Ints(i)[nIndex])
+				WriteColumn(i)->nValues[nIndex] = 0;
+		}
+		bDirty = true;
+	}
+
+	if ((uint32)entity.nClass < m_classProps.size())
+	{
+		const class_props_t& classProps = m_classProps[entity.nClass];
+		const uint8* pValues = entity.values.data();
+		uint32 nCopied = 0;		// columns a copy was written to
+
+		for (uint32 i = 0; i < classProps.nCount; i++)
+		{
+			const hot_prop_t& hot = m_hotProps[classProps.nFirst + i];
+
+			// the other copy may hold a stale value, only the decoded one
+			// counts; entering, the first copy fills what none was decoded for
+			if (hot.bCopy)
+			{
+				uint32 nColumns = ((1u << hot.nComponents) - 1) << hot.nColumn;
+				if (!std::binary_search(pFields, pFields + nFields, hot.nProp) && (!bEnter || (nCopied & nColumns)))
+					continue;
+				nCopied |= nColumns;
+			}
+
+			for (int j = 0; j < hot.nComponents; j++)
+			{
+				int nColumn = hot.nColumn + j;
+
+				// values are 4 bytes each, converted when the column's type differs
+				int32 nValue;
+				memcpy(&nValue, pValues + hot.nValueOffset + j * 4, sizeof(nValue));
+
+				if (hot.nType == DPT_Int && !is_int_column(nColumn))
+				{
+					float flValue = (float)nValue;
+					memcpy(&nValue, &flValue, sizeof(nValue));
+				}
+				else if (hot.nType != DPT_Int && is_int_column(nColumn))
+				{
+					float flValue;
+					memcpy(&flValue, &nValue, sizeof(flValue));
+					nValue = (int32)flValue;
+				}
+
+				if (m_live.Ints(nColumn)[nIndex] != nValue)
+				{
+					WriteColumn(nColumn)->nValues[nIndex] = nValue;
+					bDirty = true;
+				}
+			}
+		}
+	}
+
+	if (bDirty)
+		m_live.nDirty[nIndex >> 6] |= 1ull << (nIndex & 63);
+}
+
+void CEntityStore::Remove(int nIndex)
+{
+	if (m_live.Ints(ENTITY_COLUMN_CLASS)[nIndex] < 0)
+		return;
+
+	WriteColumn(ENTITY_COLUMN_CLASS)->nValues[nIndex] = -1;
+	for (int i = ENTITY_COLUMN_CLASS + 1; i < ENTITY_COLUMNS; i++)
+	{
+		if (m_live.Ints(i)[nIndex])
+			WriteColumn(i)->nValues[nIndex] = 0;
+	}
+
+	m_live.nDirty[nIndex >> 6] |= 1ull << (nIndex & 63);
+}
+
+void CEntityStore::RemoveAll()
+{
+	const int32* pClasses = m_live.Ints(ENTITY_COLUMN_CLASS);
+	for (int i = 0; i < MAX_EDICTS; i++)
+	{
+		if (pClasses[i] >= 0)
+		{
+			Remove(i);
+			pClasses = m_live.Ints(ENTITY_COLUMN_CLASS);
+		}
+	}
+}
+
+void CEntityStore::Snapshot(int nTick)
+{
+	entity_snapshot_t* pSnapshot;
+
+	if (m_nSnapshots && m_snapshots[m_nNewest].nTick == nTick)
+	{
+		// more updates for the same tick, the snapshot takes them all in
+		pSnapshot = &m_snapshots[m_nNewest];
+		for (int i = 0; i < ENTITY_DIRTY_WORDS; i++)
+			m_live.nDirty[i] |= pSnapshot->nDirty[i];
+		for (int i = 0; i < ENTITY_COLUMNS; i++)
+			ReleaseColumn(pSnapshot->pColumns[i]);
+	}
+	else
+	{
+		m_nNewest = (m_nNewest + 1) % ENTITY_MAX_SNAPSHOTS;
+		pSnapshot = &m_snapshots[m_nNewest];
+
+		if (m_nSnapshots == ENTITY_MAX_SNAPSHOTS)
+		{
+			for (int i = 0; i < ENTITY_COLUMNS; i++)
+				ReleaseColumn(pSnapshot->pColumns[i]);
+		}
+		else
+			m_nSnapshots++;
+	}
+
+	pSnapshot->nTick = nTick;
+	for (int i = 0; i < ENTITY_COLUMNS; i++)
+	{
+		pSnapshot->pColumns[i] = m_live.pColumns[i];
+		m_live.pColumns[i]->nRefs++;
+	}
+
+	memcpy(pSnapshot->nDirty, m_live.nDirty, sizeof(pSnapshot->nDirty));
+	memset(m_live.nDirty, 0, sizeof(m_live.nDirty));
+	m_live.nTick = nTick;
+}
+
+bool CEntityStore::Restore(int nTick)
+{
+	const entity_snapshot_t* pSnapshot = FindSnapshot(nTick);
+	if (!pSnapshot)
+		return false;
+
+	for (int i = 0; i < ENTITY_COLUMNS; i++)
+	{
+		entity_column_t* pColumn = pSnapshot->pColumns[i];
+		if (m_live.pColumns[i] == pColumn)
+			continue;
+
+		const int32* pLive = m_live.pColumns[i]->nValues;
+		for (int j = 0; j < MAX_EDICTS; j++)
+		{
+			if (pLive[j] != pColumn->nValues[j])
+				m_live.nDirty[j >> 6] |= 1ull << (j & 63);
+		}
+
+		// shared again, copied on the next write like after a snapshot
+		pColumn->nRefs++;
+		ReleaseColumn(m_live.pColumns[i]);
+		m_live.pColumns[i] = pColumn;
+	}
+
+	return true;
+}
+
+const entity_snapshot_t* CEntityStore::FindSnapshot(int nTick) const
+{
+	for (int i = 0; i < m_nSnapshots; i++)
+	{
+		const entity_snapshot_t& snapshot = m_snapshots[(m_nNewest - i + ENTITY_MAX_SNAPSHOTS) % ENTITY_MAX_SNAPSHOTS];
+		if (snapshot.nTick == nTick)
+			return &snapshot;
+	}
+
+	return NULL;
+}
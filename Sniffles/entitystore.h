@@ -0,0 +1,158 @@
+#pragma once
+
+#include <vector>
+
+#include "platform.h"
+#include "net.h"
+#include "sendtable.h"
+
+struct entity_t;
+
+#define ENTITY_MAX_SNAPSHOTS	32		// ticks kept per session, the oldest goes first
+#define ENTITY_DIRTY_WORDS		(MAX_EDICTS / 64)
+
+// One array per property, indexed by entity
+enum entity_column_id_t
+{
+	ENTITY_COLUMN_CLASS,		// int32, -1 for a free slot
+	ENTITY_COLUMN_ORIGIN_X,		// float
+	ENTITY_COLUMN_ORIGIN_Y,
+	ENTITY_COLUMN_ORIGIN_Z,
+	ENTITY_COLUMN_PITCH,		// float, eye angles for players, m_angRotation otherwise
+	ENTITY_COLUMN_YAW,
+	ENTITY_COLUMN_ROLL,
+	ENTITY_COLUMN_HEALTH,		// int32
+	ENTITY_COLUMN_TEAM,			// int32
+	ENTITY_COLUMNS
+};
+
+// Columns are shared between the live state and any number of snapshots, and
+// copied before a write while shared
+struct entity_column_t
+{
+	union
+	{
+		float	flValues[MAX_EDICTS];
+		int32	nValues[MAX_EDICTS];
+	};
+	int		nRefs;
+};
+
+//-----------------------------------------------------------------------------
+// Hot props of every entity at one tick
+//-----------------------------------------------------------------------------
+struct entity_snapshot_t
+{
+	int					nTick;
+	entity_column_t*	pColumns[ENTITY_COLUMNS];
+	uint64				nDirty[ENTITY_DIRTY_WORDS];	// entities whose hot props changed since the snapshot before
+
+	const float*	Floats(int nColumn) const { return pColumns[nColumn]->flValues; }
+	const int32*	Ints(int nColumn) const { return pColumns[nColumn]->nValues; }
+
+	bool			IsDirty(int nIndex) const { return ((nDirty[nIndex >> 6] >> (nIndex & 63)) & 1) != 0; }
+};
+
+// Index and origin of every entity of a class, one pass down the columns.
+// pIndices and pOrigins need room for MAX_EDICTS entries.
+static inline int entity_select_origins(const entity_snapshot_t& snapshot, int nClass, uint16* pIndices, float (*pOrigins)[3])
+{
+	const int32* pClasses = snapshot.Ints(ENTITY_COLUMN_CLASS);
+	const float* pX = snapshot.Floats(ENTITY_COLUMN_ORIGIN_X);
+	const float* pY = snapshot.Floats(ENTITY_COLUMN_ORIGIN_Y);
+	const float* pZ = snapshot.Floats(ENTITY_COLUMN_ORIGIN_Z);
+
+	int nCount = 0;
+	for (int i = 0; i < MAX_EDICTS; i++)
+	{
+		// written unconditionally, kept only on a match
+		pIndices[nCount] = (uint16)i;
+		pOrigins[nCount][0] = pX[i];
+		pOrigins[nCount][1] = pY[i];
+		pOrigins[nCount][2] = pZ[i];
+		nCount += pClasses[i] == nClass;
+	}
+
+	return nCount;
+}
+
+//-----------------------------------------------------------------------------
+// Origin, angles, health and team of every entity in a session, as
+// structure-of-arrays columns rather than per entity, so a query over all
+// entities is a linear scan. CEntityDecoder keeps it up to date; a snapshot
+// after each svc_PacketEntities keeps the last ENTITY_MAX_SNAPSHOTS ticks.
+// Taking one copies nothing, a column is only copied the first time it is
+// written after a snapshot.
+//-----------------------------------------------------------------------------
+class CEntityStore
+{
+public:
+	CEntityStore();
+	~CEntityStore();
+
+	// Frees every entity and forgets the snapshots
+	void			Reset();
+
+	// Refreshes an entity's columns from its value block. pFields are the
+	// props the update decoded, in ascending order; of a prop sent in two
+	// copies, only a decoded one is written, or as the entity enters,
+	// whichever its baseline holds.
+	void			Update(int nIndex, const entity_t& entity, const CSendTables& tables, const uint16* pFields, int nFields, bool bEnter);
+	void			Remove(int nIndex);
+	void			RemoveAll();
+
+	// Keeps the current state as the state at nTick
+	void			Snapshot(int nTick);
+
+	// Makes the snapshot of nTick the current state again, marking the
+	// entities that differ from the current state dirty. False if it is gone.
+	bool			Restore(int nTick);
+
+	// The current state; nTick is that of the last snapshot
+	const entity_snapshot_t&	GetLive() const { return m_live; }
+
+	// NULL when the tick wasn't snapshotted or is too old
+	const entity_snapshot_t*	FindSnapshot(int nTick) const;
+	int				GetSnapshotCount() const { return m_nSnapshots; }
+
+private:
+	CEntityStore(const CEntityStore&);
+	CEntityStore& operator=(const CEntityStore&);
+
+	// Where a class keeps the props behind the columns
+	struct hot_prop_t
+	{
+		uint32		nValueOffset;
+		uint16		nProp;			// index in the class's flattened props
+		uint8		nType;			// SendPropType
+		uint8		nColumn;		// first column
+		uint8		nComponents;	// columns it fills
+		bool		bCopy;			// shares its columns with another copy of the value
+	};
+
+	struct class_props_t
+	{
+		uint32		nFirst;
+		uint32		nCount;
+	};
+
+	void			ResolveClasses(const CSendTables& tables);
+
+	entity_column_t*	AllocColumn();
+	void			ReleaseColumn(entity_column_t* pColumn);
+	entity_column_t*	WriteColumn(int nColumn);
+	void			ClearLive();
+
+	entity_snapshot_t			m_live;
+	entity_snapshot_t			m_snapshots[ENTITY_MAX_SNAPSHOTS];	// ring, m_nNewest is the latest
+	int							m_nSnapshots;
+	int							m_nNewest;
+
+	std::vector<entity_column_t*>	m_freeColumns;	// column buffers nobody uses
+	std::vector<entity_column_t*>	m_allColumns;
+
+	std::vector<class_props_t>	m_classProps;	// by class id
+	std::vector<hot_prop_t>		m_hotProps;
+	uint32						m_nTablesGeneration;
+	bool						m_bResolved;
+};
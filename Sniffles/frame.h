@@ -0,0 +1,174 @@
+#pragma once
+
+#include "platform.h"
+
+// Link types we can walk without libtins (values from pcap/bpf.h)
+#define LINKTYPE_NULL			0		// BSD loopback
+#define LINKTYPE_ETHERNET		1		// DLT_EN10MB
+#define LINKTYPE_RAW			12		// DLT_RAW, raw IPv4/IPv6
+#define LINKTYPE_RAW_FILE		101		// what DLT_RAW is stored as in capture files
+#define LINKTYPE_LINUX_SLL		113		// DLT_LINUX_SLL, "any" device cooked capture
+
+#define ETHERTYPE_IPV4			0x0800
+#define ETHERTYPE_VLAN			0x8100
+#define ETHERTYPE_QINQ			0x88A8
+
+#define IPPROTO_UDP_			17
+
+// A UDP datagram located inside a captured frame. The payload points into the
+// capture buffer itself and is only valid until the next packet is read.
+struct udp_frame_t
+{
+	uint32			nSrcAddr;		// host byte order
+	uint32			nDstAddr;
+	uint16			nSrcPort;
+	uint16			nDstPort;
+	uint16			nIpId;
+	const uint8*	pPayload;
+	uint32			nPayloadSize;
+	uint64			nTimestampUs;	// capture time, set by the capture loop, 0 if unknown
+};
+
+static inline uint16 load_be16(const uint8* p)
+{
+	return (uint16)((p[0] << 8) | p[1]);
+}
+
+static inline uint32 load_be32(const uint8* p)
+{
+	return ((uint32)p[0] << 24) | ((uint32)p[1] << 16) | ((uint32)p[2] << 8) | p[3];
+}
+
+// Game headers inside the payload are little endian
+static inline uint16 load_le16(const uint8* p)
+{
+	return (uint16)(p[0] | (p[1] << 8));
+}
+
+static inline uint32 load_le32(const uint8* p)
+{
+	return p[0] | ((uint32)p[1] << 8) | ((uint32)p[2] << 16) | ((uint32)p[3] << 24);
+}
+
+static inline void store_le16(uint8* p, uint16 nValue)
+{
+	p[0] = (uint8)nValue;
+	p[1] = (uint8)(nValue >> 8);
+}
+
+static inline void store_le32(uint8* p, uint32 nValue)
+{
+	p[0] = (uint8)nValue;
+	p[1] = (uint8)(nValue >> 8);
+	p[2] = (uint8)(nValue >> 16);
+	p[3] = (uint8)(nValue >> 24);
+}
+
+//-----------------------------------------------------------------------------
+// Reads the Ethernet/VLAN/IPv4/UDP headers straight out of a captured frame.
+// Returns false for anything that is not an unfragmented IPv4 UDP datagram
+// that was captured in full.
+//-----------------------------------------------------------------------------
+static inline bool parse_udp_frame(int nLinkType, const uint8* pFrame, uint32 nCapLen, udp_frame_t& frame)
+{
+	const uint8* p = pFrame;
+	const uint8* pEnd = pFrame + nCapLen;
+	uint16 etherType;
+
+	switch (nLinkType)
+	{
+	case LINKTYPE_ETHERNET:
+		if (nCapLen < 14)
+			return false;
+		etherType = load_be16(p + 12);
+		p += 14;
+
+		// skip any number of 802.1Q / 802.1ad tags
+		while ((etherType == ETHERTYPE_VLAN || etherType == ETHERTYPE_QINQ) && p + 4 <= pEnd)
+		{
+			etherType = load_be16(p + 2);
+			p += 4;
+		}
+		break;
+
+	case LINKTYPE_LINUX_SLL:
+		if (nCapLen < 16)
+			return false;
+		etherType = load_be16(p + 14);
+		p += 16;
+		break;
+
+	case LINKTYPE_NULL:
+		if (nCapLen < 4)
+			return false;
+		// address family is in host byte order of the capturing machine, AF_INET is 2 everywhere
+		etherType = (p[0] == 2 || p[3] == 2) ? ETHERTYPE_IPV4 : 0;
+		p += 4;
+		break;
+
+	case LINKTYPE_RAW:
+	case LINKTYPE_RAW_FILE:
+		etherType = ETHERTYPE_IPV4;
+		break;
+
+	default:
+		return false;
+	}
+
+	if (etherType != ETHERTYPE_IPV4 || p + 20 > pEnd)
+		return false;
+
+	// IPv4
+	if ((p[0] >> 4) != 4)
+		return false;
+
+	uint32 ipHeaderSize = (p[0] & 0x0F) * 4;
+	uint32 ipTotalSize = load_be16(p + 2);
+	if (ipHeaderSize < 20 || ipTotalSize < ipHeaderSize + 8 || p + ipTotalSize > pEnd)
+		return false;
+
+	// fragments can't be decoded on their own
+	if (load_be16(p + 6) & 0x3FFF)
+		return false;
+
+	if (p[9] != IPPROTO_UDP_)
+		return false;
+
+	frame.nIpId = load_be16(p + 4);
+	frame.nSrcAddr = load_be32(p + 12);
+	frame.nDstAddr = load_be32(p + 16);
+
+	// UDP
+	const uint8* pUdp = p + ipHeaderSize;
+	uint32 udpSize = load_be16(pUdp + 4);
+	if (udpSize < 8 || pUdp + udpSize > p + ipTotalSize)
+		return false;
+
+	frame.nSrcPort = load_be16(pUdp);
+	frame.nDstPort = load_be16(pUdp + 2);
+	frame.pPayload = pUdp + 8;
+	frame.nPayloadSize = udpSize - 8;
+
+	return true;
+}
+
+// Symmetric, so both directions of a session hash to the same worker
+static inline uint32 hash_flow(const udp_frame_t& frame)
+{
+	uint32 h = (frame.nSrcAddr ^ frame.nDstAddr) * 0x9E3779B1u;
+	h ^= ((uint32)(frame.nSrcPort ^ frame.nDstPort) << 8) | IPPROTO_UDP_;
+
+	// murmur3 finalizer
+	h ^= h >> 16;
+	h *= 0x85EBCA6Bu;
+	h ^= h >> 13;
+	h *= 0xC2B2AE35u;
+	h ^= h >> 16;
+	return h;
+}
+
+static inline void format_ipv4(uint32 nAddr, char* pszOut, size_t nOutSize)
+{
+	_snprintf_s(pszOut, nOutSize, _TRUNCATE, "%u.%u.%u.%u",
+		(nAddr >> 24) & 0xFF, (nAddr >> 16) & 0xFF, (nAddr >> 8) & 0xFF, nAddr & 0xFF);
+}
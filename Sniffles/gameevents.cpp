@@ -0,0 +1,335 @@
+#include "gameevents.h"
+#include "decoder.h"
+#include "dispatch.h"
+#include "str.h"
+#include "wirefields.h"
+
+#include "google/protobuf/wire_format_lite.h"
+
+using google::protobuf::internal::WireFormatLite;
+
+// Names behind known_game_event_t and known_game_event_key_t
+static const char* s_pszKnownEvents[GAMEEVENT_KNOWN_COUNT] =
+{
+	"player_death",
+	"player_hurt",
+	"weapon_fire",
+	"player_spawn",
+	"round_start",
+	"round_end",
+};
+
+static const char* s_pszKnownKeys[GAMEEVENT_KEY_COUNT] =
+{
+	"userid",
+	"attacker",
+	"assister",
+	"weapon",
+	"headshot",
+	"health",
+	"armor",
+	"dmg_health",
+	"dmg_armor",
+	"hitgroup",
+	"silenced",
+	"winner",
+	"reason",
+};
+
+CGameEventLayouts::CGameEventLayouts()
+{
+	Clear();
+}
+
+void CGameEventLayouts::Clear()
+{
+	for (int i = 0; i < GAMEEVENT_MAX_EVENTS; i++)
+	{
+		m_layouts[i].strName.clear();
+		m_layouts[i].nKnown = GAMEEVENT_UNKNOWN;
+		m_layouts[i].nFirstKey = 0;
+		m_layouts[i].nKeys = 0;
+		m_layouts[i].bValid = false;
+	}
+
+	m_keys.clear();
+	m_nEvents = 0;
+}
+
+bool CGameEventLayouts::Compile(const CSVCMsg_GameEventList& msg)
+{
+	Clear();
+
+	bool bValid = true;
+	for (int i = 0; i < msg.descriptors_size(); i++)
+	{
+		const CSVCMsg_GameEventList::descriptor_t& descriptor = msg.descriptors(i);
+
+		int nEventId = descriptor.eventid();
+		if ((uint32)nEventId >= GAMEEVENT_MAX_EVENTS || m_layouts[nEventId].bValid ||
+			descriptor.keys_size() > GAMEEVENT_MAX_KEYS)
+		{
+			bValid = false;
+			continue;
+		}
+
+		bool bKeysValid = true;
+		for (int j = 0; j < descriptor.keys_size() && bKeysValid; j++)
+			bKeysValid = (uint32)descriptor.keys(j).type() < GAMEEVENT_TYPE_COUNT;
+
+		if (!bKeysValid)
+		{
+			bValid = false;
+			continue;
+		}
+
+		game_event_layout_t& layout = m_layouts[nEventId];
+		layout.strName = descriptor.name();
+		layout.nFirstKey = (uint32)m_keys.size();
+		layout.nKeys = (uint32)descriptor.keys_size();
+		layout.bValid = true;
+		memset(layout.nKnownKeys, -1, sizeof(layout.nKnownKeys));
+
+		for (int j = 0; j < GAMEEVENT_KNOWN_COUNT; j++)
+		{
+			if (layout.strName == s_pszKnownEvents[j])
+				layout.nKnown = j;
+		}
+
+		for (int j = 0; j < descriptor.keys_size(); j++)
+		{
+			game_event_key_t key;
+			key.strName = descriptor.keys(j).name();
+			key.nType = (uint8)descriptor.keys(j).type();
+
+			// key_t numbers its value fields one past the type: val_string is
+			// 2 for GAMEEVENT_TYPE_STRING and so on
+			key.nValueField = key.nType == GAMEEVENT_TYPE_LOCAL ? 0 : key.nType + 1;
+			m_keys.push_back(key);
+
+			for (int k = 0; k < GAMEEVENT_KEY_COUNT; k++)
+			{
+				if (layout.nKnownKeys[k] < 0 && key.strName == s_pszKnownKeys[k])
+					layout.nKnownKeys[k] = (int8)j;
+			}
+		}
+
+		m_nEvents++;
+	}
+
+	return bValid;
+}
+
+int CGameEventLayouts::FindEvent(const char* pszName) const
+{
+	for (int i = 0; i < GAMEEVENT_MAX_EVENTS; i++)
+	{
+		if (m_layouts[i].bValid && m_layouts[i].strName == pszName)
+			return i;
+	}
+
+	return -1;
+}
+
+int CGameEventLayouts::FindKey(int nEventId, const char* pszName) const
+{
+	const game_event_layout_t* pLayout = GetLayout(nEventId);
+	if (!pLayout)
+		return -1;
+
+	for (uint32 i = 0; i < pLayout->nKeys; i++)
+	{
+		if (m_keys[pLayout->nFirstKey + i].strName == pszName)
+			return (int)i;
+	}
+
+	return -1;
+}
+
+//-----------------------------------------------------------------------------
+// One key_t: its type must be the declared one, and only the value field the
+// type implies is read
+//-----------------------------------------------------------------------------
+static bool decode_key(const uint8* p, const uint8* pEnd, const game_event_key_t& key, game_event_value_t& value)
+{
+	value.nValue64 = 0;
+	value.pData = "";
+	value.nLength = 0;
+
+	while (p < pEnd)
+	{
+		uint64 nTag;
+		if (!wire_read_varint(p, pEnd, nTag))
+			return false;
+
+		uint32 nField = (uint32)(nTag >> 3);
+		int nWireType = (int)(nTag & 7);
+
+		if (nField == CSVCMsg_GameEvent_key_t::kTypeFieldNumber && nWireType == WireFormatLite::WIRETYPE_VARINT)
+		{
+			uint64 nType;
+			if (!wire_read_varint(p, pEnd, nType) || nType != key.nType)
+				return false;
+			continue;
+		}
+
+		if (nField != key.nValueField)
+		{
+			if (!wire_skip_field(p, pEnd, nWireType))
+				return false;
+			continue;
+		}
+
+		switch (key.nType)
+		{
+		case GAMEEVENT_TYPE_STRING:
+		case GAMEEVENT_TYPE_WSTRING:
+		{
+			const uint8* pData;
+			if (nWireType != WireFormatLite::WIRETYPE_LENGTH_DELIMITED || !wire_read_bytes(p, pEnd, pData, value.nLength))
+				return false;
+			value.pData = (const char*)pData;
+		}
+		break;
+
+		case GAMEEVENT_TYPE_FLOAT:
+			if (nWireType != WireFormatLite::WIRETYPE_FIXED32 || pEnd - p < 4)
+				return false;
+			memcpy(&value.flValue, p, sizeof(value.flValue));
+			p += 4;
+			break;
+
+		case GAMEEVENT_TYPE_UINT64:
+			if (nWireType != WireFormatLite::WIRETYPE_VARINT || !wire_read_varint(p, pEnd, value.nValue64))
+				return false;
+			break;
+
+		default:
+		{
+			// int32 fields are sign extended to 10 bytes on the wire
+			uint64 nValue;
+			if (nWireType != WireFormatLite::WIRETYPE_VARINT || !wire_read_varint(p, pEnd, nValue))
+				return false;
+			value.nValue64 = 0;
+			value.nValue = (int32)nValue;
+		}
+		break;
+		}
+	}
+
+	return true;
+}
+
+bool CGameEventLayouts::Decode(const uint8* pData, int nSize, game_event_t& event) const
+{
+	event.nEventId = -1;
+	event.pLayout = NULL;
+	event.pKeys = NULL;
+	event.nKeys = 0;
+
+	const uint8* p = pData;
+	const uint8* pEnd = pData + nSize;
+
+	while (p < pEnd)
+	{
+		uint64 nTag;
+		if (!wire_read_varint(p, pEnd, nTag))
+			return false;
+
+		uint32 nField = (uint32)(nTag >> 3);
+		int nWireType = (int)(nTag & 7);
+
+		if (nField == CSVCMsg_GameEvent::kEventidFieldNumber && nWireType == WireFormatLite::WIRETYPE_VARINT)
+		{
+			uint64 nEventId;
+			if (!wire_read_varint(p, pEnd, nEventId) || event.pLayout)
+				return false;
+
+			event.nEventId = nEventId < GAMEEVENT_MAX_EVENTS ? (int)nEventId : -1;
+			event.pLayout = GetLayout(event.nEventId);
+			if (!event.pLayout)
+				return false;
+			event.pKeys = m_keys.data() + event.pLayout->nFirstKey;
+		}
+		else if (nField == CSVCMsg_GameEvent::kKeysFieldNumber && nWireType == WireFormatLite::WIRETYPE_LENGTH_DELIMITED)
+		{
+			// keys follow the id in field order, and are matched to the
+			// layout's by position
+			if (!event.pLayout || event.nKeys >= event.pLayout->nKeys)
+				return false;
+
+			const uint8* pKey;
+			uint32 nLength;
+			if (!wire_read_bytes(p, pEnd, pKey, nLength) ||
+				!decode_key(pKey, pKey + nLength, event.pKeys[event.nKeys], event.values[event.nKeys]))
+				return false;
+
+			event.nKeys++;
+		}
+		else if (!wire_skip_field(p, pEnd, nWireType))
+			return false;
+	}
+
+	return event.pLayout && event.nKeys == event.pLayout->nKeys;
+}
+
+//-----------------------------------------------------------------------------
+// Dispatcher glue, layouts live with the session's other state in the
+// decoder's entity tracker
+//-----------------------------------------------------------------------------
+static void on_game_event_list(const CSVCMsg_GameEventList& msg, int /*nSize*/, const message_source_t& source, void* /*pContext*/)
+{
+	source.pDecoder->GetEntityTracker().OnGameEventList(*source.pFrame, msg, source.pDecoder->m_stats);
+}
+
+static void on_game_event(int /*nCmd*/, const uint8* pData, int nSize, const message_source_t& source, void* pContext)
+{
+	const game_event_t* pEvent = source.pDecoder->GetEntityTracker().OnGameEvent(*source.pFrame, pData, nSize, source.pDecoder->m_stats);
+
+	const game_event_handler_t* pHandler = (const game_event_handler_t*)pContext;
+	if (pEvent && pHandler)
+		pHandler->pfnHandler(*pEvent, source, pHandler->pContext);
+}
+
+void add_game_event_handlers(CMessageDispatcher& dispatcher, const game_event_handler_t* pHandler)
+{
+	dispatcher.Subscribe(on_game_event_list);
+	dispatcher.SubscribeRaw(svc_GameEvent, on_game_event, (void*)pHandler);
+}
+
+static void print_game_event(const game_event_t& event, const message_source_t& /*source*/, void* /*pContext*/)
+{
+	std::string strLine = event.pLayout->strName;
+
+	for (uint32 i = 0; i < event.nKeys; i++)
+	{
+		const game_event_key_t& key = event.pKeys[i];
+		const game_event_value_t& value = event.values[i];
+
+		char szValue[32];
+		switch (key.nType)
+		{
+		case GAMEEVENT_TYPE_LOCAL:
+			continue;
+		case GAMEEVENT_TYPE_STRING:
+		case GAMEEVENT_TYPE_WSTRING:
+			strLine += " " + key.strName + "=" + std::string(value.pData, value.nLength);
+			continue;
+		case GAMEEVENT_TYPE_FLOAT:
+			_snprintf_s(szValue, sizeof(szValue), _TRUNCATE, "%g", value.flValue);
+			break;
+		case GAMEEVENT_TYPE_UINT64:
+			_snprintf_s(szValue, sizeof(szValue), _TRUNCATE, "%llu", (unsigned long long)value.nValue64);
+			break;
+		default:
+			_snprintf_s(szValue, sizeof(szValue), _TRUNCATE, "%d", value.nValue);
+			break;
+		}
+
+		strLine += " " + key.strName + "=" + szValue;
+	}
+
+	outf("[event] %s\n", strLine.c_str());
+}
+
+const game_event_handler_t g_printGameEvents = { print_game_event, NULL };
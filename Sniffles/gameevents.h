@@ -0,0 +1,180 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "platform.h"
+#include "net.h"
+
+struct message_source_t;
+class CMessageDispatcher;
+
+#define GAMEEVENT_MAX_EVENTS	512		// MAX_EVENT_NUMBER in the engine, ids are 9 bits
+#define GAMEEVENT_MAX_KEYS		64		// keys per event, more than any CS:GO event has
+
+// Key types as svc_GameEventList declares them
+enum GameEventKeyType
+{
+	GAMEEVENT_TYPE_LOCAL = 0,	// never networked
+	GAMEEVENT_TYPE_STRING,
+	GAMEEVENT_TYPE_FLOAT,
+	GAMEEVENT_TYPE_LONG,
+	GAMEEVENT_TYPE_SHORT,
+	GAMEEVENT_TYPE_BYTE,
+	GAMEEVENT_TYPE_BOOL,
+	GAMEEVENT_TYPE_UINT64,
+	GAMEEVENT_TYPE_WSTRING,
+	GAMEEVENT_TYPE_COUNT
+};
+
+// Events resolved when the list is compiled, so handlers can tell them apart
+// without comparing names
+enum known_game_event_t
+{
+	GAMEEVENT_UNKNOWN = -1,
+	GAMEEVENT_PLAYER_DEATH,
+	GAMEEVENT_PLAYER_HURT,
+	GAMEEVENT_WEAPON_FIRE,
+	GAMEEVENT_PLAYER_SPAWN,
+	GAMEEVENT_ROUND_START,
+	GAMEEVENT_ROUND_END,
+	GAMEEVENT_KNOWN_COUNT
+};
+
+// Keys of the known events, by what they mean rather than where they are
+enum known_game_event_key_t
+{
+	GAMEEVENT_KEY_USERID,
+	GAMEEVENT_KEY_ATTACKER,
+	GAMEEVENT_KEY_ASSISTER,
+	GAMEEVENT_KEY_WEAPON,
+	GAMEEVENT_KEY_HEADSHOT,
+	GAMEEVENT_KEY_HEALTH,
+	GAMEEVENT_KEY_ARMOR,
+	GAMEEVENT_KEY_DMG_HEALTH,
+	GAMEEVENT_KEY_DMG_ARMOR,
+	GAMEEVENT_KEY_HITGROUP,
+	GAMEEVENT_KEY_SILENCED,
+	GAMEEVENT_KEY_WINNER,
+	GAMEEVENT_KEY_REASON,
+	GAMEEVENT_KEY_COUNT
+};
+
+struct game_event_key_t
+{
+	std::string		strName;
+	uint8			nType;			// GameEventKeyType
+	uint8			nValueField;	// key_t field number of its value, 0 for GAMEEVENT_TYPE_LOCAL
+};
+
+struct game_event_layout_t
+{
+	std::string		strName;
+	int				nKnown;			// known_game_event_t
+	uint32			nFirstKey;		// into the keys of CGameEventLayouts
+	uint32			nKeys;			// 0 with bValid false for an id the list didn't declare
+	bool			bValid;
+	int8			nKnownKeys[GAMEEVENT_KEY_COUNT];	// key positions, -1 where the event has none
+};
+
+// One key's value. Strings point into the serialized message, they are only
+// valid while the handler runs and aren't terminated.
+struct game_event_value_t
+{
+	union
+	{
+		int32		nValue;			// long, short, byte and bool
+		float		flValue;
+		uint64		nValue64;
+	};
+	const char*		pData;			// string and wstring
+	uint32			nLength;
+};
+
+//-----------------------------------------------------------------------------
+// An svc_GameEvent decoded against its compiled layout, values[i] is the
+// value of the layout's key i
+//-----------------------------------------------------------------------------
+struct game_event_t
+{
+	int							nEventId;
+	const game_event_layout_t*	pLayout;
+	const game_event_key_t*		pKeys;		// pLayout's, nKeys of them
+	uint32						nKeys;
+	game_event_value_t			values[GAMEEVENT_MAX_KEYS];
+};
+
+// Values by known key; 0 or an empty string when the event doesn't have it
+static inline int32 game_event_int(const game_event_t& event, int nKnownKey)
+{
+	int nKey = event.pLayout->nKnownKeys[nKnownKey];
+	return nKey >= 0 ? event.values[nKey].nValue : 0;
+}
+
+static inline float game_event_float(const game_event_t& event, int nKnownKey)
+{
+	int nKey = event.pLayout->nKnownKeys[nKnownKey];
+	return nKey >= 0 ? event.values[nKey].flValue : 0.0f;
+}
+
+// Not terminated, nLength bytes
+static inline const char* game_event_string(const game_event_t& event, int nKnownKey, uint32& nLength)
+{
+	int nKey = event.pLayout->nKnownKeys[nKnownKey];
+	nLength = nKey >= 0 ? event.values[nKey].nLength : 0;
+	return nKey >= 0 ? event.values[nKey].pData : "";
+}
+
+//-----------------------------------------------------------------------------
+// The event descriptors of one session, compiled from svc_GameEventList into
+// a table indexed by event id. Key types, value field numbers and the
+// positions of well known keys are worked out once, so decoding an event is
+// one pass over its wire format with no name lookups.
+//-----------------------------------------------------------------------------
+class CGameEventLayouts
+{
+public:
+	CGameEventLayouts();
+
+	// False when a descriptor was malformed; the others are still compiled
+	bool			Compile(const CSVCMsg_GameEventList& msg);
+	void			Clear();
+
+	bool			IsReady() const { return m_nEvents > 0; }
+
+	// NULL for an id the list didn't declare
+	const game_event_layout_t*	GetLayout(int nEventId) const
+	{
+		return (uint32)nEventId < GAMEEVENT_MAX_EVENTS && m_layouts[nEventId].bValid ? &m_layouts[nEventId] : NULL;
+	}
+
+	// -1 if there is no such event or key
+	int				FindEvent(const char* pszName) const;
+	int				FindKey(int nEventId, const char* pszName) const;
+
+	// Decodes a serialized CSVCMsg_GameEvent. False when it's malformed, doesn't
+	// match its layout or has an id without one, which leaves pLayout NULL.
+	bool			Decode(const uint8* pData, int nSize, game_event_t& event) const;
+
+private:
+	game_event_layout_t				m_layouts[GAMEEVENT_MAX_EVENTS];
+	std::vector<game_event_key_t>	m_keys;
+	int								m_nEvents;
+};
+
+// Gets every decoded svc_GameEvent of the sessions a decoder tracks
+typedef void (*pfnGameEventHandler_t)(const game_event_t& event, const message_source_t& source, void* pContext);
+
+struct game_event_handler_t
+{
+	pfnGameEventHandler_t	pfnHandler;
+	void*					pContext;
+};
+
+// Compiles svc_GameEventList and decodes svc_GameEvent for the entity tracker
+// of the decoder that received them, handing each event to pHandler. Call
+// once per dispatcher; pHandler must outlive it, NULL only counts the events.
+void add_game_event_handlers(CMessageDispatcher& dispatcher, const game_event_handler_t* pHandler);
+
+// Prints events with their key names, for -gameevents on a live capture
+extern const game_event_handler_t g_printGameEvents;
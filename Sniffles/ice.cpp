@@ -7,43 +7,30 @@
 #include "ice.h"
 #pragma warning(disable: 4244)
 
-
-/* Structure of a single round subkey */
+/* The bulk decryption has an AVX2 path on x86, picked at runtime */
+#if !defined(ICE_NO_SIMD) && (defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__))
+#define ICE_AVX2
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define ICE_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define ICE_TARGET_AVX2	__attribute__((target("avx2")))
+#endif
+#endif
+
+
+/* Structure of a single round subkey, each value is 20 bits */
 class IceSubkey {
 public:
-	unsigned long	val[3];
+	unsigned int	val[3];
 };
 
 
 /* The S-boxes */
-static unsigned long	ice_sbox[4][1024];
-static int		ice_sboxes_initialised = 0;
-
-
-/* Modulo values for the S-boxes */
-static const int	ice_smod[4][4] = {
-	{ 333, 313, 505, 369 },
-	{ 379, 375, 319, 391 },
-	{ 361, 445, 451, 397 },
-	{ 397, 425, 395, 505 } };
-
-/* XOR values for the S-boxes */
-static const int	ice_sxor[4][4] = {
-	{ 0x83, 0x85, 0x9b, 0xcd },
-	{ 0xcc, 0xa7, 0xad, 0x41 },
-	{ 0x4b, 0x2e, 0xd4, 0x33 },
-	{ 0xea, 0xcb, 0x2e, 0x04 } };
-
-/* Permutation values for the P-box */
-static const unsigned long	ice_pbox[32] = {
-	0x00000001, 0x00000080, 0x00000400, 0x00002000,
-	0x00080000, 0x00200000, 0x01000000, 0x40000000,
-	0x00000008, 0x00000020, 0x00000100, 0x00004000,
-	0x00010000, 0x00800000, 0x04000000, 0x20000000,
-	0x00000004, 0x00000010, 0x00000200, 0x00008000,
-	0x00020000, 0x00400000, 0x08000000, 0x10000000,
-	0x00000002, 0x00000040, 0x00000800, 0x00001000,
-	0x00040000, 0x00100000, 0x02000000, 0x80000000 };
+#include "icesbox.h"
+
 
 /* The key rotation schedule */
 static const int	ice_keyrot[16] = {
@@ -51,93 +38,64 @@ static const int	ice_keyrot[16] = {
 	1, 3, 2, 0, 3, 1, 0, 2 };
 
 
+#ifdef ICE_AVX2
 /*
-* 8-bit Galois Field multiplication of a by b, modulo m.
-* Just like arithmetic multiplication, except that additions and
-* subtractions are replaced by XOR.
+* Check that both the CPU and the OS (YMM state saving) support AVX2.
 */
-static unsigned int gf_mult(register unsigned int a, register unsigned int b, register unsigned int	m)
+static int ice_cpu_has_avx2(void)
 {
-	register unsigned int	res = 0;
+	unsigned int	a, b, c, d;
+	unsigned long long	xcr0;
 
-	while (b) {
-		if (b & 1)
-			res ^= a;
+#if defined(_MSC_VER)
+	int		regs[4];
 
-		a <<= 1;
-		b >>= 1;
-
-		if (a >= 256)
-			a ^= m;
-	}
-
-	return (res);
-}
-
-
-/*
-* Galois Field exponentiation.
-* Raise the base to the power of 7, modulo m.
-*/
-static unsigned long gf_exp7(register unsigned int b, unsigned int m)
-{
-	register unsigned int	x;
+	__cpuid(regs, 0);
+	if (regs[0] < 7)
+		return (0);
 
-	if (b == 0)
+	__cpuid(regs, 1);
+	c = regs[2];
+#else
+	if (__get_cpuid_max(0, 0) < 7)
 		return (0);
 
-	x = gf_mult(b, b, m);
-	x = gf_mult(b, x, m);
-	x = gf_mult(x, x, m);
-	return (gf_mult(b, x, m));
-}
+	__cpuid(1, a, b, c, d);
+#endif
 
+	/* OSXSAVE and AVX */
+	if ((c & 0x18000000) != 0x18000000)
+		return (0);
 
-/*
-* Carry out the ICE 32-bit P-box permutation.
-*/
-static unsigned long ice_perm32(register unsigned long	x)
-{
-	register unsigned long		res = 0;
-	register const unsigned long	*pbox = ice_pbox;
-
-	while (x) {
-		if (x & 1)
-			res |= *pbox;
-		pbox++;
-		x >>= 1;
-	}
+#if defined(_MSC_VER)
+	xcr0 = _xgetbv(0);
+	__cpuidex(regs, 7, 0);
+	b = regs[1];
+#else
+	__asm__ __volatile__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+	xcr0 = ((unsigned long long)d << 32) | a;
+	__cpuid_count(7, 0, a, b, c, d);
+#endif
+
+	/* XMM and YMM state enabled by the OS */
+	if ((xcr0 & 6) != 6)
+		return (0);
 
-	return (res);
+	return ((b & 0x20) != 0);
 }
 
 
 /*
-* Initialise the ICE S-boxes.
-* This only has to be done once.
+* Checked on first use. A local static is initialized exactly once even
+* when several threads get here together, so keys can be built anywhere.
 */
-static void ice_sboxes_init(void)
+static int ice_use_avx2(void)
 {
-	register int	i;
-
-	for (i = 0; i<1024; i++) {
-		int			col = (i >> 1) & 0xff;
-		int			row = (i & 0x1) | ((i & 0x200) >> 8);
-		unsigned long	x;
-
-		x = gf_exp7(col ^ ice_sxor[0][row], ice_smod[0][row]) << 24;
-		ice_sbox[0][i] = ice_perm32(x);
-
-		x = gf_exp7(col ^ ice_sxor[1][row], ice_smod[1][row]) << 16;
-		ice_sbox[1][i] = ice_perm32(x);
-
-		x = gf_exp7(col ^ ice_sxor[2][row], ice_smod[2][row]) << 8;
-		ice_sbox[2][i] = ice_perm32(x);
+	static const int	use_avx2 = ice_cpu_has_avx2();
 
-		x = gf_exp7(col ^ ice_sxor[3][row], ice_smod[3][row]);
-		ice_sbox[3][i] = ice_perm32(x);
-	}
+	return (use_avx2);
 }
+#endif
 
 
 /*
@@ -145,12 +103,6 @@ static void ice_sboxes_init(void)
 */
 IceKey::IceKey(int n)
 {
-	if (!ice_sboxes_initialised)
-	{
-		ice_sboxes_init();
-		ice_sboxes_initialised = 1;
-	}
-
 	if (n < 1) {
 		_size = 1;
 		_rounds = 8;
@@ -242,12 +194,15 @@ void IceKey::encrypt(const unsigned char* ptext, unsigned char* ctext) const
 
 
 /*
-* Decrypt a block of 8 bytes of data with the given ICE key.
+* Decrypt one block. ROUNDS is the round count when known at compile time,
+* so the level 2 loop used by the game is fully unrolled; 0 means use rounds.
 */
-void IceKey::decrypt(const unsigned char* ctext, unsigned char* ptext) const
+template <int ROUNDS>
+static void ice_decrypt_block(const IceSubkey* keysched, int rounds, const unsigned char* ctext, unsigned char* ptext)
 {
 	register int i;
 	register unsigned long	l, r;
+	const int	n = ROUNDS ? ROUNDS : rounds;
 
 	l = (((unsigned long)ctext[0]) << 24)
 		| (((unsigned long)ctext[1]) << 16)
@@ -256,10 +211,10 @@ void IceKey::decrypt(const unsigned char* ctext, unsigned char* ptext) const
 		| (((unsigned long)ctext[5]) << 16)
 		| (((unsigned long)ctext[6]) << 8) | ctext[7];
 
-	for (i = _rounds - 1; i > 0; i -= 2)
+	for (i = n - 1; i > 0; i -= 2)
 	{
-		l ^= ice_f(r, &_keysched[i]);
-		r ^= ice_f(l, &_keysched[i - 1]);
+		l ^= ice_f(r, &keysched[i]);
+		r ^= ice_f(l, &keysched[i - 1]);
 	}
 
 	for (i = 0; i < 4; i++)
@@ -273,6 +228,168 @@ void IceKey::decrypt(const unsigned char* ctext, unsigned char* ptext) const
 }
 
 
+/*
+* Decrypt a block of 8 bytes of data with the given ICE key.
+*/
+void IceKey::decrypt(const unsigned char* ctext, unsigned char* ptext) const
+{
+	if (_rounds == 32)
+		ice_decrypt_block<32>(_keysched, _rounds, ctext, ptext);
+	else
+		ice_decrypt_block<0>(_keysched, _rounds, ctext, ptext);
+}
+
+
+/*
+* Number of blocks the scalar bulk path decrypts side by side.
+* The blocks are independent, so their rounds overlap in the pipeline.
+*/
+#define ICE_LANES	4
+
+template <int ROUNDS>
+static void ice_decrypt_lanes(const IceSubkey* keysched, int rounds, const unsigned char* ctext, unsigned char* ptext)
+{
+	register int	i, b;
+	unsigned long	l[ICE_LANES], r[ICE_LANES];
+	const int	n = ROUNDS ? ROUNDS : rounds;
+
+	for (b = 0; b < ICE_LANES; b++, ctext += 8)
+	{
+		l[b] = (((unsigned long)ctext[0]) << 24)
+			| (((unsigned long)ctext[1]) << 16)
+			| (((unsigned long)ctext[2]) << 8) | ctext[3];
+		r[b] = (((unsigned long)ctext[4]) << 24)
+			| (((unsigned long)ctext[5]) << 16)
+			| (((unsigned long)ctext[6]) << 8) | ctext[7];
+	}
+
+	for (i = n - 1; i > 0; i -= 2)
+	{
+		const IceSubkey	*sk0 = &keysched[i];
+		const IceSubkey	*sk1 = &keysched[i - 1];
+
+		for (b = 0; b < ICE_LANES; b++)
+			l[b] ^= ice_f(r[b], sk0);
+
+		for (b = 0; b < ICE_LANES; b++)
+			r[b] ^= ice_f(l[b], sk1);
+	}
+
+	for (b = 0; b < ICE_LANES; b++, ptext += 8)
+	{
+		for (i = 0; i < 4; i++)
+		{
+			ptext[3 - i] = r[b] & 0xff;
+			ptext[7 - i] = l[b] & 0xff;
+
+			r[b] >>= 8;
+			l[b] >>= 8;
+		}
+	}
+}
+
+
+#ifdef ICE_AVX2
+/*
+* The ICE f function on 8 blocks at once, S-box lookups done with gathers.
+*/
+static ICE_TARGET_AVX2 __m256i ice_f_avx2(__m256i p, const IceSubkey* sk)
+{
+	const __m256i	m3ff = _mm256_set1_epi32(0x3ff);
+	const __m256i	mffc00 = _mm256_set1_epi32(0xffc00);
+	__m256i		tl, tr, al, ar, res;
+
+	tl = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(p, 16), m3ff),
+		_mm256_and_si256(_mm256_or_si256(_mm256_srli_epi32(p, 14), _mm256_slli_epi32(p, 18)), mffc00));
+
+	tr = _mm256_or_si256(_mm256_and_si256(p, m3ff), _mm256_and_si256(_mm256_slli_epi32(p, 2), mffc00));
+
+	al = _mm256_and_si256(_mm256_set1_epi32((int)sk->val[2]), _mm256_xor_si256(tl, tr));
+	ar = _mm256_xor_si256(al, tr);
+	al = _mm256_xor_si256(al, tl);
+
+	al = _mm256_xor_si256(al, _mm256_set1_epi32((int)sk->val[0]));
+	ar = _mm256_xor_si256(ar, _mm256_set1_epi32((int)sk->val[1]));
+
+	res = _mm256_i32gather_epi32((const int*)ice_sbox[0], _mm256_srli_epi32(al, 10), 4);
+	res = _mm256_or_si256(res, _mm256_i32gather_epi32((const int*)ice_sbox[1], _mm256_and_si256(al, m3ff), 4));
+	res = _mm256_or_si256(res, _mm256_i32gather_epi32((const int*)ice_sbox[2], _mm256_srli_epi32(ar, 10), 4));
+	res = _mm256_or_si256(res, _mm256_i32gather_epi32((const int*)ice_sbox[3], _mm256_and_si256(ar, m3ff), 4));
+
+	return (res);
+}
+
+
+/*
+* Decrypt 8 blocks (64 bytes). The halves are byte swapped and split into
+* one register of left halves and one of right halves, one block per lane.
+*/
+template <int ROUNDS>
+static ICE_TARGET_AVX2 void ice_decrypt8_avx2(const IceSubkey* keysched, int rounds, const unsigned char* ctext, unsigned char* ptext)
+{
+	const __m256i	bswap = _mm256_setr_epi8(
+		3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+		3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	const __m256i	split = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+	const __m256i	merge = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	register int	i;
+	const int	n = ROUNDS ? ROUNDS : rounds;
+	__m256i		a, b, l, r;
+
+	/* l0 r0 l1 r1 .. -> l0 l1 l2 l3 r0 r1 r2 r3 */
+	a = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)ctext), bswap), split);
+	b = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(ctext + 32)), bswap), split);
+
+	l = _mm256_permute2x128_si256(a, b, 0x20);
+	r = _mm256_permute2x128_si256(a, b, 0x31);
+
+	for (i = n - 1; i > 0; i -= 2)
+	{
+		l = _mm256_xor_si256(l, ice_f_avx2(r, &keysched[i]));
+		r = _mm256_xor_si256(r, ice_f_avx2(l, &keysched[i - 1]));
+	}
+
+	/* the output block is r then l */
+	a = _mm256_permute2x128_si256(r, l, 0x20);
+	b = _mm256_permute2x128_si256(r, l, 0x31);
+
+	_mm256_storeu_si256((__m256i*)ptext, _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(a, merge), bswap));
+	_mm256_storeu_si256((__m256i*)(ptext + 32), _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(b, merge), bswap));
+}
+#endif
+
+
+template <int ROUNDS>
+static void ice_decrypt_run(const IceSubkey* keysched, int rounds, const unsigned char* ctext, unsigned char* ptext, int nBlocks)
+{
+#ifdef ICE_AVX2
+	if (ice_use_avx2())
+	{
+		for (; nBlocks >= 8; nBlocks -= 8, ctext += 64, ptext += 64)
+			ice_decrypt8_avx2<ROUNDS>(keysched, rounds, ctext, ptext);
+	}
+#endif
+
+	for (; nBlocks >= ICE_LANES; nBlocks -= ICE_LANES, ctext += ICE_LANES * 8, ptext += ICE_LANES * 8)
+		ice_decrypt_lanes<ROUNDS>(keysched, rounds, ctext, ptext);
+
+	for (; nBlocks > 0; nBlocks--, ctext += 8, ptext += 8)
+		ice_decrypt_block<ROUNDS>(keysched, rounds, ctext, ptext);
+}
+
+
+/*
+* Decrypt nBlocks consecutive blocks of 8 bytes with the given ICE key.
+*/
+void IceKey::decryptBlocks(const unsigned char* ctext, unsigned char* ptext, int nBlocks) const
+{
+	if (_rounds == 32)
+		ice_decrypt_run<32>(_keysched, _rounds, ctext, ptext, nBlocks);
+	else
+		ice_decrypt_run<0>(_keysched, _rounds, ctext, ptext, nBlocks);
+}
+
+
 /*
 * Set 8 rounds [n, n+7] of the key schedule of an ICE key.
 */
@@ -292,7 +409,7 @@ void IceKey::scheduleBuild(unsigned short* kb, int n, const int* keyrot)
 		for (j = 0; j<15; j++)
 		{
 			register int	k;
-			unsigned long	*curr_sk = &isk->val[j % 3];
+			unsigned int	*curr_sk = &isk->val[j % 3];
 
 			for (k = 0; k<4; k++) {
 				unsigned short	*curr_kb = &kb[(kr + k) & 3];
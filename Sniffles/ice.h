@@ -19,6 +19,9 @@ Before an IceKey can be used to encrypt data, its key schedule must be set with
 The length of the key required is determined by the level, as described above.
 The member functions encrypt() and decrypt() encrypt and decrypt respectively data
 in blocks of eight chracters, using the specified key.
+decryptBlocks() decrypts nBlocks consecutive blocks (ECB) in one call, working on
+several blocks per round, and with AVX2 when the CPU has it. The output may be
+the input buffer itself, but must not partially overlap it.
 Two functions keySize() and blockSize() are provided
 which return the key and block size respectively, measured in bytes.
 The key size is determined by the level, while the block size is always 8.
@@ -39,6 +42,8 @@ public:
 
 	void	decrypt(const unsigned char *ciphertext, unsigned char *plaintext) const;
 
+	void	decryptBlocks(const unsigned char *ciphertext, unsigned char *plaintext, int nBlocks) const;
+
 	int		keySize() const;
 
 	int		blockSize() const;
@@ -0,0 +1,133 @@
+#include "icekeys.h"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct ice_key_entry_t
+{
+	int				nLevel;
+	std::string		strKey;
+	IceKey*			pIce;
+};
+
+// Defined ahead of g_iceKeys, whose constructor already goes through the cache
+static std::mutex						s_keyCacheMutex;
+static std::vector<ice_key_entry_t>		s_keyCache;
+
+CIceKeyRegistry g_iceKeys;
+
+const IceKey* CIceKeyCache::Get(int nLevel, const unsigned char* pKey)
+{
+	// level 0 (Thin-ICE) still takes an 8 byte key
+	size_t nKeySize = (nLevel < 1 ? 1 : nLevel) * 8;
+	std::string strKey((const char*)pKey, nKeySize);
+
+	std::lock_guard<std::mutex> lock(s_keyCacheMutex);
+
+	for (size_t i = 0; i < s_keyCache.size(); i++)
+	{
+		if (s_keyCache[i].nLevel == nLevel && s_keyCache[i].strKey == strKey)
+			return s_keyCache[i].pIce;
+	}
+
+	ice_key_entry_t entry;
+	entry.nLevel = nLevel;
+	entry.strKey = strKey;
+	entry.pIce = new IceKey(nLevel);
+	entry.pIce->set(pKey);
+
+	s_keyCache.push_back(entry);
+	return entry.pIce;
+}
+
+CIceKeyRegistry::CIceKeyRegistry() : m_nKeys(0)
+{
+	AddBuild(ICE_DEFAULT_BUILD);
+}
+
+void CIceKeyRegistry::MakeBuildKey(int nBuild, unsigned char* pKey)
+{
+	uint32 values[3] = { (uint32)nBuild, (uint32)nBuild >> 2, (uint32)nBuild >> 4 };
+
+	pKey[0] = 'C';
+	pKey[1] = 'S';
+	pKey[2] = 'G';
+	pKey[3] = 'O';
+
+	for (int i = 0; i < 3; i++)
+	{
+		pKey[4 + i * 4 + 0] = (unsigned char)(values[i]);
+		pKey[4 + i * 4 + 1] = (unsigned char)(values[i] >> 8);
+		pKey[4 + i * 4 + 2] = (unsigned char)(values[i] >> 16);
+		pKey[4 + i * 4 + 3] = (unsigned char)(values[i] >> 24);
+	}
+}
+
+bool CIceKeyRegistry::AddBuild(int nBuild)
+{
+	for (int i = 0; i < m_nKeys; i++)
+	{
+		if (m_nBuilds[i] == nBuild)
+			return true;
+	}
+
+	if (m_nKeys >= ICE_MAX_KEYS)
+		return false;
+
+	unsigned char key[ICE_KEY_SIZE];
+	MakeBuildKey(nBuild, key);
+
+	m_nBuilds[m_nKeys] = nBuild;
+	m_pKeys[m_nKeys] = CIceKeyCache::Get(2, key);
+	m_nKeys++;
+	return true;
+}
+
+bool CIceKeyRegistry::CheckFraming(const IceKey& ice, const uint8* pData, uint32 size)
+{
+	if (size < 8)
+		return false;
+
+	uint8 block[8];
+	ice.decrypt(pData, block);
+
+	uint32 deltaOffset = block[0];
+	if (deltaOffset == 0 || deltaOffset + 5 >= size)
+		return false;
+
+	// dataFinalSize is the big endian dword at [deltaOffset + 1, deltaOffset + 5),
+	// which can straddle two blocks or run into the unencrypted tail
+	uint8 header[16];
+	uint32 nFirst = (deltaOffset + 1) / 8;
+	uint32 nLast = (deltaOffset + 4) / 8;
+	uint32 nFullBlocks = size / 8;
+
+	for (uint32 i = nFirst; i <= nLast; i++)
+	{
+		uint8* pOut = &header[(i - nFirst) * 8];
+
+		if (i == 0)
+			memcpy(pOut, block, 8);
+		else if (i < nFullBlocks)
+			ice.decrypt(pData + i * 8, pOut);
+		else
+			memcpy(pOut, pData + i * 8, size - i * 8);
+	}
+
+	const uint8* p = &header[deltaOffset + 1 - nFirst * 8];
+	uint32 dataFinalSize = ((uint32)p[0] << 24) | ((uint32)p[1] << 16) | ((uint32)p[2] << 8) | p[3];
+
+	return dataFinalSize + deltaOffset + 5 == size;
+}
+
+const IceKey* CIceKeyRegistry::Detect(const uint8* pData, uint32 size, const IceKey* pSkip) const
+{
+	for (int i = 0; i < m_nKeys; i++)
+	{
+		if (m_pKeys[i] != pSkip && CheckFraming(*m_pKeys[i], pData, size))
+			return m_pKeys[i];
+	}
+
+	return NULL;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "platform.h"
+#include "ice.h"
+
+// Game build the sniffer is keyed for when no -build is given
+#define ICE_DEFAULT_BUILD		13516
+
+#define ICE_MAX_KEYS			16
+#define ICE_KEY_SIZE			16		// level 2
+
+//-----------------------------------------------------------------------------
+// Key schedules built once per distinct key. Entries are never freed, so the
+// returned key can be kept and shared read-only by every decoder thread.
+//-----------------------------------------------------------------------------
+class CIceKeyCache
+{
+public:
+	static const IceKey*	Get(int nLevel, const unsigned char* pKey);
+};
+
+//-----------------------------------------------------------------------------
+// Every game build we may see on the wire, each with its key schedule. Filled
+// in at startup and read-only once decoding starts.
+//-----------------------------------------------------------------------------
+class CIceKeyRegistry
+{
+public:
+	CIceKeyRegistry();
+
+	// "CSGO" followed by the build number, build >> 2 and build >> 4, little endian
+	static void				MakeBuildKey(int nBuild, unsigned char* pKey);
+
+	// Returns false when the registry is full. Adding a known build is a no-op.
+	bool					AddBuild(int nBuild);
+
+	int						GetKeyCount() const { return m_nKeys; }
+	int						GetBuild(int nIndex) const { return m_nBuilds[nIndex]; }
+	const IceKey*			GetKey(int nIndex) const { return m_pKeys[nIndex]; }
+
+	// Finds the key a datagram was encrypted with. Only the first block and the
+	// block(s) holding the size field are decrypted per candidate; the key has
+	// to produce a sane deltaOffset and a dataFinalSize that matches the
+	// datagram size. Returns NULL when no key fits, pSkip is not tried.
+	const IceKey*			Detect(const uint8* pData, uint32 size, const IceKey* pSkip) const;
+
+	// The cheap framing check Detect runs for a single key
+	static bool				CheckFraming(const IceKey& ice, const uint8* pData, uint32 size);
+
+private:
+	int						m_nKeys;
+	int						m_nBuilds[ICE_MAX_KEYS];
+	const IceKey*			m_pKeys[ICE_MAX_KEYS];
+};
+
+extern CIceKeyRegistry g_iceKeys;
@@ -0,0 +1,536 @@
+// Purpose: Precomputed S-boxes for the ICE encryption algorithm.
+//			Output of ice_sboxes_init() from the public domain code by Matthew Kwan,
+//			http://www.darkside.com.au/ice/ - kept as data so no startup work is needed.
+
+#ifndef _IceSbox_H
+#define _IceSbox_H
+
+/*
+* col = (x >> 1) & 0xff, row = (x & 0x1) | ((x & 0x200) >> 8)
+* ice_sbox[i][x] = ice_perm32(gf_exp7(col ^ ice_sxor[i][row], ice_smod[i][row]) << (24 - 8 * i))
+* 32 bits wide on every platform, so the whole table is 16 KB.
+*/
+static const unsigned int	ice_sbox[4][1024] = {
+	{
+		0x00040842, 0x00041842, 0x02101002, 0x82140042, 0x00000840, 0x80040802, 0x00101000, 0x02000042,
+		0x80141002, 0x00140040, 0x00101842, 0x02001840, 0x82101040, 0x80141000, 0x82140040, 0x00100002,
+		0x02100040, 0x82101800, 0x00001800, 0x80100842, 0x02100042, 0x02000000, 0x00100802, 0x02041802,
+		0x82000842, 0x02040840, 0x80000840, 0x02041002, 0x82141002, 0x80001800, 0x02001840, 0x00001040,
+		0x02101040, 0x02041840, 0x00140002, 0x00001802, 0x80041842, 0x00041800, 0x00100000, 0x80100840,
+		0x80140000, 0x00101042, 0x80001802, 0x02141000, 0x00141040, 0x80101042, 0x00141802, 0x82001840,
+		0x82141840, 0x80140802, 0x82040042, 0x82100800, 0x02101802, 0x82141040, 0x82041800, 0x00101840,
+		0x00001000, 0x80141002, 0x80000800, 0x00141800, 0x80041002, 0x02000040, 0x02040842, 0x80041802,
+		0x00000800, 0x02141802, 0x02140002, 0x02001802, 0x82100840, 0x80040000, 0x02000842, 0x80001840,
+		0x80140800, 0x82001800, 0x80040042, 0x82101000, 0x82101042, 0x82000002, 0x82000840, 0x00040800,
+		0x02101800, 0x02000842, 0x82100802, 0x80141802, 0x00001840, 0x02041040, 0x00101042, 0x82100040,
+		0x82101842, 0x82140000, 0x82140042, 0x82001040, 0x02001802, 0x02141042, 0x00100042, 0x82041800,
+		0x80141842, 0x80040800, 0x02000802, 0x80100000, 0x82041000, 0x80141842, 0x02000040, 0x02140840,
+		0x82101000, 0x82141042, 0x82001840, 0x02001042, 0x00001842, 0x82140040, 0x80040842, 0x02100000,
+		0x82001000, 0x02101040, 0x80101000, 0x00140002, 0x02041002, 0x80041040, 0x00100002, 0x02040000,
+		0x80001042, 0x82101802, 0x82140000, 0x82100840, 0x82100842, 0x02001002, 0x02041040, 0x00001800,
+		0x00140042, 0x00000802, 0x80001840, 0x02101840, 0x02140800, 0x00101002, 0x02041840, 0x82141802,
+		0x00100800, 0x82140842, 0x80101800, 0x02100042, 0x80000802, 0x02041000, 0x02000800, 0x80101800,
+		0x80040840, 0x02141002, 0x00100040, 0x82001002, 0x80040000, 0x00100840, 0x82001042, 0x02000802,
+		0x82041840, 0x02101842, 0x80041000, 0x82140800, 0x02000042, 0x82000802, 0x00140800, 0x02040040,
+		0x02141802, 0x82040802, 0x02100842, 0x82040800, 0x80140802, 0x02140042, 0x80001800, 0x00041840,
+		0x82040040, 0x02101802, 0x02140042, 0x00000042, 0x82000002, 0x80001040, 0x80041802, 0x02040842,
+		0x00041042, 0x82100842, 0x02101840, 0x80041000, 0x82100800, 0x00041002, 0x82001040, 0x02100840,
+		0x82001800, 0x02040802, 0x82000802, 0x80040002, 0x80040802, 0x80041800, 0x00041002, 0x80000842,
+		0x80041840, 0x82001000, 0x00001802, 0x00000800, 0x80001002, 0x82040042, 0x00001002, 0x80140800,
+		0x80100002, 0x00001002, 0x80141802, 0x80141840, 0x80101842, 0x02140002, 0x02141840, 0x80140040,
+		0x00100842, 0x00040002, 0x02040002, 0x02101042, 0x82100002, 0x80101842, 0x82141800, 0x00040040,
+		0x02141842, 0x80100802, 0x02000002, 0x02140000, 0x82041802, 0x00001840, 0x02040840, 0x82000042,
+		0x82000040, 0x02141842, 0x02041800, 0x02100040, 0x00141042, 0x82100000, 0x00000040, 0x80000802,
+		0x82040840, 0x02140040, 0x02001002, 0x80000800, 0x00001042, 0x02001800, 0x82101802, 0x00041802,
+		0x02000840, 0x00140800, 0x02041042, 0x00141040, 0x00041000, 0x00100802, 0x82041040, 0x00141842,
+		0x00040040, 0x80100040, 0x82001002, 0x80040042, 0x00040802, 0x02100800, 0x82001842, 0x80041840,
+		0x82141842, 0x02140800, 0x80000000, 0x00100842, 0x00000002, 0x02041842, 0x00000000, 0x80101802,
+		0x00141800, 0x00000002, 0x02040800, 0x00000000, 0x82140840, 0x82141842, 0x00141840, 0x80000000,
+		0x80041040, 0x82000000, 0x80101802, 0x82101040, 0x82000800, 0x80140840, 0x82140802, 0x02040002,
+		0x02041842, 0x80141800, 0x80141000, 0x00040000, 0x02001000, 0x02101002, 0x02140842, 0x82040842,
+		0x80100840, 0x80140842, 0x80141042, 0x80040040, 0x80140842, 0x02100842, 0x02100000, 0x00140000,
+		0x02141800, 0x00040840, 0x82141000, 0x82140002, 0x02100800, 0x82040002, 0x82140800, 0x80041042,
+		0x02040802, 0x00000842, 0x02100840, 0x82141840, 0x80040040, 0x80100002, 0x00040042, 0x02000840,
+		0x80101840, 0x02000002, 0x82000042, 0x80101840, 0x00041802, 0x80000840, 0x00041800, 0x80101000,
+		0x82140002, 0x02101000, 0x00140040, 0x80001042, 0x80001842, 0x80001842, 0x80140840, 0x82041002,
+		0x00101840, 0x00140842, 0x02000000, 0x00000040, 0x80041042, 0x82100802, 0x82040002, 0x80141040,
+		0x02001042, 0x82041802, 0x00101800, 0x00101040, 0x00000802, 0x80140002, 0x82100000, 0x80041842,
+		0x80101040, 0x00041040, 0x80100842, 0x82101842, 0x02040040, 0x00140802, 0x00000042, 0x82000840,
+		0x80001040, 0x00140840, 0x80000002, 0x00041000, 0x02141040, 0x00100800, 0x00141842, 0x02101800,
+		0x82041842, 0x00141042, 0x82140842, 0x02040042, 0x82041002, 0x82041840, 0x02100002, 0x00001842,
+		0x02041000, 0x02041042, 0x80040002, 0x82000800, 0x82101840, 0x82101002, 0x00040002, 0x02141800,
+		0x00040800, 0x00100000, 0x00141002, 0x00101802, 0x00101002, 0x00040042, 0x82101800, 0x82001042,
+		0x80041800, 0x02141840, 0x00040000, 0x82040000, 0x80000842, 0x00001042, 0x80140040, 0x80000002,
+		0x80141800, 0x80101040, 0x82141040, 0x00141002, 0x00140842, 0x80001002, 0x00040840, 0x82100002,
+		0x80100802, 0x80040840, 0x02141000, 0x00141802, 0x02001842, 0x82101042, 0x02040042, 0x00001000,
+		0x82040842, 0x00141000, 0x00000842, 0x02141040, 0x82040000, 0x02100802, 0x00041842, 0x80140000,
+		0x02140840, 0x82101840, 0x00041040, 0x82100042, 0x82101002, 0x00100040, 0x80001000, 0x82041000,
+		0x80000042, 0x82141800, 0x80101042, 0x02041800, 0x80140002, 0x80100800, 0x02001040, 0x00101800,
+		0x82141042, 0x02040800, 0x80100000, 0x82141002, 0x82100042, 0x80141042, 0x82001802, 0x80001802,
+		0x02141042, 0x82040040, 0x80100042, 0x00000840, 0x80140042, 0x82041842, 0x82000000, 0x02001842,
+		0x02100802, 0x02001040, 0x02140000, 0x00101842, 0x02041802, 0x80100042, 0x02140802, 0x82140840,
+		0x02101842, 0x00041042, 0x00001040, 0x82000842, 0x00141000, 0x02000800, 0x80141840, 0x02140842,
+		0x80000040, 0x82001842, 0x00101040, 0x82000040, 0x82041042, 0x82141000, 0x00140840, 0x80101002,
+		0x82100040, 0x02140802, 0x82141802, 0x00040802, 0x80101002, 0x80000040, 0x00101802, 0x02100002,
+		0x02141002, 0x80001000, 0x00100840, 0x82140802, 0x80100800, 0x82040840, 0x02140040, 0x02001000,
+		0x00140802, 0x80041002, 0x80040800, 0x82001802, 0x80141040, 0x80140042, 0x02001800, 0x82041042,
+		0x82040800, 0x80000042, 0x02040000, 0x00140042, 0x00041840, 0x00101000, 0x02101042, 0x00040842,
+		0x82040802, 0x80040842, 0x02101000, 0x82041040, 0x00140000, 0x00141840, 0x80100040, 0x00100042,
+		0x80000040, 0x80040802, 0x82000800, 0x80041002, 0x80140000, 0x02001042, 0x80001002, 0x02040000,
+		0x02001000, 0x02100000, 0x02100040, 0x80141040, 0x02100002, 0x02040842, 0x80100000, 0x82001800,
+		0x80100842, 0x02101042, 0x00040000, 0x80141002, 0x82000802, 0x82101042, 0x00040040, 0x00001842,
+		0x80041800, 0x80101042, 0x02141802, 0x80140840, 0x02041042, 0x00100840, 0x02001840, 0x02041042,
+		0x80040042, 0x00001800, 0x82040840, 0x82100800, 0x80001802, 0x80000840, 0x82000840, 0x02040800,
+		0x82100842, 0x00001840, 0x80141840, 0x02100042, 0x80101040, 0x82041042, 0x02101002, 0x82041040,
+		0x02040002, 0x80101002, 0x80040002, 0x02000802, 0x80000800, 0x02040042, 0x02040802, 0x80100800,
+		0x82041802, 0x82141840, 0x00141042, 0x80001840, 0x82100802, 0x80141842, 0x80000840, 0x80000040,
+		0x82101002, 0x02140842, 0x00100840, 0x82001842, 0x82041002, 0x00101000, 0x00140040, 0x00001000,
+		0x82140002, 0x82140840, 0x02040042, 0x80041042, 0x80041840, 0x80100002, 0x80001800, 0x00000040,
+		0x00041842, 0x82100042, 0x82041842, 0x82101040, 0x80141042, 0x02100800, 0x02000000, 0x82040800,
+		0x02040000, 0x00140002, 0x82000842, 0x82140800, 0x00040802, 0x02041040, 0x00101802, 0x02140000,
+		0x02100840, 0x80100840, 0x00040840, 0x80001000, 0x80140802, 0x82000840, 0x80040000, 0x02041802,
+		0x00041040, 0x82000000, 0x02140842, 0x02101000, 0x82041840, 0x00041840, 0x02140040, 0x02040802,
+		0x82100002, 0x00140042, 0x82101040, 0x02140840, 0x00141802, 0x80100802, 0x02141800, 0x02140800,
+		0x82000042, 0x02100840, 0x82101842, 0x80141800, 0x80140840, 0x80101040, 0x02000800, 0x80140040,
+		0x80100040, 0x80100000, 0x80141802, 0x82100802, 0x82040802, 0x00100842, 0x82001000, 0x00101800,
+		0x80140042, 0x02101802, 0x02101800, 0x02001040, 0x00101800, 0x02141802, 0x02100802, 0x02000040,
+		0x82140042, 0x00040802, 0x02000040, 0x82001840, 0x02040800, 0x00141802, 0x82141000, 0x80001002,
+		0x80101000, 0x82101842, 0x82100042, 0x02001842, 0x02041002, 0x80140800, 0x80041042, 0x00101802,
+		0x82101802, 0x80100042, 0x02041040, 0x00140040, 0x00001842, 0x80001800, 0x82001042, 0x02141840,
+		0x02100000, 0x82040040, 0x02100842, 0x02140040, 0x00100040, 0x82041800, 0x82000040, 0x02001002,
+		0x02101000, 0x80000800, 0x00000802, 0x02040002, 0x82000002, 0x00101040, 0x82000000, 0x80141802,
+		0x80100840, 0x80100040, 0x02000002, 0x02041842, 0x00040002, 0x82001002, 0x00001840, 0x00100000,
+		0x80040040, 0x80140802, 0x82140840, 0x80101842, 0x00040842, 0x80000042, 0x00101040, 0x02041000,
+		0x00041800, 0x00040040, 0x80141002, 0x02101002, 0x00140802, 0x02040040, 0x02041802, 0x80141840,
+		0x82141040, 0x02140002, 0x82001840, 0x80041040, 0x02101042, 0x02101840, 0x00041002, 0x02100802,
+		0x80041000, 0x80000842, 0x02040842, 0x00040800, 0x00041042, 0x00001040, 0x00000840, 0x00101842,
+		0x00000800, 0x02001802, 0x02140800, 0x82140002, 0x82041042, 0x80141000, 0x80000042, 0x82101000,
+		0x82001800, 0x02000840, 0x00001802, 0x82001000, 0x82140842, 0x02140042, 0x80001040, 0x02000842,
+		0x00101840, 0x02000002, 0x02141040, 0x82040840, 0x02141840, 0x80140042, 0x00041802, 0x82101002,
+		0x00000042, 0x02141042, 0x82041800, 0x82000842, 0x00001002, 0x80101802, 0x02140802, 0x80001040,
+		0x80000842, 0x02100842, 0x80100802, 0x00101042, 0x80141040, 0x80001842, 0x80001000, 0x80040042,
+		0x80140040, 0x02041800, 0x80101802, 0x00041042, 0x82001802, 0x00041842, 0x02040840, 0x02041840,
+		0x02000042, 0x02041002, 0x80041842, 0x02001840, 0x82140040, 0x82141000, 0x00100002, 0x80041840,
+		0x80100042, 0x00140000, 0x02141000, 0x00140802, 0x82101840, 0x82041840, 0x80101840, 0x82141800,
+		0x02041840, 0x00100040, 0x80101042, 0x80101840, 0x80140842, 0x82140040, 0x00100042, 0x00000042,
+		0x02001800, 0x82140842, 0x82140800, 0x00100042, 0x80101842, 0x00141040, 0x82100040, 0x82000802,
+		0x82141842, 0x00140840, 0x80000000, 0x00141042, 0x00000002, 0x80000002, 0x00000000, 0x82040000,
+		0x00140002, 0x82040002, 0x00141002, 0x80041802, 0x02141042, 0x80041842, 0x80041002, 0x82041002,
+		0x00100000, 0x02100002, 0x80140800, 0x82001802, 0x80140002, 0x00100802, 0x02101840, 0x02040840,
+		0x80141800, 0x82100000, 0x00040800, 0x02000800, 0x00101042, 0x82101840, 0x02041800, 0x82000042,
+		0x80040840, 0x00041802, 0x00000040, 0x80000802, 0x02001842, 0x80040840, 0x80001842, 0x82140000,
+		0x02141002, 0x80101000, 0x82101042, 0x00100002, 0x00041000, 0x80001802, 0x02001040, 0x80101800,
+		0x02101040, 0x82101802, 0x80040802, 0x82140042, 0x82100000, 0x82141040, 0x00100802, 0x00040840,
+		0x00001042, 0x80040040, 0x80141000, 0x82040842, 0x82001842, 0x02141002, 0x82040040, 0x80041000,
+		0x00101842, 0x82100002, 0x80100800, 0x00040002, 0x02140840, 0x00040842, 0x82041000, 0x00140800,
+		0x00140800, 0x82001040, 0x82001002, 0x02141000, 0x80041802, 0x00100800, 0x82040002, 0x00040042,
+		0x80040842, 0x00140842, 0x02001802, 0x80001042, 0x02001042, 0x02000000, 0x82141800, 0x82140802,
+		0x00100800, 0x00041002, 0x02101842, 0x00041040, 0x02001002, 0x80141042, 0x82141042, 0x82100842,
+		0x00001040, 0x02141842, 0x02140002, 0x82041000, 0x82041040, 0x80140000, 0x82040042, 0x00141842,
+		0x82040842, 0x00000002, 0x00000842, 0x00000000, 0x00001000, 0x82141842, 0x00141840, 0x80000000,
+		0x80001840, 0x80140842, 0x00101000, 0x82141042, 0x00141842, 0x00000800, 0x80000802, 0x02101800,
+		0x00141000, 0x00141800, 0x02141842, 0x80041800, 0x02140000, 0x82101800, 0x80141842, 0x00141840,
+		0x02000802, 0x00041800, 0x00140840, 0x80040002, 0x02100042, 0x00141002, 0x00040042, 0x80140002,
+		0x80040800, 0x80100842, 0x00141800, 0x82041842, 0x82140802, 0x00000802, 0x82001040, 0x00101840,
+		0x80101002, 0x82000040, 0x00140842, 0x02140802, 0x00101002, 0x00101002, 0x80000002, 0x00041000,
+		0x82141840, 0x02001000, 0x82140000, 0x02000042, 0x80001042, 0x80040842, 0x00100842, 0x02001800,
+		0x80101800, 0x82040042, 0x02101802, 0x00040000, 0x82100800, 0x00000840, 0x00001800, 0x02100040,
+		0x00140042, 0x02101842, 0x02041000, 0x00001002, 0x00140000, 0x02101040, 0x82100840, 0x82141802,
+		0x02100800, 0x00141000, 0x00141040, 0x00001802, 0x02000840, 0x02141800, 0x02041842, 0x82100040,
+		0x82101800, 0x00000842, 0x02040040, 0x82041802, 0x02140042, 0x82000002, 0x00041840, 0x82100840,
+		0x80100002, 0x80040000, 0x82040800, 0x00001042, 0x82040000, 0x82000800, 0x82141802, 0x82040802,
+		0x82101000, 0x82141002, 0x02000842, 0x80040800, 0x80041040, 0x82001042, 0x82141002, 0x02141040,
+	},
+	{
+		0x00020004, 0x08000014, 0x08020214, 0x10400000, 0x00000200, 0x18020004, 0x08420014, 0x08400210,
+		0x10408214, 0x08000200, 0x08428014, 0x08028000, 0x10400010, 0x18408010, 0x00408204, 0x18400000,
+		0x10000004, 0x18020014, 0x00028200, 0x08408014, 0x10008200, 0x10020200, 0x18400210, 0x00008000,
+		0x18020210, 0x18000004, 0x08420200, 0x18028014, 0x10408010, 0x08008004, 0x10020204, 0x00420204,
+		0x10408200, 0x10420214, 0x10400004, 0x10420210, 0x18008000, 0x00008004, 0x10028004, 0x08400200,
+		0x18400200, 0x18428004, 0x00000010, 0x08000004, 0x08400200, 0x10028200, 0x10420200, 0x00008010,
+		0x00408210, 0x18000010, 0x18020004, 0x08020004, 0x08000214, 0x18008004, 0x00400010, 0x08000210,
+		0x00028204, 0x18420210, 0x10400200, 0x10000004, 0x18428004, 0x18020204, 0x10420000, 0x18428200,
+		0x08400004, 0x08408004, 0x08008014, 0x10408010, 0x08008004, 0x00028000, 0x10008214, 0x08000000,
+		0x00420210, 0x18008010, 0x10428200, 0x18420000, 0x08400010, 0x08008214, 0x08408210, 0x10408200,
+		0x08028214, 0x18008000, 0x00408014, 0x08420010, 0x10408000, 0x08420004, 0x18420210, 0x00400000,
+		0x00008210, 0x18028210, 0x08420214, 0x18000000, 0x18408200, 0x08400000, 0x18020204, 0x18020214,
+		0x18000214, 0x10008210, 0x08428204, 0x18400014, 0x00400014, 0x00000014, 0x00028000, 0x18008204,
+		0x08000204, 0x10400010, 0x00400210, 0x08420000, 0x00400004, 0x00428200, 0x10408004, 0x00008214,
+		0x10028014, 0x10428210, 0x08020210, 0x08400014, 0x10420204, 0x10028014, 0x00428214, 0x10020204,
+		0x10008204, 0x08008000, 0x00420200, 0x08420214, 0x08008010, 0x10008204, 0x18028210, 0x00400014,
+		0x08000010, 0x08428210, 0x18400014, 0x18420204, 0x18028004, 0x18008210, 0x00408010, 0x00400004,
+		0x18420200, 0x10420004, 0x00400214, 0x08028014, 0x10420010, 0x08420200, 0x08028004, 0x10428000,
+		0x00420010, 0x18008214, 0x18000010, 0x08008200, 0x00420204, 0x00420014, 0x08020004, 0x10400200,
+		0x00028210, 0x08000204, 0x00420004, 0x18428010, 0x10408204, 0x00428214, 0x08428200, 0x18020210,
+		0x08008200, 0x00420200, 0x00428210, 0x00428004, 0x10008210, 0x10028204, 0x18000014, 0x18008200,
+		0x08420000, 0x08020210, 0x00008004, 0x08428200, 0x10020014, 0x08408204, 0x10428214, 0x08028004,
+		0x08408214, 0x08028204, 0x08400204, 0x10020004, 0x00400200, 0x18028000, 0x18020214, 0x00428000,
+		0x08028014, 0x00020204, 0x18420214, 0x10400014, 0x08028000, 0x18420004, 0x08400214, 0x00408004,
+		0x18420204, 0x18028004, 0x10028214, 0x18000200, 0x00028014, 0x08008014, 0x18428210, 0x18428204,
+		0x18408010, 0x08408000, 0x18000000, 0x00020010, 0x10428204, 0x08000214, 0x08420010, 0x18020200,
+		0x08428010, 0x00428014, 0x18000200, 0x00008200, 0x18008214, 0x18428000, 0x00428000, 0x00020200,
+		0x00020000, 0x08408214, 0x08000014, 0x08400010, 0x08420204, 0x18400010, 0x00000204, 0x08420210,
+		0x00420000, 0x10008004, 0x08020010, 0x08028210, 0x00428010, 0x18020010, 0x10428010, 0x10020210,
+		0x10000210, 0x08020014, 0x18028204, 0x10400204, 0x18008004, 0x08020010, 0x00028010, 0x08420204,
+		0x10028200, 0x18000214, 0x00000014, 0x18420014, 0x18028000, 0x10408204, 0x08400014, 0x08428010,
+		0x18008204, 0x10020214, 0x18000210, 0x18028214, 0x10400204, 0x08020200, 0x18400000, 0x10428204,
+		0x10020010, 0x00008204, 0x00428014, 0x18408210, 0x18408000, 0x10408214, 0x18420000, 0x10428214,
+		0x18400004, 0x10000210, 0x00020214, 0x18408014, 0x18428204, 0x08428014, 0x18020000, 0x10400214,
+		0x10400000, 0x10408014, 0x10008010, 0x10028214, 0x00028004, 0x10420000, 0x08000200, 0x00000214,
+		0x00428204, 0x10028010, 0x18400204, 0x08428204, 0x10008014, 0x00408204, 0x08008210, 0x00008014,
+		0x10020210, 0x10428004, 0x10008000, 0x00020004, 0x00408214, 0x08400204, 0x18408204, 0x00000210,
+		0x10428014, 0x00008210, 0x10000014, 0x08408210, 0x10028000, 0x08408010, 0x00020210, 0x10000014,
+		0x10028204, 0x08028214, 0x00408004, 0x18408004, 0x18420010, 0x08028010, 0x08028200, 0x08020214,
+		0x18008200, 0x00428204, 0x18420014, 0x00028210, 0x08020000, 0x08420014, 0x00028214, 0x10408004,
+		0x08408200, 0x18028204, 0x08408204, 0x00408010, 0x10420214, 0x10420200, 0x18028010, 0x08428214,
+		0x18008014, 0x18428214, 0x10400214, 0x10000000, 0x00020010, 0x00000004, 0x08428000, 0x00000000,
+		0x08000004, 0x00028204, 0x08000210, 0x00028214, 0x10028210, 0x18020000, 0x00420014, 0x10028210,
+		0x18400214, 0x00400204, 0x00400000, 0x18420010, 0x08020014, 0x10008200, 0x08020200, 0x08020204,
+		0x18028200, 0x18028200, 0x10420004, 0x00408200, 0x08428004, 0x00028014, 0x00020204, 0x18408214,
+		0x00000210, 0x00000200, 0x08428214, 0x00428010, 0x08028204, 0x10420014, 0x08008214, 0x18008014,
+		0x10428000, 0x00408000, 0x18428010, 0x18400200, 0x00008200, 0x00408014, 0x10008004, 0x10020014,
+		0x18420004, 0x10000204, 0x00008010, 0x18028010, 0x18020010, 0x00000204, 0x10000200, 0x08408200,
+		0x10400014, 0x18000014, 0x10428004, 0x00420010, 0x10408210, 0x18000210, 0x08400210, 0x18420200,
+		0x08400000, 0x18428014, 0x18000204, 0x00028010, 0x18008210, 0x18408000, 0x18020014, 0x10008000,
+		0x08028210, 0x08000010, 0x08008204, 0x00420214, 0x00020200, 0x08400214, 0x00020014, 0x10400004,
+		0x00000000, 0x10020000, 0x00000004, 0x10408000, 0x10000000, 0x08020000, 0x18428214, 0x10028004,
+		0x18408210, 0x08428000, 0x18028014, 0x10400210, 0x00008000, 0x00420210, 0x10000010, 0x00020014,
+		0x00008214, 0x10028000, 0x18428200, 0x00020000, 0x10420210, 0x00400214, 0x10020000, 0x00020210,
+		0x08408014, 0x10000200, 0x08428210, 0x00020214, 0x18028214, 0x10008010, 0x10420014, 0x10020010,
+		0x10000204, 0x18400004, 0x18428014, 0x08428004, 0x00000214, 0x18408204, 0x08408010, 0x10428200,
+		0x10428210, 0x10420204, 0x10408014, 0x18400210, 0x08028010, 0x10428010, 0x08000000, 0x18400204,
+		0x18408004, 0x18428210, 0x08420004, 0x10428014, 0x18008010, 0x00408214, 0x00420214, 0x00400200,
+		0x00008204, 0x00420000, 0x10020200, 0x18000204, 0x08408004, 0x00000010, 0x00428004, 0x10008014,
+		0x00408000, 0x00420004, 0x10020004, 0x10008214, 0x18400010, 0x00408210, 0x18428000, 0x10408210,
+		0x10020214, 0x10420010, 0x08420210, 0x10000010, 0x00400204, 0x00400210, 0x10400210, 0x00400010,
+		0x18000004, 0x18400214, 0x18020200, 0x10000214, 0x08008000, 0x08008010, 0x08020204, 0x08028200,
+		0x00408200, 0x00428210, 0x08408000, 0x08400004, 0x00008014, 0x18420214, 0x18408014, 0x18408200,
+		0x10028010, 0x08008210, 0x10000214, 0x00028200, 0x18408214, 0x08008204, 0x00428200, 0x00028004,
+		0x10408014, 0x00408014, 0x08000204, 0x00008214, 0x00020014, 0x10428200, 0x10428204, 0x00000214,
+		0x10428004, 0x10420214, 0x00408200, 0x10428004, 0x10008014, 0x08420210, 0x10020014, 0x00008200,
+		0x18000014, 0x18408004, 0x08408204, 0x08028210, 0x18420214, 0x10000010, 0x00400010, 0x08028000,
+		0x18408004, 0x08408210, 0x18020010, 0x00420210, 0x10420010, 0x08028014, 0x00428214, 0x10000204,
+		0x00428014, 0x10008200, 0x10408210, 0x10400210, 0x18000000, 0x00408000, 0x10020000, 0x18408014,
+		0x10400204, 0x00020014, 0x00020004, 0x08400200, 0x18400004, 0x08020004, 0x08028204, 0x00400200,
+		0x10020004, 0x00428200, 0x00400014, 0x18420210, 0x00008204, 0x00408010, 0x08000004, 0x18428014,
+		0x10028214, 0x00408204, 0x18400010, 0x08428214, 0x08028004, 0x18020204, 0x00020214, 0x08420214,
+		0x00408204, 0x10020210, 0x08420210, 0x08020010, 0x00000200, 0x10000210, 0x10008204, 0x18400010,
+		0x10000010, 0x10428210, 0x08420000, 0x18008204, 0x08400204, 0x10428014, 0x10008000, 0x10000014,
+		0x08020014, 0x08008200, 0x00428200, 0x08020014, 0x10408214, 0x08400014, 0x00408004, 0x00408210,
+		0x08008200, 0x08420204, 0x08400200, 0x00028000, 0x10028014, 0x08000214, 0x10020214, 0x10020014,
+		0x18028210, 0x08008014, 0x10008200, 0x00400000, 0x10028004, 0x00400010, 0x10028200, 0x10028214,
+		0x18408000, 0x18000210, 0x08008004, 0x08408204, 0x08020200, 0x00008010, 0x08408214, 0x10028200,
+		0x10020204, 0x00428204, 0x10020200, 0x18428210, 0x18408200, 0x00400204, 0x10000004, 0x18000010,
+		0x10428014, 0x00420200, 0x10400214, 0x18420010, 0x18028200, 0x10000004, 0x08400004, 0x10008000,
+		0x08428200, 0x00000004, 0x18400000, 0x00000000, 0x00020000, 0x18428214, 0x18408014, 0x10000000,
+		0x00008004, 0x18400000, 0x08408000, 0x08428010, 0x10408204, 0x00400014, 0x08400210, 0x00408200,
+		0x10408004, 0x10008204, 0x10400200, 0x08028214, 0x08020210, 0x18000200, 0x00000214, 0x10028010,
+		0x18000214, 0x08008204, 0x18028004, 0x18000004, 0x00020204, 0x00420004, 0x10028010, 0x18028010,
+		0x00400210, 0x00420010, 0x08400010, 0x10008014, 0x08028200, 0x08020214, 0x18428010, 0x18400210,
+		0x00428004, 0x10020000, 0x18028010, 0x18000204, 0x10428210, 0x08428000, 0x08420010, 0x18008210,
+		0x08420214, 0x18028210, 0x18000204, 0x18000214, 0x08420204, 0x08000010, 0x00028210, 0x10400004,
+		0x18028014, 0x18008000, 0x00400000, 0x18428000, 0x18000004, 0x18020004, 0x00408210, 0x18420000,
+		0x00008010, 0x00000014, 0x10408000, 0x18408000, 0x18400014, 0x08028204, 0x10420200, 0x18420214,
+		0x08420004, 0x08428004, 0x18428200, 0x10020200, 0x00020200, 0x08028004, 0x10400004, 0x00028210,
+		0x18420000, 0x00428210, 0x10420214, 0x08008210, 0x18020014, 0x00020200, 0x08028010, 0x18020214,
+		0x00028000, 0x08408214, 0x10028210, 0x18028200, 0x08020010, 0x00420014, 0x18020214, 0x18028000,
+		0x08400014, 0x00428014, 0x08408014, 0x18008004, 0x10420004, 0x10420200, 0x18008004, 0x08420004,
+		0x08400214, 0x10400200, 0x00028010, 0x00400214, 0x00008200, 0x18400204, 0x18008200, 0x10428010,
+		0x18408010, 0x10428000, 0x08400000, 0x10400010, 0x00028004, 0x00008204, 0x18028000, 0x18020010,
+		0x18020204, 0x10028004, 0x18000200, 0x00420214, 0x08428010, 0x18408010, 0x18408204, 0x08408010,
+		0x10000204, 0x08400000, 0x00008014, 0x00020214, 0x00408014, 0x18408210, 0x10428214, 0x18028004,
+		0x00020010, 0x08420000, 0x10000210, 0x00028204, 0x08000210, 0x10420010, 0x00000204, 0x08420200,
+		0x10420014, 0x08020000, 0x08008204, 0x18028014, 0x08408010, 0x10408000, 0x10420204, 0x10020004,
+		0x08428210, 0x00408004, 0x08420200, 0x08428204, 0x10428000, 0x10020204, 0x08028210, 0x10028000,
+		0x18028214, 0x00420204, 0x18420210, 0x10020214, 0x10020010, 0x10420204, 0x00400200, 0x00400004,
+		0x00428210, 0x10008004, 0x08020214, 0x08000210, 0x10428200, 0x18420204, 0x10000214, 0x18400214,
+		0x00400204, 0x00020204, 0x00028014, 0x00428000, 0x18420200, 0x10408204, 0x08408210, 0x08000200,
+		0x00420210, 0x08020204, 0x10400210, 0x18020000, 0x18008204, 0x00028004, 0x00420200, 0x10420014,
+		0x10408010, 0x18420004, 0x10008004, 0x18028204, 0x00400004, 0x18428200, 0x10008010, 0x10408214,
+		0x18400200, 0x08400214, 0x00008214, 0x18008200, 0x18020004, 0x08400204, 0x08428214, 0x08028010,
+		0x10028204, 0x18400200, 0x10428010, 0x08428200, 0x00428000, 0x08028200, 0x10408200, 0x08008004,
+		0x00000004, 0x00020004, 0x00000000, 0x18008014, 0x18428214, 0x10408210, 0x10000000, 0x00020010,
+		0x10008214, 0x18420200, 0x08428004, 0x10408200, 0x18008010, 0x10428204, 0x00420004, 0x18408200,
+		0x10400010, 0x08408000, 0x18000210, 0x18000000, 0x08408200, 0x10028210, 0x18008000, 0x18020200,
+		0x10000014, 0x00408214, 0x00020210, 0x10420000, 0x00000014, 0x10028204, 0x10400000, 0x18428004,
+		0x18020200, 0x08000204, 0x00428204, 0x18408214, 0x00428010, 0x08000000, 0x00408000, 0x18428010,
+		0x10420000, 0x18020014, 0x08020004, 0x00028014, 0x00420014, 0x00400210, 0x18408214, 0x08008214,
+		0x18428004, 0x18408204, 0x10000200, 0x10008210, 0x18000010, 0x00428214, 0x08008214, 0x00020210,
+		0x08008000, 0x08408014, 0x00008000, 0x00028214, 0x10400014, 0x10400014, 0x18400204, 0x10000200,
+		0x08428000, 0x00000210, 0x08008010, 0x00028200, 0x18008210, 0x18400004, 0x00420214, 0x08000014,
+		0x00408010, 0x10400000, 0x18008214, 0x00008014, 0x00028214, 0x18420014, 0x08000010, 0x10008214,
+		0x18420014, 0x08420010, 0x18020000, 0x00000204, 0x08008014, 0x10420210, 0x00028204, 0x18428204,
+		0x08028000, 0x00028010, 0x08428014, 0x08428210, 0x18408210, 0x00428010, 0x08008210, 0x08428014,
+		0x08020000, 0x00008210, 0x08028014, 0x08420014, 0x10008210, 0x10420004, 0x18008014, 0x00000010,
+		0x18420204, 0x00420000, 0x00420010, 0x10408004, 0x08000214, 0x08400004, 0x00408214, 0x08400210,
+		0x18020210, 0x10400214, 0x08028214, 0x00008000, 0x10028000, 0x10020010, 0x08420014, 0x08008000,
+		0x00420204, 0x00000200, 0x00400214, 0x08408004, 0x10420210, 0x10408014, 0x00420000, 0x10408010,
+		0x18400214, 0x18008010, 0x08020204, 0x08020200, 0x08428204, 0x00008004, 0x10020210, 0x00020000,
+		0x08000000, 0x08400010, 0x18420004, 0x00428004, 0x08408004, 0x18028214, 0x18420010, 0x08408200,
+		0x18400210, 0x10428214, 0x08000014, 0x10400204, 0x00000210, 0x18020210, 0x08000200, 0x18008214,
+		0x18428204, 0x10008010, 0x18428210, 0x08020210, 0x00008210, 0x10000214, 0x00028200, 0x08000004,
+		0x00000010, 0x10028014, 0x18428014, 0x18000014, 0x18028204, 0x08008010, 0x18428000, 0x18400014,
+	},
+	{
+		0x24004128, 0x00804028, 0x04000000, 0x20804020, 0x24000020, 0x20000028, 0x20810120, 0x00010020,
+		0x24004000, 0x04004100, 0x00014100, 0x20804100, 0x24800108, 0x04000028, 0x24004100, 0x20004020,
+		0x20804128, 0x00800120, 0x04010020, 0x00800128, 0x00810000, 0x00804108, 0x04000020, 0x04000000,
+		0x00004020, 0x24004100, 0x20810108, 0x04800020, 0x00004120, 0x04814008, 0x00814000, 0x20000020,
+		0x20804008, 0x04804020, 0x24014028, 0x24814100, 0x04010108, 0x24014008, 0x20800020, 0x20804108,
+		0x20800000, 0x20000128, 0x20014108, 0x20814128, 0x20800108, 0x24804000, 0x00014028, 0x00004028,
+		0x24014008, 0x24814028, 0x00004100, 0x24010120, 0x00004008, 0x24004108, 0x00804108, 0x04814120,
+		0x24000100, 0x04004120, 0x04000128, 0x00000028, 0x04010120, 0x20814108, 0x00800020, 0x04010128,
+		0x00000128, 0x20810128, 0x04804108, 0x00010008, 0x20000108, 0x24810100, 0x24814028, 0x04804008,
+		0x24004028, 0x00810128, 0x20800128, 0x04810000, 0x00010100, 0x20804028, 0x04804020, 0x24804120,
+		0x20814000, 0x00004100, 0x00810108, 0x04014100, 0x20004008, 0x04004020, 0x04800100, 0x04014108,
+		0x24810008, 0x20000000, 0x04800028, 0x24814128, 0x00800120, 0x00000000, 0x24010020, 0x00000008,
+		0x04014008, 0x24800120, 0x04004020, 0x24804128, 0x00010020, 0x00014020, 0x04804028, 0x24014020,
+		0x04814128, 0x04014020, 0x04814120, 0x04814108, 0x20810000, 0x00000020, 0x24014108, 0x24010108,
+		0x24014128, 0x20004128, 0x24814120, 0x04004028, 0x20014008, 0x04010000, 0x20800120, 0x00800008,
+		0x24004020, 0x24804020, 0x24800000, 0x24004120, 0x20810028, 0x20004000, 0x20000008, 0x00800000,
+		0x20814020, 0x04810028, 0x00014108, 0x00000120, 0x24004108, 0x24004028, 0x04800000, 0x20800028,
+		0x04800120, 0x24000120, 0x20800008, 0x24000000, 0x24010008, 0x00014028, 0x00014020, 0x00814008,
+		0x24814128, 0x00814108, 0x20000000, 0x04810120, 0x00000008, 0x04804100, 0x00000000, 0x04000120,
+		0x00010108, 0x20814008, 0x00010028, 0x04004128, 0x20010000, 0x20010100, 0x24804120, 0x00814020,
+		0x20014000, 0x00810008, 0x24804020, 0x20000008, 0x04010008, 0x04800128, 0x04010128, 0x00814000,
+		0x04000108, 0x24810020, 0x04000028, 0x24814120, 0x20010108, 0x20814020, 0x24800008, 0x04800000,
+		0x04814008, 0x00804008, 0x00000120, 0x20014100, 0x20000128, 0x20810000, 0x24814000, 0x20010120,
+		0x00800100, 0x00004120, 0x00810120, 0x24004008, 0x04814000, 0x20010000, 0x04804100, 0x24814108,
+		0x00810128, 0x00810120, 0x24000120, 0x24804108, 0x24810028, 0x20810120, 0x24800128, 0x04014028,
+		0x20010008, 0x00800108, 0x04014108, 0x00004108, 0x24804000, 0x20814000, 0x24000128, 0x20014128,
+		0x04804008, 0x04010100, 0x24010108, 0x24000128, 0x00000108, 0x20014028, 0x00804000, 0x04000020,
+		0x24014120, 0x24810128, 0x04000120, 0x04014008, 0x20810100, 0x00814100, 0x20814028, 0x24800008,
+		0x24804128, 0x00004000, 0x04004128, 0x20804120, 0x20804108, 0x24000020, 0x20010120, 0x20800000,
+		0x20804100, 0x24014028, 0x00800108, 0x04000008, 0x20004020, 0x04810128, 0x20014120, 0x00010000,
+		0x00814100, 0x04810020, 0x00000100, 0x20800128, 0x04804000, 0x24010008, 0x20814128, 0x20814100,
+		0x24014000, 0x24000100, 0x24010000, 0x24800028, 0x04010028, 0x00014000, 0x20810020, 0x20814120,
+		0x20004128, 0x04814100, 0x00810100, 0x24000028, 0x00014008, 0x00810020, 0x00000028, 0x04810008,
+		0x04014120, 0x00010100, 0x04800108, 0x04000128, 0x20004108, 0x20004008, 0x00010008, 0x00014128,
+		0x20014128, 0x20014120, 0x20800028, 0x00814028, 0x24000028, 0x20804000, 0x00804020, 0x20004108,
+		0x24814020, 0x20804008, 0x04014128, 0x00804120, 0x04014000, 0x04010108, 0x00804120, 0x04804028,
+		0x00814008, 0x24004128, 0x00800008, 0x24814000, 0x20014028, 0x00810028, 0x04014100, 0x00004020,
+		0x00810008, 0x20000120, 0x20814108, 0x20010020, 0x00004128, 0x24010020, 0x04014020, 0x24810008,
+		0x24810120, 0x20800108, 0x20814100, 0x20810028, 0x00800000, 0x00000128, 0x24000008, 0x04800028,
+		0x24814100, 0x04800120, 0x00814028, 0x20014108, 0x00004108, 0x04810108, 0x04800128, 0x24000108,
+		0x04810000, 0x20010108, 0x04814028, 0x04800100, 0x00804028, 0x20000100, 0x04804120, 0x20800020,
+		0x24804028, 0x20014000, 0x00814108, 0x00000108, 0x20004000, 0x00800020, 0x00010120, 0x04010008,
+		0x04004008, 0x24810000, 0x04010000, 0x04804108, 0x24814008, 0x00814128, 0x24014020, 0x00004008,
+		0x04000008, 0x00800028, 0x20014100, 0x00014100, 0x04810020, 0x04014120, 0x20010028, 0x24810028,
+		0x20814120, 0x24010128, 0x20010020, 0x00010120, 0x24804008, 0x24010000, 0x24810108, 0x00810100,
+		0x00014000, 0x04004108, 0x24814108, 0x00804128, 0x20804120, 0x20014020, 0x04814108, 0x24800100,
+		0x04810008, 0x04810100, 0x20014020, 0x24800020, 0x04810028, 0x20004028, 0x24014100, 0x04000100,
+		0x24810020, 0x24800108, 0x24004008, 0x00014120, 0x20804020, 0x24010028, 0x24010028, 0x04004000,
+		0x24800020, 0x24014000, 0x04810120, 0x20804128, 0x04810108, 0x04814128, 0x20810008, 0x24814008,
+		0x20004028, 0x04010120, 0x20800100, 0x24014128, 0x20814008, 0x24800000, 0x24000000, 0x20800008,
+		0x24000108, 0x24014100, 0x04814100, 0x00004128, 0x20000028, 0x04004008, 0x00014120, 0x00010128,
+		0x20004100, 0x20810008, 0x20010128, 0x04010020, 0x24010100, 0x00804100, 0x24804108, 0x04814028,
+		0x04014028, 0x24004020, 0x04000100, 0x24800128, 0x20810128, 0x00804020, 0x20000120, 0x00000100,
+		0x24800100, 0x20014008, 0x04010100, 0x20000108, 0x04810100, 0x00010028, 0x24804100, 0x00810108,
+		0x00010128, 0x20004100, 0x24810000, 0x00814120, 0x20010100, 0x04814000, 0x00804008, 0x20810108,
+		0x00814120, 0x24804008, 0x04804128, 0x20800100, 0x04814020, 0x04804120, 0x04810128, 0x04800108,
+		0x20804000, 0x24810108, 0x00814128, 0x04000108, 0x24004120, 0x24014120, 0x24800120, 0x20810100,
+		0x00814020, 0x04014128, 0x04004028, 0x20010008, 0x20000100, 0x00014108, 0x04004100, 0x00810000,
+		0x04800020, 0x24804100, 0x04004108, 0x20004120, 0x24810100, 0x04010028, 0x00010000, 0x20010128,
+		0x24810128, 0x00800100, 0x00800128, 0x24810120, 0x00000020, 0x24804028, 0x00014128, 0x20800120,
+		0x20804028, 0x04814020, 0x00810028, 0x00804000, 0x20004120, 0x20810020, 0x24010128, 0x24004000,
+		0x00004028, 0x20814028, 0x04800008, 0x04014000, 0x00804128, 0x04800008, 0x20000020, 0x20010028,
+		0x00800028, 0x04804128, 0x24010120, 0x24010100, 0x04004000, 0x00010108, 0x00004000, 0x24814020,
+		0x00810020, 0x00014008, 0x00804100, 0x24014108, 0x24800028, 0x04804000, 0x04004120, 0x24000008,
+		0x20000008, 0x00014108, 0x00804100, 0x24800000, 0x00010008, 0x00810028, 0x04004128, 0x24800100,
+		0x24000028, 0x04010120, 0x24000128, 0x20000008, 0x24014008, 0x00814128, 0x04010020, 0x00004028,
+		0x20804020, 0x20000020, 0x20014000, 0x04804108, 0x00004028, 0x00810120, 0x24004108, 0x00804020,
+		0x00004128, 0x04814028, 0x00014128, 0x04000108, 0x20004028, 0x24810008, 0x00010028, 0x24810108,
+		0x00014028, 0x00804128, 0x00814028, 0x24814108, 0x24004100, 0x24010108, 0x24810120, 0x24800020,
+		0x20004000, 0x20804128, 0x04810108, 0x04800008, 0x24010028, 0x20800000, 0x04004000, 0x04000020,
+		0x00814000, 0x24014100, 0x24000020, 0x24010100, 0x04800000, 0x20014000, 0x20000128, 0x20804100,
+		0x24014020, 0x00804028, 0x04810120, 0x24000100, 0x20800008, 0x24800028, 0x04804100, 0x24814008,
+		0x20800000, 0x20000028, 0x20814128, 0x20004020, 0x04004120, 0x04010000, 0x04804108, 0x24804000,
+		0x20004020, 0x04014128, 0x24004000, 0x24004000, 0x00800100, 0x20804000, 0x00800120, 0x04000128,
+		0x04014108, 0x00800128, 0x24800100, 0x24010128, 0x20800128, 0x20800100, 0x00800108, 0x00814100,
+		0x00010120, 0x04814000, 0x04814008, 0x24804108, 0x00000028, 0x20800120, 0x00804028, 0x20010020,
+		0x00004120, 0x24814128, 0x04004108, 0x20000000, 0x20814000, 0x00000008, 0x00804120, 0x00000000,
+		0x00810100, 0x04800100, 0x04014120, 0x20810028, 0x24000100, 0x00004100, 0x00000128, 0x04804100,
+		0x24014108, 0x04814020, 0x04814108, 0x00810100, 0x24000008, 0x24810000, 0x20810028, 0x00014008,
+		0x00010000, 0x20800128, 0x00010020, 0x20814020, 0x24800108, 0x24000020, 0x04004008, 0x20810008,
+		0x00004020, 0x20010028, 0x00010108, 0x24004020, 0x24014028, 0x04000100, 0x20004008, 0x00810108,
+		0x04014008, 0x00804008, 0x24814020, 0x24800008, 0x00800028, 0x20810000, 0x20810008, 0x20014008,
+		0x24000120, 0x04810000, 0x00810020, 0x00004020, 0x04810100, 0x00010120, 0x24004020, 0x20014108,
+		0x20010120, 0x04014000, 0x04010108, 0x04004000, 0x00800000, 0x00004008, 0x24010108, 0x00800008,
+		0x04814120, 0x20810128, 0x24014120, 0x24014108, 0x04014000, 0x04014028, 0x04014100, 0x24010120,
+		0x04010100, 0x20810020, 0x00814100, 0x04814128, 0x24014128, 0x20800020, 0x04804128, 0x04000008,
+		0x04004028, 0x04804000, 0x04000108, 0x24804008, 0x20810000, 0x00010008, 0x00014108, 0x20804120,
+		0x24810100, 0x00814020, 0x20814008, 0x24800128, 0x00004108, 0x24000120, 0x20014128, 0x24804100,
+		0x24804128, 0x20000128, 0x00010128, 0x00000100, 0x20814020, 0x04810028, 0x24000000, 0x04000028,
+		0x20004128, 0x00000028, 0x00814128, 0x20800108, 0x20814028, 0x24014020, 0x24810108, 0x00000120,
+		0x24014000, 0x00000128, 0x24810020, 0x04004100, 0x24004028, 0x20004000, 0x04800100, 0x20804008,
+		0x00814108, 0x00800000, 0x24010100, 0x20810108, 0x24800000, 0x24814028, 0x24810000, 0x24004108,
+		0x04000100, 0x04804128, 0x24010020, 0x20000120, 0x24814008, 0x04014008, 0x00000100, 0x24004100,
+		0x20014100, 0x24014000, 0x00810120, 0x00800020, 0x04000120, 0x04810008, 0x24814028, 0x00814120,
+		0x20804100, 0x20014120, 0x20804108, 0x04810128, 0x24804008, 0x24810128, 0x20000100, 0x20814028,
+		0x04800128, 0x04004128, 0x24010008, 0x04004120, 0x24804020, 0x24000000, 0x04004100, 0x20804108,
+		0x00804008, 0x00014128, 0x04814000, 0x24004128, 0x20014120, 0x00814008, 0x20014020, 0x04010100,
+		0x20800120, 0x20814008, 0x24800120, 0x20014020, 0x04014020, 0x04010108, 0x00810028, 0x00000020,
+		0x04804000, 0x04814108, 0x04810008, 0x00800100, 0x24814100, 0x24010028, 0x20810128, 0x24804120,
+		0x24804108, 0x04004020, 0x04804120, 0x00014028, 0x20014108, 0x04010128, 0x00810000, 0x20804028,
+		0x04800028, 0x24010000, 0x04010000, 0x24804028, 0x20810120, 0x04810020, 0x00814008, 0x00814028,
+		0x24810028, 0x00004000, 0x20800108, 0x24810120, 0x04804028, 0x24010020, 0x24814108, 0x20010128,
+		0x20804128, 0x24000108, 0x20010008, 0x20814128, 0x24800128, 0x24004028, 0x04800020, 0x00014020,
+		0x20800028, 0x04004008, 0x04810028, 0x00004108, 0x00004008, 0x04000120, 0x00014120, 0x04800000,
+		0x20804008, 0x04814008, 0x20010100, 0x00010000, 0x00014008, 0x04014108, 0x20814120, 0x00010020,
+		0x20000028, 0x00810000, 0x04014028, 0x00014120, 0x20810020, 0x20814108, 0x20004100, 0x04814100,
+		0x20804120, 0x04010008, 0x24800020, 0x04014020, 0x00014000, 0x00810128, 0x24004008, 0x24000028,
+		0x00004000, 0x20814000, 0x00804020, 0x00004128, 0x20010000, 0x00004120, 0x04010028, 0x20004128,
+		0x04000000, 0x00000108, 0x24004120, 0x24014120, 0x20004108, 0x04014100, 0x04810000, 0x04804120,
+		0x20810100, 0x20814120, 0x20804028, 0x00010100, 0x24814120, 0x24814100, 0x24804120, 0x04810120,
+		0x24804100, 0x00010128, 0x04010120, 0x04800120, 0x20014008, 0x00804000, 0x04010128, 0x04804008,
+		0x00000020, 0x24004008, 0x20800020, 0x00810020, 0x04014128, 0x20010100, 0x24810128, 0x20010120,
+		0x24810008, 0x00014000, 0x24010000, 0x24010008, 0x24004128, 0x04800108, 0x00000108, 0x00010028,
+		0x00810008, 0x04800128, 0x00010100, 0x24800120, 0x04800108, 0x24014008, 0x24010128, 0x00804120,
+		0x20010028, 0x04010020, 0x20004120, 0x00800028, 0x24014100, 0x20004100, 0x00804108, 0x20014028,
+		0x20814108, 0x20014100, 0x00804128, 0x04014120, 0x00810128, 0x24814000, 0x00810108, 0x20010108,
+		0x04810128, 0x20014128, 0x00000120, 0x20800008, 0x20014028, 0x20004008, 0x24804000, 0x24000128,
+		0x00000000, 0x24804020, 0x00000008, 0x20804020, 0x20000000, 0x20004108, 0x24814128, 0x04810100,
+		0x04804008, 0x24810020, 0x04800008, 0x20814100, 0x04004020, 0x04800028, 0x04000128, 0x20000100,
+		0x04800120, 0x24810028, 0x20010108, 0x00814000, 0x20000120, 0x04804020, 0x00004100, 0x24000008,
+		0x20814100, 0x00010108, 0x20800100, 0x04004028, 0x04814128, 0x20810100, 0x04000028, 0x24004120,
+		0x20000020, 0x00804100, 0x04804020, 0x20004120, 0x24800008, 0x00804108, 0x04010008, 0x04800020,
+		0x20810108, 0x04004108, 0x20804000, 0x04000000, 0x00800020, 0x20000108, 0x00014100, 0x04810108,
+		0x24800028, 0x24810100, 0x20000108, 0x24814120, 0x04814028, 0x24800108, 0x04000020, 0x24014028,
+		0x04810020, 0x20800028, 0x24804028, 0x04010028, 0x04814100, 0x20010000, 0x00804000, 0x20004028,
+		0x00814020, 0x00014100, 0x00800128, 0x00800120, 0x20010020, 0x00814108, 0x00814120, 0x00800108,
+		0x00800008, 0x20010008, 0x24814000, 0x24814020, 0x24000108, 0x24804128, 0x24010120, 0x20810120,
+		0x20010128, 0x04804028, 0x04000008, 0x00810008, 0x04814020, 0x04814120, 0x00014020, 0x24014128,
+	},
+	{
+		0x40282400, 0x00000401, 0x41280080, 0x40000480, 0x40000400, 0x01080000, 0x01200081, 0x40282000,
+		0x00282000, 0x01080081, 0x41280081, 0x40000401, 0x41000001, 0x00200400, 0x01202080, 0x41200400,
+		0x40200001, 0x01200001, 0x40082481, 0x40282080, 0x41000481, 0x01082481, 0x40002001, 0x40080401,
+		0x40202080, 0x41000481, 0x41202080, 0x41000480, 0x01280400, 0x40080481, 0x40002401, 0x41282080,
+		0x00200081, 0x41080001, 0x01080080, 0x40202080, 0x40082081, 0x00080480, 0x40002400, 0x40080001,
+		0x01082480, 0x40002400, 0x40082400, 0x41080000, 0x40080401, 0x41280481, 0x41282000, 0x00202080,
+		0x41080001, 0x40282480, 0x00082000, 0x00202001, 0x00080081, 0x40082001, 0x01200401, 0x40002000,
+		0x41200480, 0x40280400, 0x01200481, 0x40002081, 0x00202480, 0x01200081, 0x41082001, 0x40200481,
+		0x41282080, 0x00002400, 0x40080001, 0x00080401, 0x40280480, 0x41280001, 0x41202481, 0x40280480,
+		0x00280001, 0x40000400, 0x01202081, 0x01002080, 0x41082481, 0x00280001, 0x01282480, 0x41082400,
+		0x01080081, 0x40282481, 0x40200081, 0x00280081, 0x40002081, 0x41202000, 0x40080000, 0x01000000,
+		0x00200480, 0x01280080, 0x00082400, 0x40200480, 0x00200401, 0x00200001, 0x00282401, 0x40202400,
+		0x01000000, 0x40280080, 0x01002401, 0x01282480, 0x01280401, 0x01002081, 0x40000401, 0x01002480,
+		0x41282480, 0x01000001, 0x41280400, 0x00202000, 0x41082081, 0x01202480, 0x41200401, 0x40280081,
+		0x01002081, 0x00002081, 0x00080401, 0x41200480, 0x41002480, 0x41080081, 0x40280400, 0x40002401,
+		0x40002480, 0x00082080, 0x00202400, 0x41082401, 0x01200080, 0x01082000, 0x00202401, 0x01080001,
+		0x40282481, 0x00280480, 0x41000401, 0x00280401, 0x00082080, 0x40200401, 0x41002081, 0x41280081,
+		0x00002401, 0x01202401, 0x01002001, 0x01082400, 0x01200000, 0x41002400, 0x01000480, 0x41080401,
+		0x41202081, 0x40082400, 0x41080000, 0x01002481, 0x00282081, 0x41002081, 0x01280080, 0x00280481,
+		0x41280480, 0x00080481, 0x00002000, 0x01282001, 0x40080481, 0x00282480, 0x41080080, 0x00000080,
+		0x00200400, 0x00000481, 0x01282401, 0x40202481, 0x41202480, 0x00200481, 0x41080081, 0x01002401,
+		0x00082081, 0x41080080, 0x01002080, 0x00282080, 0x40202081, 0x01082480, 0x01080481, 0x00002001,
+		0x41002481, 0x40280000, 0x00082481, 0x01282400, 0x01080400, 0x41082481, 0x00282001, 0x40202081,
+		0x40082080, 0x00080080, 0x40282001, 0x00080001, 0x00000080, 0x40082401, 0x01080401, 0x01082081,
+		0x01200480, 0x01280081, 0x00080481, 0x41280000, 0x01202001, 0x40282001, 0x00202000, 0x01082080,
+		0x00280080, 0x00082400, 0x41002001, 0x00202481, 0x40080480, 0x40002480, 0x40080400, 0x40200000,
+		0x41082480, 0x01200480, 0x00000401, 0x41282000, 0x01202480, 0x40202001, 0x01082400, 0x00202401,
+		0x00080400, 0x01202400, 0x40282480, 0x41002401, 0x01280480, 0x40280481, 0x41282400, 0x01280001,
+		0x01082080, 0x40202000, 0x01080001, 0x40202401, 0x41000081, 0x01000481, 0x00280481, 0x40280401,
+		0x00002481, 0x00282001, 0x40282000, 0x41282480, 0x40002481, 0x00080000, 0x00002480, 0x01082401,
+		0x00080000, 0x40200001, 0x01282001, 0x00002401, 0x00080080, 0x41000000, 0x01082401, 0x41200001,
+		0x00082480, 0x41280080, 0x00280000, 0x00080081, 0x01282400, 0x00082001, 0x40282401, 0x00002000,
+		0x41202001, 0x40080080, 0x01202000, 0x01202481, 0x40202480, 0x00200080, 0x00080001, 0x41200401,
+		0x41200481, 0x01280480, 0x00282080, 0x01202001, 0x41202400, 0x40000080, 0x41000480, 0x41082080,
+		0x41082401, 0x41200080, 0x40280481, 0x41200481, 0x41080480, 0x00282401, 0x01082081, 0x01282000,
+		0x01282481, 0x01002000, 0x40280080, 0x00200000, 0x01000001, 0x40082481, 0x40200080, 0x41002080,
+		0x00002080, 0x01280401, 0x01280000, 0x41002480, 0x40082401, 0x00002480, 0x00080480, 0x00082000,
+		0x01002000, 0x41000400, 0x01082000, 0x41202481, 0x00200001, 0x01200401, 0x00002001, 0x40082480,
+		0x41002080, 0x41082081, 0x40080081, 0x00202400, 0x00280401, 0x01000400, 0x01000400, 0x01200400,
+		0x41200001, 0x40000081, 0x00202001, 0x01202081, 0x40082001, 0x40002080, 0x40280000, 0x41002000,
+		0x01280481, 0x40002481, 0x40082480, 0x01002400, 0x40282081, 0x00000081, 0x41280481, 0x41002481,
+		0x01002480, 0x41200000, 0x01002481, 0x01000081, 0x40202401, 0x01000080, 0x41000000, 0x40080081,
+		0x40000480, 0x01080401, 0x01202481, 0x40200081, 0x41002400, 0x01280481, 0x01082001, 0x41280400,
+		0x00200080, 0x41000001, 0x41082000, 0x41082000, 0x00282480, 0x40000001, 0x01280001, 0x40080000,
+		0x01002400, 0x41202480, 0x00000481, 0x01000480, 0x40202001, 0x00282481, 0x40002000, 0x00002481,
+		0x40280401, 0x40200400, 0x00200000, 0x00082480, 0x41002401, 0x41000401, 0x41282081, 0x40082080,
+		0x00000400, 0x41202081, 0x40000481, 0x41000080, 0x01000081, 0x00082481, 0x01280081, 0x41080400,
+		0x40200401, 0x41282401, 0x00000081, 0x01002001, 0x00000480, 0x41280401, 0x41082080, 0x41082480,
+		0x41080400, 0x01200481, 0x41082400, 0x01202000, 0x40202400, 0x01082001, 0x40082000, 0x01080080,
+		0x41000400, 0x01200000, 0x00202081, 0x41202080, 0x41282001, 0x00002080, 0x41200081, 0x41282001,
+		0x41282401, 0x41282481, 0x00202481, 0x40000000, 0x41200080, 0x00000001, 0x41080401, 0x00000000,
+		0x01200001, 0x40080480, 0x40202481, 0x41200081, 0x01000080, 0x01280000, 0x40200000, 0x00000480,
+		0x01202401, 0x41202400, 0x40000080, 0x41280480, 0x00202080, 0x00282000, 0x00280480, 0x40280001,
+		0x01000401, 0x00282081, 0x01282081, 0x41080480, 0x41280401, 0x00200401, 0x41280001, 0x00200480,
+		0x41200000, 0x40282400, 0x00082401, 0x01200080, 0x41200400, 0x00200081, 0x00280081, 0x00080400,
+		0x40000001, 0x40200080, 0x01080480, 0x00000400, 0x00002081, 0x40282081, 0x00282481, 0x40002001,
+		0x00280400, 0x00280000, 0x01282080, 0x00082081, 0x00082001, 0x41000081, 0x41280000, 0x41082001,
+		0x40282080, 0x01080480, 0x40200481, 0x01282080, 0x40280001, 0x40082081, 0x41000080, 0x41282081,
+		0x40000000, 0x01202080, 0x41282481, 0x41282400, 0x00000000, 0x40082000, 0x00000001, 0x01000401,
+		0x40280081, 0x41080481, 0x01200400, 0x41002001, 0x01202400, 0x01080481, 0x00002400, 0x01282481,
+		0x41080481, 0x40282401, 0x00200481, 0x40202480, 0x00282400, 0x00280080, 0x40200400, 0x40000481,
+		0x41202401, 0x01282081, 0x01282000, 0x00082401, 0x40080080, 0x01080400, 0x40200480, 0x41202001,
+		0x40002080, 0x00202480, 0x40000081, 0x00280400, 0x41202000, 0x00202081, 0x01080000, 0x41202401,
+		0x41002000, 0x40080400, 0x01082481, 0x01280400, 0x01000481, 0x01282401, 0x40202000, 0x00282400,
+		0x41200480, 0x40082001, 0x00082000, 0x01282081, 0x01002000, 0x00282001, 0x40202401, 0x00280001,
+		0x01080480, 0x00000000, 0x40080480, 0x00000001, 0x01200480, 0x40000000, 0x01202080, 0x41282481,
+		0x40080401, 0x41200080, 0x40082400, 0x40202481, 0x41080481, 0x41280400, 0x00002001, 0x01002400,
+		0x00202480, 0x00200081, 0x01080001, 0x40280481, 0x41080000, 0x40202081, 0x40202481, 0x01082480,
+		0x01082401, 0x40202480, 0x00200401, 0x41202480, 0x40080081, 0x01282000, 0x00080401, 0x40200081,
+		0x00002080, 0x00200001, 0x01200400, 0x41280080, 0x00202081, 0x40082481, 0x01202400, 0x01000081,
+		0x41002400, 0x01080480, 0x01002001, 0x41002401, 0x41202401, 0x40202401, 0x01082080, 0x40280080,
+		0x01000080, 0x40002000, 0x40082001, 0x40282080, 0x40202480, 0x40200401, 0x40080000, 0x40000481,
+		0x01000480, 0x41080001, 0x40280001, 0x40082401, 0x01200481, 0x41002001, 0x41280401, 0x00280400,
+		0x40000401, 0x41082000, 0x41082080, 0x01280480, 0x00200081, 0x40200400, 0x41002480, 0x00202481,
+		0x41002080, 0x41080080, 0x01080401, 0x41002481, 0x41202481, 0x40282000, 0x41082001, 0x00002081,
+		0x40000000, 0x00200401, 0x41282481, 0x41200000, 0x00000000, 0x40080401, 0x00000001, 0x01202080,
+		0x41082481, 0x01002080, 0x41000000, 0x00082000, 0x40200400, 0x41202081, 0x00282081, 0x01282001,
+		0x41280000, 0x40002481, 0x01202481, 0x01002481, 0x01282401, 0x00000080, 0x40280401, 0x40080480,
+		0x40002480, 0x01082400, 0x41280081, 0x00202081, 0x41280080, 0x00080400, 0x41000081, 0x40282400,
+		0x41282080, 0x01202480, 0x01002481, 0x40280001, 0x01080080, 0x40280400, 0x01282400, 0x00200000,
+		0x40000081, 0x41002080, 0x40200000, 0x41280401, 0x01280001, 0x00282400, 0x00080481, 0x40080400,
+		0x01200001, 0x00080081, 0x40082080, 0x01200081, 0x40202000, 0x00280480, 0x41000001, 0x01000401,
+		0x00280481, 0x40282481, 0x40200081, 0x01280000, 0x00282001, 0x01282481, 0x00200400, 0x00282000,
+		0x00000480, 0x40000401, 0x00000080, 0x00282481, 0x00080001, 0x00202000, 0x01002081, 0x40002480,
+		0x01000400, 0x00282480, 0x41282000, 0x00002000, 0x41280481, 0x00000481, 0x41202081, 0x41080481,
+		0x41280400, 0x41080081, 0x40282000, 0x41082080, 0x00002401, 0x01280001, 0x00280480, 0x00002080,
+		0x01280480, 0x41282081, 0x01280481, 0x01002001, 0x00282080, 0x01202481, 0x01080481, 0x00200400,
+		0x41000481, 0x41282400, 0x01282480, 0x01002081, 0x41200081, 0x01002401, 0x41200001, 0x40080481,
+		0x00202080, 0x41282001, 0x01280080, 0x40082080, 0x00082081, 0x01000481, 0x01282000, 0x41202000,
+		0x00280001, 0x41282401, 0x00200481, 0x41080000, 0x00200080, 0x41080400, 0x41082000, 0x40200001,
+		0x41082081, 0x00082480, 0x40202081, 0x01280081, 0x41282480, 0x01080080, 0x01282001, 0x41202400,
+		0x40080001, 0x01082481, 0x41200481, 0x01000480, 0x40280400, 0x00282080, 0x41200080, 0x01200400,
+		0x01082000, 0x41200480, 0x41280001, 0x00280000, 0x00080080, 0x01082000, 0x01200401, 0x00280081,
+		0x00082080, 0x00002400, 0x41080401, 0x41200400, 0x00000081, 0x01202401, 0x41000401, 0x40202400,
+		0x00080000, 0x00200481, 0x40082081, 0x40002081, 0x01002401, 0x41280000, 0x41080400, 0x41282480,
+		0x41080001, 0x40000001, 0x01280400, 0x00202001, 0x41282401, 0x00280481, 0x40082401, 0x40202001,
+		0x40282400, 0x40000480, 0x00082401, 0x41200401, 0x41202001, 0x00282081, 0x00200000, 0x41082401,
+		0x00202001, 0x01080401, 0x00282481, 0x40000400, 0x00082480, 0x40080001, 0x40280481, 0x01080001,
+		0x40082481, 0x01202001, 0x01282080, 0x40202080, 0x00280400, 0x40282480, 0x01280401, 0x41200481,
+		0x40202080, 0x41000480, 0x40280000, 0x40002401, 0x01000001, 0x41080480, 0x00202000, 0x40080081,
+		0x01202401, 0x01002480, 0x01080400, 0x01082081, 0x41202080, 0x01282401, 0x01082480, 0x40082400,
+		0x41280480, 0x00080080, 0x01080000, 0x41000401, 0x01200080, 0x00080000, 0x40082480, 0x40200481,
+		0x40202001, 0x40200000, 0x41082480, 0x01200001, 0x41080081, 0x01200080, 0x41200401, 0x01002000,
+		0x01000000, 0x40002001, 0x41200000, 0x40280000, 0x00002081, 0x41000400, 0x00282401, 0x40000080,
+		0x00002400, 0x01000400, 0x41002000, 0x40280480, 0x00002480, 0x41202481, 0x41082400, 0x41000081,
+		0x00280081, 0x01282400, 0x41080480, 0x00282401, 0x01002080, 0x41202080, 0x01202480, 0x41200001,
+		0x40080080, 0x01280080, 0x40002401, 0x41082480, 0x40000480, 0x01280481, 0x01000081, 0x00082080,
+		0x40002481, 0x40080000, 0x41282001, 0x40280401, 0x41000080, 0x00080480, 0x40282001, 0x01200480,
+		0x40002001, 0x00202401, 0x40282081, 0x00080401, 0x01200081, 0x41000481, 0x40200080, 0x01080000,
+		0x40280081, 0x01000000, 0x40002000, 0x40282081, 0x01080081, 0x41082481, 0x01002400, 0x00082481,
+		0x41002481, 0x40002400, 0x00202400, 0x40082480, 0x00280000, 0x01080081, 0x41202400, 0x41280001,
+		0x00000401, 0x00280080, 0x40200481, 0x41082001, 0x41080080, 0x00200480, 0x40082000, 0x41202001,
+		0x40080400, 0x00002480, 0x40280080, 0x00080001, 0x00080400, 0x01000001, 0x00000400, 0x40200480,
+		0x41002401, 0x41000000, 0x40282080, 0x41000001, 0x40002080, 0x00000401, 0x00082400, 0x01202000,
+		0x40200401, 0x41000080, 0x40000481, 0x00200080, 0x41002081, 0x01200481, 0x00080081, 0x01200000,
+		0x40000400, 0x41002081, 0x40282481, 0x00002481, 0x00002481, 0x01082080, 0x00082001, 0x41202401,
+		0x01082400, 0x40082081, 0x41282081, 0x01082001, 0x00202481, 0x41200081, 0x01082081, 0x40202000,
+		0x40282480, 0x41282000, 0x01200000, 0x01080400, 0x01282081, 0x01000080, 0x40200001, 0x41280081,
+		0x41202480, 0x01200401, 0x01000481, 0x00202400, 0x01280000, 0x01202400, 0x41000480, 0x40280081,
+		0x40200480, 0x41002000, 0x00282480, 0x41080401, 0x40202400, 0x40282401, 0x41282400, 0x40200080,
+		0x40282401, 0x01280401, 0x40002400, 0x00002001, 0x00200480, 0x41082400, 0x01082481, 0x00000081,
+		0x41000400, 0x00082401, 0x00280080, 0x01282480, 0x40000001, 0x01282080, 0x41202000, 0x00202480,
+		0x40002081, 0x40002080, 0x00200001, 0x41280481, 0x00080480, 0x00002401, 0x00282000, 0x41002400,
+		0x00002000, 0x40000081, 0x00202401, 0x41082081, 0x01202001, 0x01280400, 0x00082481, 0x00000400,
+		0x40280480, 0x00000480, 0x01202000, 0x00082081, 0x41200400, 0x01080481, 0x40080481, 0x40082000,
+		0x01282481, 0x00082001, 0x01002480, 0x01202081, 0x40000080, 0x41002480, 0x41002001, 0x41282080,
+		0x00282400, 0x01082401, 0x01280081, 0x00280401, 0x01202081, 0x40282001, 0x01000401, 0x00082400,
+		0x41082401, 0x00202080, 0x00280401, 0x00080481, 0x00000481, 0x41280480, 0x01082001, 0x40080080,
+	}
+};
+
+#endif
@@ -175,6 +175,8 @@ unsigned char *CLZSS::CompressNoAlloc(unsigned char *pInput, int inputLength, un
 		if (pOutput >= pEnd)
 		{
 			// compression is worse, abandon
+			free(m_pHashTable);
+			free(m_pHashTarget);
 			return NULL;
 		}
 	}
@@ -182,6 +184,8 @@ unsigned char *CLZSS::CompressNoAlloc(unsigned char *pInput, int inputLength, un
 	if (inputLength != 0)
 	{
 		// unexpected failure
+		free(m_pHashTable);
+		free(m_pHashTarget);
 		return NULL;
 	}
 
@@ -203,6 +207,8 @@ unsigned char *CLZSS::CompressNoAlloc(unsigned char *pInput, int inputLength, un
 		*pOutputSize = pOutput - pStart;
 	}
 
+	free(m_pHashTable);
+	free(m_pHashTarget);
 	return pStart;
 }
 
@@ -224,34 +230,61 @@ unsigned char* CLZSS::Compress(unsigned char *pInput, int inputLength, unsigned
 }
 
 //-----------------------------------------------------------------------------
-// Uncompress a buffer, Returns the uncompressed size. Caller must provide an
-// adequate sized output buffer or memory corruption will occur.
+// Uncompress a buffer, Returns the uncompressed size. The output buffer must
+// hold GetActualSize() bytes. Compress() never produces more than that plus
+// the header, so the input is bounded to the same size.
 //-----------------------------------------------------------------------------
 unsigned int CLZSS::Uncompress(unsigned char *pInput, unsigned char *pOutput)
+{
+	unsigned int actualSize = GetActualSize(pInput);
+	return SafeUncompress(pInput, actualSize + sizeof(lzss_header_t), pOutput, actualSize);
+}
+
+//-----------------------------------------------------------------------------
+// Uncompress a buffer, Returns the uncompressed size. Never reads more than
+// nInputSize bytes or writes more than unBufSize bytes; returns 0 if the data
+// would need either, or is otherwise corrupt.
+//-----------------------------------------------------------------------------
+unsigned int CLZSS::SafeUncompress(const unsigned char *pInput, unsigned int nInputSize, unsigned char *pOutput, unsigned int unBufSize)
 {
 	unsigned int totalBytes = 0;
 	int cmdByte = 0;
 	int getCmdByte = 0;
 
-	unsigned int actualSize = GetActualSize(pInput);
-	if (!actualSize)
+	if (nInputSize < sizeof(lzss_header_t))
+	{
+		return 0;
+	}
+
+	unsigned int actualSize = GetActualSize((unsigned char *)pInput);
+	if (!actualSize || actualSize > unBufSize)
 	{
-		// unrecognized
+		// unrecognized, or won't fit
 		return 0;
 	}
 
+	const unsigned char *pInputEnd = pInput + nInputSize;
+	const unsigned char *pOutputStart = pOutput;
 	pInput += sizeof(lzss_header_t);
 
 	for (;;)
 	{
 		if (!getCmdByte)
 		{
+			if (pInput >= pInputEnd)
+			{
+				return 0;
+			}
 			cmdByte = *pInput++;
 		}
 		getCmdByte = (getCmdByte + 1) & 0x07;
 
 		if (cmdByte & 0x01)
 		{
+			if (pInputEnd - pInput < 2)
+			{
+				return 0;
+			}
 			int position = *pInput++ << LZSS_LOOKSHIFT;
 			position |= (*pInput >> LZSS_LOOKSHIFT);
 			int count = (*pInput++ & 0x0F) + 1;
@@ -259,6 +292,13 @@ unsigned int CLZSS::Uncompress(unsigned char *pInput, unsigned char *pOutput)
 			{
 				break;
 			}
+
+			// the match has to start inside what we've written and end inside the buffer
+			if (position >= pOutput - pOutputStart || totalBytes + count > actualSize)
+			{
+				return 0;
+			}
+
 			unsigned char *pSource = pOutput - position - 1;
 			for (int i = 0; i<count; i++)
 			{
@@ -268,6 +308,10 @@ unsigned int CLZSS::Uncompress(unsigned char *pInput, unsigned char *pOutput)
 		}
 		else
 		{
+			if (pInput >= pInputEnd || totalBytes >= actualSize)
+			{
+				return 0;
+			}
 			*pOutput++ = *pInput++;
 			totalBytes++;
 		}
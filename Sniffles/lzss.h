@@ -30,6 +30,7 @@ public:
 	unsigned char*	Compress(unsigned char *pInput, int inputlen, unsigned int *pOutputSize);
 	unsigned char*	CompressNoAlloc(unsigned char *pInput, int inputlen, unsigned char *pOutput, unsigned int *pOutputSize);
 	unsigned int	Uncompress(unsigned char *pInput, unsigned char *pOutput);
+	unsigned int	SafeUncompress(const unsigned char *pInput, unsigned int nInputSize, unsigned char *pOutput, unsigned int unBufSize);
 	bool			IsCompressed(unsigned char *pInput);
 	unsigned int	GetActualSize(unsigned char *pInput);
 
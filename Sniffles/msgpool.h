@@ -0,0 +1,44 @@
+#pragma once
+
+#include "platform.h"
+#include "dispatch.h"
+
+//-----------------------------------------------------------------------------
+// One message object per type, reused for every message of that type. Parsing
+// clears the object first, and Clear() keeps the capacity of strings and
+// repeated fields, so after the first few packets entity_data, classes, keys
+// and the like parse without touching the heap.
+//
+// A pool belongs to one decoder and therefore to one thread. Handlers get a
+// reference into it that is only valid for the duration of the call.
+//-----------------------------------------------------------------------------
+class CMessagePool
+{
+public:
+	CMessagePool()
+	{
+		memset(m_pMessages, 0, sizeof(m_pMessages));
+	}
+
+	~CMessagePool()
+	{
+		for (int i = 0; i < DISPATCH_MAX_MESSAGE_TYPES; i++)
+			delete m_pMessages[i];
+	}
+
+	template <typename T>
+	T&		Get()
+	{
+		::google::protobuf::Message*& pMessage = m_pMessages[message_id<T>::value];
+		if (!pMessage)
+			pMessage = new T;
+
+		return *static_cast<T*>(pMessage);
+	}
+
+private:
+	CMessagePool(const CMessagePool&);
+	CMessagePool& operator=(const CMessagePool&);
+
+	::google::protobuf::Message*	m_pMessages[DISPATCH_MAX_MESSAGE_TYPES];
+};
@@ -56,12 +56,25 @@ using namespace Tins;
 #define PACKET_FLAG_ENCRYPTED			(1<<2)  // packet is encrypted
 #define PACKET_FLAG_SPLIT				(1<<3)  // packet is split
 #define PACKET_FLAG_CHOKED				(1<<4)  // packet was choked by sender
+#define PACKET_FLAG_CHALLENGE			(1<<5)  // packet contains challenge number
 //printf("PACKET_FLAG_RELIABLE   = %i\n", PACKET_FLAG_RELIABLE);
 //printf("PACKET_FLAG_COMPRESSED = %i\n", PACKET_FLAG_COMPRESSED);
 //printf("PACKET_FLAG_ENCRYPTED  = %i\n", PACKET_FLAG_ENCRYPTED);
 //printf("PACKET_FLAG_SPLIT	   = %i\n", PACKET_FLAG_SPLIT);
 //printf("PACKET_FLAG_CHOKED	   = %i\n", PACKET_FLAG_CHOKED);
 
+// reliable data is sent as fragments on up to two subchannel streams
+#define MAX_STREAMS				2
+#define FRAG_NORMAL_STREAM		0
+#define FRAG_FILE_STREAM		1
+
+#define FRAGMENT_BITS			8
+#define FRAGMENT_SIZE			(1<<FRAGMENT_BITS)
+#define MAX_FILE_SIZE_BITS		26
+#define MAX_FILE_SIZE			((1<<MAX_FILE_SIZE_BITS)-1)	// maximum transferable size is	64MB
+
+#define BYTES2FRAGMENTS(i) (((i)+FRAGMENT_SIZE-1)/FRAGMENT_SIZE)
+
 
 
 enum UpdateType
@@ -91,7 +104,7 @@ static void *get_in_addr(struct sockaddr *sa)
 	return &(((struct sockaddr_in6*)sa)->sin6_addr);
 }
 
-void print_dev(pcap_if_t* dev)
+static void print_dev(pcap_if_t* dev)
 {
 	outf("\n\n%s\n", dev->description);
 	outf("  name: %s\n", dev->name);
@@ -106,7 +119,7 @@ void print_dev(pcap_if_t* dev)
 	out("\n");
 }
 
-std::vector<pcap_if_t*> list_all_devs()
+static std::vector<pcap_if_t*> list_all_devs()
 {
 	std::vector<pcap_if_t*> devList;
 	pcap_if_t *alldevs;
@@ -144,7 +157,7 @@ std::vector<pcap_if_t*> list_all_devs()
 	return devList;
 }
 
-std::vector<pcap_if_t*> create_dev_list()
+static std::vector<pcap_if_t*> create_dev_list()
 {
 	std::vector<pcap_if_t*> devList;
 	pcap_if_t *alldevs;
@@ -0,0 +1,59 @@
+#include "netcompress.h"
+#include "frame.h"
+#include "lzss.h"
+#include "snappy.h"
+
+net_compression_t net_get_compression(const uint8* pInput, uint32 nInputSize, uint32& nUncompressedSize)
+{
+	nUncompressedSize = 0;
+
+	if (nInputSize < sizeof(lzss_header_t))
+		return NET_COMPRESSION_NONE;
+
+	uint32 id = load_le32(pInput);
+
+	if (id == LZSS_ID)
+	{
+		nUncompressedSize = load_le32(pInput + 4);
+		return NET_COMPRESSION_LZSS;
+	}
+
+	if (id == SNAPPY_ID)
+	{
+		size_t nLength = 0;
+		if (!snappy::GetUncompressedLength((const char*)pInput + 4, nInputSize - 4, &nLength) || nLength > 0xFFFFFFFF)
+			return NET_COMPRESSION_NONE;
+
+		nUncompressedSize = (uint32)nLength;
+		return NET_COMPRESSION_SNAPPY;
+	}
+
+	return NET_COMPRESSION_NONE;
+}
+
+uint32 net_decompress(const uint8* pInput, uint32 nInputSize, uint8* pOutput, uint32 nOutputSize)
+{
+	uint32 nUncompressedSize;
+
+	switch (net_get_compression(pInput, nInputSize, nUncompressedSize))
+	{
+	case NET_COMPRESSION_LZSS:
+	{
+		CLZSS lzss;
+		return lzss.SafeUncompress(pInput, nInputSize, pOutput, nOutputSize);
+	}
+
+	case NET_COMPRESSION_SNAPPY:
+		if (!nUncompressedSize || nUncompressedSize > nOutputSize)
+			return 0;
+
+		// RawUncompress checks the input and writes exactly the length it reported
+		if (!snappy::RawUncompress((const char*)pInput + 4, nInputSize - 4, (char*)pOutput))
+			return 0;
+
+		return nUncompressedSize;
+
+	default:
+		return 0;
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "platform.h"
+
+// Compressed netchannel payloads start with one of these (read little endian)
+#define SNAPPY_ID				(('P'<<24)|('A'<<16)|('N'<<8)|('S'))
+
+enum net_compression_t
+{
+	NET_COMPRESSION_NONE = 0,
+	NET_COMPRESSION_LZSS,
+	NET_COMPRESSION_SNAPPY,
+};
+
+// Which codec a payload (the bytes after the NET_HEADER_FLAG_COMPRESSEDPACKET
+// header) was compressed with, and the size it claims to expand to.
+net_compression_t	net_get_compression(const uint8* pInput, uint32 nInputSize, uint32& nUncompressedSize);
+
+// Decompresses a payload into pOutput. Nothing is written unless the claimed
+// size fits in nOutputSize, and corrupt input never reads or writes out of
+// bounds. Returns the decompressed size, or 0 on failure.
+uint32				net_decompress(const uint8* pInput, uint32 nInputSize, uint8* pOutput, uint32 nOutputSize);
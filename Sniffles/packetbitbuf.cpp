@@ -25,6 +25,12 @@
 #include <assert.h>
 #include "packetbitbuf.h"
 
+// SSE2 is there on every x64 build, and on x86 unless /arch says otherwise
+#if !defined(BITBUF_NO_SIMD) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__))
+#define BITBUF_SSE2
+#include <emmintrin.h>
+#endif
+
 const uint32 CBitRead::s_nMaskTable[33] = {
 	0,
 	(1 << 1) - 1,
@@ -66,11 +72,7 @@ int CBitRead::GetNumBitsRead(void) const
 	if (!m_pData)									   // pesky null ptr bitbufs. these happen.
 		return 0;
 
-	int nCurOfs = ((int(m_pDataIn) - int(m_pData)) / 4) - 1;
-	nCurOfs *= 32;
-	nCurOfs += (32 - m_nBitsAvail);
-	int nAdjust = 8 * (m_nDataBytes & 3);
-	return MIN(nCurOfs + nAdjust, m_nDataBits);
+	return MIN(m_nCurBit, m_nDataBits);
 }
 
 int CBitRead::GetNumBytesRead(void) const
@@ -78,112 +80,29 @@ int CBitRead::GetNumBytesRead(void) const
 	return ((GetNumBitsRead() + 7) >> 3);
 }
 
-void CBitRead::GrabNextDWord(bool bOverFlowImmediately)
+//-----------------------------------------------------------------------------
+// ReadUBitLong within 8 bytes of the end, where a 64-bit load would run past
+// the buffer. A read that doesn't fit in what is left returns 0 and moves to
+// the end, so every read after it returns 0 as well.
+//-----------------------------------------------------------------------------
+unsigned int CBitRead::ReadUBitLongTail(int numbits)
 {
-	if (m_pDataIn == m_pBufferEnd)
-	{
-		m_nBitsAvail = 1;									// so that next read will run out of words
-		m_nInBufWord = 0;
-		m_pDataIn++;										// so seek count increments like old
-		if (bOverFlowImmediately)
-		{
-			SetOverflowFlag();
-		}
-	}
-	else 
+	if (m_nCurBit + numbits > m_nBufferBits)
 	{
-		if (m_pDataIn > m_pBufferEnd)
-		{
-			SetOverflowFlag();
-			m_nInBufWord = 0;
-		}
-		else
-		{
-			//assert(reinterpret_cast< int >(m_pDataIn)+3 < reinterpret_cast< int >(m_pBufferEnd));
-			m_nInBufWord = *(m_pDataIn++);
-		}
+		SetOverflowFlag();
+		m_nCurBit = m_nBufferBits;
+		return 0;
 	}
-}
 
-void CBitRead::FetchNext(void)
-{
-	m_nBitsAvail = 32;
-	GrabNextDWord(false);
-}
+	uint64 nWindow = 0;
+	int nByte = m_nCurBit >> 3;
+	memcpy(&nWindow, m_pData + nByte, MIN((m_nBufferBits >> 3) - nByte, (int)sizeof(nWindow)));
 
-int CBitRead::ReadOneBit(void)
-{
-	int nRet = m_nInBufWord & 1;
-	if (--m_nBitsAvail == 0)
-	{
-		FetchNext();
-	}
-	else
-	{
-		m_nInBufWord >>= 1;
-	}
+	unsigned int nRet = (unsigned int)(nWindow >> (m_nCurBit & 7)) & s_nMaskTable[numbits];
+	m_nCurBit += numbits;
 	return nRet;
 }
 
-int CBitRead::ReadBit(void)
-{
-	int nRet = m_nInBufWord & 1;
-	bool v10 = m_nBitsAvail-- == 1;
-	if (v10)
-	{
-		m_nBitsAvail = 32;
-		if (m_pDataIn == m_pBufferEnd)
-		{
-			m_nBitsAvail = 1;// so that next read will run out of words
-			m_nInBufWord = 0;
-			m_pDataIn++;// so seek count increments like old
-		}
-		if (m_pDataIn > m_pBufferEnd)
-		{
-			m_bOverflow = true;
-			m_nInBufWord = 0;
-		}	
-		//assert(reinterpret_cast< int >(m_pDataIn)+3 < reinterpret_cast< int >(m_pBufferEnd));
-		m_nInBufWord = *(m_pDataIn++);
-	}
-	else
-	{
-		m_nInBufWord >>= 1;
-	}
-	return nRet;
-}
-
-unsigned int CBitRead::ReadUBitLong(int numbits)
-{
-	if (m_nBitsAvail >= numbits)
-	{
-		unsigned int nRet = m_nInBufWord & s_nMaskTable[numbits];
-		m_nBitsAvail -= numbits;
-		if (m_nBitsAvail)
-		{
-			m_nInBufWord >>= numbits;
-		}
-		else
-		{
-			FetchNext();
-		}
-		return nRet;
-	}
-	else
-	{
-		// need to merge words
-		unsigned int nRet = m_nInBufWord;
-		numbits -= m_nBitsAvail;
-		GrabNextDWord(true);
-		if (m_bOverflow)
-			return 0;
-		nRet |= ((m_nInBufWord & s_nMaskTable[numbits]) << m_nBitsAvail);
-		m_nBitsAvail = 32 - numbits;
-		m_nInBufWord >>= numbits;
-		return nRet;
-	}
-}
-
 int CBitRead::ReadSBitLong(int numbits)
 {
 	int nRet = ReadUBitLong(numbits);
@@ -271,58 +190,18 @@ bool CBitRead::Seek(int nPosition)
 		bSucc = false;
 		nPosition = m_nDataBits;
 	}
-	int nHead = m_nDataBytes & 3;							// non-multiple-of-4 bytes at head of buffer. We put the "round off"
-	// at the head to make reading and detecting the end efficient.
 
-	int nByteOfs = nPosition / 8;
-	if ((m_nDataBytes < 4) || (nHead && (nByteOfs < nHead)))
-	{
-		// partial first dword
-		unsigned char const *pPartial = (unsigned char const *)m_pData;
-		if (m_pData)
-		{
-			m_nInBufWord = *(pPartial++);
-			if (nHead > 1)
-			{
-				m_nInBufWord |= (*pPartial++) << 8;
-			}
-			if (nHead > 2)
-			{
-				m_nInBufWord |= (*pPartial++) << 16;
-			}
-		}
-		m_pDataIn = (uint32 const *)pPartial;
-		m_nInBufWord >>= (nPosition & 31);
-		m_nBitsAvail = (nHead << 3) - (nPosition & 31);
-	}
-	else
-	{
-		int nAdjPosition = nPosition - (nHead << 3);
-		m_pDataIn = reinterpret_cast< uint32 const * > (reinterpret_cast< unsigned char const * >(m_pData)+((nAdjPosition / 32) << 2) + nHead);
-		if (m_pData)
-		{
-			m_nBitsAvail = 32;
-			GrabNextDWord();
-		}
-		else
-		{
-			m_nInBufWord = 0;
-			m_nBitsAvail = 1;
-		}
-		m_nInBufWord >>= (nAdjPosition & 31);
-		m_nBitsAvail = MIN(m_nBitsAvail, 32 - (nAdjPosition & 31));	// in case grabnextdword overflowed
-	}
+	m_nCurBit = nPosition;
 	return bSucc;
 }
 
 
 void CBitRead::StartReading(const void *pData, int nBytes, int iStartBit, int nBits)
 {
-	// Make sure it's dword aligned and padded.
-	assert(((unsigned long)pData & 3) == 0);
-	m_pData = (uint32 *)pData;
-	m_pDataIn = m_pData;
+	// Any pointer will do: reads are unaligned loads, and none go past nBytes
+	m_pData = (uint8 const *)pData;
 	m_nDataBytes = nBytes;
+	m_nCurBit = 0;
 
 	if (nBits == -1)
 	{
@@ -334,7 +213,12 @@ void CBitRead::StartReading(const void *pData, int nBytes, int iStartBit, int nB
 		m_nDataBits = nBits;
 	}
 	m_bOverflow = false;
-	m_pBufferEnd = reinterpret_cast< uint32 const * > (reinterpret_cast< unsigned char const * >(m_pData)+nBytes);
+	m_nBufferBits = m_pData ? nBytes << 3 : 0;
+	m_nLastWindowBit = m_nBufferBits - (int)(sizeof(uint64) << 3) + 7;
+	if (m_nLastWindowBit < 7)
+	{
+		m_nLastWindowBit = -1;
+	}
 	if (m_pData)
 	{
 		Seek(iStartBit);
@@ -389,7 +273,7 @@ bool CBitRead::ReadString(char *pStr, int maxLen, bool bLine, int *pOutNumChars)
 // 24-bits: 16384-2097151
 // 32-bits: 2097152-268435455
 // 40-bits: 268435456-0xFFFFFFFF
-uint32 CBitRead::ReadVarInt32()
+uint32 CBitRead::ReadVarInt32Bytewise()
 {
 	uint32 result = 0;
 	int count = 0;
@@ -409,7 +293,7 @@ uint32 CBitRead::ReadVarInt32()
 	return result;
 }
 
-uint64 CBitRead::ReadVarInt64()
+uint64 CBitRead::ReadVarInt64Bytewise()
 {
 	uint64 result = 0;
 	int count = 0;
@@ -436,7 +320,7 @@ void CBitRead::ReadBits(void *pOutData, int nBits)
 
 
 	// align output to dword boundary
-	while (((unsigned long)pOut & 3) != 0 && nBitsLeft >= 8)
+	while (((uintp)pOut & 3) != 0 && nBitsLeft >= 8)
 	{
 		*pOut = (unsigned char)ReadUBitLong(8);
 		++pOut;
@@ -446,8 +330,8 @@ void CBitRead::ReadBits(void *pOutData, int nBits)
 	// read dwords
 	while (nBitsLeft >= 32)
 	{
-		*((unsigned long*)pOut) = ReadUBitLong(32);
-		pOut += sizeof(unsigned long);
+		*((uint32*)pOut) = ReadUBitLong(32);
+		pOut += sizeof(uint32);
 		nBitsLeft -= 32;
 	}
 
@@ -732,6 +616,230 @@ void CBitRead::ReadBitAngles(QAngle& fa)
 	fa.Init(tmp.x, tmp.y, tmp.z);
 }
 
+//-----------------------------------------------------------------------------
+// Bulk coordinates. The first two bits of a coordinate say which fields
+// follow, so they index a table of where each field sits and one window
+// decodes it without branching on them. Coordinates are stored in place as a
+// fixed point magnitude with the sign in the top bit, then turned into floats
+// four at a time once the run is read. Magnitudes fit in 24 bits, which makes
+// the conversion exact: the floats are the scalar reads', signed zeros
+// included. Near the end of the buffer the scalar reads take over.
+//-----------------------------------------------------------------------------
+struct coord_fields_t
+{
+	uint8	nBits;			// flags included
+	uint8	nSignShift;
+	uint8	nIntShift;
+	uint8	nFractShift;
+	uint32	nSignMask;		// 0 when there is no sign
+	uint32	nIntMask;		// 0 when there is no integer
+	uint32	nIntBias;		// integers are sent less one
+	uint32	nFractMask;
+};
+
+// Two flags, then the sign, the integer and the fraction, where sent
+#define COORD_FIELDS(sign, intbits, fractbits) \
+	{ 2 + (sign) + (intbits) + (fractbits), 2, 3, 3 + (intbits), (sign), (1u << (intbits)) - 1, (intbits) ? 1u : 0u, (1u << (fractbits)) - 1 }
+
+#define COORD_MAX_BITS		(3 + COORD_INTEGER_BITS + COORD_FRACTIONAL_BITS)
+
+// ReadBitCoord, by its integer and fraction flags
+static const coord_fields_t s_coordFields[4] =
+{
+	COORD_FIELDS(0, 0, 0),
+	COORD_FIELDS(1, COORD_INTEGER_BITS, 0),
+	COORD_FIELDS(1, 0, COORD_FRACTIONAL_BITS),
+	COORD_FIELDS(1, COORD_INTEGER_BITS, COORD_FRACTIONAL_BITS),
+};
+
+// ReadBitCoordMP, by EBitCoordType, then its in bounds and integer flags
+static const coord_fields_t s_coordMPFields[3][4] =
+{
+	{
+		COORD_FIELDS(1, 0, COORD_FRACTIONAL_BITS),
+		COORD_FIELDS(1, 0, COORD_FRACTIONAL_BITS),
+		COORD_FIELDS(1, COORD_INTEGER_BITS, COORD_FRACTIONAL_BITS),
+		COORD_FIELDS(1, COORD_INTEGER_BITS_MP, COORD_FRACTIONAL_BITS),
+	},
+	{
+		COORD_FIELDS(1, 0, COORD_FRACTIONAL_BITS_MP_LOWPRECISION),
+		COORD_FIELDS(1, 0, COORD_FRACTIONAL_BITS_MP_LOWPRECISION),
+		COORD_FIELDS(1, COORD_INTEGER_BITS, COORD_FRACTIONAL_BITS_MP_LOWPRECISION),
+		COORD_FIELDS(1, COORD_INTEGER_BITS_MP, COORD_FRACTIONAL_BITS_MP_LOWPRECISION),
+	},
+	{
+		COORD_FIELDS(0, 0, 0),
+		COORD_FIELDS(0, 0, 0),
+		COORD_FIELDS(1, COORD_INTEGER_BITS, 0),
+		COORD_FIELDS(1, COORD_INTEGER_BITS_MP, 0),
+	},
+};
+
+#undef COORD_FIELDS
+
+static const int s_nCoordFractBits[3] = { COORD_FRACTIONAL_BITS, COORD_FRACTIONAL_BITS_MP_LOWPRECISION, 0 };
+static const float s_flCoordResolution[3] = { COORD_RESOLUTION, COORD_RESOLUTION_LOWPRECISION, 1.0f };
+
+static FORCEINLINE uint32 decode_coord(uint64 nWindow, const coord_fields_t* pTable, int nFractBits, int& nBits)
+{
+	const coord_fields_t& fields = pTable[nWindow & 3];
+	uint32 nSign = (uint32)(nWindow >> fields.nSignShift) & fields.nSignMask;
+	uint32 nInt = ((uint32)(nWindow >> fields.nIntShift) & fields.nIntMask) + fields.nIntBias;
+	uint32 nFract = (uint32)(nWindow >> fields.nFractShift) & fields.nFractMask;
+
+	nBits = fields.nBits;
+	return (nSign << 31) | (nInt << nFractBits) | nFract;
+}
+
+static FORCEINLINE void store_fixed(float* pValue, uint32 nFixed)
+{
+	memcpy(pValue, &nFixed, sizeof(nFixed));
+}
+
+// Fixed point values stored by store_fixed into floats, in place
+static void fixed_to_floats(float* pValues, int nCount, float flScale)
+{
+	int i = 0;
+
+#ifdef BITBUF_SSE2
+	const __m128i nSignMask = _mm_set1_epi32((int)0x80000000);
+	const __m128 flScales = _mm_set1_ps(flScale);
+
+	for (; i + 4 <= nCount; i += 4)
+	{
+		__m128i nFixed = _mm_loadu_si128((const __m128i*)(pValues + i));
+		__m128 flMagnitude = _mm_mul_ps(_mm_cvtepi32_ps(_mm_andnot_si128(nSignMask, nFixed)), flScales);
+		_mm_storeu_ps(pValues + i, _mm_or_ps(flMagnitude, _mm_castsi128_ps(_mm_and_si128(nFixed, nSignMask))));
+	}
+#endif
+
+	for (; i < nCount; i++)
+	{
+		uint32 nFixed;
+		memcpy(&nFixed, pValues + i, sizeof(nFixed));
+
+		float flMagnitude = (float)(int32)(nFixed & 0x7FFFFFFF) * flScale;
+		uint32 nValue;
+		memcpy(&nValue, &flMagnitude, sizeof(nValue));
+		nValue |= nFixed & 0x80000000;
+		memcpy(pValues + i, &nValue, sizeof(nValue));
+	}
+}
+
+bool CBitRead::ReadBitCoords(float *pOut, int nCount)
+{
+	int i = 0;
+	for (; i < nCount && m_nCurBit <= m_nLastWindowBit; i++)
+	{
+		int nBits;
+		store_fixed(pOut + i, decode_coord(LoadWindow(), s_coordFields, COORD_FRACTIONAL_BITS, nBits));
+		m_nCurBit += nBits;
+	}
+
+	fixed_to_floats(pOut, i, COORD_RESOLUTION);
+
+	for (; i < nCount; i++)
+		pOut[i] = ReadBitCoord();
+
+	return !IsOverflowed();
+}
+
+bool CBitRead::ReadBitCoordMPs(float *pOut, int nCount, EBitCoordType coordType)
+{
+	const coord_fields_t* pTable = s_coordMPFields[coordType];
+	int nFractBits = s_nCoordFractBits[coordType];
+
+	int i = 0;
+	for (; i < nCount && m_nCurBit <= m_nLastWindowBit; i++)
+	{
+		int nBits;
+		store_fixed(pOut + i, decode_coord(LoadWindow(), pTable, nFractBits, nBits));
+		m_nCurBit += nBits;
+	}
+
+	fixed_to_floats(pOut, i, s_flCoordResolution[coordType]);
+
+	for (; i < nCount; i++)
+		pOut[i] = ReadBitCoordMP(coordType);
+
+	return !IsOverflowed();
+}
+
+bool CBitRead::ReadBitCellCoords(float *pOut, int nCount, int bits, EBitCoordType coordType)
+{
+	// wider integers would round before their fraction is added
+	int i = 0;
+	if (bits <= 24)
+	{
+		int nFractBits = s_nCoordFractBits[coordType];
+		uint32 nIntMask = s_nMaskTable[bits];
+		uint32 nMask = s_nMaskTable[bits + nFractBits];
+
+		for (; i < nCount && m_nCurBit <= m_nLastWindowBit; i++)
+		{
+			uint32 nValue = (uint32)LoadWindow() & nMask;
+			store_fixed(pOut + i, ((nValue & nIntMask) << nFractBits) | (nValue >> bits));
+			m_nCurBit += bits + nFractBits;
+		}
+
+		fixed_to_floats(pOut, i, s_flCoordResolution[coordType]);
+	}
+
+	for (; i < nCount; i++)
+		pOut[i] = ReadBitCellCoord(bits, coordType);
+
+	return !IsOverflowed();
+}
+
+bool CBitRead::ReadBitNormals(float *pOut, int nCount)
+{
+	int i = 0;
+	for (; i < nCount && m_nCurBit <= m_nLastWindowBit; i++)
+	{
+		uint32 nValue = (uint32)LoadWindow();
+		store_fixed(pOut + i, (nValue << 31) | ((nValue >> 1) & s_nMaskTable[NORMAL_FRACTIONAL_BITS]));
+		m_nCurBit += 1 + NORMAL_FRACTIONAL_BITS;
+	}
+
+	fixed_to_floats(pOut, i, NORMAL_RESOLUTION);
+
+	for (; i < nCount; i++)
+		pOut[i] = ReadBitNormal();
+
+	return !IsOverflowed();
+}
+
+bool CBitRead::ReadBitVec3Coords(Vector *pOut, int nCount)
+{
+	static_assert(sizeof(Vector) == 3 * sizeof(float), "Vector must be three packed floats");
+	float* pValues = (float*)pOut;
+
+	// the flags, then a coordinate for each one set; components without one
+	// decode anyway and are masked off, rather than branched around
+	int i = 0;
+	for (; i < nCount && m_nCurBit + 3 + 2 * COORD_MAX_BITS <= m_nLastWindowBit; i++)
+	{
+		uint32 nFlags = (uint32)LoadWindow();
+		m_nCurBit += 3;
+
+		for (int j = 0; j < 3; j++)
+		{
+			uint32 nMask = 0 - ((nFlags >> j) & 1);
+
+			int nBits;
+			store_fixed(pValues + i * 3 + j, decode_coord(LoadWindow(), s_coordFields, COORD_FRACTIONAL_BITS, nBits) & nMask);
+			m_nCurBit += nBits & nMask;
+		}
+	}
+
+	fixed_to_floats(pValues, i * 3, COORD_RESOLUTION);
+
+	for (; i < nCount; i++)
+		ReadBitVec3Coord(pOut[i]);
+
+	return !IsOverflowed();
+}
+
 float CBitRead::ReadBitFloat(void)
 {
 	uint32 nvalue = ReadUBitLong(32);
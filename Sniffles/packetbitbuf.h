@@ -25,8 +25,20 @@
 #ifndef PACKETBITBUF_H
 #define PACKETBITBUF_H
 
+#include <string.h>
 #include "packet.h"
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// pext gathers the bits of a varint in one instruction, where the build
+// targets BMI2 on x64
+#if (defined(__BMI2__) && defined(__x86_64__)) || (defined(_MSC_VER) && defined(__AVX2__) && defined(_M_X64))
+#define BITBUF_PEXT
+#include <immintrin.h>
+#endif
+
 // OVERALL Coordinate Size Limits used in COMMON.C MSG_*BitCoord() Routines (and someday the HUD)
 #define	COORD_INTEGER_BITS			14
 #define COORD_FRACTIONAL_BITS		5
@@ -103,19 +115,77 @@ namespace bitbuf
 
 	const int kMaxVarintBytes = 10;
 	const int kMaxVarint32Bytes = 5;
+
+	// Index of the lowest set bit, n must not be 0
+	inline int CountTrailingZeros64(uint64 n)
+	{
+#if defined(_MSC_VER)
+		unsigned long nIndex;
+#if defined(_M_X64)
+		_BitScanForward64(&nIndex, n);
+#else
+		if (!_BitScanForward(&nIndex, (unsigned long)n))
+		{
+			_BitScanForward(&nIndex, (unsigned long)(n >> 32));
+			nIndex += 32;
+		}
+#endif
+		return (int)nIndex;
+#else
+		return __builtin_ctzll(n);
+#endif
+	}
+
+	// The low 7 bits of each byte of n packed together, the first byte lowest
+	inline uint64 GatherVarIntBits(uint64 n)
+	{
+#if defined(BITBUF_PEXT)
+		return _pext_u64(n, 0x7F7F7F7F7F7F7F7Full);
+#else
+		n &= 0x7F7F7F7F7F7F7F7Full;
+		n = (n & 0x007F007F007F007Full) | ((n & 0x7F007F007F007F00ull) >> 1);
+		n = (n & 0x00003FFF00003FFFull) | ((n & 0x3FFF00003FFF0000ull) >> 2);
+		return (n & 0x000000000FFFFFFFull) | ((n & 0x0FFFFFFF00000000ull) >> 4);
+#endif
+	}
+
+	// Decodes the varint at the start of nWindow, 8 bytes in little endian
+	// order, without looping over them. Only bytes whose top bit is in
+	// nEndMask may end it. Returns its length in bytes, 0 when none of them
+	// did and the varint is longer than the window.
+	inline int DecodeVarIntWindow(uint64 nWindow, uint64 nEndMask, uint64& nValue)
+	{
+		uint64 nEnds = ~nWindow & nEndMask;
+		if (!nEnds)
+			return 0;
+
+		// nEnds ^ (nEnds - 1) keeps the bytes up to the first end
+		nValue = GatherVarIntBits(nWindow & (nEnds ^ (nEnds - 1)));
+		return (CountTrailingZeros64(nEnds) >> 3) + 1;
+	}
 }
 
+//-----------------------------------------------------------------------------
+// Reads bits LSB first from a byte buffer, returning zeros and setting the
+// overflow flag once a read runs past its end.
+//
+// A read is one unaligned 64-bit load at the byte holding the next bit,
+// shifted down to it, which leaves at least 57 bits for reads of up to 32.
+// Nothing is buffered between reads, so one read depends on the last only
+// through m_nCurBit and doesn't branch on how many bits are left over. Within
+// 8 bytes of the end ReadUBitLongTail loads what is left instead, so the
+// buffer needs no padding or alignment and can be read where it is.
+//-----------------------------------------------------------------------------
 class CBitRead
 {
-	uint32 m_nInBufWord; // 0
-	int m_nBitsAvail; // 4
-	uint32 const *m_pDataIn; // 8
-	uint32 const *m_pBufferEnd; // 12
-	uint32 const *m_pData; // 16
+	uint8 const *m_pData;
+	int m_nCurBit;					// bits read
+	int m_nLastWindowBit;			// highest m_nCurBit whose 64-bit load stays in the buffer, -1 if none
+	int m_nBufferBits;				// reads past this overflow
 
-	bool m_bOverflow; // 20
-	int m_nDataBits;  // 24
-	size_t m_nDataBytes; // 30
+	bool m_bOverflow;
+	int m_nDataBits;
+	size_t m_nDataBytes;
 
 	static const uint32 s_nMaskTable[33];							// 0 1 3 7 15 ..
 
@@ -130,6 +200,10 @@ public:
 
 	CBitRead(void)
 	{
+		m_pData = NULL;
+		m_nCurBit = 0;
+		m_nLastWindowBit = -1;
+		m_nBufferBits = 0;
 		m_bOverflow = false;
 		m_nDataBits = -1;
 		m_nDataBytes = 0;
@@ -182,8 +256,7 @@ public:
 	int GetNumBitsRead(void) const;
 	int GetNumBytesRead(void) const;
 
-	void GrabNextDWord(bool bOverFlowImmediately = false);
-	void FetchNext(void);
+	// numbits <= 32
 	unsigned int ReadUBitLong(int numbits);
 	int ReadSBitLong(int numbits);
 	unsigned int ReadUBitVar(void);
@@ -193,7 +266,6 @@ public:
 
 	// Returns 0 or 1.
 	int	ReadOneBit(void);
-	int	ReadBit(void);
 	int ReadLong(void);
 	int ReadChar(void);
 	int ReadByte(void);
@@ -212,6 +284,17 @@ public:
 	float ReadBitAngle(int numbits);
 	float ReadBitFloat(void);
 
+	// nCount of the above in a row into pOut, the same floats as reading them
+	// one at a time. False if it overflowed. Entity vectors are decoded with
+	// these: a coordinate's flag bits index a table of where its fields sit,
+	// so each comes out of one window load without branching on them, and the
+	// run is converted to floats with SSE2 where the build has it.
+	bool ReadBitCoords(float *pOut, int nCount);
+	bool ReadBitCoordMPs(float *pOut, int nCount, EBitCoordType coordType);
+	bool ReadBitCellCoords(float *pOut, int nCount, int bits, EBitCoordType coordType);
+	bool ReadBitNormals(float *pOut, int nCount);
+	bool ReadBitVec3Coords(Vector *pOut, int nCount);
+
 	// Returns false if bufLen isn't large enough to hold the
 	// string in the buffer.
 	//
@@ -230,10 +313,86 @@ public:
 	// reads a varint encoded integer
 	uint32 ReadVarInt32();
 	uint64 ReadVarInt64();
+
+	// Reads nCount varints in a row, like as many ReadVarInt32s. False if
+	// it overflowed.
+	bool ReadVarInt32s(uint32 *pValues, int nCount);
 	int32 ReadSignedVarInt32() { return bitbuf::ZigZagDecode32(ReadVarInt32()); }
 	int64 ReadSignedVarInt64() { return bitbuf::ZigZagDecode64(ReadVarInt64()); }
+
+private:
+	// The 57 or more bits from m_nCurBit on, m_nCurBit <= m_nLastWindowBit
+	uint64 LoadWindow(void) const
+	{
+		uint64 nWindow;
+		memcpy(&nWindow, m_pData + (m_nCurBit >> 3), sizeof(nWindow));
+		return nWindow >> (m_nCurBit & 7);
+	}
+
+	unsigned int ReadUBitLongTail(int numbits);
+	uint32 ReadVarInt32Bytewise();
+	uint64 ReadVarInt64Bytewise();
 };
 
+FORCEINLINE unsigned int CBitRead::ReadUBitLong(int numbits)
+{
+	if (m_nCurBit > m_nLastWindowBit)
+		return ReadUBitLongTail(numbits);
+
+	unsigned int nRet = (unsigned int)LoadWindow() & s_nMaskTable[numbits];
+	m_nCurBit += numbits;
+	return nRet;
+}
+
+//-----------------------------------------------------------------------------
+// Varints come out of the same window as ReadUBitLong, at any bit offset.
+// The first byte without its top bit set ends one, and the 7-bit groups
+// before it are packed together by bitbuf::GatherVarIntBits, with pext on
+// BMI2 builds. wire_read_varint (wirefields.h) does the same on protobuf
+// bytes. Within 8 bytes of the end, and for 64-bit varints longer than the 7 bytes
+// a window surely holds, they are read a byte at a time instead.
+//-----------------------------------------------------------------------------
+FORCEINLINE uint32 CBitRead::ReadVarInt32()
+{
+	if (m_nCurBit > m_nLastWindowBit)
+		return ReadVarInt32Bytewise();
+
+	// the fifth byte ends it whatever its top bit says, like kMaxVarint32Bytes
+	uint64 nValue;
+	int nBytes = bitbuf::DecodeVarIntWindow(LoadWindow() & ~(0x80ull << 32), 0x8080808080ull, nValue);
+	m_nCurBit += nBytes << 3;
+	return (uint32)nValue;
+}
+
+FORCEINLINE uint64 CBitRead::ReadVarInt64()
+{
+	if (m_nCurBit <= m_nLastWindowBit)
+	{
+		uint64 nValue;
+		int nBytes = bitbuf::DecodeVarIntWindow(LoadWindow(), 0x80808080808080ull, nValue);
+		if (nBytes)
+		{
+			m_nCurBit += nBytes << 3;
+			return nValue;
+		}
+	}
+
+	return ReadVarInt64Bytewise();
+}
+
+FORCEINLINE bool CBitRead::ReadVarInt32s(uint32 *pValues, int nCount)
+{
+	for (int i = 0; i < nCount; i++)
+		pValues[i] = ReadVarInt32();
+
+	return !IsOverflowed();
+}
+
+FORCEINLINE int CBitRead::ReadOneBit(void)
+{
+	return ReadUBitLong(1);
+}
+
 #ifndef MIN
 #define MIN( a, b ) ( ( ( a ) < ( b ) ) ? ( a ) : ( b ) )
 #endif
@@ -0,0 +1,104 @@
+#include "pipeline.h"
+
+#include <chrono>
+
+CDecodePipeline::CDecodePipeline(int nWorkers, bool bBlockWhenFull)
+	: m_bStopping(false), m_bBlockWhenFull(bBlockWhenFull), m_nDropped(0)
+{
+	if (nWorkers < 1)
+		nWorkers = 1;
+
+	for (int i = 0; i < nWorkers; i++)
+		m_workers.push_back(new worker_t);
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+		m_workers[i]->thread = std::thread(WorkerMain, this, m_workers[i]);
+}
+
+CDecodePipeline::~CDecodePipeline()
+{
+	Stop();
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+		delete m_workers[i];
+}
+
+void CDecodePipeline::Push(const udp_frame_t& frame)
+{
+	if (frame.nPayloadSize > PIPELINE_MAX_DATAGRAM)
+	{
+		m_nDropped++;
+		return;
+	}
+
+	worker_t* pWorker = m_workers[hash_flow(frame) % m_workers.size()];
+
+	datagram_slot_t* pSlot = pWorker->ring.BeginPush();
+	while (!pSlot)
+	{
+		if (!m_bBlockWhenFull)
+		{
+			m_nDropped++;
+			return;
+		}
+
+		std::this_thread::yield();
+		pSlot = pWorker->ring.BeginPush();
+	}
+
+	pSlot->frame = frame;
+	memcpy(pSlot->data, frame.pPayload, frame.nPayloadSize);
+	pWorker->ring.CommitPush();
+}
+
+void CDecodePipeline::Stop()
+{
+	m_bStopping.store(true, std::memory_order_release);
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		if (m_workers[i]->thread.joinable())
+			m_workers[i]->thread.join();
+	}
+}
+
+void CDecodePipeline::CollectStats(decode_stats_t& stats) const
+{
+	for (size_t i = 0; i < m_workers.size(); i++)
+		merge_stats(stats, m_workers[i]->decoder.m_stats);
+
+	stats.nDropped += m_nDropped;
+}
+
+void CDecodePipeline::WorkerMain(CDecodePipeline* pPipeline, worker_t* pWorker)
+{
+	int nIdle = 0;
+
+	for (;;)
+	{
+		datagram_slot_t* pSlot = pWorker->ring.BeginPop();
+		if (pSlot)
+		{
+			pSlot->frame.pPayload = pSlot->data;
+			pWorker->decoder.ProcessDatagram(pSlot->frame);
+			pWorker->ring.CommitPop();
+
+			nIdle = 0;
+			continue;
+		}
+
+		if (pPipeline->m_bStopping.load(std::memory_order_acquire))
+		{
+			// the producer may have pushed between our pop and the stop flag
+			if (!pWorker->ring.BeginPop())
+				break;
+			continue;
+		}
+
+		// spin briefly while traffic is flowing, back off when the wire is quiet
+		if (++nIdle < 256)
+			std::this_thread::yield();
+		else
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <thread>
+#include <vector>
+
+#include "ring.h"
+#include "decoder.h"
+
+#define PIPELINE_RING_SLOTS		2048	// per worker
+#define PIPELINE_MAX_DATAGRAM	2048	// anything larger can't arrive unfragmented on a 1500 MTU link
+
+struct datagram_slot_t
+{
+	udp_frame_t	frame;
+	uint8		data[PIPELINE_MAX_DATAGRAM];
+};
+
+//-----------------------------------------------------------------------------
+// Fans datagrams out from the capture thread to N decode workers. Datagrams are
+// sharded by their UDP 5-tuple, so a session is always decoded by the same
+// worker, in capture order, and session state never needs a lock.
+//-----------------------------------------------------------------------------
+class CDecodePipeline
+{
+public:
+	// bBlockWhenFull makes Push wait for a worker instead of dropping, which is
+	// what we want when replaying a file rather than keeping up with a wire.
+	CDecodePipeline(int nWorkers, bool bBlockWhenFull);
+	~CDecodePipeline();
+
+	// Capture thread only. Copies the payload, the frame can be reused on return.
+	void	Push(const udp_frame_t& frame);
+
+	// Lets the workers drain their rings and joins them
+	void	Stop();
+
+	// Sum of all worker stats plus drops. Only valid after Stop().
+	void	CollectStats(decode_stats_t& stats) const;
+
+	int		GetWorkerCount() const { return (int)m_workers.size(); }
+
+private:
+	CDecodePipeline(const CDecodePipeline&);
+	CDecodePipeline& operator=(const CDecodePipeline&);
+
+	struct worker_t
+	{
+		CSpscRing<datagram_slot_t, PIPELINE_RING_SLOTS>	ring;
+		CNetDecoder										decoder;
+		std::thread										thread;
+	};
+
+	static void WorkerMain(CDecodePipeline* pPipeline, worker_t* pWorker);
+
+	std::vector<worker_t*>	m_workers;
+	std::atomic<bool>		m_bStopping;
+	bool					m_bBlockWhenFull;
+	uint64					m_nDropped;
+};
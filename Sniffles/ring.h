@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include "platform.h"
+
+#define CACHE_LINE_SIZE		64
+
+//-----------------------------------------------------------------------------
+// Lock-free single producer / single consumer ring of N slots (N must be a
+// power of two). Slots are filled and drained in place:
+//
+//   producer: T* p = ring.BeginPush(); if (p) { fill *p; ring.CommitPush(); }
+//   consumer: T* p = ring.BeginPop();  if (p) { use *p;  ring.CommitPop();  }
+//
+// Records spanning several slots are pushed with Reserve(n), PushSlot(0..n-1)
+// and CommitPush(n), which publishes them all at once; the consumer reads the
+// rest of a record it has seen the start of with PopSlot and CommitPop(n).
+//
+// Each side keeps a cached copy of the other side's index so the shared cache
+// lines are only touched when the ring looks full/empty.
+//-----------------------------------------------------------------------------
+template <typename T, uint32 N>
+class CSpscRing
+{
+public:
+	CSpscRing() : m_nHead(0), m_nTailCache(0), m_nTail(0), m_nHeadCache(0)
+	{
+		static_assert((N & (N - 1)) == 0, "CSpscRing size must be a power of two");
+		m_pSlots = new T[N];
+	}
+
+	~CSpscRing()
+	{
+		delete[] m_pSlots;
+	}
+
+	// producer side
+	T* BeginPush()
+	{
+		uint32 head = m_nHead.load(std::memory_order_relaxed);
+		if (head - m_nTailCache >= N)
+		{
+			m_nTailCache = m_nTail.load(std::memory_order_acquire);
+			if (head - m_nTailCache >= N)
+				return NULL;
+		}
+		return &m_pSlots[head & (N - 1)];
+	}
+
+	bool Reserve(uint32 nCount)
+	{
+		uint32 head = m_nHead.load(std::memory_order_relaxed);
+		if (head + nCount - m_nTailCache > N)
+		{
+			m_nTailCache = m_nTail.load(std::memory_order_acquire);
+			if (head + nCount - m_nTailCache > N)
+				return false;
+		}
+		return true;
+	}
+
+	T* PushSlot(uint32 nIndex)
+	{
+		return &m_pSlots[(m_nHead.load(std::memory_order_relaxed) + nIndex) & (N - 1)];
+	}
+
+	void CommitPush(uint32 nCount = 1)
+	{
+		m_nHead.store(m_nHead.load(std::memory_order_relaxed) + nCount, std::memory_order_release);
+	}
+
+	// consumer side
+	T* BeginPop()
+	{
+		uint32 tail = m_nTail.load(std::memory_order_relaxed);
+		if (tail == m_nHeadCache)
+		{
+			m_nHeadCache = m_nHead.load(std::memory_order_acquire);
+			if (tail == m_nHeadCache)
+				return NULL;
+		}
+		return &m_pSlots[tail & (N - 1)];
+	}
+
+	T* PopSlot(uint32 nIndex)
+	{
+		return &m_pSlots[(m_nTail.load(std::memory_order_relaxed) + nIndex) & (N - 1)];
+	}
+
+	void CommitPop(uint32 nCount = 1)
+	{
+		m_nTail.store(m_nTail.load(std::memory_order_relaxed) + nCount, std::memory_order_release);
+	}
+
+private:
+	CSpscRing(const CSpscRing&);
+	CSpscRing& operator=(const CSpscRing&);
+
+	// producer owned
+	std::atomic<uint32>	m_nHead;
+	uint32				m_nTailCache;
+	char				m_pad0[CACHE_LINE_SIZE - sizeof(std::atomic<uint32>) - sizeof(uint32)];
+
+	// consumer owned
+	std::atomic<uint32>	m_nTail;
+	uint32				m_nHeadCache;
+	char				m_pad1[CACHE_LINE_SIZE - sizeof(std::atomic<uint32>) - sizeof(uint32)];
+
+	T*					m_pSlots;
+};
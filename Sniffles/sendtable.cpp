@@ -0,0 +1,538 @@
+#include "sendtable.h"
+
+#include <algorithm>
+#include <map>
+
+typedef CSVCMsg_SendTable::sendprop_t sendprop_t;
+
+// Data tables nest a few levels deep, anything past this is a loop
+#define SENDTABLE_MAX_DEPTH		32
+
+//-----------------------------------------------------------------------------
+// Flattens one server class at a time. Mirrors the engine's
+// SendTable_BuildHierarchy and SendTable_SortByPriority, since the field
+// indices on the wire only mean something in exactly that order.
+//-----------------------------------------------------------------------------
+struct send_table_builder_t
+{
+	struct flat_prop_t
+	{
+		const CSVCMsg_SendTable*	pTable;
+		const sendprop_t*			pProp;
+		const sendprop_t*			pElement;	// DPT_Array only
+	};
+
+	struct exclude_t
+	{
+		const std::string*	pTable;
+		const std::string*	pName;
+	};
+
+	std::map<std::string, const CSVCMsg_SendTable*>	tables;
+	std::vector<exclude_t>		excludes;
+	std::vector<flat_prop_t>	props;
+	bool						bFailed;
+
+	const CSVCMsg_SendTable* FindTable(const std::string& strName) const
+	{
+		std::map<std::string, const CSVCMsg_SendTable*>::const_iterator it = tables.find(strName);
+		return it != tables.end() ? it->second : NULL;
+	}
+
+	void GatherExcludes(const CSVCMsg_SendTable& table, int nDepth)
+	{
+		if (nDepth > SENDTABLE_MAX_DEPTH)
+		{
+			bFailed = true;
+			return;
+		}
+
+		for (int i = 0; i < table.props_size(); i++)
+		{
+			const sendprop_t& prop = table.props(i);
+
+			if (prop.flags() & SPROP_EXCLUDE)
+			{
+				exclude_t exclude;
+				exclude.pTable = &prop.dt_name();
+				exclude.pName = &prop.var_name();
+				excludes.push_back(exclude);
+			}
+
+			if (prop.type() == DPT_DataTable)
+			{
+				const CSVCMsg_SendTable* pSubTable = FindTable(prop.dt_name());
+				if (pSubTable)
+					GatherExcludes(*pSubTable, nDepth + 1);
+			}
+		}
+	}
+
+	bool IsExcluded(const CSVCMsg_SendTable& table, const sendprop_t& prop) const
+	{
+		for (size_t i = 0; i < excludes.size(); i++)
+		{
+			if (*excludes[i].pTable == table.net_table_name() && *excludes[i].pName == prop.var_name())
+				return true;
+		}
+
+		return false;
+	}
+
+	// A collapsible sub table's props join its parent's list. Any other sub
+	// table is gathered on its own and lands before the parent's props.
+	void IterateProps(const CSVCMsg_SendTable& table, std::vector<flat_prop_t>& tableProps, int nDepth)
+	{
+		if (nDepth > SENDTABLE_MAX_DEPTH)
+		{
+			bFailed = true;
+			return;
+		}
+
+		for (int i = 0; i < table.props_size(); i++)
+		{
+			const sendprop_t& prop = table.props(i);
+
+			if ((prop.flags() & (SPROP_INSIDEARRAY | SPROP_EXCLUDE)) || IsExcluded(table, prop))
+				continue;
+
+			if (prop.type() == DPT_DataTable)
+			{
+				const CSVCMsg_SendTable* pSubTable = FindTable(prop.dt_name());
+				if (!pSubTable)
+					continue;
+
+				if (prop.flags() & SPROP_COLLAPSIBLE)
+					IterateProps(*pSubTable, tableProps, nDepth + 1);
+				else
+					GatherProps(*pSubTable, nDepth + 1);
+				continue;
+			}
+
+			if ((uint32)prop.type() >= DPT_NUMSendPropTypes)
+			{
+				bFailed = true;
+				continue;
+			}
+
+			flat_prop_t flat;
+			flat.pTable = &table;
+			flat.pProp = &prop;
+			flat.pElement = NULL;
+
+			if (prop.type() == DPT_Array)
+			{
+				// the element description is the prop right before the array,
+				// and arrays don't nest
+				if (i == 0 || !send_prop_is_element_type(table.props(i - 1).type()))
+				{
+					bFailed = true;
+					continue;
+				}
+				flat.pElement = &table.props(i - 1);
+			}
+
+			tableProps.push_back(flat);
+		}
+	}
+
+	void GatherProps(const CSVCMsg_SendTable& table, int nDepth)
+	{
+		std::vector<flat_prop_t> tableProps;
+		IterateProps(table, tableProps, nDepth);
+		props.insert(props.end(), tableProps.begin(), tableProps.end());
+	}
+
+	// Not a stable sort; the swaps have to be exactly the engine's
+	void SortByPriority()
+	{
+		std::vector<int> priorities;
+		priorities.push_back(SENDPROP_CHANGES_OFTEN_PRIORITY);
+
+		for (size_t i = 0; i < props.size(); i++)
+		{
+			int nPriority = props[i].pProp->priority();
+			if (std::find(priorities.begin(), priorities.end(), nPriority) == priorities.end())
+				priorities.push_back(nPriority);
+		}
+
+		std::sort(priorities.begin(), priorities.end());
+
+		size_t nStart = 0;
+		for (size_t i = 0; i < priorities.size(); i++)
+		{
+			int nPriority = priorities[i];
+
+			while (true)
+			{
+				size_t nCurrent = nStart;
+				while (nCurrent < props.size())
+				{
+					const sendprop_t* pProp = props[nCurrent].pProp;
+
+					if (pProp->priority() == nPriority ||
+						(nPriority == SENDPROP_CHANGES_OFTEN_PRIORITY && (pProp->flags() & SPROP_CHANGES_OFTEN)))
+					{
+						if (nStart != nCurrent)
+							std::swap(props[nStart], props[nCurrent]);
+
+						nStart++;
+						break;
+					}
+
+					nCurrent++;
+				}
+
+				if (nCurrent == props.size())
+					break;
+			}
+		}
+	}
+};
+
+static uint8 prop_decode_type(const sendprop_t& prop)
+{
+	int nFlags = prop.flags();
+
+	switch (prop.type())
+	{
+	case DPT_Int:
+	case DPT_Int64:
+		if (nFlags & SPROP_VARINT)
+			return (nFlags & SPROP_UNSIGNED) ? PROP_DECODE_UVARINT : PROP_DECODE_VARINT;
+		return (nFlags & SPROP_UNSIGNED) ? PROP_DECODE_UINT : PROP_DECODE_INT;
+
+	case DPT_Float:
+	case DPT_Vector:
+	case DPT_VectorXY:
+		// same precedence as the engine's DecodeSpecialFloat
+		if (nFlags & SPROP_COORD)
+			return PROP_DECODE_COORD;
+		if (nFlags & SPROP_COORD_MP)
+			return PROP_DECODE_COORD_MP;
+		if (nFlags & SPROP_COORD_MP_LOWPRECISION)
+			return PROP_DECODE_COORD_MP_LOWPRECISION;
+		if (nFlags & SPROP_COORD_MP_INTEGRAL)
+			return PROP_DECODE_COORD_MP_INTEGRAL;
+		if (nFlags & SPROP_NOSCALE)
+			return PROP_DECODE_NOSCALE;
+		if (nFlags & SPROP_NORMAL)
+			return PROP_DECODE_NORMAL;
+		if (nFlags & SPROP_CELL_COORD)
+			return PROP_DECODE_CELL_COORD;
+		if (nFlags & SPROP_CELL_COORD_LOWPRECISION)
+			return PROP_DECODE_CELL_COORD_LOWPRECISION;
+		if (nFlags & SPROP_CELL_COORD_INTEGRAL)
+			return PROP_DECODE_CELL_COORD_INTEGRAL;
+		return PROP_DECODE_FLOAT;
+	}
+
+	return PROP_DECODE_INT;
+}
+
+static uint32 add_string(std::vector<char>& strings, std::map<std::string, uint32>& offsets, const std::string& str)
+{
+	std::map<std::string, uint32>::const_iterator it = offsets.find(str);
+	if (it != offsets.end())
+		return it->second;
+
+	uint32 nOffset = (uint32)strings.size();
+	strings.insert(strings.end(), str.begin(), str.end());
+	strings.push_back('\0');
+	offsets[str] = nOffset;
+	return nOffset;
+}
+
+static send_prop_t make_send_prop(const CSVCMsg_SendTable& table, const sendprop_t& prop,
+	std::vector<char>& strings, std::map<std::string, uint32>& offsets)
+{
+	send_prop_t sendProp;
+	memset(&sendProp, 0, sizeof(sendProp));
+
+	// Bit counts come off the wire; keep them in range of the bit reader
+	int nBits = prop.num_bits();
+	int nMaxBits = prop.type() == DPT_Int64 ? 64 : 32;
+	if (nBits < 0)
+		nBits = 0;
+	if (nBits > nMaxBits)
+		nBits = nMaxBits;
+
+	int nElements = prop.num_elements();
+	if (nElements < 0)
+		nElements = 0;
+	if (nElements > 0xFFFF)
+		nElements = 0xFFFF;
+
+	sendProp.nFlags = (uint32)prop.flags();
+	sendProp.flLowValue = prop.low_value();
+	sendProp.flHighValue = prop.high_value();
+	sendProp.nNameOffset = add_string(strings, offsets, prop.var_name());
+	sendProp.nTableOffset = add_string(strings, offsets, table.net_table_name());
+	sendProp.nElements = (uint16)nElements;
+	sendProp.nType = (uint8)prop.type();
+	sendProp.nDecode = prop_decode_type(prop);
+	sendProp.nBits = (uint8)nBits;
+	sendProp.nPriority = (uint8)prop.priority();
+	return sendProp;
+}
+
+CSendTables::CSendTables()
+{
+	m_nGeneration = 0;
+	Clear();
+}
+
+void CSendTables::Clear()
+{
+	m_classes.clear();
+	m_props.clear();
+	m_strings.clear();
+	m_pClasses = NULL;
+	m_pProps = NULL;
+	m_pStrings = NULL;
+	m_nClasses = 0;
+	m_nProps = 0;
+	m_nStrings = 0;
+	m_nClassBits = 0;
+	m_nGeneration++;
+}
+
+bool CSendTables::Build(const std::vector<CSVCMsg_SendTable>& tables, const CSVCMsg_ClassInfo& classInfo)
+{
+	int nClasses = classInfo.classes_size();
+	if (nClasses <= 0 || nClasses > SENDTABLE_MAX_CLASSES)
+		return false;
+
+	std::vector<server_class_t> classes(nClasses);
+	std::vector<send_prop_t> props;
+	std::vector<char> strings;
+	std::map<std::string, uint32> offsets;
+
+	send_table_builder_t builder;
+	for (size_t i = 0; i < tables.size(); i++)
+		builder.tables[tables[i].net_table_name()] = &tables[i];
+
+	memset(classes.data(), 0, nClasses * sizeof(server_class_t));
+
+	for (int i = 0; i < nClasses; i++)
+	{
+		const CSVCMsg_ClassInfo::class_t& classEntry = classInfo.classes(i);
+
+		int nClass = classEntry.class_id();
+		if (nClass < 0 || nClass >= nClasses)
+			return false;
+
+		const CSVCMsg_SendTable* pTable = builder.FindTable(classEntry.data_table_name());
+		if (!pTable)
+			return false;
+
+		builder.excludes.clear();
+		builder.props.clear();
+		builder.bFailed = false;
+
+		builder.GatherExcludes(*pTable, 0);
+		builder.GatherProps(*pTable, 0);
+		builder.SortByPriority();
+
+		if (builder.bFailed || builder.props.size() > SENDTABLE_MAX_PROPS)
+			return false;
+
+		server_class_t& serverClass = classes[nClass];
+		serverClass.nFirstProp = (uint32)props.size();
+		serverClass.nProps = (uint32)builder.props.size();
+		serverClass.nNameOffset = add_string(strings, offsets, classEntry.class_name());
+		serverClass.nTableOffset = add_string(strings, offsets, classEntry.data_table_name());
+
+		for (size_t j = 0; j < builder.props.size(); j++)
+			props.push_back(make_send_prop(*builder.props[j].pTable, *builder.props[j].pProp, strings, offsets));
+
+		// Array element descriptions go after the class's own props and
+		// values are laid out once they are all known
+		uint32 nValueSize = 0;
+		for (size_t j = 0; j < builder.props.size(); j++)
+		{
+			const send_table_builder_t::flat_prop_t& flat = builder.props[j];
+			const send_prop_t* pElement = NULL;
+
+			if (flat.pElement)
+			{
+				props[serverClass.nFirstProp + j].nElementProp = (uint16)(props.size() - serverClass.nFirstProp);
+				props.push_back(make_send_prop(*flat.pTable, *flat.pElement, strings, offsets));
+				pElement = &props.back();
+			}
+
+			send_prop_t& sendProp = props[serverClass.nFirstProp + j];
+			sendProp.nValueOffset = nValueSize;
+			nValueSize += (send_prop_value_size(sendProp, pElement) + 3) & ~3u;
+		}
+
+		if (nValueSize > SENDTABLE_MAX_VALUE_SIZE)
+			return false;
+
+		serverClass.nAllProps = (uint32)props.size() - serverClass.nFirstProp;
+		serverClass.nValueSize = nValueSize;
+	}
+
+	// Class ids are sent in Q_log2(nClasses) + 1 bits
+	int nClassBits = 0;
+	for (int n = nClasses; n >>= 1; )
+		nClassBits++;
+
+	// the pool is saved as is, so keep it a multiple of 4
+	strings.resize((strings.size() + 3) & ~3u, '\0');
+
+	m_classes.swap(classes);
+	m_props.swap(props);
+	m_strings.swap(strings);
+	m_pClasses = m_classes.data();
+	m_pProps = m_props.data();
+	m_pStrings = m_strings.data();
+	m_nClasses = (uint32)m_classes.size();
+	m_nProps = (uint32)m_props.size();
+	m_nStrings = (uint32)m_strings.size();
+	m_nClassBits = nClassBits + 1;
+	m_nGeneration++;
+	return true;
+}
+
+void CSendTables::Save(std::string& strOut) const
+{
+	send_table_layout_t header;
+	header.nMagic = SENDTABLE_LAYOUT_MAGIC;
+	header.nVersion = SENDTABLE_LAYOUT_VERSION;
+	header.nClasses = m_nClasses;
+	header.nProps = m_nProps;
+	header.nStrings = m_nStrings;
+	header.nClassBits = (uint32)m_nClassBits;
+
+	strOut.clear();
+	strOut.reserve(sizeof(header) + m_nClasses * sizeof(server_class_t) + m_nProps * sizeof(send_prop_t) + m_nStrings);
+	strOut.append((const char*)&header, sizeof(header));
+	strOut.append((const char*)m_pClasses, m_nClasses * sizeof(server_class_t));
+	strOut.append((const char*)m_pProps, m_nProps * sizeof(send_prop_t));
+	strOut.append(m_pStrings, m_nStrings);
+}
+
+//-----------------------------------------------------------------------------
+// A stored layout is only as good as the disk it came from, so everything the
+// decoder indexes with is checked once here rather than on every update
+//-----------------------------------------------------------------------------
+static bool valid_string(const char* pStrings, uint32 nStrings, uint32 nOffset)
+{
+	return nOffset < nStrings && memchr(pStrings + nOffset, '\0', nStrings - nOffset) != NULL;
+}
+
+static bool valid_send_prop(const send_prop_t& prop, const char* pStrings, uint32 nStrings)
+{
+	if (prop.nType >= DPT_NUMSendPropTypes || prop.nType == DPT_DataTable || prop.nDecode > PROP_DECODE_CELL_COORD_INTEGRAL)
+		return false;
+	if (prop.nBits > (prop.nType == DPT_Int64 ? 64 : 32))
+		return false;
+	return valid_string(pStrings, nStrings, prop.nNameOffset) && valid_string(pStrings, nStrings, prop.nTableOffset);
+}
+
+bool CSendTables::Attach(const void* pData, size_t nSize)
+{
+	send_table_layout_t header;
+	if (nSize < sizeof(header) || ((uintp)pData & 3))
+		return false;
+
+	memcpy(&header, pData, sizeof(header));
+	if (header.nMagic != SENDTABLE_LAYOUT_MAGIC || header.nVersion != SENDTABLE_LAYOUT_VERSION)
+		return false;
+	// every class at its largest, each prop an array, keeps the sizes below
+	// from overflowing
+	if (!header.nClasses || header.nClasses > SENDTABLE_MAX_CLASSES || header.nClassBits > 32 ||
+		header.nProps > SENDTABLE_MAX_CLASSES * 2 * SENDTABLE_MAX_PROPS || (header.nStrings & 3))
+		return false;
+
+	size_t nClassBytes = header.nClasses * sizeof(server_class_t);
+	size_t nPropBytes = (size_t)header.nProps * sizeof(send_prop_t);
+	if (nSize != sizeof(header) + nClassBytes + nPropBytes + header.nStrings)
+		return false;
+
+	const uint8* pBytes = (const uint8*)pData + sizeof(header);
+	const server_class_t* pClasses = (const server_class_t*)pBytes;
+	const send_prop_t* pProps = (const send_prop_t*)(pBytes + nClassBytes);
+	const char* pStrings = (const char*)(pBytes + nClassBytes + nPropBytes);
+
+	for (uint32 i = 0; i < header.nClasses; i++)
+	{
+		const server_class_t& serverClass = pClasses[i];
+
+		if (serverClass.nProps > SENDTABLE_MAX_PROPS || serverClass.nAllProps < serverClass.nProps ||
+			serverClass.nFirstProp > header.nProps || serverClass.nAllProps > header.nProps - serverClass.nFirstProp ||
+			serverClass.nValueSize > SENDTABLE_MAX_VALUE_SIZE)
+			return false;
+		if (!valid_string(pStrings, header.nStrings, serverClass.nNameOffset) ||
+			!valid_string(pStrings, header.nStrings, serverClass.nTableOffset))
+			return false;
+
+		const send_prop_t* pClassProps = pProps + serverClass.nFirstProp;
+		for (uint32 j = 0; j < serverClass.nAllProps; j++)
+		{
+			const send_prop_t& prop = pClassProps[j];
+			if (!valid_send_prop(prop, pStrings, header.nStrings))
+				return false;
+
+			// only the class's own props get values, each inside the block
+			if (j >= serverClass.nProps)
+				continue;
+
+			const send_prop_t* pElement = NULL;
+			if (prop.nType == DPT_Array)
+			{
+				if (prop.nElementProp < serverClass.nProps || prop.nElementProp >= serverClass.nAllProps)
+					return false;
+
+				pElement = &pClassProps[prop.nElementProp];
+				if (!send_prop_is_element_type(pElement->nType))
+					return false;
+			}
+
+			if (prop.nValueOffset > serverClass.nValueSize ||
+				send_prop_value_size(prop, pElement) > serverClass.nValueSize - prop.nValueOffset)
+				return false;
+		}
+	}
+
+	Clear();
+	m_pClasses = pClasses;
+	m_pProps = pProps;
+	m_pStrings = pStrings;
+	m_nClasses = header.nClasses;
+	m_nProps = header.nProps;
+	m_nStrings = header.nStrings;
+	m_nClassBits = (int)header.nClassBits;
+	return true;
+}
+
+int CSendTables::FindProp(int nClass, const char* pszName, const char* pszTable) const
+{
+	const server_class_t* pClass = GetClass(nClass);
+	if (!pClass)
+		return -1;
+
+	const send_prop_t* pProps = GetProps(*pClass);
+	for (uint32 i = 0; i < pClass->nProps; i++)
+	{
+		if (strcmp(GetString(pProps[i].nNameOffset), pszName))
+			continue;
+		if (pszTable && strcmp(GetString(pProps[i].nTableOffset), pszTable))
+			continue;
+		return (int)i;
+	}
+
+	return -1;
+}
+
+int CSendTables::FindClass(const char* pszName) const
+{
+	for (uint32 i = 0; i < m_nClasses; i++)
+	{
+		if (!strcmp(GetString(m_pClasses[i].nNameOffset), pszName))
+			return (int)i;
+	}
+
+	return -1;
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "platform.h"
+#include "net.h"
+
+enum SendPropType
+{
+	DPT_Int = 0,
+	DPT_Float,
+	DPT_Vector,
+	DPT_VectorXY,
+	DPT_String,
+	DPT_Array,			// elements are described by the prop before it
+	DPT_DataTable,
+	DPT_Int64,
+	DPT_NUMSendPropTypes
+};
+
+#define SPROP_UNSIGNED					(1<<0)	// unsigned integer data
+#define SPROP_COORD						(1<<1)	// float/vector is a world coordinate, ReadBitCoord
+#define SPROP_NOSCALE					(1<<2)	// float/vector is sent as a raw 32 bit float
+#define SPROP_ROUNDDOWN					(1<<3)
+#define SPROP_ROUNDUP					(1<<4)
+#define SPROP_NORMAL					(1<<5)	// vector is a normal, z is derived from x and y
+#define SPROP_EXCLUDE					(1<<6)	// names a prop (dt_name.var_name) to leave out of the class
+#define SPROP_XYZE						(1<<7)
+#define SPROP_INSIDEARRAY				(1<<8)	// element description of the DPT_Array that follows
+#define SPROP_PROXY_ALWAYS_YES			(1<<9)
+#define SPROP_IS_A_VECTOR_ELEM			(1<<10)
+#define SPROP_COLLAPSIBLE				(1<<11)	// data table is merged into its parent's prop list
+#define SPROP_COORD_MP					(1<<12)
+#define SPROP_COORD_MP_LOWPRECISION		(1<<13)
+#define SPROP_COORD_MP_INTEGRAL			(1<<14)
+#define SPROP_CELL_COORD				(1<<15)
+#define SPROP_CELL_COORD_LOWPRECISION	(1<<16)
+#define SPROP_CELL_COORD_INTEGRAL		(1<<17)
+#define SPROP_CHANGES_OFTEN				(1<<18)	// sorted first, with priority SENDPROP_CHANGES_OFTEN_PRIORITY
+#define SPROP_VARINT					(1<<19)
+
+#define SENDPROP_CHANGES_OFTEN_PRIORITY	64
+
+#define DT_MAX_STRING_BITS				9
+#define DT_MAX_STRING_BUFFERSIZE		(1 << DT_MAX_STRING_BITS)
+
+#define SENDTABLE_MAX_CLASSES			1024	// MAX_SERVER_CLASS_BITS is 9 in the engine
+#define SENDTABLE_MAX_PROPS				4096	// flattened props per class, MAX_DATATABLE_PROPS
+#define SENDTABLE_MAX_VALUE_SIZE		(1 << 20)	// bytes of one entity's values
+
+#define SENDTABLE_LAYOUT_MAGIC			0x4C54534E	// "NSTL"
+#define SENDTABLE_LAYOUT_VERSION		1
+
+// How a prop's scalars are read off the wire, resolved from its flags when
+// the tables are built so decoding is a single switch
+enum send_prop_decode_t
+{
+	PROP_DECODE_INT,				// nBits, sign extended
+	PROP_DECODE_UINT,
+	PROP_DECODE_VARINT,				// zigzag
+	PROP_DECODE_UVARINT,
+	PROP_DECODE_FLOAT,				// nBits quantized between flLowValue and flHighValue
+	PROP_DECODE_COORD,
+	PROP_DECODE_COORD_MP,
+	PROP_DECODE_COORD_MP_LOWPRECISION,
+	PROP_DECODE_COORD_MP_INTEGRAL,
+	PROP_DECODE_NOSCALE,
+	PROP_DECODE_NORMAL,
+	PROP_DECODE_CELL_COORD,
+	PROP_DECODE_CELL_COORD_LOWPRECISION,
+	PROP_DECODE_CELL_COORD_INTEGRAL,
+};
+
+//-----------------------------------------------------------------------------
+// A networked property after flattening: everything needed to decode it and
+// where an entity keeps its value. Plain data with offsets instead of
+// pointers, so a whole set of tables can be stored and loaded as is.
+//-----------------------------------------------------------------------------
+struct send_prop_t
+{
+	uint32	nFlags;			// SPROP_*
+	float	flLowValue;
+	float	flHighValue;
+	uint32	nNameOffset;	// var_name in the string pool
+	uint32	nTableOffset;	// net_table_name of the table that declares it
+	uint32	nValueOffset;	// into the entity's value block
+	uint16	nElementProp;	// DPT_Array: element description, indexed like the class's props
+	uint16	nElements;		// DPT_Array: most elements sent
+	uint8	nType;			// SendPropType
+	uint8	nDecode;		// send_prop_decode_t
+	uint8	nBits;
+	uint8	nPriority;
+};
+
+struct server_class_t
+{
+	uint32	nFirstProp;		// into the prop array
+	uint32	nProps;			// flattened props, in the order they are sent
+	uint32	nAllProps;		// plus the array element descriptions that follow them
+	uint32	nValueSize;		// bytes of an entity's value block
+	uint32	nNameOffset;	// class_name
+	uint32	nTableOffset;	// data_table_name
+};
+
+// Bytes a value of the prop takes in an entity's value block. Strings are a
+// uint32 length and DT_MAX_STRING_BUFFERSIZE bytes, arrays a uint32 element
+// count and room for every element.
+static inline uint32 send_prop_value_size(const send_prop_t& prop, const send_prop_t* pElement)
+{
+	switch (prop.nType)
+	{
+	case DPT_Int:
+	case DPT_Float:
+		return 4;
+	case DPT_Int64:
+	case DPT_VectorXY:
+		return 8;
+	case DPT_Vector:
+		return 12;
+	case DPT_String:
+		return 4 + DT_MAX_STRING_BUFFERSIZE;
+	case DPT_Array:
+		return pElement ? 4 + prop.nElements * send_prop_value_size(*pElement, NULL) : 4;
+	}
+
+	return 0;
+}
+
+// Array elements are a single scalar, never a table or another array
+static inline bool send_prop_is_element_type(int nType)
+{
+	return nType >= DPT_Int && nType < DPT_NUMSendPropTypes && nType != DPT_Array && nType != DPT_DataTable;
+}
+
+// A saved layout starts with this, followed by the classes, the props and the
+// string pool. Everything is 4 byte aligned and little endian.
+struct send_table_layout_t
+{
+	uint32	nMagic;			// SENDTABLE_LAYOUT_MAGIC
+	uint32	nVersion;		// SENDTABLE_LAYOUT_VERSION
+	uint32	nClasses;
+	uint32	nProps;
+	uint32	nStrings;		// bytes, padded to 4
+	uint32	nClassBits;
+};
+
+//-----------------------------------------------------------------------------
+// The flattened prop lists of every server class, built once per signon from
+// the svc_SendTable burst and svc_ClassInfo the way the engine builds them:
+// excluded props removed, collapsible tables merged into their parent, then
+// sorted by priority. Field indices in entity updates index these lists.
+//-----------------------------------------------------------------------------
+class CSendTables
+{
+public:
+	CSendTables();
+
+	// False when a class names a table that wasn't sent or a class is larger
+	// than SENDTABLE_MAX_PROPS/SENDTABLE_MAX_VALUE_SIZE; the previous layout
+	// is kept then
+	bool			Build(const std::vector<CSVCMsg_SendTable>& tables, const CSVCMsg_ClassInfo& classInfo);
+	void			Clear();
+
+	// A layout as one block, for storing and loading it as is
+	void			Save(std::string& strOut) const;
+
+	// Uses a saved layout in place, nothing is copied. The block must stay
+	// valid and unchanged until the tables are built, cleared or attached
+	// again. False when it isn't a layout that could have come from Build.
+	bool			Attach(const void* pData, size_t nSize);
+
+	bool			IsReady() const { return m_nClasses != 0; }
+
+	// Changes whenever the layout does, for caches derived from it
+	uint32			GetGeneration() const { return m_nGeneration; }
+	int				GetClassCount() const { return (int)m_nClasses; }
+
+	// Bits of the class id sent with every entity entering the PVS
+	int				GetClassBits() const { return m_nClassBits; }
+
+	const server_class_t*	GetClass(int nClass) const
+	{
+		return (uint32)nClass < m_nClasses ? &m_pClasses[nClass] : NULL;
+	}
+
+	const send_prop_t*	GetProps(const server_class_t& serverClass) const { return m_pProps + serverClass.nFirstProp; }
+	const char*		GetString(uint32 nOffset) const { return &m_pStrings[nOffset]; }
+
+	// Flattened index of a prop, optionally of a given declaring table, or -1
+	int				FindProp(int nClass, const char* pszName, const char* pszTable = NULL) const;
+	int				FindClass(const char* pszName) const;
+
+private:
+	CSendTables(const CSendTables&);
+	CSendTables& operator=(const CSendTables&);
+
+	// Built tables live here, attached ones wherever the caller keeps them
+	std::vector<server_class_t>	m_classes;
+	std::vector<send_prop_t>	m_props;
+	std::vector<char>			m_strings;
+
+	const server_class_t*		m_pClasses;		// indexed by class id
+	const send_prop_t*			m_pProps;
+	const char*					m_pStrings;
+	uint32						m_nClasses;
+	uint32						m_nProps;
+	uint32						m_nStrings;
+	int							m_nClassBits;
+	uint32						m_nGeneration;
+};
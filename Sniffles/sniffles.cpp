@@ -2,162 +2,345 @@
 //
 #include "sniffles.h"
 
-const unsigned char g_iceKey[] = { 0x43, 0x53, 0x47, 0x4F, 0xCC, 0x34, 0x00, 0x00, 0x33, 0x0D, 0x00, 0x00, 0x4C, 0x03, 0x00, 0x00 };
+struct capture_t
+{
+	int					nLinkType;
+	decode_stats_t		stats;		// frame counters, owned by the capture thread
+	CNetDecoder*		pDecoder;	// decode inline...
+	CDecodePipeline*	pPipeline;	// ...or hand off to the workers
+};
+
+void pcap_packet_handler(u_char* user, const struct pcap_pkthdr* header, const u_char* data)
+{
+	capture_t* pCapture = (capture_t*)user;
 
-int ReadPacket(unsigned char* packetData, int size)
-{	
-	if (size < 8)
-		return size;
+	pCapture->stats.nFrames++;
+	pCapture->stats.nFrameBytes += header->caplen;
 
-	unsigned char data[NET_MAX_PAYLOAD];
-	CBitRead buf(data, NET_MAX_PAYLOAD);
-	memcpy((void*)buf.GetBasePointer(), packetData, size);
-	buf.Seek(0);
+	udp_frame_t frame;
+	if (!parse_udp_frame(pCapture->nLinkType, data, header->caplen, frame))
+		return;
 
-	int32 nSeqNrIn = buf.ReadSBitLong(32); // SeqNrIn
-	int32 nSeqNrOut = buf.ReadSBitLong(32); // SeqNrOut
-	int32 nFlags = buf.ReadVarInt32(); // nFlags
-	
-	int unk0 = buf.ReadSBitLong(16); // dunno what this is
-	int unk1 = buf.ReadSignedVarInt32(); // dunno what this is
+	frame.nTimestampUs = (uint64)header->ts.tv_sec * 1000000 + header->ts.tv_usec;
+
+	if (pCapture->pPipeline)
+		pCapture->pPipeline->Push(frame);
+	else
+		pCapture->pDecoder->ProcessDatagram(frame);
+}
+
+// Runs the capture off the raw pcap handle so we never build a PDU tree. With
+// more than one thread, datagrams are sharded by flow across decode workers.
+void capture_loop(BaseSniffer& sniffer, int nThreads, bool bOffline, decode_stats_t& stats)
+{
+	pcap_t* handle = sniffer.get_pcap_handle();
+
+	capture_t capture;
+	capture.nLinkType = pcap_datalink(handle);
+	capture.pDecoder = NULL;
+	capture.pPipeline = NULL;
+	reset_stats(capture.stats);
 
-	if (!nFlags || ((unsigned char)nFlags) >= 0xE1u)
+	if (nThreads > 1)
 	{
+		CDecodePipeline pipeline(nThreads, bOffline);
+		capture.pPipeline = &pipeline;
 
-		while (buf.GetNumBytesRead() < size)
-		{
-			int Cmd = buf.ReadVarInt32();
-			int Size = buf.ReadVarInt32();
+		pcap_loop(handle, -1, pcap_packet_handler, (u_char*)&capture);
 
-			void* parseBuffer = (void*)((int)buf.GetBasePointer() + buf.GetNumBytesRead());
-			size_t bufferSize = Size;
+		pipeline.Stop();
+		pipeline.CollectStats(stats);
+	}
+	else
+	{
+		CNetDecoder decoder;
+		capture.pDecoder = &decoder;
 
-			switch (Cmd)
-			{
+		pcap_loop(handle, -1, pcap_packet_handler, (u_char*)&capture);
 
-			case net_Tick:
-			{
-				CNETMsg_Tick msg;
-				if (msg.ParseFromArray(parseBuffer, bufferSize))
-					MsgPrintf(msg, bufferSize, "%s", msg.DebugString().c_str());
-			}
-			break;
+		merge_stats(stats, decoder.m_stats);
+	}
 
-			case net_SignonState:
-			{
-				CNETMsg_SignonState msg;
-				if (msg.ParseFromArray(parseBuffer, bufferSize))
-					MsgPrintf(msg, bufferSize, "%s", msg.DebugString().c_str());
-			}
-			break;
+	// frames the kernel or driver dropped before pcap saw them
+	struct pcap_stat kernelStats;
+	if (!bOffline && pcap_stats(handle, &kernelStats) == 0)
+		stats.nDropped += kernelStats.ps_drop;
 
-			case svc_ServerInfo:
-			{
-				CSVCMsg_ServerInfo msg;
-				if (msg.ParseFromArray(parseBuffer, bufferSize))
-					MsgPrintf(msg, bufferSize, "%s", msg.DebugString().c_str());
-			}
-			break;
+	merge_stats(stats, capture.stats);
+}
 
-			case svc_PacketEntities:
-			{
-				CSVCMsg_PacketEntities msg;
-				if (msg.ParseFromArray(parseBuffer, bufferSize))
-					MsgPrintf(msg, bufferSize, "%s", msg.DebugString().c_str());
+// A live capture runs until Ctrl+C, which ends whichever loop is running so
+// the stats can be printed
+static pcap_t* volatile s_pLiveHandle = NULL;
+#ifdef __linux__
+static CAfPacketCapture* volatile s_pLiveAfPacket = NULL;
+#endif
 
-			}
-			break;
+static void on_interrupt(int /*nSignal*/)
+{
+	if (s_pLiveHandle)
+		pcap_breakloop(s_pLiveHandle);
+#ifdef __linux__
+	if (s_pLiveAfPacket)
+		s_pLiveAfPacket->Stop();
+#endif
+}
 
-			default:
-				break;
+// Stops the emitter and recorder after a live capture, then reports what it saw
+static void finish_capture(const decode_stats_t& stats, double flSeconds, CEventEmitter* pEmitter)
+{
+	if (pEmitter)
+		pEmitter->Stop();
 
-			}
+	bool bRecorded = g_corpusRecorder.IsOpen();
+	g_corpusRecorder.Close();
 
-			buf.SeekRelative(Size * 8);
-		}
-	}
+	if (pEmitter && pEmitter->IsStdout())
+		return;
+
+	print_stats(stats, flSeconds, true);
 
-	return size;
+	if (pEmitter)
+		pEmitter->PrintStats();
+	if (bRecorded)
+		outf("recorded %llu packets\n", (unsigned long long)g_corpusRecorder.GetPackets());
 }
 
-bool packet_loop_handler(PDU& eth) 
+// 0 means one decode worker per core, leaving one core for capture
+static int resolve_thread_count(int nThreads)
 {
-	//TCP* tcp = eth.find_pdu<TCP>();
-	IP* ip = eth.find_pdu<IP>();
-	if (!ip)
-		return 1;
-	UDP* udp = eth.find_pdu<UDP>();
-	if (!udp)
+	if (nThreads > 0)
+		return nThreads;
+
+	int nCores = (int)std::thread::hardware_concurrency();
+	return nCores > 2 ? nCores - 1 : 1;
+}
+
+static std::string tchar_to_string(const _TCHAR* str)
+{
+#ifdef _UNICODE
+	char buffer[MAX_OSPATH];
+	size_t converted = 0;
+	wcstombs_s(&converted, buffer, str, _TRUNCATE);
+	return std::string(buffer);
+#else
+	return std::string(str);
+#endif
+}
+
+// Feeds a pcap/pcapng file through the live decode path as fast as it can be read
+// and reports the achieved rates. Per-packet output is off unless bVerbose is set,
+// otherwise we would be measuring the console instead of the decoder. The
+// emitter, if any, is stopped once everything is decoded.
+int replay_capture(const std::string& strFile, bool bVerbose, int nThreads, CEventEmitter* pEmitter)
+{
+	g_bQuiet = !bVerbose;
+
+	decode_stats_t stats;
+	reset_stats(stats);
+
+	try
+	{
+		FileSniffer sniffer(strFile);
+
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		capture_loop(sniffer, nThreads, true, stats);
+		std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+
+		if (pEmitter)
+			pEmitter->Stop();
+
+		// the report would end up in the middle of the records
+		if (pEmitter && pEmitter->IsStdout())
+			return 0;
+
+		print_stats(stats, std::chrono::duration<double>(end - start).count());
+
+		if (pEmitter)
+			pEmitter->PrintStats();
+	}
+	catch (std::exception& e)
+	{
+		shout_error(e.what());
 		return 1;
+	}
 
-	if (udp->sport() == 27015)
+	return 0;
+}
+
+// Registers the ICE key of every build in a comma separated list
+static bool add_builds(const std::string& strBuilds)
+{
+	size_t nStart = 0;
+	while (nStart < strBuilds.size())
 	{
-		outf("\npacket %i:\n", ip->id());
-		outf("  ver: %i\n", ip->version());
-		outf("  src addr: %s:%i\n", ip->src_addr().to_string().c_str(), udp->dport());
-		outf("  dst addr: %s:%i\n", ip->dst_addr().to_string().c_str(), udp->dport());
-
-		RawPDU* raw = eth.find_pdu<RawPDU>();
-
-		std::vector<uint8> payload = raw->payload();
-		size_t size = raw->payload_size();
-		outf("  payload size: %d\n", size);
-
-		unsigned char* pData = payload.data();
-
-		IceKey ice(2);
-		ice.set(g_iceKey);
-		
-		uint8* pDataOut = (uint8*)malloc(size);
-		
-		int32 blockSize = ice.blockSize();
-		
-		uint8* p1 = pData;
-		uint8* p2 = pDataOut;
-		
-		// encrypt data in 8 byte blocks
-		int32 bytesLeft = size;
-		
-		while (bytesLeft >= blockSize)
+		size_t nEnd = strBuilds.find(',', nStart);
+		if (nEnd == std::string::npos)
+			nEnd = strBuilds.size();
+
+		int nBuild = atoi(strBuilds.substr(nStart, nEnd - nStart).c_str());
+		if (nBuild <= 0 || !g_iceKeys.AddBuild(nBuild))
 		{
-			ice.decrypt(p1, p2);
-		
-			bytesLeft -= blockSize;
-			p1 += blockSize;
-			p2 += blockSize;
+			shout_error("Bad -build list or too many builds");
+			return false;
 		}
-		
-		//The end chunk doesn't get an encryption. it sux.
-		memcpy(p2, p1, bytesLeft);
 
-		unsigned char deltaOffset = *(unsigned char*)pDataOut;
-		outf("  deltaOffset: %d\n", deltaOffset);
-		if (deltaOffset > 0 && (uint32)deltaOffset + 5 < size)
-		{
-			uint32 dataFinalSize = _byteswap_ulong(*(uint32*)&pDataOut[deltaOffset + 1]);
-			outf("  dataFinalSize: %d\n", dataFinalSize);
+		nStart = nEnd + 1;
+	}
+
+	return true;
+}
 
-			if (dataFinalSize + deltaOffset + 5 == size)
+int _tmain(int argc, _TCHAR* argv[])
+{
+	// Sniffles [-threads <n>] [-build <n>[,<n>...]] [-afpacket [-afpacketring <MB>]] [-replay <capture.pcap> [-verbose]] [-bench [filter]]
+	//          [-emit ndjson|binary <file|->] [-messages <name>[,<name>...]] [-record <corpus>] [-corpus <corpus>]
+	//          [-entities] [-tablecache <file>] [-gameevents] [-usermessages]
+	std::string strReplayFile;
+	std::string strBenchFilter;
+	std::string strEmitFile;
+	std::string strMessages;
+	std::string strTableCache;
+	std::string strRecordFile;
+	std::string strCorpusFile;
+	emit_format_t emitFormat = EMIT_FORMAT_NDJSON;
+	bool bBench = false;
+	bool bVerbose = false;
+	bool bAfPacket = false;
+	bool bEntities = false;
+	bool bGameEvents = false;
+	bool bUserMessages = false;
+	int nThreads = 1;
+	int nRingMB = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (!_tcscmp(argv[i], _T("-replay")) && i + 1 < argc)
+			strReplayFile = tchar_to_string(argv[++i]);
+		else if (!_tcscmp(argv[i], _T("-threads")) && i + 1 < argc)
+			nThreads = resolve_thread_count(_tstoi(argv[++i]));
+		else if (!_tcscmp(argv[i], _T("-verbose")))
+			bVerbose = true;
+		else if (!_tcscmp(argv[i], _T("-build")) && i + 1 < argc)
+		{
+			if (!add_builds(tchar_to_string(argv[++i])))
+				return 1;
+		}
+		else if (!_tcscmp(argv[i], _T("-afpacket")))
+			bAfPacket = true;
+		else if (!_tcscmp(argv[i], _T("-afpacketring")) && i + 1 < argc)
+			nRingMB = _tstoi(argv[++i]);
+		else if (!_tcscmp(argv[i], _T("-emit")) && i + 2 < argc)
+		{
+			if (!_tcscmp(argv[i + 1], _T("binary")))
+				emitFormat = EMIT_FORMAT_BINARY;
+			else if (_tcscmp(argv[i + 1], _T("ndjson")))
 			{
-				uint8* packetData = (uint8*)malloc(dataFinalSize);
-				memcpy(packetData, &pDataOut[deltaOffset + 5], dataFinalSize);
-				free(pDataOut);
-				if (packetData)
-				{
-					ReadPacket(packetData, dataFinalSize);
-					free(packetData);
-				}
+				shout_error("-emit format must be ndjson or binary");
+				return 1;
 			}
-		}			
-		
+
+			strEmitFile = tchar_to_string(argv[i + 2]);
+			i += 2;
+		}
+		else if (!_tcscmp(argv[i], _T("-messages")) && i + 1 < argc)
+			strMessages = tchar_to_string(argv[++i]);
+		else if (!_tcscmp(argv[i], _T("-entities")))
+			bEntities = true;
+		else if (!_tcscmp(argv[i], _T("-tablecache")) && i + 1 < argc)
+		{
+			strTableCache = tchar_to_string(argv[++i]);
+			bEntities = true;
+		}
+		else if (!_tcscmp(argv[i], _T("-gameevents")))
+			bGameEvents = true;
+		else if (!_tcscmp(argv[i], _T("-usermessages")))
+			bUserMessages = true;
+		else if (!_tcscmp(argv[i], _T("-bench")))
+		{
+			bBench = true;
+			if (i + 1 < argc && argv[i + 1][0] != '-')
+				strBenchFilter = tchar_to_string(argv[++i]);
+		}
+		else if (!_tcscmp(argv[i], _T("-record")) && i + 1 < argc)
+			strRecordFile = tchar_to_string(argv[++i]);
+		else if (!_tcscmp(argv[i], _T("-corpus")) && i + 1 < argc)
+			strCorpusFile = tchar_to_string(argv[++i]);
 	}
 
-	return 1;
-}
+	if (bBench)
+	{
+		return run_benchmarks(strBenchFilter.empty() ? NULL : strBenchFilter.c_str(),
+			strCorpusFile.empty() ? NULL : strCorpusFile.c_str());
+	}
 
+	// Emitted messages are written by the emitter's own thread; decoders only
+	// queue them
+	CEventEmitter emitter;
+	if (!strEmitFile.empty())
+	{
+		if (!emitter.Open(strEmitFile.c_str(), emitFormat))
+			return 1;
+
+		if (!emitter.Subscribe(g_dispatcher, strMessages.empty() ? NULL : strMessages.c_str()))
+		{
+			shout_error("Unknown message name in -messages");
+			return 1;
+		}
+
+		// stdout carries the records, nothing else may go there
+		if (emitter.IsStdout())
+		{
+			bVerbose = false;
+			g_bQuiet = true;
+		}
+	}
+
+	// Messages are only parsed for someone who wants them; with nothing to
+	// print, a replay just counts them
+	bool bPrint = (strReplayFile.empty() && strEmitFile.empty()) || bVerbose;
+	if (bPrint)
+		add_print_handlers(g_dispatcher);
+
+	// Entity state is kept per decoder, next to the session's other state
+	if (bEntities)
+		add_entity_handlers(g_dispatcher);
+
+	// Game events are decoded against their session's compiled event list,
+	// and printed along with the other messages
+	if (bGameEvents)
+		add_game_event_handlers(g_dispatcher, bPrint ? &g_printGameEvents : NULL);
+
+	// User messages are split out of svc_UserMessage in place, and only the
+	// types someone subscribed to are parsed
+	if (bUserMessages)
+	{
+		if (bPrint)
+			add_user_message_print_handlers(g_userMessages);
+		add_user_message_handlers(g_dispatcher, g_userMessages);
+	}
+
+	if (!strTableCache.empty())
+		g_sendTableCache.Open(strTableCache.c_str());
+
+	// Every packet the decoders read is written out for the corpus_* bench cases
+	if (!strRecordFile.empty() && !g_corpusRecorder.Open(strRecordFile.c_str()))
+		return 1;
+
+	if (!strReplayFile.empty())
+	{
+		int nResult = replay_capture(strReplayFile, bVerbose, nThreads, strEmitFile.empty() ? NULL : &emitter);
+
+		if (g_corpusRecorder.IsOpen())
+		{
+			g_corpusRecorder.Close();
+			if (!emitter.IsStdout())
+				outf("recorded %llu packets to %s\n", (unsigned long long)g_corpusRecorder.GetPackets(), strRecordFile.c_str());
+		}
+
+		return nResult;
+	}
 
-int _tmain(int argc, _TCHAR* argv[])
-{
 	out("/////////////////////////////////////////////////////////\n"
 		"//::::::::::::::::::: Sniffles 0.1a ::::::::::::::::::://\n"
 		"//:::::::::::::::::::  by: dude719  ::::::::::::::::::://\n"
@@ -253,17 +436,62 @@ int _tmain(int argc, _TCHAR* argv[])
 	String strFilter = String("port ") + StrUtils::NumToStr<int>(cfg_port.value()).CStr();
 	out(strFilter.CStr());
 
+	unsigned short nPort = (unsigned short)cfg_port.value();
+
 	cfg_device.free();
 	cfg_port.free();
 
+	decode_stats_t stats;
+	reset_stats(stats);
+
+	CEventEmitter* pEmitter = strEmitFile.empty() ? NULL : &emitter;
+
+#ifdef __linux__
+	// Kernel fanout straight into the decode workers, skips libpcap entirely
+	if (bAfPacket)
+	{
+		CAfPacketCapture capture(device->name, nPort, nThreads, nRingMB > 0 ? nRingMB : AFPACKET_RING_MB);
+		if (!capture.Open())
+			return 1;
+
+		s_pLiveAfPacket = &capture;
+		signal(SIGINT, on_interrupt);
+
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		capture.Run();
+		std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+
+		signal(SIGINT, SIG_DFL);
+		s_pLiveAfPacket = NULL;
+
+		// kernel drops are read once more as each worker exits
+		capture.CollectStats(stats);
+		finish_capture(stats, std::chrono::duration<double>(end - start).count(), pEmitter);
+		return 0;
+	}
+#else
+	if (bAfPacket)
+		out("-afpacket is only available on Linux, using pcap\n");
+#endif
+
 	SnifferConfiguration config;
 	config.set_filter(strFilter.CStr());
 	config.set_promisc_mode(true);
 
 	// Create sniffer configuration object.
 	Sniffer sniffer(device->name, config);
-	sniffer.sniff_loop(packet_loop_handler);
 
+	s_pLiveHandle = sniffer.get_pcap_handle();
+	signal(SIGINT, on_interrupt);
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	capture_loop(sniffer, nThreads, false, stats);
+	std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+
+	signal(SIGINT, SIG_DFL);
+	s_pLiveHandle = NULL;
+
+	finish_capture(stats, std::chrono::duration<double>(end - start).count(), pEmitter);
 	return 0;
 }
 
@@ -1,11 +1,23 @@
 #pragma once
 
 #include "net.h"
+#include "frame.h"
 #include "str.h"
 #include "cfg.h"
 #include "err.h"
 #include "ice.h"
+#include "icekeys.h"
+#include "stats.h"
+#include "decoder.h"
+#include "dispatch.h"
+#include "emitter.h"
+#include "pipeline.h"
+#include "afpacket.h"
+#include "bench.h"
+#include "corpus.h"
 
 #include "packetbitbuf.h"
 
-#include <tchar.h>
\ No newline at end of file
+#include <tchar.h>
+#include <signal.h>
+#include <chrono>
\ No newline at end of file
@@ -0,0 +1,214 @@
+#include "split.h"
+#include "net.h"
+
+CSplitReassembler::CSplitReassembler()
+{
+	memset(m_packets, 0, sizeof(m_packets));
+	memset(m_slotSize, 0, sizeof(m_slotSize));
+
+	m_pSlotData = (uint8*)malloc(SPLIT_POOL_SLOTS * SPLIT_MAX_FRAGMENT);
+	m_pOutput = (uint8*)malloc(NET_MAX_MESSAGE);
+
+	for (uint32 i = 0; i < SPLIT_POOL_SLOTS; i++)
+		m_freeSlots[i] = (uint16)(SPLIT_POOL_SLOTS - 1 - i);
+	m_nFreeSlots = SPLIT_POOL_SLOTS;
+}
+
+CSplitReassembler::~CSplitReassembler()
+{
+	free(m_pSlotData);
+	free(m_pOutput);
+}
+
+bool CSplitReassembler::AddFragment(const udp_frame_t& frame, const uint8*& pOut, uint32& nOutSize, decode_stats_t& stats)
+{
+	const uint8* pData = frame.pPayload;
+	uint32 size = frame.nPayloadSize;
+
+	stats.nSplitFragments++;
+
+	if (size <= SPLIT_HEADER_SIZE)
+	{
+		stats.nSplitInvalid++;
+		return false;
+	}
+
+	int32 nSequence = (int32)load_le32(pData + 4);
+	uint32 packetID = load_le16(pData + 8);
+	uint32 nSplitSize = load_le16(pData + 10);
+	uint32 nNumber = packetID >> 8;
+	uint32 nCount = packetID & 0xFF;
+
+	const uint8* pBody = pData + SPLIT_HEADER_SIZE;
+	uint32 nBodySize = size - SPLIT_HEADER_SIZE;
+
+	// Every fragment but the last is exactly nSplitSize, which is what lets the
+	// engine place fragment n at n * nSplitSize
+	bool bLast = nNumber + 1 == nCount;
+	if (!nCount || nNumber >= nCount || !nSplitSize || nSplitSize > SPLIT_MAX_FRAGMENT ||
+		(nCount - 1) * nSplitSize >= NET_MAX_MESSAGE ||
+		(bLast ? nBodySize > nSplitSize : nBodySize != nSplitSize))
+	{
+		stats.nSplitInvalid++;
+		return false;
+	}
+
+	ExpirePackets(frame.nTimestampUs, stats);
+
+	split_packet_t* pPacket = FindPacket(frame);
+	if (pPacket && (pPacket->nSequence != nSequence || pPacket->nCount != nCount || pPacket->nSplitSize != nSplitSize))
+	{
+		// the session moved on to a new packet before this one completed
+		ClosePacket(*pPacket);
+		stats.nSplitDropped++;
+		pPacket = NULL;
+	}
+
+	if (!pPacket)
+	{
+		pPacket = OpenPacket(frame, stats);
+		pPacket->nSequence = nSequence;
+		pPacket->nSplitSize = nSplitSize;
+		pPacket->nCount = nCount;
+	}
+
+	pPacket->nLastUs = frame.nTimestampUs;
+
+	uint32 nBit = 1u << (nNumber & 31);
+	if (pPacket->received[nNumber >> 5] & nBit)
+		return false;	// duplicate
+
+	if (!m_nFreeSlots && !EvictOldest(pPacket, stats))
+	{
+		ClosePacket(*pPacket);
+		stats.nSplitDropped++;
+		return false;
+	}
+
+	uint16 slot = m_freeSlots[--m_nFreeSlots];
+	memcpy(m_pSlotData + slot * SPLIT_MAX_FRAGMENT, pBody, nBodySize);
+	m_slotSize[slot] = (uint16)nBodySize;
+
+	pPacket->slots[nNumber] = slot;
+	pPacket->received[nNumber >> 5] |= nBit;
+	pPacket->nReceived++;
+	pPacket->nTotalSize += nBodySize;
+
+	if (pPacket->nReceived < pPacket->nCount)
+		return false;
+
+	if (pPacket->nTotalSize > NET_MAX_MESSAGE)
+	{
+		ClosePacket(*pPacket);
+		stats.nSplitInvalid++;
+		return false;
+	}
+
+	uint8* p = m_pOutput;
+	for (uint32 i = 0; i < pPacket->nCount; i++)
+	{
+		uint16 fragmentSlot = pPacket->slots[i];
+		memcpy(p, m_pSlotData + fragmentSlot * SPLIT_MAX_FRAGMENT, m_slotSize[fragmentSlot]);
+		p += m_slotSize[fragmentSlot];
+	}
+
+	pOut = m_pOutput;
+	nOutSize = pPacket->nTotalSize;
+
+	ClosePacket(*pPacket);
+	stats.nSplitPackets++;
+	return true;
+}
+
+CSplitReassembler::split_packet_t* CSplitReassembler::FindPacket(const udp_frame_t& frame)
+{
+	for (int i = 0; i < SPLIT_MAX_OPEN; i++)
+	{
+		split_packet_t& packet = m_packets[i];
+		if (packet.bOpen && packet.nSrcAddr == frame.nSrcAddr && packet.nDstAddr == frame.nDstAddr &&
+			packet.nSrcPort == frame.nSrcPort && packet.nDstPort == frame.nDstPort)
+			return &packet;
+	}
+
+	return NULL;
+}
+
+CSplitReassembler::split_packet_t* CSplitReassembler::OpenPacket(const udp_frame_t& frame, decode_stats_t& stats)
+{
+	split_packet_t* pPacket = NULL;
+
+	for (int i = 0; i < SPLIT_MAX_OPEN && !pPacket; i++)
+	{
+		if (!m_packets[i].bOpen)
+			pPacket = &m_packets[i];
+	}
+
+	if (!pPacket)
+	{
+		// table full, the entry freed by the eviction is the one we take
+		EvictOldest(NULL, stats);
+		return OpenPacket(frame, stats);
+	}
+
+	memset(pPacket->received, 0, sizeof(pPacket->received));
+	pPacket->bOpen = true;
+	pPacket->nSrcAddr = frame.nSrcAddr;
+	pPacket->nDstAddr = frame.nDstAddr;
+	pPacket->nSrcPort = frame.nSrcPort;
+	pPacket->nDstPort = frame.nDstPort;
+	pPacket->nReceived = 0;
+	pPacket->nTotalSize = 0;
+	pPacket->nStartUs = frame.nTimestampUs;
+	pPacket->nLastUs = frame.nTimestampUs;
+	return pPacket;
+}
+
+void CSplitReassembler::ClosePacket(split_packet_t& packet)
+{
+	for (uint32 i = 0; i < packet.nCount; i++)
+	{
+		if (packet.received[i >> 5] & (1u << (i & 31)))
+			m_freeSlots[m_nFreeSlots++] = packet.slots[i];
+	}
+
+	packet.bOpen = false;
+}
+
+bool CSplitReassembler::EvictOldest(const split_packet_t* pKeep, decode_stats_t& stats)
+{
+	split_packet_t* pOldest = NULL;
+
+	for (int i = 0; i < SPLIT_MAX_OPEN; i++)
+	{
+		split_packet_t& packet = m_packets[i];
+		if (!packet.bOpen || &packet == pKeep)
+			continue;
+
+		if (!pOldest || packet.nLastUs < pOldest->nLastUs)
+			pOldest = &packet;
+	}
+
+	if (!pOldest)
+		return false;
+
+	ClosePacket(*pOldest);
+	stats.nSplitDropped++;
+	return true;
+}
+
+void CSplitReassembler::ExpirePackets(uint64 nNowUs, decode_stats_t& stats)
+{
+	// no capture clock, eviction alone keeps the pool bounded
+	if (!nNowUs)
+		return;
+
+	for (int i = 0; i < SPLIT_MAX_OPEN; i++)
+	{
+		split_packet_t& packet = m_packets[i];
+		if (packet.bOpen && nNowUs > packet.nStartUs && nNowUs - packet.nStartUs > SPLIT_TIMEOUT_US)
+		{
+			ClosePacket(packet);
+			stats.nSplitDropped++;
+		}
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "platform.h"
+#include "frame.h"
+#include "stats.h"
+
+// int -2, int sequence, short packetID (number << 8 | count), short split size
+#define SPLIT_HEADER_SIZE		12
+
+// Largest fragment body: a 1500 byte MTU minus IP, UDP and split headers
+#define SPLIT_MAX_FRAGMENT		1460
+
+#define SPLIT_POOL_SLOTS		512			// fragment bodies per reassembler, ~730 KB
+#define SPLIT_MAX_OPEN			32			// partial packets per reassembler
+#define SPLIT_MAX_COUNT			256			// packetID only has 8 bits for the count
+#define SPLIT_TIMEOUT_US		2000000		// partial packets older than this are dropped
+
+//-----------------------------------------------------------------------------
+// Puts split datagrams (NET_HEADER_FLAG_SPLITPACKET) back together before they
+// are decrypted. All memory is allocated up front. When the fragment pool or
+// the open packet table runs out, the least recently updated partial packet
+// is evicted, so lossy or hostile traffic can't grow it.
+//
+// A session has at most one packet open, like the engine: a fragment with a
+// new sequence number abandons the previous one.
+//-----------------------------------------------------------------------------
+class CSplitReassembler
+{
+public:
+	CSplitReassembler();
+	~CSplitReassembler();
+
+	// Takes a datagram that starts with the split header. Returns true once it
+	// completes a packet, which is then in pOut/nOutSize until the next call.
+	bool			AddFragment(const udp_frame_t& frame, const uint8*& pOut, uint32& nOutSize, decode_stats_t& stats);
+
+private:
+	CSplitReassembler(const CSplitReassembler&);
+	CSplitReassembler& operator=(const CSplitReassembler&);
+
+	struct split_packet_t
+	{
+		bool		bOpen;
+		uint32		nSrcAddr;
+		uint32		nDstAddr;
+		uint16		nSrcPort;
+		uint16		nDstPort;
+		int32		nSequence;
+		uint32		nSplitSize;			// body size of every fragment but the last
+		uint32		nCount;
+		uint32		nReceived;
+		uint32		nTotalSize;
+		uint64		nStartUs;
+		uint64		nLastUs;			// for LRU eviction
+		uint32		received[SPLIT_MAX_COUNT / 32];
+		uint16		slots[SPLIT_MAX_COUNT];
+	};
+
+	split_packet_t*	FindPacket(const udp_frame_t& frame);
+	split_packet_t*	OpenPacket(const udp_frame_t& frame, decode_stats_t& stats);
+	void			ClosePacket(split_packet_t& packet);
+	bool			EvictOldest(const split_packet_t* pKeep, decode_stats_t& stats);
+	void			ExpirePackets(uint64 nNowUs, decode_stats_t& stats);
+
+	split_packet_t	m_packets[SPLIT_MAX_OPEN];
+
+	// fragment pool
+	uint8*			m_pSlotData;		// SPLIT_POOL_SLOTS * SPLIT_MAX_FRAGMENT
+	uint16			m_slotSize[SPLIT_POOL_SLOTS];
+	uint16			m_freeSlots[SPLIT_POOL_SLOTS];
+	uint32			m_nFreeSlots;
+
+	// completed packets are assembled here
+	uint8*			m_pOutput;
+};
@@ -0,0 +1,107 @@
+#include "stats.h"
+#include "str.h"
+#include "allocstats.h"
+
+bool g_bQuiet = false;
+
+void reset_stats(decode_stats_t& stats)
+{
+	memset(&stats, 0, sizeof(stats));
+}
+
+// Every field is a counter, so the structs can be summed as arrays
+void merge_stats(decode_stats_t& stats, const decode_stats_t& other)
+{
+	uint64* pDst = (uint64*)&stats;
+	const uint64* pSrc = (const uint64*)&other;
+
+	for (size_t i = 0; i < sizeof(decode_stats_t) / sizeof(uint64); i++)
+		pDst[i] += pSrc[i];
+}
+
+void count_message(decode_stats_t& stats, int cmd, int size)
+{
+	if (cmd < 0 || cmd >= STATS_MAX_MESSAGE_TYPES)
+		cmd = STATS_MAX_MESSAGE_TYPES;
+
+	stats.nMessages[cmd]++;
+	stats.nMessageBytes[cmd] += size;
+}
+
+static const char* message_name(int cmd)
+{
+	if (cmd == STATS_MAX_MESSAGE_TYPES)
+		return "<invalid>";
+	if (NET_Messages_IsValid(cmd))
+		return NET_Messages_Name((NET_Messages)cmd).c_str();
+	if (SVC_Messages_IsValid(cmd))
+		return SVC_Messages_Name((SVC_Messages)cmd).c_str();
+	return "<unknown>";
+}
+
+void print_stats(const decode_stats_t& stats, double flSeconds, bool bLive)
+{
+	if (flSeconds <= 0.0)
+		flSeconds = 1e-9;
+
+	outf("\n---- %s finished in %.3f s -----------------\n", bLive ? "capture" : "replay", flSeconds);
+	outf("  frames:    %10llu  (%.0f pkt/s, %.2f MB/s)\n", stats.nFrames,
+		stats.nFrames / flSeconds, stats.nFrameBytes / flSeconds / (1024.0 * 1024.0));
+	// a replay waits for the workers, only a live capture can drop
+	if (stats.nDropped || bLive)
+		outf("  dropped:   %10llu\n", stats.nDropped);
+	outf("  datagrams: %10llu  (%.0f pkt/s, %.2f MB/s)\n", stats.nDatagrams,
+		stats.nDatagrams / flSeconds, stats.nDatagramBytes / flSeconds / (1024.0 * 1024.0));
+	outf("  packets:   %10llu  (%.0f pkt/s, %.2f MB/s)\n", stats.nPackets,
+		stats.nPackets / flSeconds, stats.nPacketBytes / flSeconds / (1024.0 * 1024.0));
+	outf("  key detections: %llu, key misses: %llu\n", stats.nKeyDetections, stats.nKeyMisses);
+	if (stats.nSplitFragments)
+	{
+		outf("  split fragments: %llu, reassembled: %llu, dropped: %llu, invalid: %llu\n",
+			stats.nSplitFragments, stats.nSplitPackets, stats.nSplitDropped, stats.nSplitInvalid);
+	}
+	if (stats.nCompressedPackets || stats.nDecompressFailed)
+	{
+		outf("  compressed: %llu (%llu bytes), failed: %llu\n",
+			stats.nCompressedPackets, stats.nCompressedBytes, stats.nDecompressFailed);
+	}
+	if (stats.nSubChannelFragments)
+	{
+		outf("  subchannel chunks: %llu, transfers: %llu, skipped: %llu, dropped: %llu, invalid: %llu\n",
+			stats.nSubChannelFragments, stats.nSubChannelTransfers, stats.nSubChannelSkipped,
+			stats.nSubChannelDropped, stats.nSubChannelInvalid);
+	}
+	outf("  messages skipped: %llu, parse failures: %llu\n", stats.nMessagesSkipped, stats.nParseFailed);
+	if (stats.nEntityPackets || stats.nEntityNoTables || stats.nEntityUntracked || stats.nEntityTableBuilds || stats.nEntityErrors)
+	{
+		outf("  entity packets: %llu, updates: %llu, without tables: %llu, untracked: %llu, table builds: %llu, cached: %llu, errors: %llu\n",
+			stats.nEntityPackets, stats.nEntityUpdates, stats.nEntityNoTables, stats.nEntityUntracked,
+			stats.nEntityTableBuilds, stats.nEntityTablesCached, stats.nEntityErrors);
+	}
+	if (stats.nStringTableUpdates)
+	{
+		outf("  string table updates: %llu, entries: %llu, errors: %llu\n",
+			stats.nStringTableUpdates, stats.nStringTableEntries, stats.nStringTableErrors);
+	}
+	if (stats.nGameEventLists || stats.nGameEvents || stats.nGameEventsNoList)
+	{
+		outf("  game event lists: %llu, events: %llu, without a list: %llu, errors: %llu\n",
+			stats.nGameEventLists, stats.nGameEvents, stats.nGameEventsNoList, stats.nGameEventErrors);
+	}
+	if (stats.nUserMessages || stats.nUserMessagesSkipped)
+		outf("  user messages: %llu, skipped: %llu\n", stats.nUserMessages, stats.nUserMessagesSkipped);
+
+	alloc_stats_t allocs;
+	if (get_alloc_stats(allocs))
+		outf("  heap: %llu allocations, %llu frees, %llu bytes\n", allocs.nAllocs, allocs.nFrees, allocs.nBytes);
+
+	out("  messages:\n");
+	for (int i = 0; i <= STATS_MAX_MESSAGE_TYPES; i++)
+	{
+		if (!stats.nMessages[i])
+			continue;
+
+		outf("    [%2d] %-24s %10llu  %12llu bytes\n", i, message_name(i),
+			stats.nMessages[i], stats.nMessageBytes[i]);
+	}
+}
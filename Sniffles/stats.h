@@ -0,0 +1,57 @@
+#pragma once
+
+#include "platform.h"
+
+// Message ids are NETMSG_TYPE_BITS wide, anything above is counted as garbage
+#define STATS_MAX_MESSAGE_TYPES		32
+
+struct decode_stats_t
+{
+	uint64	nFrames;			// frames read from the capture
+	uint64	nFrameBytes;
+	uint64	nDropped;			// frames dropped because a decode worker fell behind
+	uint64	nDatagrams;			// udp datagrams that matched the game port
+	uint64	nDatagramBytes;
+	uint64	nPackets;			// datagrams that decrypted into a valid netchannel packet
+	uint64	nPacketBytes;
+	uint64	nKeyDetections;		// sessions (re)assigned an ICE key from the registry
+	uint64	nKeyMisses;			// datagrams no registered key could decrypt
+	uint64	nSplitFragments;	// datagrams carrying one fragment of a split packet
+	uint64	nSplitPackets;		// split packets put back together
+	uint64	nSplitDropped;		// partial split packets evicted or timed out
+	uint64	nSplitInvalid;		// fragments with a broken split header
+	uint64	nCompressedPackets;	// packets that arrived LZSS or Snappy compressed
+	uint64	nCompressedBytes;	// their size before decompression
+	uint64	nDecompressFailed;	// compressed packets that were corrupt or too large
+	uint64	nSubChannelFragments;	// reliable stream chunks read from packets
+	uint64	nSubChannelTransfers;	// reliable transfers completed and decoded
+	uint64	nSubChannelSkipped;		// file transfers and oversized streams parsed past
+	uint64	nSubChannelDropped;		// partial transfers evicted or aborted by the server
+	uint64	nSubChannelInvalid;		// chunks with a broken header or no header fragment
+	uint64	nMessagesSkipped;	// messages with no subscriber, never parsed
+	uint64	nParseFailed;		// subscribed messages that didn't parse
+	uint64	nEntityPackets;		// svc_PacketEntities decoded into entity state
+	uint64	nEntityUpdates;		// entities that entered or changed
+	uint64	nEntityNoTables;	// svc_PacketEntities of sessions we have no prop lists for
+	uint64	nEntityUntracked;	// svc_PacketEntities of new sessions every session slot was busy for
+	uint64	nEntityTableBuilds;	// signons whose send tables were flattened
+	uint64	nEntityTablesCached;	// sessions that got their tables from g_sendTableCache
+	uint64	nEntityErrors;		// updates or send tables that didn't decode
+	uint64	nStringTableUpdates;	// svc_CreateStringTable and svc_UpdateStringTable decoded
+	uint64	nStringTableEntries;	// entries they added or changed
+	uint64	nStringTableErrors;		// of those, the ones that didn't decode
+	uint64	nGameEventLists;	// svc_GameEventList compiled into event layouts
+	uint64	nGameEvents;		// svc_GameEvent decoded against them
+	uint64	nGameEventsNoList;	// events of sessions or ids we have no layout for
+	uint64	nGameEventErrors;	// lists and events that were malformed or didn't match
+	uint64	nUserMessages;		// svc_UserMessage payloads handed to a subscriber
+	uint64	nUserMessagesSkipped;	// payloads nobody subscribed to, never parsed
+
+	uint64	nMessages[STATS_MAX_MESSAGE_TYPES + 1];		// last slot counts out of range ids
+	uint64	nMessageBytes[STATS_MAX_MESSAGE_TYPES + 1];
+};
+
+void reset_stats(decode_stats_t& stats);
+void merge_stats(decode_stats_t& stats, const decode_stats_t& other);
+void count_message(decode_stats_t& stats, int cmd, int size);
+void print_stats(const decode_stats_t& stats, double flSeconds, bool bLive = false);
@@ -13,6 +13,11 @@
 #define out(a)		fputs(a, stdout)
 #define outf(...)	printf(__VA_ARGS__)
 
+// Per-packet output, suppressed while replaying captures at full rate
+extern bool g_bQuiet;
+#define vout(a)		do { if (!g_bQuiet) out(a); } while (0)
+#define voutf(...)	do { if (!g_bQuiet) outf(__VA_ARGS__); } while (0)
+
 static void MsgPrintf(const ::google::protobuf::Message& msg, int size, const char *fmt, ...)
 {
 	va_list vlist;
@@ -285,11 +290,9 @@ private:
 	int _size;
 	size_t _length;
 
-	static const size_t npos;	// bad/missing length/position
+	static const size_t npos = (size_t)-1;	// bad/missing length/position
 };
 
-const size_t String::npos = -1;
-
 
 namespace StrUtils
 {
@@ -0,0 +1,431 @@
+#include "stringtable.h"
+#include "packetbitbuf.h"
+#include "wirefields.h"
+
+#include "google/protobuf/wire_format_lite.h"
+
+using google::protobuf::internal::WireFormatLite;
+
+//-----------------------------------------------------------------------------
+// CStringArena
+//-----------------------------------------------------------------------------
+static inline uint32 hash_string(const char* psz, uint32 nLength)
+{
+	// FNV-1a
+	uint32 nHash = 2166136261u;
+	for (uint32 i = 0; i < nLength; i++)
+		nHash = (nHash ^ (uint8)psz[i]) * 16777619u;
+	return nHash;
+}
+
+CStringArena::CStringArena()
+{
+	m_nChunkUsed = STRING_ARENA_CHUNK_SIZE;
+	m_nBytesUsed = 0;
+	m_nStrings = 0;
+	m_slots.resize(1024);
+	memset(m_slots.data(), 0, m_slots.size() * sizeof(slot_t));
+}
+
+CStringArena::~CStringArena()
+{
+	for (size_t i = 0; i < m_chunks.size(); i++)
+		free(m_chunks[i]);
+}
+
+void CStringArena::Clear()
+{
+	// the first chunk is all a signon usually needs, keep it
+	for (size_t i = 1; i < m_chunks.size(); i++)
+		free(m_chunks[i]);
+	if (m_chunks.size() > 1)
+		m_chunks.resize(1);
+
+	m_nChunkUsed = m_chunks.empty() ? STRING_ARENA_CHUNK_SIZE : 0;
+	m_nBytesUsed = 0;
+	m_nStrings = 0;
+	memset(m_slots.data(), 0, m_slots.size() * sizeof(slot_t));
+}
+
+char* CStringArena::Store(const char* psz, uint32 nLength)
+{
+	size_t nSize = nLength + 1;
+	if (m_nChunkUsed + nSize > STRING_ARENA_CHUNK_SIZE)
+	{
+		// STRINGTABLE_MAX_STRING is far below a chunk
+		m_chunks.push_back((char*)malloc(STRING_ARENA_CHUNK_SIZE));
+		m_nChunkUsed = 0;
+	}
+
+	char* pCopy = m_chunks.back() + m_nChunkUsed;
+	memcpy(pCopy, psz, nLength);
+	pCopy[nLength] = '\0';
+
+	m_nChunkUsed += nSize;
+	m_nBytesUsed += nSize;
+	return pCopy;
+}
+
+void CStringArena::Grow()
+{
+	std::vector<slot_t> slots(m_slots.size() * 2);
+	memset(slots.data(), 0, slots.size() * sizeof(slot_t));
+
+	uint32 nMask = (uint32)slots.size() - 1;
+	for (size_t i = 0; i < m_slots.size(); i++)
+	{
+		if (!m_slots[i].psz)
+			continue;
+
+		uint32 nSlot = m_slots[i].nHash & nMask;
+		while (slots[nSlot].psz)
+			nSlot = (nSlot + 1) & nMask;
+		slots[nSlot] = m_slots[i];
+	}
+
+	m_slots.swap(slots);
+}
+
+const char* CStringArena::Intern(const char* psz, uint32 nLength)
+{
+	if (nLength > STRINGTABLE_MAX_STRING)
+		nLength = STRINGTABLE_MAX_STRING;
+
+	uint32 nHash = hash_string(psz, nLength);
+	uint32 nMask = (uint32)m_slots.size() - 1;
+	uint32 nSlot = nHash & nMask;
+
+	for (; m_slots[nSlot].psz; nSlot = (nSlot + 1) & nMask)
+	{
+		const slot_t& slot = m_slots[nSlot];
+		if (slot.nHash == nHash && slot.nLength == nLength && !memcmp(slot.psz, psz, nLength))
+			return slot.psz;
+	}
+
+	slot_t& slot = m_slots[nSlot];
+	slot.nHash = nHash;
+	slot.nLength = nLength;
+	slot.psz = Store(psz, nLength);
+
+	const char* pszInterned = slot.psz;
+
+	// at most half full
+	if (++m_nStrings * 2 > m_slots.size())
+		Grow();
+
+	return pszInterned;
+}
+
+//-----------------------------------------------------------------------------
+// CUserDataSlab
+//-----------------------------------------------------------------------------
+CUserDataSlab::CUserDataSlab()
+{
+	memset(m_pFree, 0, sizeof(m_pFree));
+}
+
+CUserDataSlab::~CUserDataSlab()
+{
+	Clear();
+}
+
+void CUserDataSlab::Clear()
+{
+	for (size_t i = 0; i < m_chunks.size(); i++)
+		free(m_chunks[i]);
+
+	m_chunks.clear();
+	memset(m_pFree, 0, sizeof(m_pFree));
+}
+
+uint8* CUserDataSlab::Alloc(uint32 nSize)
+{
+	int nClass = SizeClass(nSize);
+
+	if (!m_pFree[nClass])
+	{
+		// a chunk's worth of blocks of this class
+		uint32 nBlockSize = USERDATA_SLAB_MIN_SIZE << nClass;
+		uint32 nBlocks = USERDATA_SLAB_CHUNK_SIZE / nBlockSize;
+
+		uint8* pChunk = (uint8*)malloc(nBlocks * nBlockSize);
+		m_chunks.push_back(pChunk);
+
+		for (uint32 i = nBlocks; i-- > 0; )
+		{
+			uint8* pBlock = pChunk + i * nBlockSize;
+			memcpy(pBlock, &m_pFree[nClass], sizeof(uint8*));
+			m_pFree[nClass] = pBlock;
+		}
+	}
+
+	uint8* pBlock = m_pFree[nClass];
+	memcpy(&m_pFree[nClass], pBlock, sizeof(uint8*));
+	return pBlock;
+}
+
+void CUserDataSlab::Free(uint8* pBlock, uint32 nSize)
+{
+	int nClass = SizeClass(nSize);
+	memcpy(pBlock, &m_pFree[nClass], sizeof(uint8*));
+	m_pFree[nClass] = pBlock;
+}
+
+//-----------------------------------------------------------------------------
+// CStringTables
+//-----------------------------------------------------------------------------
+CStringTables::CStringTables()
+{
+	m_nTables = 0;
+	m_nChangedTable = -1;
+}
+
+void CStringTables::Clear()
+{
+	for (int i = 0; i < m_nTables; i++)
+		m_tables[i].entries.clear();
+
+	m_nTables = 0;
+	m_nChangedTable = -1;
+	m_changed.clear();
+	m_arena.Clear();
+	m_slab.Clear();
+}
+
+int CStringTables::FindTable(const char* pszName) const
+{
+	for (int i = 0; i < m_nTables; i++)
+	{
+		if (m_tables[i].strName == pszName)
+			return i;
+	}
+
+	return -1;
+}
+
+void CStringTables::SetUserData(string_table_entry_t& entry, const uint8* pData, uint32 nSize)
+{
+	if (entry.pUserData && (!nSize || CUserDataSlab::SizeClass(nSize) != CUserDataSlab::SizeClass(entry.nUserDataSize)))
+	{
+		m_slab.Free(entry.pUserData, entry.nUserDataSize);
+		entry.pUserData = NULL;
+	}
+
+	if (nSize && !entry.pUserData)
+		entry.pUserData = m_slab.Alloc(nSize);
+
+	if (nSize)
+		memcpy(entry.pUserData, pData, nSize);
+	entry.nUserDataSize = nSize;
+}
+
+//-----------------------------------------------------------------------------
+// Entries as the engine's CNetworkStringTable::ParseUpdate reads them: an
+// index (or the next one), an optional string that may start with a prefix of
+// one of the last 32 strings, and optional user data.
+//-----------------------------------------------------------------------------
+bool CStringTables::ReadEntries(string_table_t& table, CBitRead& buf, int nEntries)
+{
+	m_changed.clear();
+
+	// dictionary encoded updates were never used by CS:GO servers
+	if (buf.ReadOneBit())
+		return false;
+
+	int nHistory = 0;
+	int nHistoryStart = 0;
+	int nLastEntry = -1;
+	char szEntry[STRINGTABLE_MAX_STRING];
+
+	for (int i = 0; i < nEntries; i++)
+	{
+		int nEntry = nLastEntry + 1;
+		if (!buf.ReadOneBit())
+			nEntry = buf.ReadUBitLong(table.nEntryBits);
+		nLastEntry = nEntry;
+
+		if (nEntry < 0 || nEntry >= table.nMaxEntries || buf.IsOverflowed())
+			return false;
+
+		bool bString = buf.ReadOneBit() != 0;
+		int nLength = 0;
+
+		if (bString)
+		{
+			if (buf.ReadOneBit())
+			{
+				int nIndex = buf.ReadUBitLong(5);
+				int nPrefix = buf.ReadUBitLong(SUBSTRING_BITS);
+				if (nIndex >= nHistory)
+					return false;
+
+				// history strings are cut at STRINGTABLE_HISTORY bytes, unterminated
+				const char* pszPrefix = m_history[(nHistoryStart + nIndex) % STRINGTABLE_HISTORY];
+				while (nLength < nPrefix && pszPrefix[nLength])
+				{
+					szEntry[nLength] = pszPrefix[nLength];
+					nLength++;
+				}
+			}
+
+			int nSuffix = 0;
+			buf.ReadString(szEntry + nLength, sizeof(szEntry) - nLength, false, &nSuffix);
+			nLength += nSuffix;
+		}
+
+		uint32 nUserDataSize = 0;
+		bool bUserData = buf.ReadOneBit() != 0;
+		if (bUserData)
+		{
+			if (table.bUserDataFixedSize)
+			{
+				nUserDataSize = table.nUserDataSize;
+				memset(m_userData, 0, nUserDataSize);
+				buf.ReadBits(m_userData, table.nUserDataSizeBits);
+			}
+			else
+			{
+				nUserDataSize = buf.ReadUBitLong(MAX_USERDATA_BITS);
+				buf.ReadBytes(m_userData, nUserDataSize);
+			}
+		}
+
+		if (buf.IsOverflowed())
+			return false;
+
+		string_table_entry_t* pEntry;
+		if (nEntry < (int)table.entries.size())
+		{
+			// strings never change once added, only the user data, which
+			// the engine clears when an update names the entry without any
+			pEntry = &table.entries[nEntry];
+			SetUserData(*pEntry, m_userData, nUserDataSize);
+		}
+		else
+		{
+			// new entries are appended; a gap would be a server bug, fill it
+			// with empty ones like the engine would leave them
+			string_table_entry_t empty = { m_arena.Intern("", 0), 0, NULL, 0 };
+			table.entries.resize(nEntry + 1, empty);
+
+			pEntry = &table.entries[nEntry];
+			pEntry->pszString = m_arena.Intern(szEntry, bString ? nLength : 0);
+			pEntry->nLength = bString ? nLength : 0;
+			if (bUserData)
+				SetUserData(*pEntry, m_userData, nUserDataSize);
+		}
+
+		m_changed.push_back(nEntry);
+
+		// the entry's string as it now stands goes into the history
+		char* pszHistory;
+		if (nHistory < STRINGTABLE_HISTORY)
+			pszHistory = m_history[(nHistoryStart + nHistory++) % STRINGTABLE_HISTORY];
+		else
+		{
+			pszHistory = m_history[nHistoryStart];
+			nHistoryStart = (nHistoryStart + 1) % STRINGTABLE_HISTORY;
+		}
+		strncpy(pszHistory, pEntry->pszString, STRINGTABLE_HISTORY);
+	}
+
+	return true;
+}
+
+bool CStringTables::Create(const CSVCMsg_CreateStringTable& msg)
+{
+	if (m_nTables >= STRINGTABLE_MAX_TABLES)
+		return false;
+
+	int nMaxEntries = msg.max_entries();
+	if (nMaxEntries <= 0 || nMaxEntries > STRINGTABLE_MAX_ENTRIES)
+		return false;
+
+	bool bFixedSize = msg.user_data_fixed_size();
+	if (bFixedSize && (msg.user_data_size() <= 0 || msg.user_data_size() > MAX_USERDATA_SIZE ||
+		msg.user_data_size_bits() <= 0 || msg.user_data_size_bits() > msg.user_data_size() * 8))
+		return false;
+
+	string_table_t& table = m_tables[m_nTables];
+	table.strName = msg.name();
+	table.nMaxEntries = nMaxEntries;
+	table.bUserDataFixedSize = bFixedSize;
+	table.nUserDataSize = msg.user_data_size();
+	table.nUserDataSizeBits = msg.user_data_size_bits();
+	table.entries.clear();
+	table.entries.reserve(msg.num_entries() > 0 && msg.num_entries() <= nMaxEntries ? msg.num_entries() : 0);
+
+	table.nEntryBits = 0;
+	for (int n = nMaxEntries; n >>= 1; )
+		table.nEntryBits++;
+
+	m_nChangedTable = m_nTables++;
+
+	const std::string& strData = msg.string_data();
+	CBitRead buf(strData.data(), (int)strData.size());
+	return ReadEntries(table, buf, msg.num_entries());
+}
+
+bool CStringTables::Update(const CSVCMsg_UpdateStringTable& msg)
+{
+	const std::string& strData = msg.string_data();
+	return UpdateEntries(msg.table_id(), (const uint8*)strData.data(), (int)strData.size(), msg.num_changed_entries());
+}
+
+bool CStringTables::Update(const uint8* pData, int nSize)
+{
+	m_changed.clear();
+	m_nChangedTable = -1;
+
+	const uint8* p = pData;
+	const uint8* pEnd = pData + nSize;
+
+	uint64 nTable = 0;
+	uint64 nEntries = 0;
+	const uint8* pStringData = NULL;
+	uint32 nStringDataSize = 0;
+
+	while (p < pEnd)
+	{
+		uint64 nTag;
+		if (!wire_read_varint(p, pEnd, nTag))
+			return false;
+
+		uint32 nField = (uint32)(nTag >> 3);
+		int nWireType = (int)(nTag & 7);
+
+		if (nField == CSVCMsg_UpdateStringTable::kTableIdFieldNumber && nWireType == WireFormatLite::WIRETYPE_VARINT)
+		{
+			if (!wire_read_varint(p, pEnd, nTable))
+				return false;
+		}
+		else if (nField == CSVCMsg_UpdateStringTable::kNumChangedEntriesFieldNumber && nWireType == WireFormatLite::WIRETYPE_VARINT)
+		{
+			if (!wire_read_varint(p, pEnd, nEntries))
+				return false;
+		}
+		else if (nField == CSVCMsg_UpdateStringTable::kStringDataFieldNumber && nWireType == WireFormatLite::WIRETYPE_LENGTH_DELIMITED)
+		{
+			if (!wire_read_bytes(p, pEnd, pStringData, nStringDataSize))
+				return false;
+		}
+		else if (!wire_skip_field(p, pEnd, nWireType))
+			return false;
+	}
+
+	return UpdateEntries((int32)nTable, pStringData, (int)nStringDataSize, (int32)nEntries);
+}
+
+bool CStringTables::UpdateEntries(int nTable, const uint8* pData, int nSize, int nEntries)
+{
+	m_changed.clear();
+	m_nChangedTable = -1;
+
+	if ((uint32)nTable >= (uint32)m_nTables)
+		return false;
+
+	m_nChangedTable = nTable;
+
+	CBitRead buf(pData, nSize);
+	return ReadEntries(m_tables[nTable], buf, nEntries);
+}
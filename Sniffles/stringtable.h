@@ -0,0 +1,161 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "platform.h"
+#include "net.h"
+
+class CBitRead;
+
+#define STRINGTABLE_MAX_TABLES		32		// MAX_TABLES in the engine
+#define STRINGTABLE_MAX_ENTRIES		65536	// most any table may hold
+#define STRINGTABLE_MAX_STRING		1024	// longest entry string, longer ones are cut
+#define STRINGTABLE_HISTORY			(1 << SUBSTRING_BITS)	// recent entries a string may start from
+
+#define STRING_ARENA_CHUNK_SIZE		(64 * 1024)
+#define USERDATA_SLAB_CHUNK_SIZE	(64 * 1024)
+#define USERDATA_SLAB_MIN_SIZE		16
+#define USERDATA_SLAB_CLASSES		11		// 16 bytes to MAX_USERDATA_SIZE, doubling
+
+//-----------------------------------------------------------------------------
+// Every distinct string stored once. Precache names repeat across tables and
+// across signons of the same map, so interning keeps updates from allocating.
+//-----------------------------------------------------------------------------
+class CStringArena
+{
+public:
+	CStringArena();
+	~CStringArena();
+
+	// Terminated copy of psz, the same pointer for the same string
+	const char*		Intern(const char* psz, uint32 nLength);
+	void			Clear();
+
+	size_t			GetBytesUsed() const { return m_nBytesUsed; }
+
+private:
+	CStringArena(const CStringArena&);
+	CStringArena& operator=(const CStringArena&);
+
+	struct slot_t
+	{
+		uint32		nHash;
+		uint32		nLength;
+		const char*	psz;		// NULL for an empty slot
+	};
+
+	char*			Store(const char* psz, uint32 nLength);
+	void			Grow();
+
+	std::vector<char*>	m_chunks;
+	size_t				m_nChunkUsed;		// of the last chunk
+	size_t				m_nBytesUsed;
+
+	std::vector<slot_t>	m_slots;			// open addressing, a power of two
+	uint32				m_nStrings;
+};
+
+//-----------------------------------------------------------------------------
+// User data blocks in power of two size classes carved from large chunks.
+// Freed blocks go back to their class, so replacing an entry's data with data
+// of about the same size reuses the block.
+//-----------------------------------------------------------------------------
+class CUserDataSlab
+{
+public:
+	CUserDataSlab();
+	~CUserDataSlab();
+
+	// nSize <= MAX_USERDATA_SIZE
+	uint8*			Alloc(uint32 nSize);
+	void			Free(uint8* pBlock, uint32 nSize);
+	void			Clear();
+
+	static int		SizeClass(uint32 nSize)
+	{
+		int nClass = 0;
+		while ((USERDATA_SLAB_MIN_SIZE << nClass) < (int)nSize)
+			nClass++;
+		return nClass;
+	}
+
+private:
+	CUserDataSlab(const CUserDataSlab&);
+	CUserDataSlab& operator=(const CUserDataSlab&);
+
+	std::vector<uint8*>	m_chunks;
+	uint8*				m_pFree[USERDATA_SLAB_CLASSES];	// linked through each block's first bytes
+};
+
+struct string_table_entry_t
+{
+	const char*		pszString;		// interned, never NULL
+	uint32			nLength;
+	uint8*			pUserData;		// NULL without user data
+	uint32			nUserDataSize;
+};
+
+struct string_table_t
+{
+	std::string		strName;
+	int				nMaxEntries;
+	int				nEntryBits;		// of an entry index
+	bool			bUserDataFixedSize;
+	int				nUserDataSize;
+	int				nUserDataSizeBits;
+	std::vector<string_table_entry_t>	entries;
+};
+
+//-----------------------------------------------------------------------------
+// The string tables of one session, as svc_CreateStringTable and
+// svc_UpdateStringTable build them up. Entries are decoded straight from the
+// bit stream with the engine's substring history; an update only touches the
+// entries it names, and GetChanged lists them afterwards. Like the engine's,
+// an update naming an entry without user data clears the entry's.
+//-----------------------------------------------------------------------------
+class CStringTables
+{
+public:
+	CStringTables();
+
+	// False when the entries didn't decode; those read before the error stay
+	bool			Create(const CSVCMsg_CreateStringTable& msg);
+	bool			Update(const CSVCMsg_UpdateStringTable& msg);
+
+	// An update from the serialized message, string_data decoded where it is
+	bool			Update(const uint8* pData, int nSize);
+
+	// Drops every table, for a new signon
+	void			Clear();
+
+	int				GetTableCount() const { return m_nTables; }
+	const string_table_t*	GetTable(int nTable) const { return (uint32)nTable < (uint32)m_nTables ? &m_tables[nTable] : NULL; }
+	int				FindTable(const char* pszName) const;
+
+	// Table and entry indices the last Create or Update added or changed
+	int				GetChangedTable() const { return m_nChangedTable; }
+	const std::vector<int>&	GetChanged() const { return m_changed; }
+
+	size_t			GetStringBytes() const { return m_arena.GetBytesUsed(); }
+
+private:
+	CStringTables(const CStringTables&);
+	CStringTables& operator=(const CStringTables&);
+
+	bool			UpdateEntries(int nTable, const uint8* pData, int nSize, int nEntries);
+	bool			ReadEntries(string_table_t& table, CBitRead& buf, int nEntries);
+	void			SetUserData(string_table_entry_t& entry, const uint8* pData, uint32 nSize);
+
+	CStringArena		m_arena;
+	CUserDataSlab		m_slab;
+	string_table_t		m_tables[STRINGTABLE_MAX_TABLES];	// by table id, the order they were created
+	int					m_nTables;
+
+	int					m_nChangedTable;
+	std::vector<int>	m_changed;
+
+	// decode scratch
+	char				m_history[STRINGTABLE_HISTORY][STRINGTABLE_HISTORY];
+	uint8				m_userData[MAX_USERDATA_SIZE];
+};
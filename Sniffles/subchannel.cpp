@@ -0,0 +1,295 @@
+#include "subchannel.h"
+#include "netcompress.h"
+#include "packetbitbuf.h"
+
+CSubChannelReassembler::CSubChannelReassembler()
+{
+	memset(m_transfers, 0, sizeof(m_transfers));
+
+	m_pBuffers = (uint8*)malloc(SUBCHANNEL_MAX_BUFFERS * SUBCHANNEL_MAX_BYTES);
+	m_pOutput = (uint8*)malloc(SUBCHANNEL_MAX_BYTES);
+
+	for (uint32 i = 0; i < SUBCHANNEL_MAX_BUFFERS; i++)
+		m_freeBuffers[i] = (uint16)(SUBCHANNEL_MAX_BUFFERS - 1 - i);
+	m_nFreeBuffers = SUBCHANNEL_MAX_BUFFERS;
+}
+
+CSubChannelReassembler::~CSubChannelReassembler()
+{
+	free(m_pBuffers);
+	free(m_pOutput);
+}
+
+bool CSubChannelReassembler::ReadSubChannelData(const udp_frame_t& frame, CBitRead& buf, int nStream, const uint8*& pOut, uint32& nOutSize, decode_stats_t& stats)
+{
+	pOut = NULL;
+	nOutSize = 0;
+
+	stats.nSubChannelFragments++;
+
+	uint32 nStartFragment = 0;
+	uint32 nNumFragments = 0;
+
+	bool bSingleBlock = buf.ReadOneBit() == 0;
+	if (!bSingleBlock)
+	{
+		nStartFragment = buf.ReadUBitLong(MAX_FILE_SIZE_BITS - FRAGMENT_BITS);
+		nNumFragments = buf.ReadUBitLong(3);
+	}
+
+	transfer_t* pTransfer = FindTransfer(frame, nStream);
+
+	if (nStartFragment == 0)
+	{
+		// first fragment, read the header
+		bool bFile = false;
+		uint32 nTransferID = 0;
+		bool bCompressed = false;
+		uint32 nUncompressedSize = 0;
+		uint32 nBytes;
+
+		if (!bSingleBlock && buf.ReadOneBit())
+		{
+			char szFilename[MAX_OSPATH];
+			bFile = true;
+			nTransferID = buf.ReadUBitLong(32);
+			buf.ReadString(szFilename, sizeof(szFilename));
+		}
+
+		if (buf.ReadOneBit())
+		{
+			bCompressed = true;
+			nUncompressedSize = buf.ReadUBitLong(MAX_FILE_SIZE_BITS);
+		}
+
+		nBytes = bSingleBlock ? buf.ReadVarInt32() : buf.ReadUBitLong(MAX_FILE_SIZE_BITS);
+
+		if (buf.IsOverflowed() || nBytes > MAX_FILE_SIZE)
+		{
+			if (pTransfer)
+			{
+				CloseTransfer(*pTransfer);
+				stats.nSubChannelDropped++;
+			}
+			stats.nSubChannelInvalid++;
+			return false;
+		}
+
+		// A retransmitted first fragment of the transfer we are already
+		// assembling keeps what has been received so far
+		if (pTransfer && (pTransfer->bFile != bFile || pTransfer->nTransferID != nTransferID ||
+			pTransfer->bCompressed != bCompressed || pTransfer->nUncompressedSize != nUncompressedSize ||
+			pTransfer->nBytes != nBytes))
+		{
+			// the last transfer was aborted
+			CloseTransfer(*pTransfer);
+			stats.nSubChannelDropped++;
+			pTransfer = NULL;
+		}
+
+		if (!pTransfer)
+		{
+			pTransfer = OpenTransfer(frame, nStream, stats);
+			pTransfer->bFile = bFile;
+			pTransfer->nTransferID = nTransferID;
+			pTransfer->bCompressed = bCompressed;
+			pTransfer->nUncompressedSize = nUncompressedSize;
+			pTransfer->nBytes = nBytes;
+			pTransfer->nFragments = BYTES2FRAGMENTS(nBytes);
+
+			bool bKeep = !bFile && nStream == FRAG_NORMAL_STREAM && nBytes <= SUBCHANNEL_MAX_BYTES &&
+				nUncompressedSize <= SUBCHANNEL_MAX_BYTES;
+
+			if (bKeep && (m_nFreeBuffers || EvictOldest(true, stats)))
+			{
+				pTransfer->nBuffer = m_freeBuffers[--m_nFreeBuffers];
+			}
+			else
+			{
+				stats.nSubChannelSkipped++;
+			}
+		}
+
+		if (bSingleBlock)
+			nNumFragments = pTransfer->nFragments;
+	}
+	else if (!pTransfer)
+	{
+		// The header fragment was lost. Like the engine, wait for it to be
+		// sent again; the rest of this packet can't be located.
+		stats.nSubChannelInvalid++;
+		return false;
+	}
+
+	if (nStartFragment + nNumFragments > pTransfer->nFragments)
+	{
+		// fragment beyond what the header announced
+		stats.nSubChannelInvalid++;
+		return false;
+	}
+
+	pTransfer->nLastUs = frame.nTimestampUs;
+
+	uint32 nOffset = nStartFragment * FRAGMENT_SIZE;
+	uint32 nLength = MIN(nNumFragments * FRAGMENT_SIZE, pTransfer->nBytes - nOffset);
+
+	if (nLength > (uint32)buf.GetNumBitsLeft() / 8)
+	{
+		stats.nSubChannelInvalid++;
+		return false;
+	}
+
+	// Skipped transfers are parsed past, but their fragments are recorded all
+	// the same so the transfer closes when it is complete
+	bool bSkipped = pTransfer->nBuffer == SUBCHANNEL_NO_BUFFER;
+	uint8* pBuffer = bSkipped ? NULL : m_pBuffers + pTransfer->nBuffer * SUBCHANNEL_MAX_BYTES;
+
+	for (uint32 i = nStartFragment; i < nStartFragment + nNumFragments; i++)
+	{
+		uint32 nFragmentOffset = i * FRAGMENT_SIZE;
+		uint32 nFragmentSize = MIN(FRAGMENT_SIZE, pTransfer->nBytes - nFragmentOffset);
+
+		// only files larger than a stream have fragments past the bitmap
+		if (i < SUBCHANNEL_MAX_FRAGMENTS)
+		{
+			uint32 nBit = 1u << (i & 31);
+			if (pTransfer->received[i >> 5] & nBit)
+			{
+				buf.SeekRelative(nFragmentSize * 8);	// duplicate
+				continue;
+			}
+
+			pTransfer->received[i >> 5] |= nBit;
+			pTransfer->nReceived++;
+		}
+
+		if (bSkipped)
+			buf.SeekRelative(nFragmentSize * 8);
+		else
+			buf.ReadBytes(pBuffer + nFragmentOffset, nFragmentSize);
+	}
+
+	// Those can't all be counted, they end with their last fragment, which
+	// the engine sends last
+	bool bComplete = pTransfer->nFragments <= SUBCHANNEL_MAX_FRAGMENTS ?
+		pTransfer->nReceived == pTransfer->nFragments : nStartFragment + nNumFragments == pTransfer->nFragments;
+
+	if (!bComplete)
+		return true;
+
+	if (bSkipped)
+	{
+		CloseTransfer(*pTransfer);
+		return true;
+	}
+
+	CompleteTransfer(*pTransfer, pOut, nOutSize, stats);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Hands out the data of a fully received transfer and releases its entry. The
+// stream buffer stays untouched until the next call, so pOut may point into it.
+//-----------------------------------------------------------------------------
+bool CSubChannelReassembler::CompleteTransfer(transfer_t& transfer, const uint8*& pOut, uint32& nOutSize, decode_stats_t& stats)
+{
+	const uint8* pBuffer = m_pBuffers + transfer.nBuffer * SUBCHANNEL_MAX_BYTES;
+
+	CloseTransfer(transfer);
+
+	if (transfer.bCompressed)
+	{
+		uint32 nUncompressedSize = net_decompress(pBuffer, transfer.nBytes, m_pOutput, SUBCHANNEL_MAX_BYTES);
+		if (!nUncompressedSize || nUncompressedSize != transfer.nUncompressedSize)
+		{
+			stats.nDecompressFailed++;
+			return false;
+		}
+
+		pBuffer = m_pOutput;
+		nOutSize = nUncompressedSize;
+	}
+	else
+	{
+		nOutSize = transfer.nBytes;
+	}
+
+	pOut = pBuffer;
+	stats.nSubChannelTransfers++;
+	return true;
+}
+
+CSubChannelReassembler::transfer_t* CSubChannelReassembler::FindTransfer(const udp_frame_t& frame, int nStream)
+{
+	for (int i = 0; i < SUBCHANNEL_MAX_OPEN; i++)
+	{
+		transfer_t& transfer = m_transfers[i];
+		if (transfer.bOpen && transfer.nStream == nStream && transfer.nSrcAddr == frame.nSrcAddr &&
+			transfer.nDstAddr == frame.nDstAddr && transfer.nSrcPort == frame.nSrcPort && transfer.nDstPort == frame.nDstPort)
+			return &transfer;
+	}
+
+	return NULL;
+}
+
+CSubChannelReassembler::transfer_t* CSubChannelReassembler::OpenTransfer(const udp_frame_t& frame, int nStream, decode_stats_t& stats)
+{
+	transfer_t* pTransfer = NULL;
+
+	for (int i = 0; i < SUBCHANNEL_MAX_OPEN && !pTransfer; i++)
+	{
+		if (!m_transfers[i].bOpen)
+			pTransfer = &m_transfers[i];
+	}
+
+	if (!pTransfer)
+	{
+		// table full, the entry freed by the eviction is the one we take
+		EvictOldest(false, stats);
+		return OpenTransfer(frame, nStream, stats);
+	}
+
+	memset(pTransfer->received, 0, sizeof(pTransfer->received));
+	pTransfer->bOpen = true;
+	pTransfer->nSrcAddr = frame.nSrcAddr;
+	pTransfer->nDstAddr = frame.nDstAddr;
+	pTransfer->nSrcPort = frame.nSrcPort;
+	pTransfer->nDstPort = frame.nDstPort;
+	pTransfer->nStream = nStream;
+	pTransfer->nReceived = 0;
+	pTransfer->nLastUs = frame.nTimestampUs;
+	pTransfer->nBuffer = SUBCHANNEL_NO_BUFFER;
+	return pTransfer;
+}
+
+void CSubChannelReassembler::CloseTransfer(transfer_t& transfer)
+{
+	if (transfer.nBuffer != SUBCHANNEL_NO_BUFFER)
+		m_freeBuffers[m_nFreeBuffers++] = transfer.nBuffer;
+
+	transfer.nBuffer = SUBCHANNEL_NO_BUFFER;
+	transfer.bOpen = false;
+}
+
+// bBuffered only considers transfers that hold a stream buffer
+bool CSubChannelReassembler::EvictOldest(bool bBuffered, decode_stats_t& stats)
+{
+	transfer_t* pOldest = NULL;
+
+	for (int i = 0; i < SUBCHANNEL_MAX_OPEN; i++)
+	{
+		transfer_t& transfer = m_transfers[i];
+		if (!transfer.bOpen || (bBuffered && transfer.nBuffer == SUBCHANNEL_NO_BUFFER))
+			continue;
+
+		if (!pOldest || transfer.nLastUs < pOldest->nLastUs)
+			pOldest = &transfer;
+	}
+
+	if (!pOldest)
+		return false;
+
+	CloseTransfer(*pOldest);
+	stats.nSubChannelDropped++;
+	return true;
+}
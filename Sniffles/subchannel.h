@@ -0,0 +1,81 @@
+#pragma once
+
+#include "platform.h"
+#include "frame.h"
+#include "stats.h"
+#include "net.h"
+
+class CBitRead;
+
+// The engine builds reliable transfers out of its reliable stream, which is
+// NET_MAX_PAYLOAD bytes. Anything bigger is a file and is parsed past.
+#define SUBCHANNEL_MAX_BYTES		NET_MAX_PAYLOAD
+#define SUBCHANNEL_MAX_FRAGMENTS	BYTES2FRAGMENTS(SUBCHANNEL_MAX_BYTES)
+
+#define SUBCHANNEL_MAX_OPEN			32		// transfers in progress per reassembler
+#define SUBCHANNEL_MAX_BUFFERS		8		// stream buffers per reassembler, ~2 MB
+#define SUBCHANNEL_NO_BUFFER		0xFFFF
+
+//-----------------------------------------------------------------------------
+// Puts reliable subchannel transfers (PACKET_FLAG_RELIABLE) back together,
+// following the engine's ReadSubChannelData. Each session has one transfer
+// per stream. A transfer is assembled in one of a few preallocated stream
+// buffers; a fragment bitmap makes sure retransmitted fragments are skipped
+// instead of copied again.
+//
+// File transfers and oversized streams are tracked just far enough to parse
+// past their fragments, and closed like the others once complete. When the
+// tables run out, the least recently updated transfer is evicted.
+//-----------------------------------------------------------------------------
+class CSubChannelReassembler
+{
+public:
+	CSubChannelReassembler();
+	~CSubChannelReassembler();
+
+	// Reads the data of one stream out of a reliable packet. Returns false when
+	// the rest of the packet can't be located, in which case the engine drops
+	// it too. Once a transfer completes, its uncompressed data is in
+	// pOut/nOutSize until the next call; otherwise nOutSize is 0.
+	bool			ReadSubChannelData(const udp_frame_t& frame, CBitRead& buf, int nStream, const uint8*& pOut, uint32& nOutSize, decode_stats_t& stats);
+
+private:
+	CSubChannelReassembler(const CSubChannelReassembler&);
+	CSubChannelReassembler& operator=(const CSubChannelReassembler&);
+
+	struct transfer_t
+	{
+		bool		bOpen;
+		uint32		nSrcAddr;
+		uint32		nDstAddr;
+		uint16		nSrcPort;
+		uint16		nDstPort;
+		int			nStream;
+		bool		bFile;
+		uint32		nTransferID;
+		bool		bCompressed;
+		uint32		nUncompressedSize;
+		uint32		nBytes;
+		uint32		nFragments;
+		uint32		nReceived;
+		uint64		nLastUs;			// for LRU eviction
+		uint16		nBuffer;			// SUBCHANNEL_NO_BUFFER when the data is skipped
+		uint32		received[(SUBCHANNEL_MAX_FRAGMENTS + 31) / 32];
+	};
+
+	transfer_t*		FindTransfer(const udp_frame_t& frame, int nStream);
+	transfer_t*		OpenTransfer(const udp_frame_t& frame, int nStream, decode_stats_t& stats);
+	void			CloseTransfer(transfer_t& transfer);
+	bool			EvictOldest(bool bBuffered, decode_stats_t& stats);
+	bool			CompleteTransfer(transfer_t& transfer, const uint8*& pOut, uint32& nOutSize, decode_stats_t& stats);
+
+	transfer_t		m_transfers[SUBCHANNEL_MAX_OPEN];
+
+	// stream buffers, SUBCHANNEL_MAX_BUFFERS * SUBCHANNEL_MAX_BYTES
+	uint8*			m_pBuffers;
+	uint16			m_freeBuffers[SUBCHANNEL_MAX_BUFFERS];
+	uint32			m_nFreeBuffers;
+
+	// compressed transfers are expanded into this
+	uint8*			m_pOutput;
+};
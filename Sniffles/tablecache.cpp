@@ -0,0 +1,220 @@
+#include "tablecache.h"
+#include "str.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+CSendTableCache g_sendTableCache;
+
+//-----------------------------------------------------------------------------
+// Read only views of a whole file
+//-----------------------------------------------------------------------------
+static void* map_file(const char* pszFile, size_t& nSize)
+{
+	void* pView = NULL;
+	nSize = 0;
+
+#ifdef _WIN32
+	HANDLE hFile = CreateFileA(pszFile, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return NULL;
+
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(hFile, &size) && size.QuadPart > 0 && (uint64)size.QuadPart <= (size_t)-1)
+	{
+		// the view keeps the mapping alive
+		HANDLE hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (hMapping)
+		{
+			pView = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(hMapping);
+		}
+		nSize = (size_t)size.QuadPart;
+	}
+
+	CloseHandle(hFile);
+#else
+	int fd = open(pszFile, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+
+	struct stat st;
+	if (fstat(fd, &st) == 0 && st.st_size > 0)
+	{
+		pView = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (pView == MAP_FAILED)
+			pView = NULL;
+		nSize = (size_t)st.st_size;
+	}
+
+	close(fd);
+#endif
+
+	return pView;
+}
+
+static void unmap_file(void* pView, size_t nSize)
+{
+#ifdef _WIN32
+	UnmapViewOfFile(pView);
+#else
+	munmap(pView, nSize);
+#endif
+}
+
+// Moves the new file over the old one, which may still be mapped
+static bool replace_file(const char* pszFrom, const char* pszTo)
+{
+#ifdef _WIN32
+	return MoveFileExA(pszFrom, pszTo, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	return rename(pszFrom, pszTo) == 0;
+#endif
+}
+
+CSendTableCache::CSendTableCache()
+{
+	m_pLatest = NULL;
+}
+
+CSendTableCache::~CSendTableCache()
+{
+	for (size_t i = 0; i < m_layouts.size(); i++)
+	{
+		if (m_layouts[i]->pMapping)
+			unmap_file(m_layouts[i]->pMapping, m_layouts[i]->nMappingSize);
+		delete m_layouts[i];
+	}
+}
+
+void CSendTableCache::Open(const char* pszFile)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_strFile = pszFile;
+
+	size_t nSize;
+	void* pView = map_file(pszFile, nSize);
+	if (!pView)
+		return;	// nothing cached yet
+
+	// the layout is checked again by every Attach, this only weeds out
+	// files that aren't ours
+	send_table_cache_header_t header;
+	bool bValid = nSize >= sizeof(header);
+	if (bValid)
+	{
+		memcpy(&header, pView, sizeof(header));
+		bValid = header.nMagic == SENDTABLE_CACHE_MAGIC && header.nVersion == SENDTABLE_CACHE_VERSION &&
+			header.nLayoutSize == nSize - sizeof(header);
+	}
+
+	if (!bValid)
+	{
+		unmap_file(pView, nSize);
+		outf("[tablecache] %s isn't a send table cache, it will be replaced\n", pszFile);
+		return;
+	}
+
+	layout_t* pLayout = new layout_t;
+	pLayout->key = header.key;
+	pLayout->pData = (const uint8*)pView + sizeof(header);
+	pLayout->nSize = header.nLayoutSize;
+	pLayout->pMapping = pView;
+	pLayout->nMappingSize = nSize;
+
+	m_layouts.push_back(pLayout);
+	m_pLatest = pLayout;
+}
+
+bool CSendTableCache::HasLayout()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return m_pLatest != NULL;
+}
+
+bool CSendTableCache::Load(const send_table_key_t& key, CSendTables& tables)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (size_t i = m_layouts.size(); i-- > 0; )
+	{
+		if (m_layouts[i]->key == key)
+			return tables.Attach(m_layouts[i]->pData, m_layouts[i]->nSize);
+	}
+
+	return false;
+}
+
+bool CSendTableCache::LoadLatest(CSendTables& tables)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return m_pLatest && tables.Attach(m_pLatest->pData, m_pLatest->nSize);
+}
+
+void CSendTableCache::Store(const send_table_key_t& key, const CSendTables& tables)
+{
+	if (!IsOpen() || !tables.IsReady())
+		return;
+
+	// outside the lock, it's the expensive part
+	std::string strLayout;
+	tables.Save(strLayout);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_pLatest && m_pLatest->key == key)
+		return;
+
+	layout_t* pLayout = new layout_t;
+	pLayout->key = key;
+	pLayout->strData.swap(strLayout);
+	pLayout->pData = (const uint8*)pLayout->strData.data();
+	pLayout->nSize = pLayout->strData.size();
+	pLayout->pMapping = NULL;
+	pLayout->nMappingSize = 0;
+
+	m_layouts.push_back(pLayout);
+	m_pLatest = pLayout;
+
+	if (!WriteFile(key, pLayout->strData))
+		outf("[tablecache] can't write %s\n", m_strFile.c_str());
+}
+
+// Written next to the cache and moved over it, so a reader never sees half a file
+bool CSendTableCache::WriteFile(const send_table_key_t& key, const std::string& strLayout)
+{
+	send_table_cache_header_t header;
+	header.nMagic = SENDTABLE_CACHE_MAGIC;
+	header.nVersion = SENDTABLE_CACHE_VERSION;
+	header.key = key;
+	header.nLayoutSize = (uint32)strLayout.size();
+	header.nReserved = 0;
+
+	std::string strTemp = m_strFile + ".tmp";
+
+	FILE* pFile = NULL;
+	if (fopen_s(&pFile, strTemp.c_str(), "wb") != 0 || !pFile)
+		return false;
+
+	bool bWritten = fwrite(&header, sizeof(header), 1, pFile) == 1 &&
+		fwrite(strLayout.data(), 1, strLayout.size(), pFile) == strLayout.size();
+	bWritten = fclose(pFile) == 0 && bWritten;
+
+	if (!bWritten || !replace_file(strTemp.c_str(), m_strFile.c_str()))
+	{
+		remove(strTemp.c_str());
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "platform.h"
+#include "sendtable.h"
+
+#define SENDTABLE_CACHE_MAGIC		0x43545353	// "SSTC"
+#define SENDTABLE_CACHE_VERSION		1
+
+// What a layout depends on: the game build and the number of server classes,
+// all from svc_ServerInfo
+struct send_table_key_t
+{
+	uint32	nClientCrc;
+	int32	nProtocol;
+	int32	nMaxClasses;
+};
+
+static inline bool operator==(const send_table_key_t& a, const send_table_key_t& b)
+{
+	return a.nClientCrc == b.nClientCrc && a.nProtocol == b.nProtocol && a.nMaxClasses == b.nMaxClasses;
+}
+
+// Start of the cache file, the layout follows right after it
+struct send_table_cache_header_t
+{
+	uint32				nMagic;			// SENDTABLE_CACHE_MAGIC
+	uint32				nVersion;		// SENDTABLE_CACHE_VERSION
+	send_table_key_t	key;
+	uint32				nLayoutSize;	// bytes of the send_table_layout_t block
+	uint32				nReserved;
+};
+
+//-----------------------------------------------------------------------------
+// Flattened send tables kept on disk between runs, so a session whose signon
+// we never saw can still have its entities decoded. The file holds the last
+// layout built and is mapped as is: sessions point their CSendTables at the
+// mapping instead of parsing and flattening anything.
+//
+// Every layout handed out stays valid for the life of the cache, since
+// decoders keep using it after a newer one is stored. Safe to use from any
+// decode thread.
+//-----------------------------------------------------------------------------
+class CSendTableCache
+{
+public:
+	CSendTableCache();
+	~CSendTableCache();
+
+	// Maps the file if it holds a layout. Layouts built later are written to
+	// it either way.
+	void			Open(const char* pszFile);
+	bool			IsOpen() const { return !m_strFile.empty(); }
+	bool			HasLayout();
+
+	// Attaches the tables to the cached layout of key, false without one
+	bool			Load(const send_table_key_t& key, CSendTables& tables);
+
+	// The layout stored last whatever its key, for sessions joined mid-match
+	// that never sent us their svc_ServerInfo
+	bool			LoadLatest(CSendTables& tables);
+
+	// Keeps a freshly built layout and replaces the file with it, unless it
+	// already holds the key
+	void			Store(const send_table_key_t& key, const CSendTables& tables);
+
+private:
+	CSendTableCache(const CSendTableCache&);
+	CSendTableCache& operator=(const CSendTableCache&);
+
+	struct layout_t
+	{
+		send_table_key_t	key;
+		const uint8*		pData;			// send_table_layout_t block
+		size_t				nSize;
+		void*				pMapping;		// file view it lives in, or NULL
+		size_t				nMappingSize;
+		std::string			strData;		// or the copy Store made
+	};
+
+	bool			WriteFile(const send_table_key_t& key, const std::string& strLayout);
+
+	std::mutex				m_mutex;
+	std::string				m_strFile;
+	std::vector<layout_t*>	m_layouts;		// never freed before the cache
+	layout_t*				m_pLatest;
+};
+
+extern CSendTableCache g_sendTableCache;
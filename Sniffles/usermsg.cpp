@@ -0,0 +1,206 @@
+#include "usermsg.h"
+#include "decoder.h"
+#include "wirefields.h"
+#include "str.h"
+
+#include "google/protobuf/wire_format_lite.h"
+
+using google::protobuf::internal::WireFormatLite;
+
+CUserMessageDispatcher g_userMessages;
+
+CUserMessageDispatcher::CUserMessageDispatcher()
+{
+	m_nSubscribed = 0;
+}
+
+void CUserMessageDispatcher::SubscribeRaw(int nType, pfnRawMessageHandler_t pfnHandler, void* pContext)
+{
+	AddHandler(nType, true, (pfnGenericHandler_t)pfnHandler, pContext);
+}
+
+void CUserMessageDispatcher::AddHandler(int nType, bool bRaw, pfnGenericHandler_t pfnHandler, void* pContext)
+{
+	if ((uint32)nType >= USER_MESSAGE_MAX_TYPES)
+		return;
+
+	handler_t handler;
+	handler.pfnHandler = pfnHandler;
+	handler.pContext = pContext;
+
+	if (bRaw)
+		m_handlers[nType].raw.push_back(handler);
+	else
+		m_handlers[nType].typed.push_back(handler);
+
+	m_nSubscribed |= 1ull << nType;
+}
+
+bool CUserMessageDispatcher::Dispatch(int nType, const uint8* pData, int nSize, const message_source_t& source, CUserMessagePool& pool) const
+{
+	if (!IsSubscribed(nType))
+		return true;
+
+	const message_handlers_t& handlers = m_handlers[nType];
+
+	for (size_t i = 0; i < handlers.raw.size(); i++)
+	{
+		const handler_t& handler = handlers.raw[i];
+		((pfnRawMessageHandler_t)handler.pfnHandler)(nType, pData, nSize, source, handler.pContext);
+	}
+
+	if (handlers.typed.empty())
+		return true;
+
+	const message_type_t* pType = GetMessageType(nType);
+	if (!pType)
+		return true;
+
+	return (this->*pType->pfnParse)(nType, pData, nSize, source, pool);
+}
+
+template <typename T>
+bool CUserMessageDispatcher::ParseAndDispatch(int nType, const uint8* pData, int nSize, const message_source_t& source, CUserMessagePool& pool) const
+{
+	typedef void (*pfnHandler_t)(const T& msg, int nSize, const message_source_t& source, void* pContext);
+
+	T& msg = pool.Get<T>();
+	if (!msg.ParseFromArray(pData, nSize))
+		return false;
+
+	const std::vector<handler_t>& typed = m_handlers[nType].typed;
+	for (size_t i = 0; i < typed.size(); i++)
+		((pfnHandler_t)typed[i].pfnHandler)(msg, nSize, source, typed[i].pContext);
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// svc_UserMessage is msg_type followed by msg_data. Both are read in place;
+// the payload is only looked at when its type has a handler.
+//-----------------------------------------------------------------------------
+bool CUserMessageDispatcher::DispatchUserMessage(const uint8* pData, int nSize, const message_source_t& source, CUserMessagePool& pool, decode_stats_t& stats) const
+{
+	const uint8* p = pData;
+	const uint8* pEnd = pData + nSize;
+
+	int nType = -1;
+	const uint8* pPayload = NULL;
+	uint32 nPayloadSize = 0;
+
+	while (p < pEnd)
+	{
+		uint64 nTag;
+		if (!wire_read_varint(p, pEnd, nTag))
+			return false;
+
+		uint32 nField = (uint32)(nTag >> 3);
+		int nWireType = (int)(nTag & 7);
+
+		if (nField == CSVCMsg_UserMessage::kMsgTypeFieldNumber && nWireType == WireFormatLite::WIRETYPE_VARINT)
+		{
+			uint64 nValue;
+			if (!wire_read_varint(p, pEnd, nValue))
+				return false;
+			nType = nValue < USER_MESSAGE_MAX_TYPES ? (int)nValue : -1;
+		}
+		else if (nField == CSVCMsg_UserMessage::kMsgDataFieldNumber && nWireType == WireFormatLite::WIRETYPE_LENGTH_DELIMITED)
+		{
+			if (!wire_read_bytes(p, pEnd, pPayload, nPayloadSize))
+				return false;
+		}
+		else if (!wire_skip_field(p, pEnd, nWireType))
+			return false;
+	}
+
+	if (!IsSubscribed(nType))
+	{
+		stats.nUserMessagesSkipped++;
+		return true;
+	}
+
+	// no msg_data is an empty payload, which parses
+	static const uint8 s_nEmpty = 0;
+	stats.nUserMessages++;
+	return Dispatch(nType, pPayload ? pPayload : &s_nEmpty, (int)nPayloadSize, source, pool);
+}
+
+//-----------------------------------------------------------------------------
+// Type -> message type table, NULL entries for types the protocol doesn't use
+//-----------------------------------------------------------------------------
+const CUserMessageDispatcher::message_type_t* CUserMessageDispatcher::GetMessageType(int nType)
+{
+	struct message_table_t
+	{
+		message_type_t	types[USER_MESSAGE_MAX_TYPES];
+
+		message_table_t()
+		{
+			memset(types, 0, sizeof(types));
+
+#define ADD_USER_MESSAGE_TYPE(id, type) \
+			types[id].pszName = #id; \
+			types[id].pfnParse = &CUserMessageDispatcher::ParseAndDispatch<type>;
+			USER_MESSAGE_TYPES(ADD_USER_MESSAGE_TYPE)
+#undef ADD_USER_MESSAGE_TYPE
+		}
+	};
+
+	// built on first use, safe to race from several decoder threads
+	static const message_table_t s_table;
+
+	if ((uint32)nType >= USER_MESSAGE_MAX_TYPES || !s_table.types[nType].pszName)
+		return NULL;
+
+	return &s_table.types[nType];
+}
+
+const char* CUserMessageDispatcher::GetMessageName(int nType)
+{
+	const message_type_t* pType = GetMessageType(nType);
+	return pType ? pType->pszName : NULL;
+}
+
+int CUserMessageDispatcher::FindMessage(const char* pszName)
+{
+	for (int nType = 0; nType < USER_MESSAGE_MAX_TYPES; nType++)
+	{
+		const char* pszMessage = GetMessageName(nType);
+		if (pszMessage && !strcmp(pszMessage, pszName))
+			return nType;
+	}
+
+	return -1;
+}
+
+//-----------------------------------------------------------------------------
+// Dispatcher glue, each decoder parses into its own pool
+//-----------------------------------------------------------------------------
+static void on_user_message(int /*nCmd*/, const uint8* pData, int nSize, const message_source_t& source, void* pContext)
+{
+	const CUserMessageDispatcher* pUserMessages = (const CUserMessageDispatcher*)pContext;
+	CNetDecoder* pDecoder = source.pDecoder;
+
+	if (!pUserMessages->DispatchUserMessage(pData, nSize, source, pDecoder->GetUserMessagePool(), pDecoder->m_stats))
+		pDecoder->m_stats.nParseFailed++;
+}
+
+void add_user_message_handlers(CMessageDispatcher& dispatcher, const CUserMessageDispatcher& userMessages)
+{
+	dispatcher.SubscribeRaw(svc_UserMessage, on_user_message, (void*)&userMessages);
+}
+
+template <typename T>
+static void print_user_message(const T& msg, int nSize, const message_source_t& /*source*/, void* /*pContext*/)
+{
+	MsgPrintf(msg, nSize, "%s", msg.DebugString().c_str());
+}
+
+void add_user_message_print_handlers(CUserMessageDispatcher& userMessages)
+{
+	userMessages.Subscribe(print_user_message<CCSUsrMsg_SayText>);
+	userMessages.Subscribe(print_user_message<CCSUsrMsg_SayText2>);
+	userMessages.Subscribe(print_user_message<CCSUsrMsg_TextMsg>);
+	userMessages.Subscribe(print_user_message<CCSUsrMsg_Damage>);
+	userMessages.Subscribe(print_user_message<CCSUsrMsg_AdjustMoney>);
+}
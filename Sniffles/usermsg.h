@@ -0,0 +1,191 @@
+#pragma once
+
+#include <vector>
+
+#include "platform.h"
+#include "net.h"
+#include "dispatch.h"
+#include "stats.h"
+
+// ECstrike15UserMessages ids are below this
+#define USER_MESSAGE_MAX_TYPES		64
+
+// Every message in cstrike15_usermessages_public.proto with the id it is sent under
+#define USER_MESSAGE_TYPES(X) \
+	X(CS_UM_VGUIMenu,			CCSUsrMsg_VGUIMenu) \
+	X(CS_UM_Geiger,				CCSUsrMsg_Geiger) \
+	X(CS_UM_Train,				CCSUsrMsg_Train) \
+	X(CS_UM_HudText,			CCSUsrMsg_HudText) \
+	X(CS_UM_SayText,			CCSUsrMsg_SayText) \
+	X(CS_UM_SayText2,			CCSUsrMsg_SayText2) \
+	X(CS_UM_TextMsg,			CCSUsrMsg_TextMsg) \
+	X(CS_UM_HudMsg,				CCSUsrMsg_HudMsg) \
+	X(CS_UM_ResetHud,			CCSUsrMsg_ResetHud) \
+	X(CS_UM_GameTitle,			CCSUsrMsg_GameTitle) \
+	X(CS_UM_Shake,				CCSUsrMsg_Shake) \
+	X(CS_UM_Fade,				CCSUsrMsg_Fade) \
+	X(CS_UM_Rumble,				CCSUsrMsg_Rumble) \
+	X(CS_UM_CloseCaption,		CCSUsrMsg_CloseCaption) \
+	X(CS_UM_CloseCaptionDirect,	CCSUsrMsg_CloseCaptionDirect) \
+	X(CS_UM_SendAudio,			CCSUsrMsg_SendAudio) \
+	X(CS_UM_RawAudio,			CCSUsrMsg_RawAudio) \
+	X(CS_UM_VoiceMask,			CCSUsrMsg_VoiceMask) \
+	X(CS_UM_RequestState,		CCSUsrMsg_RequestState) \
+	X(CS_UM_Damage,				CCSUsrMsg_Damage) \
+	X(CS_UM_RadioText,			CCSUsrMsg_RadioText) \
+	X(CS_UM_HintText,			CCSUsrMsg_HintText) \
+	X(CS_UM_KeyHintText,		CCSUsrMsg_KeyHintText) \
+	X(CS_UM_ProcessSpottedEntityUpdate,	CCSUsrMsg_ProcessSpottedEntityUpdate) \
+	X(CS_UM_ReloadEffect,		CCSUsrMsg_ReloadEffect) \
+	X(CS_UM_AdjustMoney,		CCSUsrMsg_AdjustMoney) \
+	X(CS_UM_StopSpectatorMode,	CCSUsrMsg_StopSpectatorMode) \
+	X(CS_UM_KillCam,			CCSUsrMsg_KillCam) \
+	X(CS_UM_DesiredTimescale,	CCSUsrMsg_DesiredTimescale) \
+	X(CS_UM_CurrentTimescale,	CCSUsrMsg_CurrentTimescale) \
+	X(CS_UM_AchievementEvent,	CCSUsrMsg_AchievementEvent) \
+	X(CS_UM_MatchEndConditions,	CCSUsrMsg_MatchEndConditions) \
+	X(CS_UM_DisconnectToLobby,	CCSUsrMsg_DisconnectToLobby) \
+	X(CS_UM_DisplayInventory,	CCSUsrMsg_DisplayInventory) \
+	X(CS_UM_WarmupHasEnded,		CCSUsrMsg_WarmupHasEnded) \
+	X(CS_UM_ClientInfo,			CCSUsrMsg_ClientInfo) \
+	X(CS_UM_CallVoteFailed,		CCSUsrMsg_CallVoteFailed) \
+	X(CS_UM_VoteStart,			CCSUsrMsg_VoteStart) \
+	X(CS_UM_VotePass,			CCSUsrMsg_VotePass) \
+	X(CS_UM_VoteFailed,			CCSUsrMsg_VoteFailed) \
+	X(CS_UM_VoteSetup,			CCSUsrMsg_VoteSetup) \
+	X(CS_UM_SendLastKillerDamageToClient,	CCSUsrMsg_SendLastKillerDamageToClient) \
+	X(CS_UM_ItemPickup,			CCSUsrMsg_ItemPickup) \
+	X(CS_UM_ShowMenu,			CCSUsrMsg_ShowMenu) \
+	X(CS_UM_BarTime,			CCSUsrMsg_BarTime) \
+	X(CS_UM_AmmoDenied,			CCSUsrMsg_AmmoDenied) \
+	X(CS_UM_MarkAchievement,	CCSUsrMsg_MarkAchievement) \
+	X(CS_UM_ItemDrop,			CCSUsrMsg_ItemDrop) \
+	X(CS_UM_GlowPropTurnOff,	CCSUsrMsg_GlowPropTurnOff)
+
+// user_message_id<CCSUsrMsg_SayText2>::value == CS_UM_SayText2
+template <typename T> struct user_message_id;
+
+#define DECLARE_USER_MESSAGE_ID(id, type) \
+	template <> struct user_message_id<type> { enum { value = id }; };
+USER_MESSAGE_TYPES(DECLARE_USER_MESSAGE_ID)
+#undef DECLARE_USER_MESSAGE_ID
+
+//-----------------------------------------------------------------------------
+// One message object per user message type, like CMessagePool
+//-----------------------------------------------------------------------------
+class CUserMessagePool
+{
+public:
+	CUserMessagePool()
+	{
+		memset(m_pMessages, 0, sizeof(m_pMessages));
+	}
+
+	~CUserMessagePool()
+	{
+		for (int i = 0; i < USER_MESSAGE_MAX_TYPES; i++)
+			delete m_pMessages[i];
+	}
+
+	template <typename T>
+	T&		Get()
+	{
+		::google::protobuf::Message*& pMessage = m_pMessages[user_message_id<T>::value];
+		if (!pMessage)
+			pMessage = new T;
+
+		return *static_cast<T*>(pMessage);
+	}
+
+private:
+	CUserMessagePool(const CUserMessagePool&);
+	CUserMessagePool& operator=(const CUserMessagePool&);
+
+	::google::protobuf::Message*	m_pMessages[USER_MESSAGE_MAX_TYPES];
+};
+
+//-----------------------------------------------------------------------------
+// The second level of dispatch, for the payloads svc_UserMessage wraps. It is
+// read straight from the svc_UserMessage body: msg_data is parsed into its
+// CCSUsrMsg_* type only when someone subscribed to that type, and skipped in
+// place otherwise. The outer message is never parsed, so its bytes are never
+// copied either.
+//
+// Handlers are registered at startup like CMessageDispatcher's, and get the
+// message's CCSUsrMsg_* body and its size.
+//-----------------------------------------------------------------------------
+class CUserMessageDispatcher
+{
+public:
+	CUserMessageDispatcher();
+
+	//   void OnSayText2(const CCSUsrMsg_SayText2& msg, int nSize, const message_source_t& source, void* pContext);
+	//   userMessages.Subscribe(OnSayText2);
+	template <typename T>
+	void			Subscribe(void (*pfnHandler)(const T& msg, int nSize, const message_source_t& source, void* pContext), void* pContext = NULL)
+	{
+		AddHandler(user_message_id<T>::value, false, (pfnGenericHandler_t)pfnHandler, pContext);
+	}
+
+	// Raw handlers get the user message type as nCmd
+	void			SubscribeRaw(int nType, pfnRawMessageHandler_t pfnHandler, void* pContext = NULL);
+
+	bool			IsSubscribed(int nType) const
+	{
+		return (uint32)nType < USER_MESSAGE_MAX_TYPES && ((m_nSubscribed >> nType) & 1);
+	}
+
+	// Hands a CCSUsrMsg_* body to its handlers. False if it had to be parsed
+	// and didn't parse.
+	bool			Dispatch(int nType, const uint8* pData, int nSize, const message_source_t& source, CUserMessagePool& pool) const;
+
+	// Splits a serialized svc_UserMessage and dispatches its payload. False
+	// when it's malformed or the payload didn't parse.
+	bool			DispatchUserMessage(const uint8* pData, int nSize, const message_source_t& source, CUserMessagePool& pool, decode_stats_t& stats) const;
+
+	static const char*	GetMessageName(int nType);
+
+	// Type of a message by the name GetMessageName gives it, -1 if unknown
+	static int			FindMessage(const char* pszName);
+
+private:
+	typedef void (*pfnGenericHandler_t)();
+
+	struct handler_t
+	{
+		pfnGenericHandler_t	pfnHandler;
+		void*				pContext;
+	};
+
+	struct message_handlers_t
+	{
+		std::vector<handler_t>	raw;
+		std::vector<handler_t>	typed;
+	};
+
+	void			AddHandler(int nType, bool bRaw, pfnGenericHandler_t pfnHandler, void* pContext);
+
+	template <typename T>
+	bool			ParseAndDispatch(int nType, const uint8* pData, int nSize, const message_source_t& source, CUserMessagePool& pool) const;
+
+	struct message_type_t
+	{
+		const char*	pszName;
+		bool		(CUserMessageDispatcher::*pfnParse)(int nType, const uint8* pData, int nSize, const message_source_t& source, CUserMessagePool& pool) const;
+	};
+
+	static const message_type_t*	GetMessageType(int nType);
+
+	uint64				m_nSubscribed;		// bit per type with at least one handler
+	message_handlers_t	m_handlers[USER_MESSAGE_MAX_TYPES];
+};
+
+// User message handlers the svc_UserMessage handler hands payloads to
+extern CUserMessageDispatcher g_userMessages;
+
+// Subscribes svc_UserMessage on dispatcher and routes the payloads through
+// userMessages, which must outlive it
+void add_user_message_handlers(CMessageDispatcher& dispatcher, const CUserMessageDispatcher& userMessages);
+
+// Prints chat, damage and money messages
+void add_user_message_print_handlers(CUserMessageDispatcher& userMessages);
@@ -0,0 +1,139 @@
+#include "wirefields.h"
+
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/wire_format_lite.h"
+
+using google::protobuf::io::CodedInputStream;
+using google::protobuf::internal::WireFormatLite;
+
+bool extract_fields(const uint8* pData, int nSize, wire_field_t* pFields, int nFields)
+{
+	int nMaxField = 0;
+
+	for (int i = 0; i < nFields; i++)
+	{
+		if (pFields[i].nField > nMaxField)
+			nMaxField = pFields[i].nField;
+		pFields[i].nCount = 0;
+		pFields[i].nWireType = 0;
+		pFields[i].nValue = 0;
+		pFields[i].pData = NULL;
+		pFields[i].nSize = 0;
+	}
+
+	CodedInputStream input(pData, nSize);
+
+	while (true)
+	{
+		uint32 tag = input.ReadTag();
+		if (!tag)
+			return input.ConsumedEntireMessage();
+
+		int nField = WireFormatLite::GetTagFieldNumber(tag);
+		int nWireType = WireFormatLite::GetTagWireType(tag);
+
+		// Serializers write fields in field number order, nothing we want
+		// can follow
+		if (nField > nMaxField)
+			return true;
+
+		wire_field_t* pField = NULL;
+		for (int i = 0; i < nFields && !pField; i++)
+		{
+			if (pFields[i].nField == nField)
+				pField = &pFields[i];
+		}
+
+		if (!pField)
+		{
+			if (!WireFormatLite::SkipField(&input, tag))
+				return false;
+			continue;
+		}
+
+		bool bOk = true;
+		switch (nWireType)
+		{
+		case WireFormatLite::WIRETYPE_VARINT:
+			bOk = input.ReadVarint64(&pField->nValue);
+			break;
+
+		case WireFormatLite::WIRETYPE_FIXED32:
+		{
+			uint32 nValue = 0;
+			bOk = input.ReadLittleEndian32(&nValue);
+			pField->nValue = nValue;
+		}
+		break;
+
+		case WireFormatLite::WIRETYPE_FIXED64:
+			bOk = input.ReadLittleEndian64(&pField->nValue);
+			break;
+
+		case WireFormatLite::WIRETYPE_LENGTH_DELIMITED:
+		{
+			uint32 nLength = 0;
+			const void* pBuffer = NULL;
+			int nBufferSize = 0;
+
+			if (!input.ReadVarint32(&nLength))
+				return false;
+
+			// The whole message is one flat buffer, so the payload is
+			// contiguous. An empty payload may sit at the very end, where
+			// there is no buffer left to point at.
+			if (input.GetDirectBufferPointer(&pBuffer, &nBufferSize))
+				bOk = nLength <= (uint32)nBufferSize;
+			else
+				bOk = nLength == 0;
+
+			if (bOk)
+			{
+				pField->pData = (const uint8*)pBuffer;
+				pField->nSize = (int)nLength;
+				bOk = input.Skip((int)nLength);
+			}
+		}
+		break;
+
+		default:
+			// groups, the protocol doesn't use them
+			bOk = WireFormatLite::SkipField(&input, tag);
+			break;
+		}
+
+		if (!bOk)
+			return false;
+
+		pField->nWireType = nWireType;
+		pField->nCount++;
+	}
+}
+
+bool wire_skip_field(const uint8*& p, const uint8* pEnd, int nWireType)
+{
+	uint64 nValue;
+	const uint8* pData;
+	uint32 nLength;
+
+	switch (nWireType)
+	{
+	case WireFormatLite::WIRETYPE_VARINT:
+		return wire_read_varint(p, pEnd, nValue);
+	case WireFormatLite::WIRETYPE_FIXED64:
+		if (pEnd - p < 8)
+			return false;
+		p += 8;
+		return true;
+	case WireFormatLite::WIRETYPE_LENGTH_DELIMITED:
+		return wire_read_bytes(p, pEnd, pData, nLength);
+	case WireFormatLite::WIRETYPE_FIXED32:
+		if (pEnd - p < 4)
+			return false;
+		p += 4;
+		return true;
+	default:
+		// groups, the protocol doesn't use them
+		return false;
+	}
+}
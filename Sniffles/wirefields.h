@@ -0,0 +1,88 @@
+#pragma once
+
+#include "platform.h"
+#include "packetbitbuf.h"
+
+//-----------------------------------------------------------------------------
+// A field to pull out of a serialized message. Set nField, typically from the
+// generated constants (CNETMsg_Tick::kTickFieldNumber), and extract_fields
+// fills in the rest. Strings, bytes and sub messages point into the message
+// itself, nothing is copied.
+//-----------------------------------------------------------------------------
+struct wire_field_t
+{
+	int				nField;
+	int				nCount;			// times the field was seen, 0 if absent
+	int				nWireType;		// WireFormatLite::WireType of the last occurrence
+	uint64			nValue;			// varint, fixed32 or fixed64 payload
+	const uint8*	pData;			// length delimited payload
+	int				nSize;
+
+	uint32			AsUInt32() const { return (uint32)nValue; }
+	int32			AsInt32() const { return (int32)nValue; }
+	uint64			AsUInt64() const { return nValue; }
+	bool			AsBool() const { return nValue != 0; }
+
+	float AsFloat() const
+	{
+		uint32 nBits = (uint32)nValue;
+		float flValue;
+		memcpy(&flValue, &nBits, sizeof(flValue));
+		return flValue;
+	}
+};
+
+// Walks the wire format once with a CodedInputStream and fills in the
+// requested fields; everything else is skipped unparsed. Like protobuf, the
+// last occurrence of a field wins. The walk stops at the first field numbered
+// above every requested one, since serializers emit fields in order. Never
+// allocates. Returns false when the message is malformed, the fields found up
+// to that point are still set.
+bool extract_fields(const uint8* pData, int nSize, wire_field_t* pFields, int nFields);
+
+//-----------------------------------------------------------------------------
+// In place readers for code that walks a message itself. p moves past what
+// was read, and never beyond pEnd.
+//-----------------------------------------------------------------------------
+static inline bool wire_read_varint(const uint8*& p, const uint8* pEnd, uint64& nValue)
+{
+	// up to 8 bytes with one load while that many are left
+	if (pEnd - p >= 8)
+	{
+		uint64 nWindow;
+		memcpy(&nWindow, p, sizeof(nWindow));
+		int nBytes = bitbuf::DecodeVarIntWindow(nWindow, 0x8080808080808080ull, nValue);
+		if (nBytes)
+		{
+			p += nBytes;
+			return true;
+		}
+	}
+
+	nValue = 0;
+	for (int nShift = 0; nShift < 64 && p < pEnd; nShift += 7)
+	{
+		uint8 nByte = *p++;
+		nValue |= (uint64)(nByte & 0x7F) << nShift;
+		if (!(nByte & 0x80))
+			return true;
+	}
+
+	return false;
+}
+
+// Length delimited payload, left where it is
+static inline bool wire_read_bytes(const uint8*& p, const uint8* pEnd, const uint8*& pData, uint32& nLength)
+{
+	uint64 nValue;
+	if (!wire_read_varint(p, pEnd, nValue) || nValue > (uint64)(pEnd - p))
+		return false;
+
+	pData = p;
+	nLength = (uint32)nValue;
+	p += nLength;
+	return true;
+}
+
+// Steps over the value of a field with the given wire type
+bool wire_skip_field(const uint8*& p, const uint8* pEnd, int nWireType);